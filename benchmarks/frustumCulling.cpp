@@ -0,0 +1,117 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+// Microbenchmark of the batched frustum culling of CSceneManager::drawAll().
+// Culls 100k random boxes with CFrustumCuller and with the per corner test
+// isCulled() used before, and checks that both agree.
+
+#include <irrlicht.h>
+#include "CFrustumCuller.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace irr;
+using namespace scene;
+
+namespace
+{
+	const u32 BOX_COUNT = 100000;
+	const u32 BATCH_RUNS = 100;
+	const u32 CORNER_RUNS = 10;
+
+	// what isCulled() does for a node with an identity transformation
+	bool isOutsideByCorners(const SViewFrustum& frustum, const core::aabbox3df& box, u32 tests)
+	{
+		if ((tests & EAC_BOX) && !box.intersectsWithBox(frustum.getBoundingBox()))
+			return true;
+
+		if (tests & EAC_FRUSTUM_BOX)
+		{
+			core::vector3df edges[8];
+			box.getEdges(edges);
+
+			for (s32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+			{
+				bool boxInFrustum = false;
+				for (u32 j=0; j<8; ++j)
+				{
+					if (frustum.planes[i].classifyPointRelation(edges[j]) != core::ISREL3D_FRONT)
+					{
+						boxInFrustum = true;
+						break;
+					}
+				}
+
+				if (!boxInFrustum)
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	f64 millisecondsSince(const std::chrono::steady_clock::time_point& start)
+	{
+		return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main()
+{
+	core::matrix4 projection;
+	projection.buildProjectionMatrixPerspectiveFovLH(1.2f, 4.f/3.f, 1.f, 3000.f);
+	core::matrix4 view;
+	view.buildCameraLookAtMatrixLH(core::vector3df(0,0,0), core::vector3df(1,0.2f,0.5f), core::vector3df(0,1,0));
+
+	SViewFrustum frustum;
+	frustum.setFrom(projection * view, true);
+	frustum.cameraPosition.set(0,0,0);
+	frustum.recalculateBoundingBox();
+
+	// boxes of all sizes around the camera, a third of them with each kind of test
+	core::array<core::aabbox3df> boxes;
+	core::array<u32> tests;
+	CFrustumCuller culler;
+	srand(1);
+	for (u32 i=0; i<BOX_COUNT; ++i)
+	{
+		const core::vector3df center((f32)(rand()%8000-4000), (f32)(rand()%2000-1000), (f32)(rand()%8000-4000));
+		const core::vector3df extent((f32)(1+rand()%50));
+		boxes.push_back(core::aabbox3df(center - extent, center + extent));
+
+		const u32 test = (i%3 == 0) ? EAC_BOX : (i%3 == 1) ? EAC_FRUSTUM_BOX : EAC_BOX|EAC_FRUSTUM_BOX;
+		tests.push_back(test);
+		culler.addBox(boxes[i], test);
+	}
+
+	culler.cull(frustum);
+	u32 visible = 0;
+	u32 mismatches = 0;
+	for (u32 i=0; i<BOX_COUNT; ++i)
+	{
+		const bool batchVisible = culler.isVisible(i);
+		if (batchVisible)
+			++visible;
+		if (batchVisible == isOutsideByCorners(frustum, boxes[i], tests[i]))
+			++mismatches;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (u32 r=0; r<BATCH_RUNS; ++r)
+		culler.cull(frustum);
+	const f64 batchTime = millisecondsSince(start) / BATCH_RUNS;
+
+	start = std::chrono::steady_clock::now();
+	u32 outside = 0;
+	for (u32 r=0; r<CORNER_RUNS; ++r)
+		for (u32 i=0; i<BOX_COUNT; ++i)
+			outside += isOutsideByCorners(frustum, boxes[i], tests[i]) ? 1 : 0;
+	const f64 cornerTime = millisecondsSince(start) / CORNER_RUNS;
+
+	printf("%u boxes, %u visible, %u mismatches\n", BOX_COUNT, visible, mismatches);
+	printf("CFrustumCuller::cull()  %8.3f ms\n", batchTime);
+	printf("per corner test         %8.3f ms\n", cornerTime);
+
+	return (mismatches == 0 && outside == (BOX_COUNT - visible) * CORNER_RUNS) ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+// Microbenchmark of IInstancedMeshSceneNode on the null driver.
+// Draws 100k cubes as mesh scene nodes and as instances of one node, once
+// expanded on the CPU and once with a driver claiming hardware instancing,
+// and prints the draw calls and the CPU time of drawAll() for each.
+
+#include <irrlicht.h>
+#include "CIrrDeviceStub.h"
+#include "CNullDriver.h"
+#include <chrono>
+#include <stdio.h>
+
+using namespace irr;
+using namespace scene;
+
+namespace
+{
+	const s32 GRID_SIZE = 316;
+	const u32 FRAME_RUNS = 5;
+
+	enum E_SETUP
+	{
+		ES_MESH_NODES,
+		ES_INSTANCES
+	};
+
+	//! Null driver which draws all instances of a buffer with one call
+	class CInstancingNullDriver : public video::CNullDriver
+	{
+	public:
+		CInstancingNullDriver(io::IFileSystem* fs)
+			: CNullDriver(fs, core::dimension2d<u32>(800,600)) {}
+
+		virtual bool canDrawInstances(const IMeshBuffer* mb) const _IRR_OVERRIDE_
+		{
+			return true;
+		}
+	};
+
+	struct SResult
+	{
+		f64 FrameTime;
+		u32 DrawCalls;
+		u32 Primitives;
+	};
+
+	SResult drawScene(video::IVideoDriver* driver, io::IFileSystem* fs, E_SETUP setup, f32 farValue)
+	{
+		ISceneManager* smgr = createSceneManager(driver, fs, 0, 0);
+		IMesh* cube = smgr->getGeometryCreator()->createCubeMesh(core::vector3df(1,1,1), ECMT_1BUF_12VTX_NA);
+
+		IInstancedMeshSceneNode* instanced = 0;
+		if (setup == ES_INSTANCES)
+			instanced = smgr->addInstancedMeshSceneNode(cube);
+
+		for (s32 x=0; x<GRID_SIZE; ++x)
+		{
+			for (s32 z=0; z<GRID_SIZE; ++z)
+			{
+				const core::vector3df position(x*4.f, 0.f, z*4.f);
+				const core::vector3df rotation(0.f, (f32)((x*7+z)%360), 0.f);
+				if (instanced)
+				{
+					core::matrix4 transform;
+					transform.setTranslation(position);
+					transform.setRotationDegrees(rotation);
+					instanced->addInstance(video::S3DInstance(transform));
+				}
+				else
+					smgr->addMeshSceneNode(cube, 0, -1, position, rotation);
+			}
+		}
+
+		ICameraSceneNode* camera = smgr->addCameraSceneNode(0, core::vector3df(-10,20,-10), core::vector3df(100,0,100));
+		camera->setFarValue(farValue);
+
+		SResult result;
+		result.FrameTime = 0.0;
+		for (u32 r=0; r<FRAME_RUNS; ++r)
+		{
+			driver->beginScene();
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			smgr->drawAll();
+			const f64 time = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+			driver->endScene();
+
+			if (r == 0 || time < result.FrameTime)
+				result.FrameTime = time;
+		}
+		result.DrawCalls = driver->getDrawCallCount();
+		result.Primitives = driver->getPrimitiveCountDrawn();
+
+		smgr->drop();
+		cube->drop();
+		return result;
+	}
+
+	void printResult(const char* name, const SResult& result)
+	{
+		printf("  %-28s %8.3f ms %7u draw calls %9u primitives\n", name, result.FrameTime, result.DrawCalls, result.Primitives);
+	}
+}
+
+int main()
+{
+	io::IFileSystem* fs = io::createFileSystem();
+	bool ok = true;
+
+	const f32 farValues[] = { 300.f, 5000.f };
+	for (u32 i=0; i<2; ++i)
+	{
+		printf("%d cubes, far value %.0f\n", GRID_SIZE*GRID_SIZE, farValues[i]);
+
+		video::IVideoDriver* driver = video::createNullDriver(fs, core::dimension2d<u32>(800,600));
+		const SResult nodes = drawScene(driver, fs, ES_MESH_NODES, farValues[i]);
+		const SResult expanded = drawScene(driver, fs, ES_INSTANCES, farValues[i]);
+		driver->drop();
+
+		driver = new CInstancingNullDriver(fs);
+		const SResult hardware = drawScene(driver, fs, ES_INSTANCES, farValues[i]);
+		driver->drop();
+
+		printResult("mesh scene nodes", nodes);
+		printResult("instances, CPU expansion", expanded);
+		printResult("instances, hardware path", hardware);
+
+		// all setups draw the same cubes, the hardware path in a single call
+		if (expanded.Primitives != nodes.Primitives || hardware.Primitives != nodes.Primitives ||
+			hardware.DrawCalls > 1)
+			ok = false;
+	}
+
+	fs->drop();
+	return ok ? 0 : 1;
+}
@@ -145,6 +145,12 @@ namespace video
 		//! Support for clamping vertices beyond far-plane to depth instead of capping them.
 		EVDF_DEPTH_CLAMP,
 
+		//! Can the driver skin EMT_SOLID geometry with a joint palette? See IVideoDriver::setSkinningData
+		EVDF_HARDWARE_SKINNING,
+
+		//! Can the driver draw all instances of a mesh buffer with one call? See IVideoDriver::setInstanceData
+		EVDF_HARDWARE_INSTANCING,
+
 		//! Only used for counting the elements of this enum
 		EVDF_COUNT
 	};
@@ -16,6 +16,14 @@ enum E_VERTEX_ATTRIBUTES
 	EVA_TCOORD1,
 	EVA_TANGENT,
 	EVA_BINORMAL,
+	EVA_JOINT_INDICES,
+	EVA_JOINT_WEIGHTS,
+	EVA_INSTANCE_TRANSFORM0,
+	EVA_INSTANCE_TRANSFORM1,
+	EVA_INSTANCE_TRANSFORM2,
+	EVA_INSTANCE_TRANSFORM3,
+	EVA_INSTANCE_COLOR,
+	EVA_INSTANCE_CUSTOM,
 	EVA_COUNT
 };
 
@@ -29,6 +37,14 @@ const char* const sBuiltInVertexAttributeNames[] =
 	"inTexCoord1",
 	"inVertexTangent",
 	"inVertexBinormal",
+	"inJointIndices",
+	"inJointWeights",
+	"inInstanceTransform0",
+	"inInstanceTransform1",
+	"inInstanceTransform2",
+	"inInstanceTransform3",
+	"inInstanceColor",
+	"inInstanceCustom",
 	0
 };
 
@@ -91,6 +91,21 @@ public:
 	*/
 	virtual void addDirectoryToFileList(const io::path &filename) {}
 
+	//! Set when compressed files are decompressed while they are read
+	/** Opening a compressed file normally decompresses all of it into
+	memory. Files of at least minStreamSize bytes are decompressed while
+	they are read instead, keeping only windowSize bytes of the
+	decompressed data. Reading on and seeking forward is cheap then,
+	seeking back before the window decompresses again from the start,
+	which is slow for loaders seeking back and forth. Archives which can
+	not stream ignore this, zip archives stream deflated files.
+	\param minStreamSize Uncompressed size from which files are
+	streamed. 0xffffffff, the default, decompresses all files when they
+	are opened.
+	\param windowSize Bytes of decompressed data kept by a streamed
+	file. */
+	virtual void setStreamingThresholds(u32 minStreamSize, u32 windowSize) {}
+
 	//! An optionally used password string
 	/** This variable is publicly accessible from the interface in order to
 	avoid single access patterns to this place, and hence allow some more
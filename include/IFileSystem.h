@@ -25,6 +25,24 @@ class IFileList;
 class IAttributes;
 
 
+//! Counters of the lookups of files in the archives of an IFileSystem
+struct SFileLookupCounts
+{
+	SFileLookupCounts() : Lookups(0), IndexHits(0), ArchiveSearches(0) {}
+
+	//! Names looked up by IFileSystem::createAndOpenFile() and IFileSystem::existFile()
+	u32 Lookups;
+
+	//! Lookups found in the index of the archives
+	u32 IndexHits;
+
+	//! Archives searched one by one for a name
+	/** Archives which are not indexed are searched in their place of
+	the search order, indexed ones only for names of folders. */
+	u32 ArchiveSearches;
+};
+
+
 //! The FileSystem manages files and archives and provides access to them.
 /** It manages where files are, so that modules which use the the IO do not
 need to know where every file is located. A file could be in a .zip-Archive or
@@ -66,6 +84,19 @@ public:
 	virtual IReadFile* createLimitReadFile(const path& fileName,
 			IReadFile* alreadyOpenedFile, long pos, long areaSize) =0;
 
+	//! Set from which size files are mapped into memory instead of read
+	/** createAndOpenFile() maps files of at least this size, which
+	are outside of archives, into memory. Their data is read from the
+	page cache without another copy, and they implement IMemoryReadFile.
+	Files stored uncompressed in mapped archives are opened as parts
+	of the archive's memory. Files are only mapped on systems with mmap.
+	A mapped file must not be truncated while it is open.
+	Mapping costs more than reading small files, which is why only
+	large ones are mapped.
+	\param size Smallest size of mapped files, 0x7fffffff to map none.
+	Default is 1048576. */
+	virtual void setFileMappingThreshold(long size) =0;
+
 	//! Creates an IWriteFile interface for accessing memory like a file.
 	/** This allows you to use a pointer to memory where an IWriteFile is requested.
 		You are responsible for allocating enough memory.
@@ -198,6 +229,16 @@ public:
 	//! Get the archive at a given index.
 	virtual IFileArchive* getFileArchive(u32 index) =0;
 
+	//! Get how often files were looked up in the archives
+	/** The files of archives of the built-in types which were added by
+	file name or file and ignore case are kept in one hashed index,
+	which finds a name in all of them at once and keeps the search
+	order. Other archives, like case sensitive ones and those added as
+	IFileArchive, are searched one by one in their place of the search
+	order. The index is updated when archives are added, removed or
+	moved. */
+	virtual SFileLookupCounts getFileLookupCounts() const =0;
+
 	//! Adds an external archive loader to the engine.
 	/** Use this function to add support for new archive types to the
 	engine, for example proprietary or encrypted file storage. */
@@ -0,0 +1,80 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "S3DInstance.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IMesh;
+
+	//! Scene node drawing many copies of one mesh
+	/** Created with ISceneManager::addInstancedMeshSceneNode(). Each
+	instance has its own transformation relative to the node, a color
+	modulating the vertex colors and 4 free floats, see S3DInstance. Instances
+	outside the view frustum are culled one by one, the visible ones are
+	drawn with one IVideoDriver::drawMeshBuffer() call per mesh buffer,
+	see IVideoDriver::setInstanceData(). Instances with transparent
+	materials are not sorted by depth. */
+	class IInstancedMeshSceneNode : public ISceneNode
+	{
+	public:
+
+		//! constructor
+		IInstancedMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f))
+			: ISceneNode(parent, mgr, id, position, rotation, scale) {}
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_INSTANCED_MESH; }
+
+		//! Sets a new mesh to draw for every instance
+		/** The materials of the node are copied from the mesh. */
+		virtual void setMesh(IMesh* mesh) = 0;
+
+		//! Get the mesh drawn for every instance
+		virtual IMesh* getMesh() = 0;
+
+		//! Adds an instance
+		/** \return Index of the new instance. */
+		virtual u32 addInstance(const video::S3DInstance& instance) = 0;
+
+		//! Replaces all instances
+		/** \param instances Array of instances, which is copied.
+		\param count Amount of instances in the array. */
+		virtual void setInstances(const video::S3DInstance* instances, u32 count) = 0;
+
+		//! Changes an instance
+		virtual void setInstance(u32 index, const video::S3DInstance& instance) = 0;
+
+		//! Get an instance
+		virtual const video::S3DInstance& getInstance(u32 index) const = 0;
+
+		//! Removes an instance
+		/** The last instance takes the index of the removed one. */
+		virtual void removeInstance(u32 index) = 0;
+
+		//! Removes all instances
+		virtual void clearInstances() = 0;
+
+		//! Get the amount of instances
+		virtual u32 getInstanceCount() const = 0;
+
+		//! Get the amount of instances which were not culled in the last frame
+		virtual u32 getVisibleInstanceCount() const = 0;
+
+		//! Get the amount of mesh buffers drawn in the last frame
+		virtual u32 getDrawCallCount() const = 0;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
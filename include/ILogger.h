@@ -35,6 +35,9 @@ enum ELOG_LEVEL
 
 
 //! Interface for logging messages, warnings and errors
+/** The engine only logs from the render thread. Messages of its worker
+threads, like those of background loads, are queued and logged by the
+next IVideoDriver::endScene() or ISceneManager::drawAll(). */
 class ILogger : public virtual IReferenceCounted
 {
 public:
@@ -13,6 +13,8 @@ namespace io
 {
 
 	//! Interface providing read access to a memory read file.
+	/** Files which are mapped into memory, see
+	IFileSystem::setFileMappingThreshold(), implement this as well. */
 	class IMemoryReadFile : public IReadFile
 	{
 	public:
@@ -53,7 +53,9 @@ namespace scene
 		/** After loading a mesh with getMesh(), the mesh can be
 		removed from the cache using this method, freeing a lot of
 		memory.
-		\param mesh Pointer to the mesh which shall be removed. */
+		\param mesh Pointer to the mesh which shall be removed. Frame 0
+		of a mesh is also found, except for skinned, MD2, MD3 and
+		Half-Life meshes which animate to return a frame. */
 		virtual void removeMesh(const IMesh* const mesh) = 0;
 
 		//! Returns amount of loaded meshes in the cache.
@@ -73,7 +75,8 @@ namespace scene
 		/** \param index: Index of the mesh, number between 0 and
 		getMeshCount()-1.
 		Note that this number is only valid until a new mesh is loaded
-		or removed.
+		or removed. Meshes are in the order they were added, not sorted
+		by name, and removing a mesh moves the last mesh into its index.
 		\return Pointer to the mesh or 0 if there is none with this
 		number. */
 		virtual IAnimatedMesh* getMeshByIndex(u32 index) = 0;
@@ -156,6 +159,15 @@ namespace scene
 		\return True if the mesh has been loaded, else false. */
 		virtual bool isMeshLoaded(const io::path& name) = 0;
 
+		//! Check if a mesh is being loaded in the background.
+		/** See ISceneManager::getMeshAsync().
+		\param name Name the mesh will have in the cache.
+		\return True if the mesh is still loading. */
+		virtual bool isMeshLoading(const io::path& name) const = 0;
+
+		//! Get the amount of meshes being loaded in the background.
+		virtual u32 getLoadingMeshCount() const = 0;
+
 		//! Clears the whole mesh cache, removing all meshes.
 		/** All meshes will be reloaded completely when using ISceneManager::getMesh()
 		after calling this method.
@@ -167,6 +179,24 @@ namespace scene
 		/** Warning: If you have pointers to meshes that were loaded with ISceneManager::getMesh()
 		and you did not grab them, then they may become invalid. */
 		virtual void clearUnusedMeshes() = 0;
+
+		//! Limits the memory used by meshes which are only held by the cache.
+		/** Each mesh is measured once when it is added, from the vertex
+		and index data of the mesh buffers of its first frame. When the
+		sum of all cached meshes exceeds the budget, the least recently
+		used meshes which are not used anywhere else are removed, like
+		clearUnusedMeshes() does. Meshes count as used when they are
+		added or looked up by name.
+		Warning: If you have pointers to meshes that were loaded with ISceneManager::getMesh()
+		and you did not grab them, then they may become invalid.
+		\param bytes Memory budget in bytes, 0 disables the limit (default). */
+		virtual void setMemoryBudget(u64 bytes) = 0;
+
+		//! Get the memory budget set with setMemoryBudget(), 0 when there is none.
+		virtual u64 getMemoryBudget() const = 0;
+
+		//! Get the memory of all cached meshes as measured for the budget.
+		virtual u64 getMemoryUsage() const = 0;
 	};
 
 
@@ -0,0 +1,37 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_MESH_LOAD_CALLBACK_H_INCLUDED__
+#define __I_MESH_LOAD_CALLBACK_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "path.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IAnimatedMesh;
+
+//! Interface to get notified when a mesh loaded in the background is ready.
+/** Pass an implementation to ISceneManager::getMeshAsync(). */
+class IMeshLoadCallBack : public virtual IReferenceCounted
+{
+public:
+
+	//! Called when the loading of a mesh finished.
+	/** Called on the render thread from ISceneManager::drawAll(), after
+	the mesh was added to the mesh cache. For a mesh which was already
+	loaded, getMeshAsync() calls it right away.
+	\param name Name of the mesh in the mesh cache.
+	\param mesh The loaded mesh, 0 if it could not be loaded. Its
+	textures might still be loading, see IVideoDriver::getTextureAsync().
+	This pointer should not be dropped. */
+	virtual void OnMeshLoaded(const io::path& name, IAnimatedMesh* mesh) = 0;
+};
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
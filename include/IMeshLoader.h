@@ -52,6 +52,18 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IAnimatedMesh* createMesh(io::IReadFile* file) = 0;
 
+	//! Check if the loader can run on a worker thread.
+	/** Used by ISceneManager::getMeshAsync(). A loader which returns true
+	may only use the video driver for getTexture(), makeNormalMapTexture()
+	and the texture creation flags, and must not change the scene. The
+	scene manager makes sure that a loader only loads one file at a time.
+	\return True if createMesh() can be called from a worker thread,
+	else the mesh is loaded on the calling thread. */
+	virtual bool canLoadInBackground() const
+	{
+		return false;
+	}
+
 	//! Set a new texture loader which this meshloader can use when searching for textures.
 	/** NOTE: Not all meshloaders do support this interface. Meshloaders which
 	support it will return a non-null value in getMeshTextureLoader from the start. Setting a
@@ -283,7 +283,11 @@ namespace scene
 		virtual IMesh* createMeshUniquePrimitives(IMesh* mesh) const = 0;
 
 		//! Creates a copy of a mesh with vertices welded
-		/** \param mesh Input mesh
+		/** Each vertex is welded to the first earlier vertex matching it
+		within tolerance, triangles collapsing by this are removed. Mesh
+		buffers keeping more than 65536 vertices are returned as
+		CDynamicMeshBuffer with 32 bit indices.
+		\param mesh Input mesh
 		\param tolerance The threshold for vertex comparisons.
 		\return Mesh without redundant vertices. If you no longer need
 		the cloned mesh, you should call IMesh::drop(). See
@@ -9,11 +9,18 @@
 #include "irrArray.h"
 #include "ITimer.h"
 #include <limits.h>	// for INT_MAX (we should have a S32_MAX...)
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 namespace irr
 {
 
 class ITimer;
+namespace io
+{
+	class IWriteFile;
+} // end namespace io
 
 //! Used to store the profile data (and also used for profile group data).
 struct SProfileData
@@ -36,6 +43,12 @@ struct SProfileData
 		return Id == pd.Id;
 	}
 
+	//! Id used for start/stop
+	s32 getId() const
+	{
+		return Id;
+	}
+
 	u32 getGroupIndex() const
 	{
 		return GroupIndex;
@@ -52,23 +65,32 @@ struct SProfileData
 		return CountCalls;
 	}
 
-	//! Longest time a profile call for this id took from start until it was stopped again.
+	//! Longest time in milliseconds a profile call for this id took from start until it was stopped again.
 	u32 getLongestTime() const
 	{
-		return LongestTime;
+		return (u32)(LongestTime / 1000000);
 	}
 
-	//! Time spend between start/stop
+	//! Time in milliseconds spend between start/stop
 	u32 getTimeSum() const
+	{
+		return (u32)(TimeSum / 1000000);
+	}
+
+	//! Longest time in nanoseconds a profile call for this id took
+	u64 getLongestTimeNs() const
+	{
+		return LongestTime;
+	}
+
+	//! Time in nanoseconds spend between start/stop
+	u64 getTimeSumNs() const
 	{
 		return TimeSum;
 	}
 
 private:
 
-	// just to be used for searching as it does no initialization besides id
-	SProfileData(u32 id) : Id(id) {}
-
 	void reset()
 	{
 		CountCalls = 0;
@@ -82,26 +104,68 @@ private:
 	u32 GroupIndex;
 	core::stringw Name;
 
-	s32 StartStopCounter; // 0 means stopped > 0 means it runs.
+	s32 StartStopCounter; // 0 means stopped > 0 means it runs. Only for the thread owning the profiler.
 	u32 CountCalls;
-	u32 LongestTime;
-	u32 TimeSum;
+	u64 LongestTime;	// nanoseconds
+	u64 TimeSum;	// nanoseconds
+
+	u64 LastTimeStarted;
+};
+
+//! One profile call recorded for the trace, see IProfiler::setTracing()
+struct SProfileEvent
+{
+	//! Index of the profile data, see IProfiler::getProfileDataByIndex()
+	u32 Index;
+
+	//! Number of the thread, 0 for the thread owning the profiler
+	u32 Thread;
+
+	//! Time of the start in nanoseconds, see IProfiler::getTime()
+	u64 Start;
+
+	//! Time from start until stop in nanoseconds
+	u64 Duration;
+};
 
-	u32 LastTimeStarted;
+//! Formats for IProfiler::writeTrace()
+enum E_PROFILER_TRACE_FORMAT
+{
+	//! JSON of the Trace Event Format, loads in chrome://tracing and Perfetto
+	EPTF_CHROME_JSON = 0,
+
+	//! Compact binary stream, in the byte order of the machine.
+	/** Header: "IRRTRACE", u32 version (1), u32 amount of names, u32
+	amount of events, u32 amount of dropped events, u64 start time of
+	the trace in nanoseconds. Then per profile data index: s32 id, u32
+	length and UTF-8 bytes of the name, u32 length and UTF-8 bytes of the
+	group name. Then the events as SProfileEvent: u32 index, u32 thread,
+	u64 start and u64 duration in nanoseconds. */
+	EPTF_BINARY
 };
 
 //! Code-profiler. Please check the example in the Irrlicht examples folder about how to use it.
+/** Times are measured in nanoseconds with a monotonic clock. start/stop
+can be called from any thread. The thread which created the profiler
+updates the profile data directly, other threads collect their calls in
+buffers of their own which are added to the profile data by
+collectThreadData(). The ids have to be added before other threads use
+them. */
 // Implementer notes:
 // The design is all about allowing to use the central start/stop mechanism with minimal time overhead.
 // This is why the class works without a virtual functions interface contrary to the usual Irrlicht design.
 // And also why it works with id's instead of strings in the start/stop functions even if it makes using
-// the class slightly harder.
+// the class slightly harder. The engine, user and automatic id's are each counted from one end of the
+// s32 range, so they are looked up in tables instead of searched.
+// Only calls from other threads than the owning one go through virtual functions.
 // The class comes without reference-counting because the profiler instance is never released (TBD).
 class IProfiler
 {
 public:
 	//! Constructor. You could use this to create a new profiler, but usually getProfiler() is used to access the global instance.
-	IProfiler()	: Timer(0), NextAutoId(INT_MAX)
+	/** The thread creating the profiler owns it. */
+	IProfiler()	: Timer(0), OwnerThread(std::this_thread::get_id()),
+		Tracing(false), TraceEventLimit(0), TraceStart(0), DroppedTraceEvents(0), NextAutoId(INT_MAX)
 	{}
 
 	virtual ~IProfiler()
@@ -135,7 +199,7 @@ public:
 	inline bool findDataIndex(u32 & result, const core::stringw &name) const;
 
 	//! Get the profile data
-	/** \param index A value between 0 and getProfileDataCount()-1.	Indices can change when new id's are added.*/
+	/** \param index A value between 0 and getProfileDataCount()-1. Indices don't change, new id's are added at the end.*/
 	const SProfileData& getProfileDataByIndex(u32 index) const
 	{
 		return ProfileDatas[index];
@@ -193,6 +257,41 @@ public:
 	/** NOTE: This is not deleting id's or groups, just resetting all timers to 0. */
 	inline void resetAll();
 
+	//! Add the calls which other threads finished to the profile data
+	/** The print functions show the profile data as it is, call this
+	before when other threads profile. CGUIProfiler calls it on each
+	update. Must be called by the thread owning the profiler. */
+	virtual void collectThreadData() = 0;
+
+	//! Start or stop recording every profile call for writeTrace()
+	/** Starting clears the events recorded before.
+	\param enable True to record.
+	\param maxEventsPerThread Calls of a thread beyond this amount are
+	dropped, so a trace which is never written can't fill the memory. */
+	virtual void setTracing(bool enable, u32 maxEventsPerThread=1<<20) = 0;
+
+	//! Check if profile calls are recorded for writeTrace()
+	bool isTracing() const
+	{
+		return Tracing.load(std::memory_order_relaxed);
+	}
+
+	//! Remove the recorded profile calls of all threads
+	virtual void clearTrace() = 0;
+
+	//! Write the recorded profile calls of all threads
+	/** \param file File to write to.
+	\param format Format of the trace.
+	\return True on success. */
+	virtual bool writeTrace(io::IWriteFile* file, E_PROFILER_TRACE_FORMAT format=EPTF_CHROME_JSON) = 0;
+
+	//! Time in nanoseconds of the monotonic clock used for profiling
+	static u64 getTime()
+	{
+		return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
 	//! Write all profile-data into a string
 	/** \param result Receives the result string.
 	\param includeOverview When true a group-overview is attached first
@@ -208,13 +307,55 @@ protected:
 
 	inline u32 addGroup(const core::stringw &name);
 
-	// I would prefer using os::Timer, but os.h is not in the public interface so far.
+	//! Index of the profile data with the id, or -1
+	inline s32 findIndex(s32 id) const;
+
+	//! Add finished calls to a profile data and its group
+	inline void addTime(u32 index, u32 calls, u64 timeSum, u64 longestTime);
+
+	//! start() and stop() for other threads than the owning one
+	virtual void startOtherThread(u32 index) = 0;
+	virtual void stopOtherThread(u32 index, u64 time) = 0;
+
+	// Not used for profiling anymore, kept for implementations which expect it.
 	// Timer must be initialized by the implementation.
 	ITimer * Timer;
 	core::array<SProfileData> ProfileDatas;
 	core::array<SProfileData> ProfileGroups;
 
+	std::thread::id OwnerThread;
+
+	//! Trace of the owning thread, other threads keep their own
+	std::atomic<bool> Tracing;
+	std::atomic<u32> TraceEventLimit;
+	u64 TraceStart;
+	core::array<SProfileEvent> TraceEvents;
+	u32 DroppedTraceEvents;
+
 private:
+
+	//! Ids which are not close to the ends of the s32 range, sorted
+	struct SSparseIndex
+	{
+		bool operator<(const SSparseIndex& other) const
+		{
+			return Id < other.Id;
+		}
+
+		s32 Id;
+		u32 Index;
+	};
+
+	//! Table in which the index of an id is kept, or 0 for the sparse ones
+	inline core::array<s32>* getIndexTable(s32 id, u32& offset);
+	inline const core::array<s32>* getIndexTable(s32 id, u32& offset) const;
+
+	//! Ids counted from -INT_MAX up (engine), from 0 up (user) and from INT_MAX down (automatic)
+	core::array<s32> EngineIndices;
+	core::array<s32> UserIndices;
+	core::array<s32> AutoIndices;
+	core::array<SSparseIndex> SparseIndices;
+
 	s32 NextAutoId;	// for giving out id's automatically
 };
 
@@ -277,52 +418,116 @@ protected:
 
 // IMPLEMENTATION for in-line stuff
 
+// Ids closer than this to the start of their range are kept in tables
+const u32 PROFILE_DENSE_ID_RANGE = 4096;
+
+core::array<s32>* IProfiler::getIndexTable(s32 id, u32& offset)
+{
+	if ( id < 0 )
+	{
+		offset = (u32)id + (u32)INT_MAX;
+		return offset < PROFILE_DENSE_ID_RANGE ? &EngineIndices : 0;
+	}
+	if ( id > INT_MAX/2 )
+	{
+		offset = (u32)(INT_MAX - id);
+		return offset < PROFILE_DENSE_ID_RANGE ? &AutoIndices : 0;
+	}
+	offset = (u32)id;
+	return offset < PROFILE_DENSE_ID_RANGE ? &UserIndices : 0;
+}
+
+const core::array<s32>* IProfiler::getIndexTable(s32 id, u32& offset) const
+{
+	return const_cast<IProfiler*>(this)->getIndexTable(id, offset);
+}
+
+s32 IProfiler::findIndex(s32 id) const
+{
+	u32 offset;
+	const core::array<s32>* table = getIndexTable(id, offset);
+	if ( table )
+		return offset < table->size() ? (*table)[offset] : -1;
+
+	SSparseIndex search;
+	search.Id = id;
+	const s32 found = SparseIndices.binary_search(search, 0, (s32)SparseIndices.size()-1);
+	return found >= 0 ? (s32)SparseIndices[found].Index : -1;
+}
+
+void IProfiler::addTime(u32 index, u32 calls, u64 timeSum, u64 longestTime)
+{
+	SProfileData &data = ProfileDatas[index];
+	data.CountCalls += calls;
+	data.TimeSum += timeSum;
+	if ( longestTime > data.LongestTime )
+		data.LongestTime = longestTime;
+
+	// update data of it's group
+	SProfileData & group = ProfileGroups[data.GroupIndex];
+	group.CountCalls += calls;
+	group.TimeSum += timeSum;
+	if ( longestTime > group.LongestTime )
+		group.LongestTime = longestTime;
+}
+
 void IProfiler::start(s32 id)
 {
-	s32 idx = ProfileDatas.binary_search(SProfileData(id));
-	if ( idx >= 0 && Timer )
+	const s32 idx = findIndex(id);
+	if ( idx < 0 )
+		return;
+
+	if ( std::this_thread::get_id() != OwnerThread )
 	{
-		++ProfileDatas[idx].StartStopCounter;
-		if (ProfileDatas[idx].StartStopCounter == 1 )
-			ProfileDatas[idx].LastTimeStarted = Timer->getRealTime();
+		startOtherThread((u32)idx);
+		return;
 	}
+
+	SProfileData &data = ProfileDatas[idx];
+	if ( ++data.StartStopCounter == 1 )
+		data.LastTimeStarted = getTime();
 }
 
 void IProfiler::stop(s32 id)
 {
-	if ( Timer )
+	const u64 timeNow = getTime();
+	const s32 idx = findIndex(id);
+	if ( idx < 0 )
+		return;
+
+	if ( std::this_thread::get_id() != OwnerThread )
 	{
-		u32 timeNow = Timer->getRealTime();
-		s32 idx = ProfileDatas.binary_search(SProfileData(id));
-		if ( idx >= 0 )
+		stopOtherThread((u32)idx, timeNow);
+		return;
+	}
+
+	SProfileData &data = ProfileDatas[idx];
+	--data.StartStopCounter;
+	if ( data.StartStopCounter == 0 )
+	{
+		const u64 diffTime = timeNow - data.LastTimeStarted;
+		addTime((u32)idx, 1, diffTime, diffTime);
+
+		if ( Tracing.load(std::memory_order_relaxed) )
 		{
-			SProfileData &data = ProfileDatas[idx];
-			--ProfileDatas[idx].StartStopCounter;
-			if ( data.LastTimeStarted != 0 && ProfileDatas[idx].StartStopCounter == 0)
-			{
-				// update data for this id
-				++data.CountCalls;
-				u32 diffTime = timeNow - data.LastTimeStarted;
-				data.TimeSum += diffTime;
-				if ( diffTime > data.LongestTime )
-					data.LongestTime = diffTime;
-				data.LastTimeStarted = 0;
-
-				// update data of it's group
-				SProfileData & group = ProfileGroups[data.GroupIndex];
-				++group.CountCalls;
-				group.TimeSum += diffTime;
-				if ( diffTime > group.LongestTime )
-					group.LongestTime = diffTime;
-				group.LastTimeStarted = 0;
-			}
-			else if ( ProfileDatas[idx].StartStopCounter < 0 )
+			if ( TraceEvents.size() < TraceEventLimit.load(std::memory_order_relaxed) )
 			{
-				// ignore additional stop calls
-				ProfileDatas[idx].StartStopCounter = 0;
+				SProfileEvent event;
+				event.Index = (u32)idx;
+				event.Thread = 0;
+				event.Start = data.LastTimeStarted;
+				event.Duration = diffTime;
+				TraceEvents.push_back(event);
 			}
+			else
+				++DroppedTraceEvents;
 		}
 	}
+	else if ( data.StartStopCounter < 0 )
+	{
+		// ignore additional stop calls
+		data.StartStopCounter = 0;
+	}
 }
 
 s32 IProfiler::add(const core::stringw &name, const core::stringw &groupName)
@@ -350,16 +555,32 @@ void IProfiler::add(s32 id, const core::stringw &name, const core::stringw &grou
 		groupIdx = addGroup(groupName);
 	}
 
-	SProfileData data(id);
-	s32 idx = ProfileDatas.binary_search(data);
+	s32 idx = findIndex(id);
 	if ( idx < 0 )
 	{
-		data.reset();
+		SProfileData data;
+		data.Id = id;
 		data.GroupIndex = groupIdx;
 		data.Name = name;
-
 		ProfileDatas.push_back(data);
-		ProfileDatas.sort();
+
+		const s32 index = (s32)ProfileDatas.size()-1;
+		u32 offset;
+		core::array<s32>* table = getIndexTable(id, offset);
+		if ( table )
+		{
+			while ( table->size() <= offset )
+				table->push_back(-1);
+			(*table)[offset] = index;
+		}
+		else
+		{
+			SSparseIndex sparse;
+			sparse.Id = id;
+			sparse.Index = (u32)index;
+			SparseIndices.push_back(sparse);
+			SparseIndices.sort();
+		}
 	}
 	else
 	{
@@ -398,8 +619,7 @@ bool IProfiler::findDataIndex(u32 & result, const core::stringw &name) const
 
 const SProfileData* IProfiler::getProfileDataById(u32 id)
 {
-	SProfileData data(id);
-	s32 idx = ProfileDatas.binary_search(data);
+	s32 idx = findIndex((s32)id);
 	if ( idx >= 0 )
 		return &ProfileDatas[idx];
 	return NULL;
@@ -421,7 +641,7 @@ bool IProfiler::findGroupIndex(u32 & result, const core::stringw &name) const
 
 void IProfiler::resetDataById(s32 id)
 {
-	s32 idx = ProfileDatas.binary_search(SProfileData(id));
+	s32 idx = findIndex(id);
 	if ( idx >= 0 )
 	{
 		resetDataByIndex((u32)idx);
@@ -430,6 +650,9 @@ void IProfiler::resetDataById(s32 id)
 
 void IProfiler::resetDataByIndex(u32 index)
 {
+	// calls of other threads which are not collected yet would be added after the reset
+	collectThreadData();
+
 	SProfileData &data = ProfileDatas[index];
 
 	SProfileData & group = ProfileGroups[data.GroupIndex];
@@ -442,6 +665,7 @@ void IProfiler::resetDataByIndex(u32 index)
 //! Reset profile data for a whole group
 void IProfiler::resetGroup(u32 index)
 {
+	collectThreadData();
 	for ( u32 i=0; i<ProfileDatas.size(); ++i )
 	{
 		if ( ProfileDatas[i].GroupIndex == index )
@@ -453,6 +677,7 @@ void IProfiler::resetGroup(u32 index)
 
 void IProfiler::resetAll()
 {
+	collectThreadData();
 	for ( u32 i=0; i<ProfileDatas.size(); ++i )
 	{
 		ProfileDatas[i].reset();
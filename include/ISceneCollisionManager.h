@@ -45,6 +45,49 @@ namespace scene
 		{}
 	};
 
+	//! One moving ellipsoid for ISceneCollisionManager::getCollisionResultPositions()
+	/** The first members describe the move, the others receive the
+	results which getCollisionResultPosition() would return. */
+	struct SCollisionMove
+	{
+		//! Position of the ellipsoid
+		core::vector3df Position;
+
+		//! Radius of the ellipsoid
+		core::vector3df Radius;
+
+		//! Direction and speed of the movement of the ellipsoid
+		core::vector3df DirectionAndSpeed;
+
+		//! Direction and force of gravity
+		core::vector3df Gravity;
+
+		//! How close the ellipsoid gets to a triangle before sliding along it
+		f32 SlidingSpeed;
+
+		//! New position of the ellipsoid
+		core::vector3df ResultPosition;
+
+		//! Position of the collision
+		core::vector3df HitPosition;
+
+		//! Last triangle causing a collision, unchanged when Collided is false
+		core::triangle3df Triangle;
+
+		//! Node with which the ellipsoid collided (if any)
+		ISceneNode* Node;
+
+		//! True if the ellipsoid is falling down, caused by gravity
+		bool Falling;
+
+		//! True if the ellipsoid hit a triangle
+		bool Collided;
+
+		SCollisionMove() : Radius(30,60,30), SlidingSpeed(0.0005f),
+			Node(0), Falling(false), Collided(false)
+		{}
+	};
+
 	//! The Scene Collision Manager provides methods for performing collision tests and picking on scene nodes.
 	class ISceneCollisionManager : public virtual IReferenceCounted
 	{
@@ -86,6 +129,27 @@ namespace scene
 			return false;
 		}
 
+		//! Finds the nearest collision points of many lines and lots of triangles.
+		/** Works like getCollisionPoint() for each ray, but the rays are
+		split across the engine's worker threads, each with its own
+		triangle buffers. The selector is queried from all of them at the
+		same time, so the scene must not change during the call. Own
+		selectors may only update cached triangles when the scene changed,
+		the first ray is cast alone to give them a chance to do so.
+		Selectors supporting ITriangleSelector::getNearestHit() are
+		fastest, they don't need to copy any triangles.
+		\param hitResults: Array of rayCount results. Rays which hit
+		nothing get a default constructed SCollisionHit.
+		\param hitFound: Optional array of rayCount flags, set to true for
+		rays which hit a triangle.
+		\param rays: Array of rayCount lines to test.
+		\param rayCount: Number of rays.
+		\param selector: TriangleSelector to be used for the collision check.
+		\return Number of rays which hit a triangle. */
+		virtual u32 getCollisionPoints(SCollisionHit* hitResults, bool* hitFound,
+				const core::line3d<f32>* rays, u32 rayCount,
+				ITriangleSelector* selector) = 0;
+
 		//! Collides a moving ellipsoid with a 3d world with gravity and returns the resulting new position of the ellipsoid.
 		/** This can be used for moving a character in a 3d world: The
 		character will slide at walls and is able to walk up stairs.
@@ -122,6 +186,19 @@ namespace scene
 			const core::vector3df& gravityDirectionAndSpeed
 			= core::vector3df(0.0f, 0.0f, 0.0f)) = 0;
 
+		//! Collides many moving ellipsoids with a 3d world with gravity.
+		/** Works like getCollisionResultPosition() for each move, but the
+		moves are split across the engine's worker threads, each with its
+		own triangle buffers. The selector is queried from all of them at
+		the same time, so the scene must not change during the call.
+		\param selector: TriangleSelector containing the triangles of
+		the world.
+		\param moves: Array of moveCount ellipsoid moves. The result
+		members are filled in.
+		\param moveCount: Number of moves. */
+		virtual void getCollisionResultPositions(ITriangleSelector* selector,
+			SCollisionMove* moves, u32 moveCount) = 0;
+
 		//! Returns a 3d ray which would go through the 2d screen coordinates.
 		/** \param pos: Screen coordinates in pixels.
 		\param camera: Camera from which the ray starts. If null, the
@@ -17,9 +17,11 @@
 #include "ESceneNodeAnimatorTypes.h"
 #include "EMeshWriterEnums.h"
 #include "SceneParameters.h"
+#include "SFrameStatistics.h"
 #include "IGeometryCreator.h"
 #include "ISkinnedMesh.h"
 #include "IXMLWriter.h"
+#include "IMeshLoadCallBack.h"
 
 namespace irr
 {
@@ -107,6 +109,7 @@ namespace scene
 	class IBillboardTextSceneNode;
 	class ICameraSceneNode;
 	class IDummyTransformationSceneNode;
+	class IInstancedMeshSceneNode;
 	class ILightManager;
 	class ILightSceneNode;
 	class IMesh;
@@ -128,6 +131,7 @@ namespace scene
 	class ISceneNodeFactory;
 	class ISceneUserDataSerializer;
 	class IShadowVolumeSceneNode;
+	class IStaticBatchSceneNode;
 	class ITerrainSceneNode;
 	class ITextSceneNode;
 	class ITriangleSelector;
@@ -138,6 +142,28 @@ namespace scene
 		struct IShader;
 	} // end namespace quake3
 
+	//! Culling counters of the last ISceneManager::drawAll()
+	struct SCullingStatistics
+	{
+		SCullingStatistics() : CellsVisited(0), CellsCulled(0),
+			NodesVisited(0), NodesCulled(0), NodesDrawn(0) {}
+
+		//! Cells of the scene index which were tested against the view frustum
+		u32 CellsVisited;
+
+		//! Cells of the scene index which were rejected with everything in them
+		u32 CellsCulled;
+
+		//! Scene nodes which registered for rendering and were tested one by one
+		u32 NodesVisited;
+
+		//! Scene nodes which were culled, one by one or with their cell
+		u32 NodesCulled;
+
+		//! Scene nodes which passed culling
+		u32 NodesDrawn;
+	};
+
 	//! The Scene Manager manages scene nodes, mesh resources, cameras and all the other stuff.
 	/** All Scene nodes can be created only here. There is a always growing
 	list of scene nodes for lots of purposes: Indoor rendering scene nodes
@@ -402,6 +428,30 @@ namespace scene
 		IReferenceCounted::drop() for more information. */
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) = 0;
 
+		//! Load a mesh in the background.
+		/** Works like getMesh(), but the file is loaded on a worker
+		thread. The finished mesh is added to the mesh cache by a later
+		drawAll(), which also calls the call back. Requests for a mesh
+		which is still loading share the load, getMesh() waits for it.
+		Textures of the mesh are loaded in the background as well, with
+		IVideoDriver::getTextureAsync(). Meshes whose loader can not run
+		on a worker thread, see IMeshLoader::canLoadInBackground(), are
+		loaded right away. Files the loader needs besides the mesh, like
+		materials, are opened on the worker thread. Archives may be added
+		and removed meanwhile, the file system is locked for it, but the
+		files are found in the archives mounted when they are opened.
+		Messages the loader logs on the worker thread reach the logger
+		and the event receiver in the next drawAll(), before the call
+		back.
+		\param filename Filename of the mesh to load.
+		\param callBack Optional, called when the mesh is ready or
+		failed to load. Grabbed until then.
+		\param alternativeCacheName See getMesh().
+		\return False if the file could not be opened. The call back
+		was called then. */
+		virtual bool getMeshAsync(const io::path& filename, IMeshLoadCallBack* callBack=0,
+			const io::path& alternativeCacheName=io::path("")) = 0;
+
 		//! Get interface to the mesh cache which is shared between all existing scene managers.
 		/** With this interface, it is possible to manually add new loaded
 		meshes (if ISceneManager::getMesh() is not sufficient), to remove them and to iterate
@@ -572,6 +622,50 @@ namespace scene
 		virtual IOctreeSceneNode* addOctreeSceneNode(IMesh* mesh, ISceneNode* parent=0,
 			s32 id=-1, s32 minimalPolysPerNode=256, bool alsoAddIfMeshPointerZero=false) = 0;
 
+		//! Merges static mesh scene nodes into few large mesh buffers
+		/** Every source node costs a transformation change and a draw
+		call per mesh buffer. The batch node bakes the mesh buffers of the
+		source nodes with their current absolute transformation into
+		buffers with 32 bit indices, one per material and vertex type for
+		each chunk. Chunks are cells of a grid with the given size, a
+		source node belongs to the chunk containing the center of its
+		bounding box. Chunks are culled against the view frustum one by
+		one. The source nodes are made invisible, but stay in the scene
+		for picking, see IStaticBatchSceneNode::getSourceNode(). Source
+		nodes with animators or children, meshes which are not triangle
+		lists and invisible nodes are not merged. Changes to the source nodes after
+		this call are not visible in the batch.
+		\param nodes: Source nodes to merge.
+		\param chunkSize: Size of the grid cells which make up the chunks.
+		\param parent: Parent node of the batch node. The geometry is
+		baked relative to the parent's current absolute transformation.
+		\param id: id of the node.
+		\return Pointer to the batch node if at least one node was merged,
+		otherwise 0. This pointer should not be dropped. See
+		IReferenceCounted::drop() for more information. */
+		virtual IStaticBatchSceneNode* addStaticBatchSceneNode(const core::array<IMeshSceneNode*>& nodes,
+			f32 chunkSize=256.f, ISceneNode* parent=0, s32 id=-1) = 0;
+
+		//! Adds a scene node drawing many copies of a mesh
+		/** Instances are added with
+		IInstancedMeshSceneNode::addInstance(). Drivers supporting
+		EVDF_HARDWARE_INSTANCING draw the visible instances of each
+		EMT_SOLID mesh buffer with one call, other drivers and materials
+		fall back to expanding the instances on the CPU.
+		\param mesh: Mesh drawn for every instance.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node.
+		\param position: Position of the node relative to its parent.
+		\param rotation: Initial rotation of the node.
+		\param scale: Initial scale of the node.
+		\return Pointer to the created scene node, or 0 if mesh is 0.
+		This pointer should not be dropped. See IReferenceCounted::drop()
+		for more information. */
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) = 0;
+
 		//! Adds a camera scene node to the scene graph and sets it as active camera.
 		/** This camera does not react on user input like for example the one created with
 		addCameraSceneNodeFPS(). If you want to move or animate it, use animators or the
@@ -1130,10 +1224,30 @@ namespace scene
 		and will use ESNRP_SHADOW for this. See scene::E_SCENE_NODE_RENDER_PASS for details.
 		Note: This is _not_ a bitfield. If you want to register a note for several render passes, then 
 		call this function once for each pass.
+		Inside drawAll() the bounding box tests of all registered nodes are done
+		at once after all nodes registered, so the return value only reflects
+		occlusion query and bounding sphere culling there.
 		\return scene will be rendered ( passed culling ) */
 		virtual u32 registerNodeForRendering(ISceneNode* node,
 			E_SCENE_NODE_RENDER_PASS pass = ESNRP_AUTOMATIC) = 0;
 
+		//! Registers a single mesh buffer of a node for the solid render pass.
+		/** Like registerNodeForRendering(), this should only be used by
+		SceneNodes when they get a ISceneNode::OnRegisterSceneNode() call.
+		Instead of calling ISceneNode::render() the scene manager draws the
+		buffer itself, with the absolute transformation of the node and the
+		given material. All solid buffers of all nodes are sorted by
+		material renderer, textures and blend state, so the driver state
+		changes less often than with whole nodes. Only use this when
+		render() of the node does nothing else for these buffers.
+		\param node: Node the buffer belongs to.
+		\param meshBuffer: Buffer to draw.
+		\param material: Material to draw the buffer with. Has to stay
+		valid until the scene is drawn.
+		\return scene will be rendered ( passed culling ) */
+		virtual u32 registerMeshBufferForRendering(ISceneNode* node,
+			IMeshBuffer* meshBuffer, const video::SMaterial& material) = 0;
+
 		//! Clear all nodes which are currently registered for rendering
 		/** Usually you don't have to care about this as drawAll will clear nodes
 		after rendering them. But sometimes you might have to manully reset this.
@@ -1368,6 +1482,40 @@ namespace scene
 		virtual ITriangleSelector* createOctreeTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
 			ISceneNode* node, s32 minimalPolysPerNode=32) = 0;
 
+		//! Creates a Triangle Selector, optimized by a bounding volume hierarchy.
+		/** Triangle selectors can be used for doing collision detection.
+		This selector sorts the triangles into a hierarchy of boxes built
+		with the surface area heuristic. Ray queries like
+		ISceneCollisionManager::getCollisionPoint() walk the hierarchy
+		through ITriangleSelector::getNearestHit() instead of copying and
+		testing all triangles along the ray, which makes it the best choice
+		for picking on large static meshes. Hits report the meshbuffer and
+		material index of the triangle.
+		Like all selectors it is not attached to the node automatically,
+		call ISceneNode::setTriangleSelector() for that.
+		\param mesh: Mesh of which the triangles are taken.
+		\param node: Scene node of which visibility and transformation is used.
+		\param maxTrianglesPerLeaf: Nodes with this many triangles or less
+		are not split any further.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh,
+			ISceneNode* node, u32 maxTrianglesPerLeaf=4) = 0;
+
+		//! Creates a Triangle Selector for a single meshbuffer, optimized by a bounding volume hierarchy.
+		/** See createBVHTriangleSelector(IMesh*, ISceneNode*, u32).
+		\param meshBuffer: Meshbuffer of which the triangles are taken.
+		\param materialIndex: Setting this value allows the triangle selector to return the material index
+		\param node: Scene node of which visibility and transformation is used.
+		\param maxTrianglesPerLeaf: Nodes with this many triangles or less
+		are not split any further.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+			ISceneNode* node, u32 maxTrianglesPerLeaf=4) = 0;
+
 		//! //! Creates a Triangle Selector, optimized by an octree.
 		/** \deprecated Use createOctreeTriangleSelector instead. This method may be removed by Irrlicht 1.9. */
 		_IRR_DEPRECATED_ ITriangleSelector* createOctTreeTriangleSelector(IMesh* mesh,
@@ -1686,6 +1834,68 @@ namespace scene
 		\return True if node is not visible in the current scene, else
 		false. */
 		virtual bool isCulled(const ISceneNode* node) const =0;
+
+		//! Keep a scene node in the spatial index of the scene manager.
+		/** drawAll() reaches indexed nodes through a loose octree instead
+		of their parent, and skips whole octree cells which are outside the
+		view frustum. This is meant for the many static nodes of large
+		scenes. The index follows changes of the absolute transformation,
+		but not of the bounding box, call this method again after changing
+		the bounding box of an indexed node. The node's children are still
+		reached through the node, unless they are indexed themselves.
+		A node leaves the index as soon as it or one of its parents is
+		removed from its parent, also when it is moved to another parent
+		with ISceneNode::setParent(). Add it again after moving it.
+		\param node Node to index. Nodes with automatic culling switched
+		off (EAC_OFF) are not indexed.
+		\return True if the node is in the index now. */
+		virtual bool addToSceneIndex(ISceneNode* node) =0;
+
+		//! Reach a scene node through its parent again
+		/** \param node Node to remove from the spatial index.
+		\return True if the node was indexed. */
+		virtual bool removeFromSceneIndex(ISceneNode* node) =0;
+
+		//! Get the culling counters of the last drawAll()
+		virtual const SCullingStatistics& getCullingStatistics() const =0;
+
+		//! Get the amount of absolute transformations recalculated during the last drawAll()
+		/** Scene nodes only recalculate their absolute transformation in
+		OnAnimate() when they or one of their parents moved, or when they
+		have animators, see ISceneNode::setTransformationDirty(). */
+		virtual u32 getTransformationUpdateCount() const =0;
+
+		//! Get the counters of a past drawAll()
+		/** The scene manager keeps the counters of the last
+		FRAME_STATISTICS_HISTORY calls to drawAll(). Unlike
+		getCullingStatistics(), this method can be called from any
+		thread while the scene is drawn, it does not lock. Together with
+		IVideoDriver::getFrameStatistics() this replaces the counters
+		which were written into getParameters() in debug builds.
+		\param statistics Receives the counters.
+		\param framesAgo 0 for the last finished drawAll(), 1 for the
+		one before and so on.
+		\return False if the frame is not kept (anymore). */
+		virtual bool getFrameStatistics(SSceneFrameStatistics& statistics, u32 framesAgo=0) const =0;
+
+		//! Animate independent subtrees of the scene on the worker threads
+		/** drawAll() splits the scene below the scene manager, empty scene
+		nodes and dummy transformation nodes into subtrees, and calls
+		OnAnimate() of the subtrees on the engine's worker threads. Parents
+		are always animated before their children. Subtrees containing a
+		node or animator which is not thread safe, see
+		ISceneNode::isAnimationThreadSafe() and
+		ISceneNodeAnimator::isThreadSafe(), are animated afterwards on the
+		calling thread. Only the built-in classes which were checked
+		report to be thread safe, other nodes and animators have to opt
+		in. Animators shared by several nodes must be thread safe even
+		then. Default is false, see also
+		SIrrlichtCreationParameters::ParallelAnimation.
+		\param enable True to animate in parallel. */
+		virtual void setParallelAnimation(bool enable) =0;
+
+		//! Check if independent subtrees are animated on the worker threads
+		virtual bool getParallelAnimation() const =0;
 	};
 
 
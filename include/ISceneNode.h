@@ -17,12 +17,35 @@
 #include "matrix4.h"
 #include "irrList.h"
 #include "IAttributes.h"
+#include <atomic>
 
 namespace irr
 {
 namespace scene
 {
 	class ISceneManager;
+	class ISceneNode;
+
+	//! Amount of absolute transformations calculated by ISceneNode::updateAbsolutePosition()
+	/** Only counts up, see ISceneManager::getTransformationUpdateCount()
+	for the amount per frame. Atomic, as nodes may be animated in parallel. */
+	IRRLICHT_API extern std::atomic<u32> TransformationUpdateCounter;
+
+	//! Spatial index which keeps scene nodes for culling
+	/** Implemented by the scene manager, see ISceneManager::addToSceneIndex(). */
+	class ISceneNodeIndex
+	{
+	public:
+
+		//! Destructor
+		virtual ~ISceneNodeIndex() {}
+
+		//! Called when the absolute transformation of an indexed node changed
+		virtual void onSceneNodeMoved(ISceneNode* node) = 0;
+
+		//! Called when an indexed node or one of its parents was removed from its parent
+		virtual void onSceneNodeRemoved(ISceneNode* node) = 0;
+	};
 
 	//! Typedef for list of scene nodes
 	typedef core::list<ISceneNode*> ISceneNodeList;
@@ -47,9 +70,9 @@ namespace scene
 				const core::vector3df& rotation = core::vector3df(0,0,0),
 				const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f))
 			: RelativeTranslation(position), RelativeRotation(rotation), RelativeScale(scale),
-				Parent(0), SceneManager(mgr), TriangleSelector(0), ID(id),
+				Parent(0), SceneManager(mgr), SceneNodeIndex(0), TriangleSelector(0), ID(id),
 				AutomaticCullingState(EAC_BOX), DebugDataVisible(EDS_OFF),
-				IsVisible(true), IsDebugObject(false)
+				IsVisible(true), IsDebugObject(false), TransformationDirty(true)
 		{
 			if (parent)
 				parent->addChild(this);
@@ -92,9 +115,11 @@ namespace scene
 		{
 			if (IsVisible)
 			{
+				// indexed children are registered by the scene index
 				ISceneNodeList::Iterator it = Children.begin();
 				for (; it != Children.end(); ++it)
-					(*it)->OnRegisterSceneNode();
+					if (!(*it)->getSceneNodeIndex())
+						(*it)->OnRegisterSceneNode();
 			}
 		}
 
@@ -104,11 +129,18 @@ namespace scene
 		depending on what they are. Also, OnAnimate() should be called for all
 		child scene nodes here. This method will be called once per frame, independent
 		of whether the scene node is visible or not.
+		The absolute transformation is only recalculated when the node or
+		one of its parents was moved, see setTransformationDirty().
 		\param timeMs Current time in milliseconds. */
 		virtual void OnAnimate(u32 timeMs)
 		{
 			if (IsVisible)
 			{
+				// animators may change the transformation in ways the node
+				// can't see, so animated nodes are updated every frame
+				if (!Animators.empty())
+					TransformationDirty = true;
+
 				// animate this node with all animators
 
 				ISceneNodeAnimatorList::Iterator ait = Animators.begin();
@@ -126,7 +158,8 @@ namespace scene
 				}
 
 				// update absolute position
-				updateAbsolutePosition();
+				if (TransformationDirty)
+					updateAbsolutePosition();
 
 				// perform the post render process on all children
 
@@ -137,6 +170,21 @@ namespace scene
 		}
 
 
+		//! Returns if OnAnimate() of this node only changes the node and its children.
+		/** When the scene manager animates in parallel, see
+		ISceneManager::setParallelAnimation(), subtrees with a node
+		returning false are animated one after another on the calling
+		thread. The animators of the node are checked separately, see
+		ISceneNodeAnimator::isThreadSafe(). Only override this to
+		return true after checking OnAnimate() of the node class.
+		\return True if OnAnimate() may run concurrently for other nodes,
+		false by default. */
+		virtual bool isAnimationThreadSafe() const
+		{
+			return false;
+		}
+
+
 		//! Renders the node.
 		virtual void render() = 0;
 
@@ -304,6 +352,7 @@ namespace scene
 				child->remove(); // remove from old parent
 				Children.push_back(child);
 				child->Parent = this;
+				child->TransformationDirty = true;
 			}
 		}
 
@@ -320,7 +369,9 @@ namespace scene
 			for (; it != Children.end(); ++it)
 				if ((*it) == child)
 				{
+					(*it)->removeFromSceneNodeIndex();
 					(*it)->Parent = 0;
+					(*it)->TransformationDirty = true;
 					(*it)->drop();
 					Children.erase(it);
 					return true;
@@ -339,7 +390,9 @@ namespace scene
 			ISceneNodeList::Iterator it = Children.begin();
 			for (; it != Children.end(); ++it)
 			{
+				(*it)->removeFromSceneNodeIndex();
 				(*it)->Parent = 0;
+				(*it)->TransformationDirty = true;
 				(*it)->drop();
 			}
 
@@ -482,6 +535,7 @@ namespace scene
 		virtual void setScale(const core::vector3df& scale)
 		{
 			RelativeScale = scale;
+			TransformationDirty = true;
 		}
 
 
@@ -502,6 +556,7 @@ namespace scene
 		virtual void setRotation(const core::vector3df& rotation)
 		{
 			RelativeRotation = rotation;
+			TransformationDirty = true;
 		}
 
 
@@ -521,6 +576,7 @@ namespace scene
 		virtual void setPosition(const core::vector3df& newpos)
 		{
 			RelativeTranslation = newpos;
+			TransformationDirty = true;
 		}
 
 
@@ -661,9 +717,13 @@ namespace scene
 
 		//! Updates the absolute position based on the relative and the parents position
 		/** Note: This does not recursively update the parents absolute positions, so if you have a deeper
-			hierarchy you might want to update the parents first.*/
+			hierarchy you might want to update the parents first.
+			The transformation is always recalculated here, OnAnimate() only calls this when
+			the node is marked dirty. When the result changed, the children are marked dirty. */
 		virtual void updateAbsolutePosition()
 		{
+			const core::matrix4 previous(AbsoluteTransformation);
+
 			if (Parent)
 			{
 				AbsoluteTransformation =
@@ -671,6 +731,54 @@ namespace scene
 			}
 			else
 				AbsoluteTransformation = getRelativeTransformation();
+
+			TransformationDirty = false;
+			TransformationUpdateCounter.fetch_add(1, std::memory_order_relaxed);
+
+			if (previous != AbsoluteTransformation)
+			{
+				ISceneNodeList::Iterator it = Children.begin();
+				for (; it != Children.end(); ++it)
+					(*it)->TransformationDirty = true;
+
+				// indexed nodes tell the index when they moved
+				if (SceneNodeIndex)
+					SceneNodeIndex->onSceneNodeMoved(this);
+			}
+		}
+
+
+		//! Mark the absolute transformation to be recalculated in the next OnAnimate()
+		/** The setters for position, rotation and scale and changes of the
+		parent do this already. Derived nodes which change their relative
+		transformation in other ways have to call it. */
+		void setTransformationDirty()
+		{
+			TransformationDirty = true;
+		}
+
+
+		//! Check if the absolute transformation is recalculated in the next OnAnimate()
+		bool isTransformationDirty() const
+		{
+			return TransformationDirty;
+		}
+
+
+		//! Get the spatial index this node is kept in
+		/** \return The index, or 0 when the node is reached through the
+		scene graph only. See ISceneManager::addToSceneIndex(). */
+		ISceneNodeIndex* getSceneNodeIndex() const
+		{
+			return SceneNodeIndex;
+		}
+
+
+		//! Set the spatial index this node is kept in
+		/** Only called by the index itself. */
+		void setSceneNodeIndex(ISceneNodeIndex* index)
+		{
+			SceneNodeIndex = index;
 		}
 
 
@@ -777,6 +885,7 @@ namespace scene
 			RelativeTranslation = toCopyFrom->RelativeTranslation;
 			RelativeRotation = toCopyFrom->RelativeRotation;
 			RelativeScale = toCopyFrom->RelativeScale;
+			TransformationDirty = true;
 			ID = toCopyFrom->ID;
 			setTriangleSelector(toCopyFrom->TriangleSelector);
 			AutomaticCullingState = toCopyFrom->AutomaticCullingState;
@@ -809,6 +918,19 @@ namespace scene
 			}
 		}
 
+		//! Take this node and its indexed children out of their spatial index
+		/** Called when the node is removed from its parent, so the index
+		doesn't keep nodes which left the scene. */
+		void removeFromSceneNodeIndex()
+		{
+			if (SceneNodeIndex)
+				SceneNodeIndex->onSceneNodeRemoved(this);
+
+			ISceneNodeList::Iterator it = Children.begin();
+			for (; it != Children.end(); ++it)
+				(*it)->removeFromSceneNodeIndex();
+		}
+
 		//! Sets the new scene manager for this node and all children.
 		//! Called by addChild when moving nodes between scene managers
 		void setSceneManager(ISceneManager* newManager)
@@ -847,6 +969,9 @@ namespace scene
 		//! Pointer to the scene manager
 		ISceneManager* SceneManager;
 
+		//! Spatial index the node is kept in, if any
+		ISceneNodeIndex* SceneNodeIndex;
+
 		//! Pointer to the triangle selector
 		ITriangleSelector* TriangleSelector;
 
@@ -864,6 +989,9 @@ namespace scene
 
 		//! Is debug object?
 		bool IsDebugObject;
+
+		//! Absolute transformation has to be recalculated in OnAnimate()
+		bool TransformationDirty;
 	};
 
 
@@ -74,6 +74,23 @@ namespace scene
 			return false;
 		}
 
+		//! Returns if the animator only changes the node it animates.
+		/** When the scene manager animates in parallel, see
+		ISceneManager::setParallelAnimation(), subtrees with an animator
+		returning false are animated one after another on the calling
+		thread. Animators which touch the scene graph, the scene manager,
+		input devices or other nodes than their own must return false.
+		Only override this to return true after checking animateNode()
+		for all of that. The built-in animators which return true keep
+		state of their own, so they should not be shared by nodes of
+		different subtrees.
+		\return True if the animator may run concurrently with others,
+		false by default. */
+		virtual bool isThreadSafe() const
+		{
+			return false;
+		}
+
 		//! Reset a time-based movement by changing the starttime.
 		/** By default most animators start on object creation.
 			This value is ignored by animators which don't work with a starttime.
@@ -27,6 +27,21 @@ namespace scene
 		EIM_COUNT
 	};
 
+	//! Software skinning implementations used by ISkinnedMesh::skinMesh()
+	enum E_SKINNING_MODE
+	{
+		//! walk the joints and add each weight to its vertex
+		ESM_JOINTS = 0,
+
+		//! blend up to 4 joints per vertex from a table built in finalize().
+		/** Vectorized where SSE or NEON is available and large buffers are
+		split across worker threads. */
+		ESM_VERTEX_INFLUENCES,
+
+		//! count of all available skinning modes
+		ESM_COUNT
+	};
+
 
 	//! Interface for using some special functions of Skinned meshes
 	class ISkinnedMesh : public IAnimatedMesh
@@ -65,6 +80,46 @@ namespace scene
 		//! Sets Interpolation Mode
 		virtual void setInterpolationMode(E_INTERPOLATION_MODE mode) = 0;
 
+		//! Selects the software skinning implementation
+		/** ESM_VERTEX_INFLUENCES is only available for meshes where no
+		vertex is influenced by more than 4 joints.
+		\return True if the mode is used, false if the mesh can't
+		be skinned that way and keeps the previous mode. */
+		virtual bool setSkinningMode(E_SKINNING_MODE mode) = 0;
+
+		//! Gets the software skinning implementation in use
+		virtual E_SKINNING_MODE getSkinningMode() const = 0;
+
+		//! Pre-samples the joint animations at a fixed rate
+		/** Afterwards animateMesh() reads the pose from a table and
+		interpolates between neighbouring samples instead of searching the
+		keyframes, which makes evaluation cost independent of the amount of
+		keys and of the frame order. Only used with EIM_LINEAR.
+		\param samplesPerFrame Samples taken per animation frame, 0 frees
+		the samples again. Results differ from the keyframes by at most the
+		interpolation error between two samples.*/
+		virtual void setAnimationSampleRate(f32 samplesPerFrame) = 0;
+
+		//! Returns the memory used by the pre-sampled joint animations in bytes
+		virtual u32 getAnimationSampleMemory() const = 0;
+
+		//! Enables sharing of animated poses between scene nodes using this mesh
+		/** Animated mesh scene nodes showing the same frame within one scene
+		frame then reuse the joint matrices and skinned vertices computed for
+		the first of them, instead of animating and skinning the mesh again.
+		Only full (unblended) poses are shared.
+		\param maxPoses Amount of different poses kept per scene frame,
+		0 disables the cache.
+		\param frameTolerance Frames are rounded to multiples of this before
+		lookup, so nodes playing almost the same frame share a pose. 0 only
+		shares exactly matching frames. */
+		virtual void setPoseCache(u32 maxPoses, f32 frameTolerance=0.f) = 0;
+
+		//! Gets the pose cache counters of the current scene frame
+		/** \param hits Amount of times a cached pose was reused.
+		\param misses Amount of times a pose had to be computed. */
+		virtual void getPoseCacheStatistics(u32& hits, u32& misses) const = 0;
+
 		//! Animates this mesh's joints based on frame input
 		virtual void animateMesh(f32 frame, f32 blend)=0;
 
@@ -76,9 +131,37 @@ namespace scene
 		virtual void convertMeshToTangents() = 0;
 
 		//! Allows to enable hardware skinning.
-		/* This feature is not implemented in Irrlicht yet */
+		/** With hardware skinning the mesh buffers keep their static pose
+		and skinMesh() only computes the joint palette. The palette and the
+		per vertex joint streams are handed to the video driver by animated
+		mesh scene nodes, see video::IVideoDriver::setSkinningData().
+		Only drivers supporting video::EVDF_HARDWARE_SKINNING skin, and only
+		buffers with video::EMT_SOLID materials. Animated mesh scene nodes
+		switch hardware skinning off again when they are drawn otherwise,
+		the mesh is skinned on the CPU then. The bounding boxes of the mesh
+		and its buffers stay the ones of the static pose, so do triangle
+		selectors created from it.
+		Needs a mesh whose vertices have at most 4 joint influences and which
+		uses less than video::MAX_SKINNING_JOINTS weighted joints.
+		\return True if hardware skinning is enabled afterwards. */
 		virtual bool setHardwareSkinning(bool on) = 0;
 
+		//! Returns if hardware skinning is enabled
+		virtual bool getHardwareSkinning() const = 0;
+
+		//! Returns the joint palette of the last skinned frame
+		/** Only filled with hardware skinning enabled. Entry 0 is the
+		identity matrix, the others transform from the static pose into the
+		animated pose in mesh space. */
+		virtual const core::array<core::matrix4>& getJointPalette() const = 0;
+
+		//! Returns the joint influences of the vertices of a mesh buffer
+		/** \param buffer Index of the mesh buffer.
+		\return One entry per vertex indexing into getJointPalette(), or 0
+		if hardware skinning is disabled or no vertex of the buffer is
+		influenced by a joint. */
+		virtual const video::S3DVertexJoints* getVertexJoints(u32 buffer) const = 0;
+
 		//! A vertex weight
 		struct SWeight
 		{
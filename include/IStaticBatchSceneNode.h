@@ -0,0 +1,69 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+#define __I_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IMesh;
+	class IMeshSceneNode;
+
+	//! Scene node drawing many static mesh scene nodes merged into few mesh buffers
+	/** Created with ISceneManager::addStaticBatchSceneNode(). The mesh
+	buffers of the source nodes are transformed into the space of the
+	batch node and merged by material into buffers with 32 bit indices.
+	The source nodes are grouped into chunks on a grid, each chunk has its
+	own buffers and bounding box and is culled against the view frustum on
+	its own. The source nodes stay in the scene but are made invisible,
+	so nodes with children are not merged. */
+	class IStaticBatchSceneNode : public ISceneNode
+	{
+	public:
+
+		//! constructor
+		IStaticBatchSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id)
+			: ISceneNode(parent, mgr, id) {}
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_STATIC_BATCH; }
+
+		//! Get the merged geometry
+		/** Holds the merged buffers of all chunks. A triangle selector
+		created from it with ISceneManager::createTriangleSelector(mesh,
+		node, true) reports the index of the buffer as
+		SCollisionTriangleRange::MaterialIndex, which can be passed to
+		getSourceNode(u32, u32) for picking. separateMeshbuffers has to
+		be true, otherwise MaterialIndex is 0 for all triangles. */
+		virtual IMesh* getMesh() =0;
+
+		//! Get the source node a triangle of a merged buffer came from
+		/** \param bufferIndex Index of the buffer in getMesh().
+		\param triangleIndex Index of the triangle in the buffer.
+		\return The source node, or 0 if the indices are out of range. */
+		virtual IMeshSceneNode* getSourceNode(u32 bufferIndex, u32 triangleIndex) const =0;
+
+		//! Get the amount of merged source nodes
+		virtual u32 getSourceNodeCount() const =0;
+
+		//! Get a merged source node
+		virtual IMeshSceneNode* getSourceNode(u32 index) const =0;
+
+		//! Get the amount of chunks
+		virtual u32 getChunkCount() const =0;
+
+		//! Get the amount of draw calls the source nodes needed, one per mesh buffer
+		virtual u32 getSourceDrawCallCount() const =0;
+
+		//! Get the amount of merged buffers drawn in the last frame
+		virtual u32 getDrawCallCount() const =0;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -0,0 +1,38 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_TEXTURE_LOAD_CALLBACK_H_INCLUDED__
+#define __I_TEXTURE_LOAD_CALLBACK_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+
+namespace irr
+{
+namespace video
+{
+	class ITexture;
+
+//! Interface to get notified when a texture loaded in the background is ready.
+/** Pass an implementation to IVideoDriver::getTextureAsync(). */
+class ITextureLoadCallBack : public virtual IReferenceCounted
+{
+public:
+
+	//! Called when the loading of a texture finished.
+	/** Called on the render thread from IVideoDriver::endScene(), after
+	the image was uploaded into the texture. For a texture which was
+	already loaded, getTextureAsync() calls it right away.
+	\param texture The texture returned by getTextureAsync().
+	\param success False if the file could not be loaded. The texture
+	then keeps its placeholder image and stays in the texture cache
+	until it is removed with IVideoDriver::removeTexture(). Also false for loads given up by
+	IVideoDriver::removeAllTextures() and the destruction of the driver,
+	the texture is deleted right after the call then. */
+	virtual void OnTextureLoaded(ITexture* texture, bool success) = 0;
+};
+
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -20,6 +20,7 @@ namespace scene
 class ISceneNode;
 class ITriangleSelector;
 class IMeshBuffer;
+struct SCollisionHit;
 
 //! Additional information about the triangle arrays returned by ITriangleSelector::getTriangles
 /** ITriangleSelector are free to fill out this information fully, partly or ignore it.
@@ -187,6 +188,30 @@ public:
 	\return The scene node associated with that triangle.
 	*/
 	virtual ISceneNode* getSceneNodeForTriangle(u32 triangleIndex) const = 0;
+
+	//! Check if this selector can answer getNearestHit() by itself.
+	/** Selectors which keep a spatial hierarchy over their triangles,
+	like the ones created by ISceneManager::createBVHTriangleSelector(),
+	return true. For all others the triangles have to be fetched with
+	getTriangles() and tested one by one. */
+	virtual bool hasNearestHitQuery() const
+	{
+		return false;
+	}
+
+	//! Find the triangle which is hit first by a 3d line.
+	/** Only works when hasNearestHitQuery() returns true. The triangles are
+	not copied, the selector walks its own hierarchy instead.
+	\param outHit Receives the intersection point, the triangle and the
+	node, meshbuffer and material index it belongs to. Point and triangle
+	are in world space.
+	\param line Line to test, in world space. Only hits between its start
+	and end are reported.
+	\return True if a triangle was hit, false otherwise. */
+	virtual bool getNearestHit(SCollisionHit& outHit, const core::line3d<f32>& line) const
+	{
+		return false;
+	}
 };
 
 } // end namespace scene
@@ -19,6 +19,9 @@
 #include "EDriverFeatures.h"
 #include "SExposedVideoData.h"
 #include "SOverrideMaterial.h"
+#include "S3DInstance.h"
+#include "SFrameStatistics.h"
+#include "ITextureLoadCallBack.h"
 
 namespace irr
 {
@@ -264,6 +267,37 @@ namespace video
 		\param material: Material to be used from now on. */
 		virtual void setMaterial(const SMaterial& material) =0;
 
+		//! Sets the data used for hardware skinning of the following draw calls.
+		/** While set, drivers supporting EVDF_HARDWARE_SKINNING draw
+		EMT_SOLID geometry with a built-in skinning material, transforming
+		each vertex by the weighted palette matrices of its joints. Other
+		drivers ignore the data. Both arrays are not copied and have to stay
+		valid until the data is unset again.
+		\param palette Joint matrices in mesh space, see
+		scene::ISkinnedMesh::getJointPalette(). Pass 0 to disable hardware
+		skinning again.
+		\param jointCount Amount of matrices in palette, at most
+		MAX_SKINNING_JOINTS.
+		\param vertexJoints Joint influences, one entry per vertex of the
+		drawn geometry. */
+		virtual void setSkinningData(const core::matrix4* palette, u32 jointCount,
+			const S3DVertexJoints* vertexJoints) =0;
+
+		//! Sets the instances drawn by the following mesh buffer draw calls.
+		/** While set, each drawMeshBuffer() call draws the buffer once
+		per instance, with the transformation of the instance applied
+		before the world transformation and the vertex colors modulated by
+		the instance color. Drivers supporting EVDF_HARDWARE_INSTANCING
+		draw triangle lists of EMT_SOLID with one call, replacing the
+		material with a built-in instancing material. Other materials and
+		primitive types, and all drawing of other drivers, expand the
+		instances on the CPU. The array is not copied and has to stay
+		valid until the data is unset again.
+		\param instances Instances to draw. Pass 0 to disable
+		instancing again.
+		\param instanceCount Amount of instances. */
+		virtual void setInstanceData(const S3DInstance* instances, u32 instanceCount) =0;
+
 		//! Get access to a named texture.
 		/** Loads the texture from disk if it is not
 		already loaded and generates mipmap levels if desired.
@@ -288,6 +322,56 @@ namespace video
 		IReferenceCounted::drop() for more information. */
 		virtual ITexture* getTexture(io::IReadFile* file) =0;
 
+		//! Get access to a named texture, loading it in the background.
+		/** Works like getTexture(), but returns at once. The file is
+		opened right away, the image is decoded by a worker thread and
+		uploaded into the texture by a later endScene(), within the
+		budget set with setTextureUploadBudget(). Until then the texture
+		is a 1x1 white placeholder, which it stays when the file can't
+		be decoded. Textures which are already loaded or still loading
+		are returned from the cache. Only 2d textures can be loaded this
+		way.
+		The texture creation flags in effect at the time of this call
+		are used for the upload. Messages the image loader logs on the
+		worker thread reach the logger and the event receiver in the
+		next endScene().
+		\param filename Filename of the texture to be loaded.
+		\param callBack Optional, called on the render thread when the
+		texture is ready or failed to load. Also called when the
+		texture was already loaded. Grabbed until then.
+		\return Pointer to the texture, or 0 if the file could not be
+		opened. This pointer should not be dropped. See
+		IReferenceCounted::drop() for more information. */
+		virtual ITexture* getTextureAsync(const io::path& filename, ITextureLoadCallBack* callBack=0) =0;
+
+		//! Set how much texture data endScene() uploads per frame
+		/** Applies to textures loaded with getTextureAsync(). At least
+		one texture is uploaded each frame when one is ready.
+		\param bytes Maximum size of the images uploaded in one frame,
+		0 for no limit.
+		\param microseconds Uploads stop once they took this long in a
+		frame, 0 for no limit.
+		The default is no limit for both. */
+		virtual void setTextureUploadBudget(u32 bytes, u32 microseconds) =0;
+
+		//! Get the amount of textures requested with getTextureAsync() which are not ready yet
+		/** Includes textures which are still decoded and decoded ones
+		waiting for their upload. */
+		virtual u32 getPendingTextureCount() const =0;
+
+		//! Get the texture a loader on a worker thread asked for
+		/** Textures can only be created on the render thread.
+		getTexture() called from a worker thread of the engine, like
+		by the mesh loaders of ISceneManager::getMeshAsync(), returns a
+		stand-in instead which only has the name and must not be drawn.
+		The texture creation flags of the worker thread and calls of
+		makeNormalMapTexture() are kept with the stand-in. On the render
+		thread this method loads the texture with getTextureAsync().
+		\param texture A texture from a material.
+		\return The loaded texture, 0 if its file could not be opened,
+		or texture itself if it is no stand-in. */
+		virtual ITexture* resolveDeferredTexture(ITexture* texture) =0;
+
 		//! Returns a texture by index
 		/** \param index: Index of the texture, must be smaller than
 		getTextureCount() Please note that this index might change when
@@ -1068,6 +1152,37 @@ namespace video
 		\return Amount of primitives drawn in the last frame. */
 		virtual u32 getPrimitiveCountDrawn( u32 mode =0 ) const =0;
 
+		//! Returns amount of calls to setMaterial() in the last frame.
+		/** \param redundant When true, only the calls which set a material
+		equal to the one already set are counted.
+		\return Amount of material changes in the last frame. */
+		virtual u32 getMaterialChangeCount(bool redundant=false) const =0;
+
+		//! Returns amount of texture binds in the last frame.
+		/** A texture layer is bound when setMaterial() puts another texture
+		into it than the material set before.
+		\param redundant When true, count the texture layers which were set
+		to the texture they already had instead.
+		\return Amount of texture binds in the last frame. */
+		virtual u32 getTextureBindCount(bool redundant=false) const =0;
+
+		//! Returns amount of draw calls in the last frame.
+		/** Every mesh buffer and vertex primitive list drawn, in 2d or
+		3d, is one draw call.
+		\return Amount of draw calls in the last frame. */
+		virtual u32 getDrawCallCount() const =0;
+
+		//! Get the counters of a past frame
+		/** The driver keeps the counters of the last
+		FRAME_STATISTICS_HISTORY frames. Unlike the other statistics
+		methods, this one can be called from any thread while the
+		driver renders, it does not lock.
+		\param statistics Receives the counters.
+		\param framesAgo 0 for the last frame which ended with
+		endScene(), 1 for the one before and so on.
+		\return False if the frame is not kept (anymore). */
+		virtual bool getFrameStatistics(SDriverFrameStatistics& statistics, u32 framesAgo=0) const =0;
+
 		//! Deletes all dynamic lights which were previously added with addDynamicLight().
 		virtual void deleteAllDynamicLights() =0;
 
@@ -1463,6 +1578,22 @@ namespace video
 		/** \param count Number of vertices to set as minimum. */
 		virtual void setMinHardwareBufferVertexCount(u32 count) =0;
 
+		//! Set the size of the buffer which streams vertices and indices from client memory
+		/** Drivers with hardware buffers copy the vertices and indices
+		given to drawVertexPrimitiveList() and draw2DVertexPrimitiveList()
+		into one buffer which is reused round robin, instead of drawing
+		from client memory. The OpenGL ES driver streams the indices
+		through a second buffer of the same size. Draws which need more
+		than the size are drawn from client memory. Whether streaming is
+		faster depends on the OpenGL implementation, software rasterizers
+		which read client memory directly are slower with it.
+		\param size Size of the buffer in bytes, 0 disables streaming.
+		The default is 0. */
+		virtual void setStreamingBufferSize(u32 size) =0;
+
+		//! Get the size of the buffer which streams vertices and indices from client memory
+		virtual u32 getStreamingBufferSize() const =0;
+
 		//! Get the global Material, which might override local materials.
 		/** Depending on the enable flags, values from this Material
 		are used to override those of local materials of some
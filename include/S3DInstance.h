@@ -0,0 +1,47 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_3D_INSTANCE_H_INCLUDED__
+#define __S_3D_INSTANCE_H_INCLUDED__
+
+#include "matrix4.h"
+#include "SColor.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Per instance data for drawing many copies of one mesh buffer at once
+/** See IVideoDriver::setInstanceData(). The built-in instancing material
+gets the members as the vertex attributes inInstanceTransform0 to
+inInstanceTransform3 (the columns of the transformation), inInstanceColor
+and inInstanceCustom. Instances drawn with other materials are expanded
+on the CPU. */
+struct S3DInstance
+{
+	S3DInstance() : Color(0xffffffff)
+	{
+		Custom[0] = Custom[1] = Custom[2] = Custom[3] = 0.f;
+	}
+
+	S3DInstance(const core::matrix4& transformation, SColor color=SColor(0xffffffff))
+		: Transformation(transformation), Color(color)
+	{
+		Custom[0] = Custom[1] = Custom[2] = Custom[3] = 0.f;
+	}
+
+	//! Transformation of the instance, applied before the world transformation
+	core::matrix4 Transformation;
+
+	//! Color of the instance, modulates the vertex colors
+	SColor Color;
+
+	//! Free data, passed as inInstanceCustom but not used by the built-in material
+	f32 Custom[4];
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -260,6 +260,24 @@ struct S3DVertexTangents : public S3DVertex
 
 
 
+//! Maximum amount of matrices in a hardware skinning joint palette
+/** Entry 0 of a palette is always the identity matrix used by vertices
+without joint influence, so a mesh can use MAX_SKINNING_JOINTS-1 joints. */
+const u32 MAX_SKINNING_JOINTS = 64;
+
+//! Joint influences of one vertex, used for hardware skinning
+/** Kept in a separate stream next to the vertices of a mesh buffer.
+Unused slots have a weight of 0. */
+struct S3DVertexJoints
+{
+	//! Indices into the joint palette
+	u16 Joints[4];
+
+	//! Weights of the joints, summing up to 1
+	f32 Weights[4];
+};
+
+
 inline u32 getVertexPitchFromType(E_VERTEX_TYPE vertexType)
 {
 	switch (vertexType)
@@ -0,0 +1,149 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_FRAME_STATISTICS_H_INCLUDED__
+#define __S_FRAME_STATISTICS_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+
+//! Amount of past frames kept by IVideoDriver::getFrameStatistics() and ISceneManager::getFrameStatistics()
+const u32 FRAME_STATISTICS_HISTORY = 64;
+
+namespace video
+{
+
+//! Counters of the video driver for one frame, from beginScene() to endScene()
+struct SDriverFrameStatistics
+{
+	SDriverFrameStatistics() : Frame(0), DrawCalls(0), PrimitivesDrawn(0),
+		MaterialChanges(0), RedundantMaterialChanges(0), TextureBinds(0),
+		RedundantTextureBinds(0), BufferUploads(0), BufferUploadBytes(0),
+		StreamBufferWraps(0), StreamBufferStalls(0), StreamBufferOverflows(0),
+		TextureLoadsPending(0), TextureUploadsPending(0), TexturesUploaded(0),
+		TextureUploadBytes(0) {}
+
+	//! Number of the frame, counting from 1
+	u32 Frame;
+
+	//! Mesh buffers and vertex primitive lists drawn
+	u32 DrawCalls;
+
+	//! Primitives drawn, instances included
+	u32 PrimitivesDrawn;
+
+	//! Calls to setMaterial()
+	u32 MaterialChanges;
+
+	//! Calls to setMaterial() with the material which was already set
+	u32 RedundantMaterialChanges;
+
+	//! Texture layers which got another texture by setMaterial()
+	u32 TextureBinds;
+
+	//! Texture layers which were set to the texture they already had
+	u32 RedundantTextureBinds;
+
+	//! Vertex and index hardware buffers which were filled
+	u32 BufferUploads;
+
+	//! Bytes copied into hardware buffers
+	u32 BufferUploadBytes;
+
+	//! Times the streaming buffer was full and started over
+	/** See IVideoDriver::setStreamingBufferSize(). */
+	u32 StreamBufferWraps;
+
+	//! Times the driver waited for the GPU to be done with a part of the streaming buffer
+	/** Only a persistently mapped streaming buffer waits, an orphaned
+	buffer gets new storage. Stalls mean the buffer is too small for the
+	amount of data streamed while the GPU is behind. */
+	u32 StreamBufferStalls;
+
+	//! Draws from client memory which did not fit into the streaming buffer
+	u32 StreamBufferOverflows;
+
+	//! Textures from IVideoDriver::getTextureAsync() still decoded at the end of the frame
+	u32 TextureLoadsPending;
+
+	//! Decoded textures waiting for their upload at the end of the frame
+	/** Keeps growing when the upload budget is too small for the amount
+	of textures loaded, see IVideoDriver::setTextureUploadBudget(). */
+	u32 TextureUploadsPending;
+
+	//! Textures loaded in the background which were uploaded in the frame
+	u32 TexturesUploaded;
+
+	//! Size of the images uploaded for TexturesUploaded
+	u32 TextureUploadBytes;
+};
+
+} // end namespace video
+
+namespace scene
+{
+
+//! Render passes counted by SSceneFrameStatistics
+/** The passes are in the order of E_SCENE_NODE_RENDER_PASS, the index of
+a pass is the index of its bit there. */
+enum E_FRAME_STATISTICS_PASS
+{
+	EFSP_CAMERA = 0,
+	EFSP_LIGHT,
+	EFSP_SKY_BOX,
+	EFSP_SOLID,
+	EFSP_TRANSPARENT,
+	EFSP_TRANSPARENT_EFFECT,
+	EFSP_SHADOW,
+	EFSP_GUI,
+
+	//! Not a pass, the amount of passes
+	EFSP_COUNT
+};
+
+//! Counters of the scene manager for one ISceneManager::drawAll()
+struct SSceneFrameStatistics
+{
+	SSceneFrameStatistics() : Frame(0), CellsVisited(0), CellsCulled(0),
+		TransformationUpdates(0)
+	{
+		for (u32 i=0; i<EFSP_COUNT; ++i)
+		{
+			NodesRegistered[i] = 0;
+			NodesCulled[i] = 0;
+			NodesDrawn[i] = 0;
+		}
+	}
+
+	//! Number of the frame, counting from 1
+	u32 Frame;
+
+	//! Registrations for rendering per pass
+	/** Solid mesh buffers registered one by one with
+	ISceneManager::registerMeshBufferForRendering() count each. */
+	u32 NodesRegistered[EFSP_COUNT];
+
+	//! Registrations which were culled per pass
+	/** Nodes culled with their cell of the scene index did not register
+	and are not counted here, see CellsCulled. */
+	u32 NodesCulled[EFSP_COUNT];
+
+	//! Registrations rendered per pass
+	u32 NodesDrawn[EFSP_COUNT];
+
+	//! Cells of the scene index which were tested against the view frustum
+	u32 CellsVisited;
+
+	//! Cells of the scene index which were rejected with everything in them
+	u32 CellsCulled;
+
+	//! Absolute transformations which were recalculated
+	u32 TransformationUpdates;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
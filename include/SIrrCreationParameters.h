@@ -49,6 +49,7 @@ namespace irr
 			DisplayAdapter(0),
 			DriverMultithreaded(false),
 			UsePerformanceTimer(true),
+			ParallelAnimation(false),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION),
 			PrivateData(0),
 			OGLES2ShaderPath("media/Shaders/")
@@ -84,6 +85,7 @@ namespace irr
 			DisplayAdapter = other.DisplayAdapter;
 			DriverMultithreaded = other.DriverMultithreaded;
 			UsePerformanceTimer = other.UsePerformanceTimer;
+			ParallelAnimation = other.ParallelAnimation;
 			PrivateData = other.PrivateData;
 			OGLES2ShaderPath = other.OGLES2ShaderPath;
 			return *this;
@@ -299,6 +301,10 @@ namespace irr
 		*/
 		bool UsePerformanceTimer;
 
+		//! Animate independent subtrees of the scene on worker threads.
+		/** See ISceneManager::setParallelAnimation(). Default: false. */
+		bool ParallelAnimation;
+
 		//! Don't use or change this parameter.
 		/** Always set it to IRRLICHT_SDK_VERSION, which is done by default.
 		This is needed for sdk version checks. */
@@ -102,6 +102,7 @@
 #include "IImageLoader.h"
 #include "IImageWriter.h"
 #include "IIndexBuffer.h"
+#include "IInstancedMeshSceneNode.h"
 #include "ILightSceneNode.h"
 #include "ILogger.h"
 #include "IMaterialRenderer.h"
@@ -109,6 +110,7 @@
 #include "IMesh.h"
 #include "IMeshBuffer.h"
 #include "IMeshCache.h"
+#include "IMeshLoadCallBack.h"
 #include "IMeshLoader.h"
 #include "IMeshManipulator.h"
 #include "IMeshSceneNode.h"
@@ -147,9 +149,11 @@
 #include "IShaderConstantSetCallBack.h"
 #include "IShadowVolumeSceneNode.h"
 #include "ISkinnedMesh.h"
+#include "IStaticBatchSceneNode.h"
 #include "ITerrainSceneNode.h"
 #include "ITextSceneNode.h"
 #include "ITexture.h"
+#include "ITextureLoadCallBack.h"
 #include "ITimer.h"
 #include "ITriangleSelector.h"
 #include "IVertexBuffer.h"
@@ -168,11 +172,13 @@
 #include "position2d.h"
 #include "quaternion.h"
 #include "rect.h"
+#include "S3DInstance.h"
 #include "S3DVertex.h"
 #include "SAnimatedMesh.h"
 #include "SceneParameters.h"
 #include "SColor.h"
 #include "SExposedVideoData.h"
+#include "SFrameStatistics.h"
 #include "SIrrCreationParameters.h"
 #include "SKeyMap.h"
 #include "SLight.h"
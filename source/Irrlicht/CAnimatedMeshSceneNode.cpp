@@ -21,6 +21,7 @@
 #include "IMeshCache.h"
 #include "IAnimatedMesh.h"
 #include "quaternion.h"
+#include <mutex>
 
 
 namespace irr
@@ -28,6 +29,20 @@ namespace irr
 namespace scene
 {
 
+namespace
+{
+	// Meshes keep the frame they were animated to, so nodes sharing a mesh
+	// take turns when the scene is animated in parallel. Joint children are
+	// updated after the lock is released, a thread never holds two slots.
+	const u32 MESH_LOCK_COUNT = 64;
+	std::recursive_mutex MeshLocks[MESH_LOCK_COUNT];
+
+	std::recursive_mutex& getMeshLock(const IAnimatedMesh* mesh)
+	{
+		return MeshLocks[((size_t)mesh / sizeof(void*)) % MESH_LOCK_COUNT];
+	}
+}
+
 
 //! constructor
 CAnimatedMeshSceneNode::CAnimatedMeshSceneNode(IAnimatedMesh* mesh,
@@ -41,7 +56,8 @@ CAnimatedMeshSceneNode::CAnimatedMeshSceneNode(IAnimatedMesh* mesh,
 	TransitionTime(0), Transiting(0.f), TransitingBlend(0.f),
 	JointMode(EJUOR_NONE), JointsUsed(false),
 	Looping(true), ReadOnlyMaterials(false), RenderFromIdentity(false),
-	LoopCallBack(0), PassCount(0), Shadow(0), MD3Special(0)
+	LoopCallBack(0), PassCount(0), PoseFrame(0.f), PoseChange(0), PoseApplied(false),
+	Shadow(0), MD3Special(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CAnimatedMeshSceneNode");
@@ -207,25 +223,31 @@ IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 		// re-animate it every frame to ensure that this node gets the mesh that it needs.
 
 		CSkinnedMesh* skinnedMesh = reinterpret_cast<CSkinnedMesh*>(Mesh);
+		checkHardwareSkinning(skinnedMesh);
+
+		// Render passes after OnAnimate() find the mesh still in the pose
+		// this node applied, unless another node animated it meanwhile
+		if (PoseApplied && JointMode != EJUOR_CONTROL && PoseFrame == getFrameNr()
+			&& PoseChange == skinnedMesh->getPoseChangeCount())
+			return skinnedMesh;
 
 		if (JointMode == EJUOR_CONTROL)//write to mesh
+		{
 			skinnedMesh->transferJointsToMesh(JointChildSceneNodes);
-		else
-			skinnedMesh->animateMesh(getFrameNr(), 1.0f);
 
-		// Update the skinned mesh for the current joint transforms.
-		skinnedMesh->skinMesh();
+			// Update the skinned mesh for the current joint transforms.
+			skinnedMesh->skinMesh();
+		}
+		else
+		{
+			// Nodes at the same frame can share one pose within a scene frame
+			skinnedMesh->animateAndSkinShared(getFrameNr(), 1.0f, LastTimeMs);
+		}
 
 		if (JointMode == EJUOR_READ)//read from mesh
 		{
+			// the joint children are updated by updateJointChildren()
 			skinnedMesh->recoverJointsFromMesh(JointChildSceneNodes);
-
-			//---slow---
-			for (u32 n=0;n<JointChildSceneNodes.size();++n)
-				if (JointChildSceneNodes[n]->getParent()==this)
-				{
-					JointChildSceneNodes[n]->updateAbsolutePositionOfAllChildren(); //temp, should be an option
-				}
 		}
 
 		if(JointMode == EJUOR_CONTROL)
@@ -234,12 +256,62 @@ IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 			skinnedMesh->updateBoundingBox();
 		}
 
+		PoseFrame = getFrameNr();
+		PoseChange = skinnedMesh->getPoseChangeCount();
+		PoseApplied = true;
+
 		return skinnedMesh;
 #endif
 	}
 }
 
 
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+//! Switch hardware skinning of the mesh off where the driver can't do it
+/** The mesh buffers keep the static pose with hardware skinning, so
+drivers without EVDF_HARDWARE_SKINNING and materials other than EMT_SOLID
+would draw the mesh unanimated. The mesh is skinned by skinMesh() then. */
+void CAnimatedMeshSceneNode::checkHardwareSkinning(ISkinnedMesh* skinnedMesh)
+{
+	if (!skinnedMesh->getHardwareSkinning())
+		return;
+
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	bool supported = driver && driver->queryFeature(video::EVDF_HARDWARE_SKINNING);
+	for (u32 i=0; i<skinnedMesh->getMeshBufferCount() && supported; ++i)
+	{
+		if (!skinnedMesh->getVertexJoints(i))
+			continue;
+
+		const video::SMaterial& material = (ReadOnlyMaterials || i >= Materials.size()) ?
+			skinnedMesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+		supported = material.MaterialType == video::EMT_SOLID;
+	}
+
+	if (!supported)
+	{
+		os::Printer::log("Animated mesh - hardware skinning needs a driver supporting it and EMT_SOLID materials, skinning on the CPU", ELL_WARNING);
+		skinnedMesh->setHardwareSkinning(false);
+	}
+}
+#endif
+
+
+//! Update the joint children after getMeshForCurrentFrame() read the joints
+void CAnimatedMeshSceneNode::updateJointChildren()
+{
+	if (JointMode != EJUOR_READ || Mesh->getMeshType() != EAMT_SKINNED)
+		return;
+
+	//---slow---
+	for (u32 n=0;n<JointChildSceneNodes.size();++n)
+		if (JointChildSceneNodes[n]->getParent()==this)
+		{
+			JointChildSceneNodes[n]->updateAbsolutePositionOfAllChildren(); //temp, should be an option
+		}
+}
+
+
 //! OnAnimate() is called just before rendering the whole scene.
 void CAnimatedMeshSceneNode::OnAnimate(u32 timeMs)
 {
@@ -250,21 +322,37 @@ void CAnimatedMeshSceneNode::OnAnimate(u32 timeMs)
 
 	// set CurrentFrameNr
 	buildFrameNr(timeMs-LastTimeMs);
+	LastTimeMs = timeMs;
 
 	// update bbox
 	if (Mesh)
 	{
+		std::lock_guard<std::recursive_mutex> lock(getMeshLock(Mesh));
 		scene::IMesh * mesh = getMeshForCurrentFrame();
 
 		if (mesh)
 			Box = mesh->getBoundingBox();
+
+		// the MD3 tags are updated with the absolute transformation
+		if (Mesh->getMeshType() == EAMT_MD3)
+			setTransformationDirty();
 	}
-	LastTimeMs = timeMs;
+
+	// outside of the lock, attached animated children take their own
+	if (Mesh)
+		updateJointChildren();
 
 	IAnimatedMeshSceneNode::OnAnimate(timeMs);
 }
 
 
+//! The animation end callback may do anything
+bool CAnimatedMeshSceneNode::isAnimationThreadSafe() const
+{
+	return !LoopCallBack;
+}
+
+
 //! renders the node.
 void CAnimatedMeshSceneNode::render()
 {
@@ -280,6 +368,7 @@ void CAnimatedMeshSceneNode::render()
 	++PassCount;
 
 	scene::IMesh* m = getMeshForCurrentFrame();
+	updateJointChildren();
 
 	if(m)
 	{
@@ -327,6 +416,12 @@ void CAnimatedMeshSceneNode::render()
 	// render original meshes
 	if (renderMeshes)
 	{
+		// meshes skinned by the driver pass their palette along
+		ISkinnedMesh* skinnedMesh = 0;
+		if (Mesh->getMeshType() == EAMT_SKINNED)
+			skinnedMesh = static_cast<ISkinnedMesh*>(Mesh);
+		bool skinning = false;
+
 		for (u32 i=0; i<m->getMeshBufferCount(); ++i)
 		{
 			const bool transparent = driver->needsTransparentRenderPass(Materials[i]);
@@ -342,10 +437,26 @@ void CAnimatedMeshSceneNode::render()
 				else if (Mesh->getMeshType() == EAMT_SKINNED)
 					driver->setTransform(video::ETS_WORLD, AbsoluteTransformation * ((SSkinMeshBuffer*)mb)->Transformation);
 
+				const video::S3DVertexJoints* joints = skinnedMesh ? skinnedMesh->getVertexJoints(i) : 0;
+				if (joints)
+				{
+					const core::array<core::matrix4>& palette = skinnedMesh->getJointPalette();
+					driver->setSkinningData(palette.const_pointer(), palette.size(), joints);
+					skinning = true;
+				}
+				else if (skinning)
+				{
+					driver->setSkinningData(0, 0, 0);
+					skinning = false;
+				}
+
 				driver->setMaterial(material);
 				driver->drawMeshBuffer(mb);
 			}
 		}
+
+		if (skinning)
+			driver->setSkinningData(0, 0, 0);
 	}
 
 	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
@@ -829,6 +940,7 @@ void CAnimatedMeshSceneNode::setMesh(IAnimatedMesh* mesh)
 
 		// grab the mesh (it's non-null!)
 		Mesh->grab();
+		PoseApplied = false;
 	}
 
 	// get materials and bounding box
@@ -879,6 +991,7 @@ void CAnimatedMeshSceneNode::updateAbsolutePosition()
 	if (!Mesh || Mesh->getMeshType() != EAMT_MD3)
 		return;
 
+	std::lock_guard<std::recursive_mutex> lock(getMeshLock(Mesh));
 	SMD3QuaternionTagList *taglist;
 	taglist = ( (IAnimatedMeshMD3*) Mesh )->getTagList ( (s32)getFrameNr(),255,getStartFrame (),getEndFrame () );
 	if (taglist)
@@ -914,6 +1027,7 @@ void CAnimatedMeshSceneNode::setJointMode(E_JOINT_UPDATE_ON_RENDER mode)
 {
 	checkJoints();
 	JointMode=mode;
+	PoseApplied=false;
 }
 
 //! Sets the transition time in seconds (note: This needs to enable joints, and setJointmode maybe set to 2)
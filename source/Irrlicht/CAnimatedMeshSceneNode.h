@@ -16,6 +16,7 @@ namespace irr
 namespace scene
 {
 	class IDummyTransformationSceneNode;
+	class ISkinnedMesh;
 
 	class CAnimatedMeshSceneNode : public IAnimatedMeshSceneNode
 	{
@@ -39,6 +40,9 @@ namespace scene
 		//! OnAnimate() is called just before rendering the whole scene.
 		virtual void OnAnimate(u32 timeMs) _IRR_OVERRIDE_;
 
+		//! Returns if OnAnimate() of this node only changes the node and its children.
+		virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_;
+
 		//! renders the node.
 		virtual void render() _IRR_OVERRIDE_;
 
@@ -166,6 +170,12 @@ namespace scene
 		//! Get a static mesh for the current frame of this animated mesh
 		IMesh* getMeshForCurrentFrame();
 
+		//! Update the absolute positions of the children of the joints read from the mesh
+		void updateJointChildren();
+
+		//! Switch hardware skinning of the mesh off where the driver can't do it
+		void checkHardwareSkinning(ISkinnedMesh* skinnedMesh);
+
 		void buildFrameNr(u32 timeMs);
 		void checkJoints();
 		void beginTransition();
@@ -195,6 +205,11 @@ namespace scene
 		IAnimationEndCallBack* LoopCallBack;
 		s32 PassCount;
 
+		// Pose of the skinned mesh applied by getMeshForCurrentFrame()
+		f32 PoseFrame;
+		u32 PoseChange;
+		bool PoseApplied;
+
 		IShadowVolumeSceneNode* Shadow;
 
 		core::array<IBoneSceneNode* > JointChildSceneNodes;
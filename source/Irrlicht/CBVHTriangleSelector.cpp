@@ -0,0 +1,546 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBVHTriangleSelector.h"
+#include "ISceneNode.h"
+#include "ISceneCollisionManager.h"
+
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	// number of buckets the centers are sorted into when looking for a split
+	const u32 BVH_BIN_COUNT = 16;
+
+	// queries use a fixed size stack, deeper subtrees are turned into leaves
+	const u32 BVH_MAX_DEPTH = 48;
+
+	struct SBVHBin
+	{
+		core::aabbox3df Box;
+		u32 Count;
+	};
+
+	inline f32 axisValue(const core::vector3df& v, u32 axis)
+	{
+		return axis == 0 ? v.X : (axis == 1 ? v.Y : v.Z);
+	}
+
+	inline u32 binIndex(f32 value, f32 minValue, f32 scale)
+	{
+		const s32 bin = (s32)((value - minValue) * scale);
+		return (u32)core::clamp<s32>(bin, 0, BVH_BIN_COUNT-1);
+	}
+
+	// slab test, reports the entry distance in line lengths
+	inline bool intersectsBox(const core::aabbox3df& box, const core::vector3df& start,
+		const core::vector3df& invDir, f32 maxT, f32& outT)
+	{
+		f32 t0 = (box.MinEdge.X - start.X) * invDir.X;
+		f32 t1 = (box.MaxEdge.X - start.X) * invDir.X;
+		f32 tMin = core::min_(t0, t1);
+		f32 tMax = core::max_(t0, t1);
+
+		t0 = (box.MinEdge.Y - start.Y) * invDir.Y;
+		t1 = (box.MaxEdge.Y - start.Y) * invDir.Y;
+		tMin = core::max_(tMin, core::min_(t0, t1));
+		tMax = core::min_(tMax, core::max_(t0, t1));
+
+		t0 = (box.MinEdge.Z - start.Z) * invDir.Z;
+		t1 = (box.MaxEdge.Z - start.Z) * invDir.Z;
+		tMin = core::max_(tMin, core::min_(t0, t1));
+		tMax = core::min_(tMax, core::max_(t0, t1));
+
+		tMin = core::max_(tMin, 0.f);
+		tMax = core::min_(tMax, maxT);
+
+		outT = tMin;
+		return tMin <= tMax;
+	}
+
+	// two sided line/triangle test, reports the distance in line lengths
+	inline bool intersectsTriangle(const core::triangle3df& triangle, const core::vector3df& start,
+		const core::vector3df& dir, f32 maxT, f32& outT)
+	{
+		const core::vector3df edge1(triangle.pointB - triangle.pointA);
+		const core::vector3df edge2(triangle.pointC - triangle.pointA);
+		const core::vector3df p(dir.crossProduct(edge2));
+		const f32 det = edge1.dotProduct(p);
+		if (det == 0.f)
+			return false;
+
+		const f32 invDet = 1.f / det;
+		const core::vector3df s(start - triangle.pointA);
+		const f32 u = s.dotProduct(p) * invDet;
+		if (u < 0.f || u > 1.f)
+			return false;
+
+		const core::vector3df q(s.crossProduct(edge1));
+		const f32 v = dir.dotProduct(q) * invDet;
+		if (v < 0.f || u + v > 1.f)
+			return false;
+
+		const f32 t = edge2.dotProduct(q) * invDet;
+		if (t < 0.f || t > maxT)
+			return false;
+
+		outT = t;
+		return true;
+	}
+}
+
+
+//! constructor
+CBVHTriangleSelector::CBVHTriangleSelector(const IMesh* mesh, ISceneNode* node, u32 maxTrianglesPerLeaf)
+	: CTriangleSelector(mesh, node, true)
+	, MaxTrianglesPerLeaf(core::max_(maxTrianglesPerLeaf, 1u))
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	buildHierarchy();
+}
+
+
+//! constructor
+CBVHTriangleSelector::CBVHTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 materialIndex, ISceneNode* node, u32 maxTrianglesPerLeaf)
+	: CTriangleSelector(meshBuffer, materialIndex, node)
+	, MaxTrianglesPerLeaf(core::max_(maxTrianglesPerLeaf, 1u))
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	buildHierarchy();
+}
+
+
+void CBVHTriangleSelector::buildHierarchy()
+{
+	Nodes.clear();
+	TriangleIndices.clear();
+
+	const u32 cnt = Triangles.size();
+	if (!cnt)
+		return;
+
+	const u32 start = os::Timer::getRealTime();
+
+	core::array<core::aabbox3df> boxes;
+	core::array<core::vector3df> centers;
+	boxes.reallocate(cnt);
+	centers.reallocate(cnt);
+	TriangleIndices.reallocate(cnt);
+
+	for (u32 i=0; i<cnt; ++i)
+	{
+		const core::triangle3df& triangle = Triangles[i];
+		core::aabbox3df box(triangle.pointA);
+		box.addInternalPoint(triangle.pointB);
+		box.addInternalPoint(triangle.pointC);
+
+		boxes.push_back(box);
+		centers.push_back(box.getCenter());
+		TriangleIndices.push_back(i);
+	}
+
+	Nodes.reallocate(2 * (cnt / MaxTrianglesPerLeaf) + 1);
+	buildNode(0, cnt, 0, boxes, centers);
+
+	c8 tmp[256];
+	sprintf(tmp, "Needed %ums to create BVHTriangleSelector.(%u nodes, %u polys)",
+		os::Timer::getRealTime() - start, Nodes.size(), cnt);
+	os::Printer::log(tmp, ELL_INFORMATION);
+}
+
+
+u32 CBVHTriangleSelector::buildNode(u32 first, u32 count, u32 depth,
+		const core::array<core::aabbox3df>& boxes,
+		const core::array<core::vector3df>& centers)
+{
+	const u32 last = first + count;
+
+	SBVHNode node;
+	node.Box = boxes[TriangleIndices[first]];
+	node.First = first;
+	node.Count = count;
+
+	core::aabbox3df centerBox(centers[TriangleIndices[first]]);
+	for (u32 i=first+1; i<last; ++i)
+	{
+		node.Box.addInternalBox(boxes[TriangleIndices[i]]);
+		centerBox.addInternalPoint(centers[TriangleIndices[i]]);
+	}
+
+	const u32 nodeIndex = Nodes.size();
+	Nodes.push_back(node);
+
+	if (count <= MaxTrianglesPerLeaf || depth >= BVH_MAX_DEPTH)
+		return nodeIndex;
+
+	// Bin the triangle centers along each axis and pick the split with
+	// the lowest surface area cost.
+	f32 bestCost = FLT_MAX;
+	s32 bestAxis = -1;
+	u32 bestSplit = 0;
+	f32 bestMin = 0.f;
+	f32 bestScale = 0.f;
+
+	for (u32 axis=0; axis<3; ++axis)
+	{
+		const f32 minValue = axisValue(centerBox.MinEdge, axis);
+		const f32 extent = axisValue(centerBox.MaxEdge, axis) - minValue;
+		if (extent <= 0.f)
+			continue;
+		const f32 scale = BVH_BIN_COUNT / extent;
+
+		SBVHBin bins[BVH_BIN_COUNT];
+		for (u32 b=0; b<BVH_BIN_COUNT; ++b)
+			bins[b].Count = 0;
+
+		for (u32 i=first; i<last; ++i)
+		{
+			const u32 triangle = TriangleIndices[i];
+			SBVHBin& bin = bins[binIndex(axisValue(centers[triangle], axis), minValue, scale)];
+			if (bin.Count)
+				bin.Box.addInternalBox(boxes[triangle]);
+			else
+				bin.Box = boxes[triangle];
+			++bin.Count;
+		}
+
+		// sweep from the right to get the cost of all right halves
+		f32 rightCost[BVH_BIN_COUNT];
+		core::aabbox3df sum;
+		u32 sumCount = 0;
+		for (u32 b=BVH_BIN_COUNT-1; b>0; --b)
+		{
+			if (bins[b].Count)
+			{
+				if (sumCount)
+					sum.addInternalBox(bins[b].Box);
+				else
+					sum = bins[b].Box;
+				sumCount += bins[b].Count;
+			}
+			rightCost[b] = sumCount ? sum.getArea() * sumCount : -1.f;
+		}
+
+		// and from the left to combine them with the left halves
+		sumCount = 0;
+		for (u32 b=0; b<BVH_BIN_COUNT-1; ++b)
+		{
+			if (bins[b].Count)
+			{
+				if (sumCount)
+					sum.addInternalBox(bins[b].Box);
+				else
+					sum = bins[b].Box;
+				sumCount += bins[b].Count;
+			}
+			if (!sumCount || rightCost[b+1] < 0.f)
+				continue;
+
+			const f32 cost = sum.getArea() * sumCount + rightCost[b+1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = b+1;
+				bestMin = minValue;
+				bestScale = scale;
+			}
+		}
+	}
+
+	u32 leftCount = count / 2;
+	if (bestAxis >= 0)
+	{
+		u32 i = first;
+		u32 j = last;
+		while (i < j)
+		{
+			if (binIndex(axisValue(centers[TriangleIndices[i]], bestAxis), bestMin, bestScale) < bestSplit)
+				++i;
+			else
+				core::swap(TriangleIndices[i], TriangleIndices[--j]);
+		}
+		leftCount = i - first;
+	}
+	// else all centers are in the same spot, any split is as good as another
+
+	buildNode(first, leftCount, depth+1, boxes, centers);
+	const u32 right = buildNode(first + leftCount, count - leftCount, depth+1, boxes, centers);
+
+	Nodes[nodeIndex].First = right;
+	Nodes[nodeIndex].Count = 0;
+	return nodeIndex;
+}
+
+
+u32 CBVHTriangleSelector::findBufferRange(u32 triangleIndex, u32 hint) const
+{
+	if (BufferRanges[hint].isIndexInRange(triangleIndex))
+		return hint;
+
+	// ranges are sorted and cover all triangles, empty ones share
+	// their start with the following range
+	u32 low = 0;
+	u32 high = BufferRanges.size()-1;
+	while (low < high)
+	{
+		const u32 mid = (low + high + 1) / 2;
+		if (BufferRanges[mid].RangeStart <= triangleIndex)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+	return low;
+}
+
+
+//! Gets all triangles which lie within a specific bounding box.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+					s32 arraySize, s32& outTriangleCount,
+					const core::aabbox3d<f32>& box,
+					const core::matrix4* transform, bool useNodeTransform,
+					irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const
+{
+	core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+	core::aabbox3df tBox(box);
+
+	if (SceneNode && useNodeTransform)
+	{
+		if ( SceneNode->getAbsoluteTransformation().getInverse(mat) )
+			mat.transformBoxEx(tBox);
+		else
+		{
+			// node has an axis scaled to 0, return all triangles
+			CTriangleSelector::getTriangles(triangles, arraySize, outTriangleCount,
+					transform, useNodeTransform, outTriangleInfo);
+			return;
+		}
+	}
+	if (transform)
+		mat = *transform;
+	else
+		mat.makeIdentity();
+	if (SceneNode && useNodeTransform)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	outTriangleCount = 0;
+
+	if (Nodes.empty() || !tBox.intersectsWithBox(Nodes[0].Box))
+		return;
+
+	// Triangles come out in hierarchy order, so a new range is started
+	// whenever the meshbuffer changes.
+	const bool splitRanges = outTriangleInfo && !BufferRanges.empty();
+	u32 activeRange = 0;
+	SCollisionTriangleRange triRange;
+	triRange.Selector = const_cast<CBVHTriangleSelector*>(this);
+	triRange.SceneNode = SceneNode;
+	triRange.MeshBuffer = MeshBuffer;
+	triRange.MaterialIndex = MaterialIndex;
+
+	s32 triangleCount = 0;
+	u32 stack[BVH_MAX_DEPTH+2];
+	u32 stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize && triangleCount < arraySize)
+	{
+		const u32 current = stack[--stackSize];
+		const SBVHNode& node = Nodes[current];
+		if (!tBox.intersectsWithBox(node.Box))
+			continue;
+
+		if (!node.Count)
+		{
+			stack[stackSize++] = node.First;
+			stack[stackSize++] = current + 1;
+			continue;
+		}
+
+		for (u32 i=node.First; i<node.First+node.Count; ++i)
+		{
+			const u32 index = TriangleIndices[i];
+
+			// This isn't an accurate test, but it's fast, and the
+			// API contract doesn't guarantee complete accuracy.
+			if (Triangles[index].isTotalOutsideBox(tBox))
+				continue;
+
+			if ( splitRanges && (triangleCount == 0 || !BufferRanges[activeRange].isIndexInRange(index)) )
+			{
+				triRange.RangeSize = triangleCount - triRange.RangeStart;
+				if ( triRange.RangeSize > 0 )
+					outTriangleInfo->push_back(triRange);
+
+				activeRange = findBufferRange(index, activeRange);
+				triRange.RangeStart = triangleCount;
+				triRange.MeshBuffer = BufferRanges[activeRange].MeshBuffer;
+				triRange.MaterialIndex = BufferRanges[activeRange].MaterialIndex;
+			}
+
+			triangles[triangleCount] = Triangles[index];
+			mat.transformVect(triangles[triangleCount].pointA);
+			mat.transformVect(triangles[triangleCount].pointB);
+			mat.transformVect(triangles[triangleCount].pointC);
+
+			++triangleCount;
+
+			if (triangleCount == arraySize)
+				break;
+		}
+	}
+
+	if ( outTriangleInfo )
+	{
+		triRange.RangeSize = triangleCount - triRange.RangeStart;
+		if ( triRange.RangeSize > 0 || !splitRanges )
+			outTriangleInfo->push_back(triRange);
+	}
+
+	outTriangleCount = triangleCount;
+}
+
+
+//! Find the triangle which is hit first by a 3d line.
+bool CBVHTriangleSelector::getNearestHit(SCollisionHit& outHit, const core::line3d<f32>& line) const
+{
+	if (Nodes.empty())
+		return false;
+
+	core::vector3df start(line.start);
+	core::vector3df end(line.end);
+	if (SceneNode)
+	{
+		core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+
+		// a node with an axis scaled to 0 has no area left to hit
+		if (!SceneNode->getAbsoluteTransformation().getInverse(mat))
+			return false;
+		mat.transformVect(start);
+		mat.transformVect(end);
+	}
+
+	// Distances are measured in line lengths, so they are the same in
+	// local and world space.
+	const core::vector3df dir(end - start);
+	const core::vector3df invDir(
+		dir.X != 0.f ? 1.f / dir.X : FLT_MAX,
+		dir.Y != 0.f ? 1.f / dir.Y : FLT_MAX,
+		dir.Z != 0.f ? 1.f / dir.Z : FLT_MAX);
+
+	f32 nearest = 1.f;
+	s32 found = -1;
+	f32 t;
+
+	if (!intersectsBox(Nodes[0].Box, start, invDir, nearest, t))
+		return false;
+
+	// closer child first, the other one is checked again against the
+	// nearest hit when it comes off the stack
+	u32 stack[BVH_MAX_DEPTH+1];
+	u32 stackSize = 0;
+	u32 current = 0;
+
+	for (;;)
+	{
+		const SBVHNode& node = Nodes[current];
+		if (node.Count)
+		{
+			for (u32 i=node.First; i<node.First+node.Count; ++i)
+			{
+				if (intersectsTriangle(Triangles[TriangleIndices[i]], start, dir, nearest, t))
+				{
+					nearest = t;
+					found = (s32)TriangleIndices[i];
+				}
+			}
+		}
+		else
+		{
+			f32 tLeft, tRight;
+			const bool hitLeft = intersectsBox(Nodes[current+1].Box, start, invDir, nearest, tLeft);
+			const bool hitRight = intersectsBox(Nodes[node.First].Box, start, invDir, nearest, tRight);
+
+			if (hitLeft && hitRight)
+			{
+				if (tLeft <= tRight)
+				{
+					stack[stackSize++] = node.First;
+					current = current + 1;
+				}
+				else
+				{
+					stack[stackSize++] = current + 1;
+					current = node.First;
+				}
+				continue;
+			}
+			if (hitLeft)
+			{
+				current = current + 1;
+				continue;
+			}
+			if (hitRight)
+			{
+				current = node.First;
+				continue;
+			}
+		}
+
+		bool next = false;
+		while (stackSize)
+		{
+			current = stack[--stackSize];
+			if (intersectsBox(Nodes[current].Box, start, invDir, nearest, t))
+			{
+				next = true;
+				break;
+			}
+		}
+		if (!next)
+			break;
+	}
+
+	if (found < 0)
+		return false;
+
+	outHit.Intersection = line.start + (line.end - line.start) * nearest;
+	outHit.Triangle = Triangles[found];
+	if (SceneNode)
+	{
+		const core::matrix4& mat = SceneNode->getAbsoluteTransformation();
+		mat.transformVect(outHit.Triangle.pointA);
+		mat.transformVect(outHit.Triangle.pointB);
+		mat.transformVect(outHit.Triangle.pointC);
+	}
+
+	outHit.TriangleSelector = const_cast<CBVHTriangleSelector*>(this);
+	outHit.Node = SceneNode;
+	if (BufferRanges.empty())
+	{
+		outHit.MeshBuffer = MeshBuffer;
+		outHit.MaterialIndex = MaterialIndex;
+	}
+	else
+	{
+		const SCollisionTriangleRange& range = BufferRanges[findBufferRange((u32)found, 0)];
+		outHit.MeshBuffer = range.MeshBuffer;
+		outHit.MaterialIndex = range.MaterialIndex;
+	}
+
+	return true;
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,70 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+#define __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+
+#include "CTriangleSelector.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Triangle selector which organizes the triangles in a bounding volume hierarchy
+/** The hierarchy is built with the surface area heuristic. Ray queries
+walk it directly through getNearestHit(), box queries (and line
+queries, which are answered with the box around the line) use it to
+skip whole subtrees. The triangles are never reordered, so the
+buffer ranges of CTriangleSelector stay valid. */
+class CBVHTriangleSelector : public CTriangleSelector
+{
+public:
+
+	//! Constructs a selector based on a mesh
+	CBVHTriangleSelector(const IMesh* mesh, ISceneNode* node, u32 maxTrianglesPerLeaf);
+
+	//! Constructs a selector based on a meshbuffer
+	CBVHTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 materialIndex, ISceneNode* node, u32 maxTrianglesPerLeaf);
+
+	//! Gets all triangles which lie within a specific bounding box.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize, s32& outTriangleCount,
+		const core::aabbox3d<f32>& box, const core::matrix4* transform, bool useNodeTransform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const _IRR_OVERRIDE_;
+
+	//! The hierarchy answers ray queries without copying triangles
+	virtual bool hasNearestHitQuery() const _IRR_OVERRIDE_ { return true; }
+
+	//! Find the triangle which is hit first by a 3d line.
+	virtual bool getNearestHit(SCollisionHit& outHit, const core::line3d<f32>& line) const _IRR_OVERRIDE_;
+
+private:
+
+	//! Flattened hierarchy node
+	/** The left child of an inner node always directly follows it,
+	First is the index of the right child. For leaves First indexes
+	TriangleIndices and Count is the number of triangles. */
+	struct SBVHNode
+	{
+		core::aabbox3df Box;
+		u32 First;
+		u32 Count;
+	};
+
+	void buildHierarchy();
+	u32 buildNode(u32 first, u32 count, u32 depth,
+		const core::array<core::aabbox3df>& boxes,
+		const core::array<core::vector3df>& centers);
+
+	//! Find the buffer range a triangle belongs to, starting the search at hint
+	u32 findBufferRange(u32 triangleIndex, u32 hint) const;
+
+	core::array<SBVHNode> Nodes;
+	core::array<u32> TriangleIndices;
+	u32 MaxTrianglesPerLeaf;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -41,6 +41,9 @@ namespace scene
 
 		virtual void OnAnimate(u32 timeMs) _IRR_OVERRIDE_;
 
+		//! Returns if OnAnimate() of this node only changes the node and its children
+		virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
 		virtual void updateAbsolutePositionOfAllChildren() _IRR_OVERRIDE_;
 
 		//! Writes attributes of the scene node.
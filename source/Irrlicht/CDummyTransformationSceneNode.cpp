@@ -35,6 +35,8 @@ const core::aabbox3d<f32>& CDummyTransformationSceneNode::getBoundingBox() const
 //! and rotation.
 core::matrix4& CDummyTransformationSceneNode::getRelativeTransformationMatrix()
 {
+	// the caller may change the matrix
+	setTransformationDirty();
 	return RelativeTransformationMatrix;
 }
 
@@ -31,6 +31,9 @@ namespace scene
 		//! Returns type of the scene node
 		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_EMPTY; }
 
+		//! Returns if OnAnimate() of this node only changes the node and its children
+		virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
 		//! Creates a clone of this scene node and its children.
 		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
 
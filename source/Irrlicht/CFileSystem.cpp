@@ -21,8 +21,10 @@
 #include "CReadFile.h"
 #include "CMemoryFile.h"
 #include "CLimitReadFile.h"
+#include "CMappedReadFile.h"
 #include "CWriteFile.h"
 #include "irrList.h"
+#include "coreutil.h"
 
 #if defined (__STRICT_ANSI__)
 	#error Compiling with __STRICT_ANSI__ not supported. g++ does set this when compiling with -std=c++11 or -std=c++0x. Use instead -std=gnu++11 or -std=gnu++0x. Or use -U__STRICT_ANSI__ to disable strict ansi.
@@ -52,6 +54,8 @@ namespace io
 
 //! constructor
 CFileSystem::CFileSystem()
+	: FileMappingThreshold(1048576), FileLookups(0), FileIndexHits(0),
+	ArchiveSearches(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CFileSystem");
@@ -114,16 +118,47 @@ IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 	IReadFile* file = 0;
 	u32 i;
 
-	for (i=0; i< FileArchives.size(); ++i)
 	{
-		file = FileArchives[i]->createAndOpenFile(filename);
-		if (file)
-			return file;
+		// background loads open files while archives are added and removed
+		std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
+
+		SIndexedFile found[2];
+		// search the archives by name when the index can't tell
+		bool walk = !findIndexedFile(filename, found);
+
+		for (i=0; i< FileArchives.size(); ++i)
+		{
+			if (ArchiveFileIndex[i] != -1 && !walk)
+			{
+				for (u32 k=0; k<2; ++k)
+				{
+					if (found[k].Archive == FileArchives[i])
+					{
+						file = FileArchives[i]->createAndOpenFile(found[k].Index);
+						if (file)
+							return file;
+						// indexed but gone, like a deleted file of a folder
+						walk = true;
+					}
+				}
+				continue;
+			}
+
+			++ArchiveSearches;
+			file = FileArchives[i]->createAndOpenFile(filename);
+			if (file)
+				return file;
+		}
 	}
 
 	// Create the file using an absolute path so that it matches
 	// the scheme used by CNullDriver::getTexture().
-	return CReadFile::createReadFile(getAbsolutePath(filename));
+	const io::path absolutePath = getAbsolutePath(filename);
+	file = CMappedReadFile::createMappedReadFile(absolutePath, FileMappingThreshold);
+	if (file)
+		return file;
+
+	return CReadFile::createReadFile(absolutePath);
 }
 
 
@@ -145,7 +180,14 @@ IReadFile* CFileSystem::createLimitReadFile(const io::path& fileName,
 	if (!alreadyOpenedFile)
 		return 0;
 	else
-		return new CLimitReadFile(alreadyOpenedFile, pos, areaSize, fileName);
+		return io::createLimitReadFile(fileName, alreadyOpenedFile, pos, areaSize);
+}
+
+
+//! Set from which size files are mapped into memory instead of read
+void CFileSystem::setFileMappingThreshold(long size)
+{
+	FileMappingThreshold = size;
 }
 
 
@@ -195,6 +237,7 @@ IArchiveLoader* CFileSystem::getArchiveLoader(u32 index) const
 //! move the hirarchy of the filesystem. moves sourceIndex relative up or down
 bool CFileSystem::moveFileArchive(u32 sourceIndex, s32 relative)
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	bool r = false;
 	const s32 dest = (s32) sourceIndex + relative;
 	const s32 dir = relative < 0 ? -1 : 1;
@@ -209,8 +252,14 @@ bool CFileSystem::moveFileArchive(u32 sourceIndex, s32 relative)
 		t = FileArchives[s + dir];
 		FileArchives[s + dir] = FileArchives[s];
 		FileArchives[s] = t;
+		const s32 fileIndex = ArchiveFileIndex[s + dir];
+		ArchiveFileIndex[s + dir] = ArchiveFileIndex[s];
+		ArchiveFileIndex[s] = fileIndex;
 		r = true;
 	}
+
+	if (r)
+		rebuildFileIndex();
 	return r;
 }
 
@@ -221,6 +270,7 @@ bool CFileSystem::addFileArchive(const io::path& filename, bool ignoreCase,
 			  const core::stringc& password,
 			  IFileArchive** retArchive)
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	IFileArchive* archive = 0;
 	bool ret = false;
 
@@ -307,7 +357,7 @@ bool CFileSystem::addFileArchive(const io::path& filename, bool ignoreCase,
 
 	if (archive)
 	{
-		FileArchives.push_back(archive);
+		appendFileArchive(archive, getFileIndexOf(archive, ignoreCase, ignorePaths));
 		if (password.size())
 			archive->Password=password;
 		if (retArchive)
@@ -327,6 +377,7 @@ bool CFileSystem::changeArchivePassword(const path& filename,
 		const core::stringc& password,
 		IFileArchive** archive)
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	for (s32 idx = 0; idx < (s32)FileArchives.size(); ++idx)
 	{
 		// TODO: This should go into a path normalization method
@@ -353,6 +404,8 @@ bool CFileSystem::addFileArchive(IReadFile* file, bool ignoreCase,
 	if (!file || archiveType == EFAT_FOLDER)
 		return false;
 
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
+
 	if (file)
 	{
 		if (changeArchivePassword(file->getFileName(), password, retArchive))
@@ -412,7 +465,7 @@ bool CFileSystem::addFileArchive(IReadFile* file, bool ignoreCase,
 
 		if (archive)
 		{
-			FileArchives.push_back(archive);
+			appendFileArchive(archive, getFileIndexOf(archive, ignoreCase, ignorePaths));
 			if (password.size())
 				archive->Password=password;
 			if (retArchive)
@@ -432,6 +485,7 @@ bool CFileSystem::addFileArchive(IReadFile* file, bool ignoreCase,
 //! Adds an archive to the file system.
 bool CFileSystem::addFileArchive(IFileArchive* archive)
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	if ( archive )
 	{
 		for (u32 i=0; i < FileArchives.size(); ++i)
@@ -441,7 +495,8 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 				return false;
 			}
 		}
-		FileArchives.push_back(archive);
+		// nothing is known about how it matches names
+		appendFileArchive(archive, -1);
 		archive->grab();
 
 		return true;
@@ -454,11 +509,14 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 //! removes an archive from the file system.
 bool CFileSystem::removeFileArchive(u32 index)
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	bool ret = false;
 	if (index < FileArchives.size())
 	{
+		unindexFileArchive(index);
 		FileArchives[index]->drop();
 		FileArchives.erase(index);
+		ArchiveFileIndex.erase(index);
 		ret = true;
 	}
 	return ret;
@@ -468,6 +526,7 @@ bool CFileSystem::removeFileArchive(u32 index)
 //! removes an archive from the file system.
 bool CFileSystem::removeFileArchive(const io::path& filename)
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	const path absPath = getAbsolutePath(filename);
 	for (u32 i=0; i < FileArchives.size(); ++i)
 	{
@@ -481,6 +540,7 @@ bool CFileSystem::removeFileArchive(const io::path& filename)
 //! Removes an archive from the file system.
 bool CFileSystem::removeFileArchive(const IFileArchive* archive)
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	for (u32 i=0; i < FileArchives.size(); ++i)
 	{
 		if (archive == FileArchives[i])
@@ -495,16 +555,192 @@ bool CFileSystem::removeFileArchive(const IFileArchive* archive)
 //! gets an archive
 u32 CFileSystem::getFileArchiveCount() const
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	return FileArchives.size();
 }
 
 
 IFileArchive* CFileSystem::getFileArchive(u32 index)
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	return index < getFileArchiveCount() ? FileArchives[index] : 0;
 }
 
 
+//! Get how often files were looked up in the archives
+SFileLookupCounts CFileSystem::getFileLookupCounts() const
+{
+	SFileLookupCounts counts;
+	counts.Lookups = FileLookups;
+	counts.IndexHits = FileIndexHits;
+	counts.ArchiveSearches = ArchiveSearches;
+	return counts;
+}
+
+
+size_t CFileSystem::SPathHash::operator()(const io::path& path) const
+{
+	u32 hash = 2166136261u;
+	const fschar_t* c = path.c_str();
+	for (u32 i=0; i<path.size(); ++i)
+	{
+		hash ^= (u32)c[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+
+//! Get the index an archive created by a loader goes into
+s32 CFileSystem::getFileIndexOf(const IFileArchive* archive, bool ignoreCase, bool ignorePaths)
+{
+	// case sensitive archives are searched by name, in their place
+	if (!ignoreCase)
+		return -1;
+
+	// the built-in archives match names like the index
+	switch (archive->getType())
+	{
+	case EFAT_ZIP:
+	case EFAT_GZIP:
+	case EFAT_FOLDER:
+	case EFAT_PAK:
+	case EFAT_NPK:
+	case EFAT_TAR:
+	case EFAT_WAD:
+		return ignorePaths ? 1 : 0;
+	default:
+		return -1;
+	}
+}
+
+
+//! Add an archive at the end of the search order
+void CFileSystem::appendFileArchive(IFileArchive* archive, s32 fileIndex)
+{
+	FileArchives.push_back(archive);
+	ArchiveFileIndex.push_back(fileIndex);
+	indexFileArchive(FileArchives.size()-1);
+}
+
+
+//! Add the files of an archive to the index, unless an archive before it has them
+void CFileSystem::indexFileArchive(u32 index)
+{
+	if (ArchiveFileIndex[index] == -1)
+		return;
+
+	IFileArchive* archive = FileArchives[index];
+	const IFileList* list = archive->getFileList();
+	std::unordered_map<io::path, SIndexedFile, SPathHash>& fileIndex = FileIndex[ArchiveFileIndex[index]];
+
+	const u32 count = list->getFileCount();
+	fileIndex.reserve(fileIndex.size() + count);
+	for (u32 i=0; i<count; ++i)
+	{
+		if (list->isDirectory(i))
+			continue;
+
+		io::path name = list->getFullFileName(i);
+		name.make_lower();
+		// keeps the archive which is searched first
+		fileIndex.emplace(name, SIndexedFile(archive, i));
+	}
+}
+
+
+//! Remove the files of an archive from the index
+void CFileSystem::unindexFileArchive(u32 index)
+{
+	const s32 indexOfArchive = ArchiveFileIndex[index];
+	if (indexOfArchive == -1)
+		return;
+
+	IFileArchive* archive = FileArchives[index];
+	const IFileList* list = archive->getFileList();
+	std::unordered_map<io::path, SIndexedFile, SPathHash>& fileIndex = FileIndex[indexOfArchive];
+
+	const u32 count = list->getFileCount();
+	for (u32 i=0; i<count; ++i)
+	{
+		if (list->isDirectory(i))
+			continue;
+
+		io::path name = list->getFullFileName(i);
+		name.make_lower();
+		std::unordered_map<io::path, SIndexedFile, SPathHash>::iterator it = fileIndex.find(name);
+		if (it == fileIndex.end() || it->second.Archive != archive)
+			continue;
+		fileIndex.erase(it);
+
+		// the file may be in an archive the removed one hid
+		for (u32 a=index+1; a<FileArchives.size(); ++a)
+		{
+			if (ArchiveFileIndex[a] != indexOfArchive)
+				continue;
+
+			const s32 found = FileArchives[a]->getFileList()->findFile(name, false);
+			if (found != -1)
+			{
+				fileIndex.emplace(name, SIndexedFile(FileArchives[a], (u32)found));
+				break;
+			}
+		}
+	}
+}
+
+
+//! Build the index of all archives again
+void CFileSystem::rebuildFileIndex()
+{
+	FileIndex[0].clear();
+	FileIndex[1].clear();
+	for (u32 i=0; i<FileArchives.size(); ++i)
+		indexFileArchive(i);
+}
+
+
+//! Look up a file in the index
+bool CFileSystem::findIndexedFile(const io::path& filename, SIndexedFile found[2]) const
+{
+	++FileLookups;
+
+	// same normalization as CFileList::findFile
+	io::path name(filename);
+	name.replace('\\', '/');
+	// folders are not in the index
+	if (name.lastChar() == '/')
+		return false;
+	name.make_lower();
+
+	bool hit = false;
+	std::unordered_map<io::path, SIndexedFile, SPathHash>::const_iterator it;
+	if (!FileIndex[0].empty())
+	{
+		it = FileIndex[0].find(name);
+		if (it != FileIndex[0].end())
+		{
+			found[0] = it->second;
+			hit = true;
+		}
+	}
+	if (!FileIndex[1].empty())
+	{
+		core::deletePathFromFilename(name);
+		it = FileIndex[1].find(name);
+		if (it != FileIndex[1].end())
+		{
+			found[1] = it->second;
+			hit = true;
+		}
+	}
+
+	if (hit)
+		++FileIndexHits;
+	return true;
+}
+
+
 //! Returns the string of the current working directory
 const io::path& CFileSystem::getWorkingDirectory()
 {
@@ -825,6 +1061,7 @@ EFileSystemType CFileSystem::setFileListSystem(EFileSystemType listType)
 //! Creates a list of files and directories in the current working directory
 IFileList* CFileSystem::createFileList()
 {
+	std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
 	CFileList* r = 0;
 	io::path Path = getWorkingDirectory();
 	Path.replace('\\', '/');
@@ -956,10 +1193,24 @@ IFileList* CFileSystem::createEmptyFileList(const io::path& path, bool ignoreCas
 //! determines if a file exists and would be able to be opened.
 bool CFileSystem::existFile(const io::path& filename) const
 {
-	for (u32 i=0; i < FileArchives.size(); ++i)
-		if (FileArchives[i]->getFileList()->findFile(filename)!=-1)
+	{
+		std::lock_guard<std::recursive_mutex> lock(ArchiveLock);
+
+		SIndexedFile found[2];
+		const bool walk = !findIndexedFile(filename, found);
+		if (found[0].Archive || found[1].Archive)
 			return true;
 
+		for (u32 i=0; i < FileArchives.size(); ++i)
+		{
+			if (ArchiveFileIndex[i] != -1 && !walk)
+				continue;
+			++ArchiveSearches;
+			if (FileArchives[i]->getFileList()->findFile(filename)!=-1)
+				return true;
+		}
+	}
+
 #if defined(_MSC_VER)
 	#if defined(_IRR_WCHAR_FILESYSTEM)
 		return (_waccess(filename.c_str(), 0) != -1);
@@ -7,6 +7,9 @@
 
 #include "IFileSystem.h"
 #include "irrArray.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 namespace irr
 {
@@ -39,6 +42,9 @@ public:
 	//! Creates an IReadFile interface for accessing files inside files
 	virtual IReadFile* createLimitReadFile(const io::path& fileName, IReadFile* alreadyOpenedFile, long pos, long areaSize) _IRR_OVERRIDE_;
 
+	//! Set from which size files are mapped into memory instead of read
+	virtual void setFileMappingThreshold(long size) _IRR_OVERRIDE_;
+
 	//! Creates an IWriteFile interface for accessing memory like a file.
 	virtual IWriteFile* createMemoryWriteFile(void* memory, s32 len, const io::path& fileName, bool deleteMemoryWhenDropped=false) _IRR_OVERRIDE_;
 
@@ -80,6 +86,9 @@ public:
 	//! gets an archive
 	virtual IFileArchive* getFileArchive(u32 index) _IRR_OVERRIDE_;
 
+	//! Get how often files were looked up in the archives
+	virtual SFileLookupCounts getFileLookupCounts() const _IRR_OVERRIDE_;
+
 	//! removes an archive from the file system.
 	virtual bool removeFileArchive(u32 index) _IRR_OVERRIDE_;
 
@@ -161,6 +170,46 @@ private:
 			const core::stringc& password,
 			IFileArchive** archive = 0);
 
+	//! A file of an indexed archive
+	struct SIndexedFile
+	{
+		SIndexedFile() : Archive(0), Index(0) {}
+		SIndexedFile(IFileArchive* archive, u32 index) : Archive(archive), Index(index) {}
+
+		IFileArchive* Archive;
+		//! Index in the file list of the archive
+		u32 Index;
+	};
+
+	struct SPathHash
+	{
+		size_t operator()(const io::path& path) const;
+	};
+
+	//! Get the index an archive created by a loader goes into
+	/** \return Index into FileIndex, -1 if the archive is searched by name. */
+	static s32 getFileIndexOf(const IFileArchive* archive, bool ignoreCase, bool ignorePaths);
+
+	//! Add an archive at the end of the search order
+	/** \param fileIndex Index into FileIndex for its files, -1 for none. */
+	void appendFileArchive(IFileArchive* archive, s32 fileIndex);
+
+	//! Add the files of an archive to the index, unless an archive before it has them
+	void indexFileArchive(u32 index);
+
+	//! Remove the files of an archive from the index
+	/** Files the archive hid come from the next archive which has them. */
+	void unindexFileArchive(u32 index);
+
+	//! Build the index of all archives again
+	void rebuildFileIndex();
+
+	//! Look up a file in the index
+	/** \param found The file in an archive which keeps its paths, and
+	in one which ignores them. Archive is 0 if there is none.
+	\return False if the name can not be looked up in the index. */
+	bool findIndexedFile(const io::path& filename, SIndexedFile found[2]) const;
+
 	//! Currently used FileSystemType
 	EFileSystemType FileSystemType;
 	//! WorkingDirectory for Native and Virtual filesystems
@@ -169,6 +218,23 @@ private:
 	core::array<IArchiveLoader*> ArchiveLoader;
 	//! currently attached Archives
 	core::array<IFileArchive*> FileArchives;
+	//! Files of at least this size are mapped into memory
+	long FileMappingThreshold;
+
+	//! Per archive in FileArchives, the index into FileIndex its files are in, -1 for none
+	core::array<s32> ArchiveFileIndex;
+	//! Lower case names of the files of the indexed archives, to the first archive which has them
+	/** FileIndex[1] holds the archives which ignore paths, with the
+	names of their files without path. */
+	std::unordered_map<io::path, SIndexedFile, SPathHash> FileIndex[2];
+
+	//! Held while FileArchives and the index are used or changed
+	/** Recursive, as loaders of archives open files. */
+	mutable std::recursive_mutex ArchiveLock;
+
+	mutable std::atomic<u32> FileLookups;
+	mutable std::atomic<u32> FileIndexHits;
+	mutable std::atomic<u32> ArchiveSearches;
 };
 
 
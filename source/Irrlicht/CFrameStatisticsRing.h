@@ -0,0 +1,114 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FRAME_STATISTICS_RING_H_INCLUDED__
+#define __C_FRAME_STATISTICS_RING_H_INCLUDED__
+
+#include "SFrameStatistics.h"
+#include <atomic>
+#include <string.h>
+
+namespace irr
+{
+
+//! The statistics of the last FRAME_STATISTICS_HISTORY frames
+/** Written by the render thread and read by any thread without locks.
+Each slot is a sequence lock: the writer makes the sequence odd while it
+copies, readers retry when the sequence was odd or changed while they
+copied. T has to be a struct of u32 starting with the frame number Frame,
+which tells readers that the slot was overwritten by a newer frame. */
+template <class T>
+class CFrameStatisticsRing
+{
+public:
+
+	CFrameStatisticsRing() : Published(0)
+	{
+		for (u32 i=0; i<FRAME_STATISTICS_HISTORY; ++i)
+		{
+			Slots[i].Sequence.store(0, std::memory_order_relaxed);
+			for (u32 j=0; j<WORD_COUNT; ++j)
+				Slots[i].Words[j].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	//! Add the statistics of the next frame, sets their frame number
+	/** Only one thread may publish. */
+	void publish(T& statistics)
+	{
+		const u32 published = Published.load(std::memory_order_relaxed);
+		statistics.Frame = published+1;
+
+		u32 words[WORD_COUNT];
+		memcpy(words, &statistics, sizeof(T));
+
+		SSlot& slot = Slots[published % FRAME_STATISTICS_HISTORY];
+		const u32 sequence = slot.Sequence.load(std::memory_order_relaxed);
+		slot.Sequence.store(sequence+1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (u32 i=0; i<WORD_COUNT; ++i)
+			slot.Words[i].store(words[i], std::memory_order_relaxed);
+		slot.Sequence.store(sequence+2, std::memory_order_release);
+
+		Published.store(published+1, std::memory_order_release);
+	}
+
+	//! Get the statistics of a past frame
+	/** \param framesAgo 0 for the last published frame.
+	\return False if the frame is not in the ring. */
+	bool get(T& statistics, u32 framesAgo) const
+	{
+		if (framesAgo >= FRAME_STATISTICS_HISTORY)
+			return false;
+
+		for (;;)
+		{
+			const u32 published = Published.load(std::memory_order_acquire);
+			if (framesAgo >= published)
+				return false;
+
+			const u32 frame = published-framesAgo;
+			const SSlot& slot = Slots[(frame-1) % FRAME_STATISTICS_HISTORY];
+			const u32 sequence = slot.Sequence.load(std::memory_order_acquire);
+			if (sequence & 1)
+				continue;
+
+			u32 words[WORD_COUNT];
+			for (u32 i=0; i<WORD_COUNT; ++i)
+				words[i] = slot.Words[i].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.Sequence.load(std::memory_order_relaxed) != sequence)
+				continue;
+
+			memcpy(&statistics, words, sizeof(T));
+			// the writer wrapped around while the slot was looked up,
+			// the frame asked for is gone
+			if (statistics.Frame != frame)
+				return false;
+			return true;
+		}
+	}
+
+	//! Amount of published frames
+	u32 getFrameCount() const
+	{
+		return Published.load(std::memory_order_acquire);
+	}
+
+private:
+
+	enum { WORD_COUNT = sizeof(T)/sizeof(u32) };
+
+	struct SSlot
+	{
+		std::atomic<u32> Sequence;
+		std::atomic<u32> Words[WORD_COUNT];
+	};
+
+	SSlot Slots[FRAME_STATISTICS_HISTORY];
+	std::atomic<u32> Published;
+};
+
+} // end namespace irr
+
+#endif
@@ -0,0 +1,256 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CFrustumCuller.h"
+#include "CWorkerPool.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define _IRR_CULLING_SSE_
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define _IRR_CULLING_NEON_
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	// Batches with fewer boxes are not worth waking the worker threads
+	const u32 CULLING_PARALLEL_MIN_BOXES = 16384;
+	const u32 CULLING_PARALLEL_MIN_GRAIN = 64;	// in words of 32 boxes
+}
+
+
+//! Runs cullWords() over a range of mask words
+class CFrustumCuller::CCullJob : public IWorkerJob
+{
+public:
+	CCullJob(CFrustumCuller& culler) : Culler(culler) {}
+
+	virtual void run(u32 begin, u32 end, u32 thread) _IRR_OVERRIDE_
+	{
+		Culler.cullWords(begin, end);
+	}
+
+private:
+	CFrustumCuller& Culler;
+};
+
+
+u32 CFrustumCuller::addBox(const core::aabbox3df& box, u32 tests)
+{
+	const u32 index = Count++;
+
+	// grow by whole words, so the kernels never need a tail loop
+	if ((index & 31) == 0)
+	{
+		for (u32 a=0; a<3; ++a)
+		{
+			MinEdge[a].set_used(index+32);
+			MaxEdge[a].set_used(index+32);
+		}
+		TestBox.push_back(0);
+		TestPlanes.push_back(0);
+	}
+
+	MinEdge[0][index] = box.MinEdge.X;
+	MinEdge[1][index] = box.MinEdge.Y;
+	MinEdge[2][index] = box.MinEdge.Z;
+	MaxEdge[0][index] = box.MaxEdge.X;
+	MaxEdge[1][index] = box.MaxEdge.Y;
+	MaxEdge[2][index] = box.MaxEdge.Z;
+
+	const u32 bit = 1u << (index & 31);
+	if (tests & EAC_BOX)
+		TestBox[index >> 5] |= bit;
+	if (tests & EAC_FRUSTUM_BOX)
+		TestPlanes[index >> 5] |= bit;
+
+	return index;
+}
+
+
+void CFrustumCuller::cull(const SViewFrustum& frustum)
+{
+	FrustumBox = frustum.getBoundingBox();
+	for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+		Planes[i] = frustum.planes[i];
+
+	const u32 words = TestBox.size();
+	Visible.set_used(words);
+	if (!words)
+		return;
+
+	if (Count >= CULLING_PARALLEL_MIN_BOXES)
+	{
+		CWorkerPool& pool = getWorkerPool();
+		CCullJob job(*this);
+		pool.parallelFor(job, words, core::max_(CULLING_PARALLEL_MIN_GRAIN, words/(pool.getThreadCount()*4)));
+	}
+	else
+		cullWords(0, words);
+
+	// padding boxes are never visible
+	if (Count & 31)
+		Visible[words-1] &= (1u << (Count & 31)) - 1;
+}
+
+
+void CFrustumCuller::cullWords(u32 begin, u32 end)
+{
+	// Per plane the box corner nearest to the inside decides, which is
+	// the min edge on axes where the normal is positive. The box is
+	// outside when even this corner is in front of the plane.
+	const f32* corner[SViewFrustum::VF_PLANE_COUNT][3];
+	for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+	{
+		const f32 normal[3] = { Planes[p].Normal.X, Planes[p].Normal.Y, Planes[p].Normal.Z };
+		for (u32 a=0; a<3; ++a)
+			corner[p][a] = normal[a] > 0.f ? MinEdge[a].const_pointer() : MaxEdge[a].const_pointer();
+	}
+
+	const f32* minX = MinEdge[0].const_pointer();
+	const f32* minY = MinEdge[1].const_pointer();
+	const f32* minZ = MinEdge[2].const_pointer();
+	const f32* maxX = MaxEdge[0].const_pointer();
+	const f32* maxY = MaxEdge[1].const_pointer();
+	const f32* maxZ = MaxEdge[2].const_pointer();
+
+#if defined(_IRR_CULLING_SSE_)
+	const __m128 boxMinX = _mm_set1_ps(FrustumBox.MinEdge.X);
+	const __m128 boxMinY = _mm_set1_ps(FrustumBox.MinEdge.Y);
+	const __m128 boxMinZ = _mm_set1_ps(FrustumBox.MinEdge.Z);
+	const __m128 boxMaxX = _mm_set1_ps(FrustumBox.MaxEdge.X);
+	const __m128 boxMaxY = _mm_set1_ps(FrustumBox.MaxEdge.Y);
+	const __m128 boxMaxZ = _mm_set1_ps(FrustumBox.MaxEdge.Z);
+	const __m128 epsilon = _mm_set1_ps(core::ROUNDING_ERROR_f32);
+	__m128 planeX[SViewFrustum::VF_PLANE_COUNT];
+	__m128 planeY[SViewFrustum::VF_PLANE_COUNT];
+	__m128 planeZ[SViewFrustum::VF_PLANE_COUNT];
+	__m128 planeD[SViewFrustum::VF_PLANE_COUNT];
+	for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+	{
+		planeX[p] = _mm_set1_ps(Planes[p].Normal.X);
+		planeY[p] = _mm_set1_ps(Planes[p].Normal.Y);
+		planeZ[p] = _mm_set1_ps(Planes[p].Normal.Z);
+		planeD[p] = _mm_set1_ps(Planes[p].D);
+	}
+#elif defined(_IRR_CULLING_NEON_)
+	const float32x4_t boxMinX = vdupq_n_f32(FrustumBox.MinEdge.X);
+	const float32x4_t boxMinY = vdupq_n_f32(FrustumBox.MinEdge.Y);
+	const float32x4_t boxMinZ = vdupq_n_f32(FrustumBox.MinEdge.Z);
+	const float32x4_t boxMaxX = vdupq_n_f32(FrustumBox.MaxEdge.X);
+	const float32x4_t boxMaxY = vdupq_n_f32(FrustumBox.MaxEdge.Y);
+	const float32x4_t boxMaxZ = vdupq_n_f32(FrustumBox.MaxEdge.Z);
+	const float32x4_t epsilon = vdupq_n_f32(core::ROUNDING_ERROR_f32);
+	const uint32x4_t laneBits = { 1, 2, 4, 8 };
+#endif
+
+	for (u32 w=begin; w<end; ++w)
+	{
+		u32 outsideBox = 0;
+		u32 outsidePlanes = 0;
+
+		for (u32 g=0; g<32; g+=4)
+		{
+			const u32 i = w*32 + g;
+
+#if defined(_IRR_CULLING_SSE_)
+			__m128 out = _mm_cmpgt_ps(_mm_loadu_ps(minX+i), boxMaxX);
+			out = _mm_or_ps(out, _mm_cmpgt_ps(_mm_loadu_ps(minY+i), boxMaxY));
+			out = _mm_or_ps(out, _mm_cmpgt_ps(_mm_loadu_ps(minZ+i), boxMaxZ));
+			out = _mm_or_ps(out, _mm_cmplt_ps(_mm_loadu_ps(maxX+i), boxMinX));
+			out = _mm_or_ps(out, _mm_cmplt_ps(_mm_loadu_ps(maxY+i), boxMinY));
+			out = _mm_or_ps(out, _mm_cmplt_ps(_mm_loadu_ps(maxZ+i), boxMinZ));
+			outsideBox |= (u32)_mm_movemask_ps(out) << g;
+
+			out = _mm_setzero_ps();
+			for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+			{
+				__m128 d = _mm_add_ps(_mm_mul_ps(planeX[p], _mm_loadu_ps(corner[p][0]+i)), planeD[p]);
+				d = _mm_add_ps(d, _mm_mul_ps(planeY[p], _mm_loadu_ps(corner[p][1]+i)));
+				d = _mm_add_ps(d, _mm_mul_ps(planeZ[p], _mm_loadu_ps(corner[p][2]+i)));
+				out = _mm_or_ps(out, _mm_cmpgt_ps(d, epsilon));
+			}
+			outsidePlanes |= (u32)_mm_movemask_ps(out) << g;
+#elif defined(_IRR_CULLING_NEON_)
+			uint32x4_t out = vcgtq_f32(vld1q_f32(minX+i), boxMaxX);
+			out = vorrq_u32(out, vcgtq_f32(vld1q_f32(minY+i), boxMaxY));
+			out = vorrq_u32(out, vcgtq_f32(vld1q_f32(minZ+i), boxMaxZ));
+			out = vorrq_u32(out, vcltq_f32(vld1q_f32(maxX+i), boxMinX));
+			out = vorrq_u32(out, vcltq_f32(vld1q_f32(maxY+i), boxMinY));
+			out = vorrq_u32(out, vcltq_f32(vld1q_f32(maxZ+i), boxMinZ));
+			uint32x4_t bits = vandq_u32(out, laneBits);
+			outsideBox |= (vgetq_lane_u32(bits, 0) | vgetq_lane_u32(bits, 1)
+				| vgetq_lane_u32(bits, 2) | vgetq_lane_u32(bits, 3)) << g;
+
+			out = vdupq_n_u32(0);
+			for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+			{
+				float32x4_t d = vmlaq_n_f32(vdupq_n_f32(Planes[p].D), vld1q_f32(corner[p][0]+i), Planes[p].Normal.X);
+				d = vmlaq_n_f32(d, vld1q_f32(corner[p][1]+i), Planes[p].Normal.Y);
+				d = vmlaq_n_f32(d, vld1q_f32(corner[p][2]+i), Planes[p].Normal.Z);
+				out = vorrq_u32(out, vcgtq_f32(d, epsilon));
+			}
+			bits = vandq_u32(out, laneBits);
+			outsidePlanes |= (vgetq_lane_u32(bits, 0) | vgetq_lane_u32(bits, 1)
+				| vgetq_lane_u32(bits, 2) | vgetq_lane_u32(bits, 3)) << g;
+#else
+			for (u32 k=i; k<i+4; ++k)
+			{
+				const u32 box = (minX[k] > FrustumBox.MaxEdge.X) | (minY[k] > FrustumBox.MaxEdge.Y) | (minZ[k] > FrustumBox.MaxEdge.Z)
+					| (maxX[k] < FrustumBox.MinEdge.X) | (maxY[k] < FrustumBox.MinEdge.Y) | (maxZ[k] < FrustumBox.MinEdge.Z);
+
+				u32 planes = 0;
+				for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+				{
+					const f32 d = Planes[p].Normal.X*corner[p][0][k] + Planes[p].Normal.Y*corner[p][1][k]
+						+ Planes[p].Normal.Z*corner[p][2][k] + Planes[p].D;
+					planes |= (d > core::ROUNDING_ERROR_f32);
+				}
+
+				outsideBox |= box << (k & 31);
+				outsidePlanes |= planes << (k & 31);
+			}
+#endif
+		}
+
+		Visible[w] = ~((outsideBox & TestBox[w]) | (outsidePlanes & TestPlanes[w]));
+	}
+}
+
+
+void CFrustumCuller::clear()
+{
+	for (u32 a=0; a<3; ++a)
+	{
+		MinEdge[a].set_used(0);
+		MaxEdge[a].set_used(0);
+	}
+	TestBox.set_used(0);
+	TestPlanes.set_used(0);
+	Visible.set_used(0);
+	Count = 0;
+}
+
+
+void CFrustumCuller::reset()
+{
+	for (u32 a=0; a<3; ++a)
+	{
+		MinEdge[a].clear();
+		MaxEdge[a].clear();
+	}
+	TestBox.clear();
+	TestPlanes.clear();
+	Visible.clear();
+	Count = 0;
+}
+
+
+} // end namespace scene
+} // end namespace irr
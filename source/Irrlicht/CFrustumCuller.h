@@ -0,0 +1,88 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FRUSTUM_CULLER_H_INCLUDED__
+#define __C_FRUSTUM_CULLER_H_INCLUDED__
+
+#include "irrArray.h"
+#include "aabbox3d.h"
+#include "SViewFrustum.h"
+#include "ECullingTypes.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Tests many world space boxes against a view frustum at once
+/** The boxes are kept as structure of arrays, so the tests run on 4
+boxes at a time with SSE or NEON. Large batches are split over the
+worker pool. The result is a bitmask with one bit per box. */
+class CFrustumCuller
+{
+public:
+
+	CFrustumCuller() : Count(0) {}
+
+	//! Add a box in world space
+	/** \param box Box to test.
+	\param tests Or'ed E_CULLING_TYPE values. EAC_BOX tests the box
+	against the bounding box of the frustum, EAC_FRUSTUM_BOX against
+	the frustum planes. Boxes without either are always visible.
+	\return Index of the box. */
+	u32 addBox(const core::aabbox3df& box, u32 tests);
+
+	//! Test all boxes against the frustum
+	void cull(const SViewFrustum& frustum);
+
+	//! Check if a box is visible after cull()
+	bool isVisible(u32 index) const
+	{
+		return (Visible[index >> 5] >> (index & 31)) & 1;
+	}
+
+	//! Get the visibility bitmask, bit i of word i/32 is set when box i is visible
+	const u32* getVisibilityMask() const
+	{
+		return Visible.const_pointer();
+	}
+
+	//! Amount of boxes
+	u32 size() const
+	{
+		return Count;
+	}
+
+	//! Remove all boxes, but keep the memory
+	void clear();
+
+	//! Remove all boxes and free the memory
+	void reset();
+
+private:
+
+	class CCullJob;
+
+	//! Test the boxes of the 32 bit mask words [begin, end)
+	void cullWords(u32 begin, u32 end);
+
+	// min and max corners per axis, padded to a multiple of 32 boxes
+	core::array<f32> MinEdge[3];
+	core::array<f32> MaxEdge[3];
+
+	// one bit per box
+	core::array<u32> TestBox;
+	core::array<u32> TestPlanes;
+	core::array<u32> Visible;
+
+	// frustum of the current cull()
+	core::aabbox3df FrustumBox;
+	core::plane3df Planes[SViewFrustum::VF_PLANE_COUNT];
+
+	u32 Count;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -35,6 +35,14 @@ CGUIProfiler::CGUIProfiler(IGUIEnvironment* environment, IGUIElement* parent, s3
 	rebuildColumns();
 }
 
+//! Milliseconds with three decimals, so short calls don't show as 0
+core::stringw CGUIProfiler::formatTime(u64 nanoseconds) const
+{
+	c8 buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.3f", nanoseconds / 1000000.0);
+	return core::stringw(buffer);
+}
+
 void CGUIProfiler::fillRow(u32 rowIndex, const SProfileData& data, bool overviewTitle, bool groupTitle)
 {
 	DisplayTable->setCellText(rowIndex, 0, data.getName());
@@ -43,9 +51,9 @@ void CGUIProfiler::fillRow(u32 rowIndex, const SProfileData& data, bool overview
 		DisplayTable->setCellText(rowIndex, 1, core::stringw(data.getCallsCounter()));
 	if ( data.getCallsCounter() > 0 )
 	{
-		DisplayTable->setCellText(rowIndex, 2, core::stringw(data.getTimeSum()));
-		DisplayTable->setCellText(rowIndex, 3, core::stringw((u32)((f32)data.getTimeSum()/(f32)data.getCallsCounter())));
-		DisplayTable->setCellText(rowIndex, 4, core::stringw(data.getLongestTime()));
+		DisplayTable->setCellText(rowIndex, 2, formatTime(data.getTimeSumNs()));
+		DisplayTable->setCellText(rowIndex, 3, formatTime(data.getTimeSumNs()/data.getCallsCounter()));
+		DisplayTable->setCellText(rowIndex, 4, formatTime(data.getLongestTimeNs()));
 	}
 
 	if ( overviewTitle || groupTitle )
@@ -62,9 +70,9 @@ void CGUIProfiler::rebuildColumns()
 		DisplayTable->clear();
 		DisplayTable->addColumn(L"name           ");
 		DisplayTable->addColumn(L"count calls");
-		DisplayTable->addColumn(L"time(sum)");
-		DisplayTable->addColumn(L"time(avg)");
-		DisplayTable->addColumn(L"time(max)      ");
+		DisplayTable->addColumn(L"ms(sum)");
+		DisplayTable->addColumn(L"ms(avg)");
+		DisplayTable->addColumn(L"ms(max)        ");
 		DisplayTable->setActiveColumn(-1);
 	}
 }
@@ -92,6 +100,7 @@ void CGUIProfiler::updateDisplay()
 	if ( DisplayTable )
 	{
 		DisplayTable->clearRows();
+		Profiler->collectThreadData();
 
 		if ( CurrentGroupIdx < Profiler->getGroupCount() )
 		{
@@ -78,6 +78,7 @@ namespace gui
 
 		void updateDisplay();
 		void fillRow(u32 rowIndex, const SProfileData& data, bool overviewTitle, bool groupTitle);
+		core::stringw formatTime(u64 nanoseconds) const;
 		u32 addDataToTable(u32 rowIndex, u32 dataIndex, u32 groupIndex);
 		void rebuildColumns();
 
@@ -12,6 +12,7 @@
 
 #include "CImage.h"
 #include "CReadFile.h"
+#include "CMappedReadFile.h"
 #include "os.h"
 
 namespace irr
@@ -47,6 +48,26 @@ void PNGAPI user_read_data_fcn(png_structp png_ptr, png_bytep data, png_size_t l
 }
 
 
+//! A file in memory, read without the IReadFile
+struct SPngMemory
+{
+	const u8* Data;
+	long Size;
+	long Pos;
+};
+
+// PNG function for reading files in memory
+void PNGAPI user_read_memory_fcn(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+	SPngMemory* memory = (SPngMemory*)png_get_io_ptr(png_ptr);
+	if ((png_size_t)(memory->Size - memory->Pos) < length)
+		png_error(png_ptr, "Read Error");
+
+	memcpy(data, memory->Data + memory->Pos, length);
+	memory->Pos += (long)length;
+}
+
+
 //! returns true if the file maybe is able to be loaded by this class
 //! based on the file extension (e.g. ".tga")
 bool CImageLoaderPng::isALoadableFileExtension(const io::path& filename) const
@@ -113,6 +134,9 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 		return 0;
 	}
 
+	// files mapped into memory are decoded straight from the mapping
+	SPngMemory memory = { io::getReadFileMemory(file), file->getSize(), file->getPos() };
+
 	// for proper error handling
 	if (setjmp(png_jmpbuf(png_ptr)))
 	{
@@ -121,8 +145,13 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 		return 0;
 	}
 
-	// changed by zola so we don't need to have public FILE pointers
-	png_set_read_fn(png_ptr, file, user_read_data_fcn);
+	if (memory.Data)
+		png_set_read_fn(png_ptr, &memory, user_read_memory_fcn);
+	else
+	{
+		// changed by zola so we don't need to have public FILE pointers
+		png_set_read_fn(png_ptr, file, user_read_data_fcn);
+	}
 
 	png_set_sig_bytes(png_ptr, 8); // Tell png that we read the signature
 
@@ -249,6 +278,8 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 	png_read_image(png_ptr, RowPointers);
 
 	png_read_end(png_ptr, NULL);
+	if (memory.Data)
+		file->seek(memory.Pos);
 	delete [] RowPointers;
 	png_destroy_read_struct(&png_ptr,&info_ptr, 0); // Clean up memory
 
@@ -0,0 +1,222 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInflateReadFile.h"
+
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+
+#include "CMappedReadFile.h"
+#include "CReadFile.h"
+#include "os.h"
+
+#ifndef _IRR_USE_NON_SYSTEM_ZLIB_
+#include <zlib.h> // use system lib
+#else
+#include "zlib/zlib.h"
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+namespace
+{
+	//! Compressed bytes read from the archive at once
+	const u32 INFLATE_INPUT_SIZE = 16384;
+}
+
+
+CInflateReadFile::CInflateReadFile(IReadFile* alreadyOpenedFile, long pos, long compressedSize,
+		long uncompressedSize, u32 windowSize, const io::path& name)
+	: Filename(name), File(alreadyOpenedFile), DataStart(pos),
+	CompressedSize(compressedSize), UncompressedSize(uncompressedSize), Pos(0),
+	Stream(0), CompressedRead(0), Input(0), Memory(0), Window(0),
+	WindowSize(core::max_(windowSize, 1024u)), WindowStart(0), WindowFill(0), Failed(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CInflateReadFile");
+	#endif
+
+	File->grab();
+
+	// a file in memory is inflated in place
+	Memory = getReadFileMemory(File);
+	if (Memory && DataStart + CompressedSize <= File->getSize())
+		Memory += DataStart;
+	else
+	{
+		Memory = 0;
+		Input = new u8[INFLATE_INPUT_SIZE];
+	}
+	Window = new u8[WindowSize];
+
+	Stream = new z_stream;
+	Stream->next_in = 0;
+	Stream->avail_in = 0;
+	Stream->zalloc = (alloc_func)0;
+	Stream->zfree = (free_func)0;
+	Stream->opaque = 0;
+
+	// wbits < 0 indicates no zlib header inside the data.
+	if (inflateInit2(Stream, -MAX_WBITS) != Z_OK)
+	{
+		os::Printer::log("Could not start decompressing", Filename, ELL_ERROR);
+		delete Stream;
+		Stream = 0;
+		Failed = true;
+	}
+}
+
+
+CInflateReadFile::~CInflateReadFile()
+{
+	if (Stream)
+	{
+		inflateEnd(Stream);
+		delete Stream;
+	}
+
+	delete [] Window;
+	delete [] Input;
+
+	File->drop();
+}
+
+
+//! returns how much was read
+size_t CInflateReadFile::read(void* buffer, size_t sizeToRead)
+{
+	u8* out = (u8*)buffer;
+	size_t done = 0;
+
+	while (done < sizeToRead && Pos < UncompressedSize)
+	{
+		if (Pos < WindowStart)
+			restart();
+
+		if (Pos >= WindowStart + (long)WindowFill)
+		{
+			if (!fillWindow())
+				break;
+			continue;
+		}
+
+		const u32 offset = (u32)(Pos - WindowStart);
+		const size_t amount = core::min_((size_t)(WindowFill - offset), sizeToRead - done);
+		memcpy(out + done, Window + offset, amount);
+		done += amount;
+		Pos += (long)amount;
+	}
+
+	return done;
+}
+
+
+//! changes position in file, returns true if successful
+bool CInflateReadFile::seek(long finalPos, bool relativeMovement)
+{
+	// only moves the position, data is inflated when it is read
+	const long pos = relativeMovement ? Pos + finalPos : finalPos;
+	if (pos < 0 || pos > UncompressedSize)
+		return false;
+
+	Pos = pos;
+	return true;
+}
+
+
+//! returns size of file
+long CInflateReadFile::getSize() const
+{
+	return UncompressedSize;
+}
+
+
+//! returns where in the file we are.
+long CInflateReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CInflateReadFile::getFileName() const
+{
+	return Filename;
+}
+
+
+//! Inflate the data after the window into the window
+bool CInflateReadFile::fillWindow()
+{
+	if (Failed)
+		return false;
+
+	WindowStart += WindowFill;
+	WindowFill = 0;
+
+	Stream->next_out = Window;
+	Stream->avail_out = WindowSize;
+
+	while (Stream->avail_out)
+	{
+		if (!Stream->avail_in && CompressedRead < CompressedSize && Memory)
+		{
+			Stream->next_in = (Bytef*)(Memory + CompressedRead);
+			Stream->avail_in = (uInt)(CompressedSize - CompressedRead);
+			CompressedRead = CompressedSize;
+		}
+		else if (!Stream->avail_in && CompressedRead < CompressedSize)
+		{
+			const u32 amount = (u32)core::min_(CompressedSize - CompressedRead, (long)INFLATE_INPUT_SIZE);
+			// the archive file is shared with the other files opened from it
+			if (readFileAt(File, DataStart + CompressedRead, Input, amount) != amount)
+			{
+				os::Printer::log("Could not read compressed data", Filename, ELL_ERROR);
+				Failed = true;
+				break;
+			}
+
+			CompressedRead += amount;
+			Stream->next_in = Input;
+			Stream->avail_in = amount;
+		}
+
+		const int err = inflate(Stream, Z_NO_FLUSH);
+		if (err == Z_STREAM_END)
+			break;
+		if (err != Z_OK)
+		{
+			// Z_BUF_ERROR: the compressed data ended before the file did
+			os::Printer::log("Error decompressing", Filename, ELL_ERROR);
+			Failed = true;
+			break;
+		}
+	}
+
+	WindowFill = WindowSize - Stream->avail_out;
+	return WindowFill != 0;
+}
+
+
+//! Start inflating from the beginning of the data again
+void CInflateReadFile::restart()
+{
+	if (Stream)
+	{
+		inflateReset(Stream);
+		Stream->next_in = 0;
+		Stream->avail_in = 0;
+	}
+
+	CompressedRead = 0;
+	WindowStart = 0;
+	WindowFill = 0;
+}
+
+
+} // end namespace io
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_ZLIB_
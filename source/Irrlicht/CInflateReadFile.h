@@ -0,0 +1,98 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INFLATE_READ_FILE_H_INCLUDED__
+#define __C_INFLATE_READ_FILE_H_INCLUDED__
+
+#include "IReadFile.h"
+#include "irrString.h"
+
+struct z_stream_s;
+
+namespace irr
+{
+namespace io
+{
+
+	/*! A read file which inflates deflate compressed data of another file
+		while it is read. Only a window of the uncompressed data is kept,
+		reading forward inflates the next part into it. Seeking back before
+		the window inflates again from the start.
+		Used for large compressed files in zip archives.
+	!*/
+	class CInflateReadFile : public IReadFile
+	{
+	public:
+
+		//! Constructor
+		/** \param alreadyOpenedFile File with the compressed data, grabbed.
+		\param pos Start of the compressed data in alreadyOpenedFile.
+		\param compressedSize Size of the compressed data.
+		\param uncompressedSize Size of the inflated data.
+		\param windowSize Bytes of inflated data kept. */
+		CInflateReadFile(IReadFile* alreadyOpenedFile, long pos, long compressedSize,
+			long uncompressedSize, u32 windowSize, const io::path& name);
+
+		virtual ~CInflateReadFile();
+
+		//! returns how much was read
+		virtual size_t read(void* buffer, size_t sizeToRead) _IRR_OVERRIDE_;
+
+		//! changes position in file, returns true if successful
+		//! if relativeMovement==true, the pos is changed relative to current pos,
+		//! otherwise from begin of file
+		virtual bool seek(long finalPos, bool relativeMovement = false) _IRR_OVERRIDE_;
+
+		//! returns size of file
+		virtual long getSize() const _IRR_OVERRIDE_;
+
+		//! returns where in the file we are.
+		virtual long getPos() const _IRR_OVERRIDE_;
+
+		//! returns name of file
+		virtual const io::path& getFileName() const _IRR_OVERRIDE_;
+
+		//! Get the type of the class implementing this interface
+		virtual EREAD_FILE_TYPE getType() const _IRR_OVERRIDE_
+		{
+			return ERFT_INFLATE_READ_FILE;
+		}
+
+	private:
+
+		//! Inflate the data after the window into the window
+		/** \return False if there is no more data. */
+		bool fillWindow();
+
+		//! Start inflating from the beginning of the data again
+		void restart();
+
+		io::path Filename;
+		IReadFile* File;
+		long DataStart;
+		long CompressedSize;
+		long UncompressedSize;
+		long Pos;
+
+		z_stream_s* Stream;
+		//! Compressed bytes read from File
+		long CompressedRead;
+		//! Buffer for the compressed data, 0 when File is in memory
+		u8* Input;
+		//! The compressed data when File is in memory
+		const u8* Memory;
+
+		//! Inflated bytes [WindowStart, WindowStart+WindowFill) of the file
+		u8* Window;
+		u32 WindowSize;
+		long WindowStart;
+		u32 WindowFill;
+
+		//! Set when the data is corrupt, reading stops there
+		bool Failed;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -0,0 +1,369 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInstancedMeshSceneNode.h"
+#include "IMesh.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "IVideoDriver.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+CInstancedMeshSceneNode::CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+		const core::vector3df& position, const core::vector3df& rotation, const core::vector3df& scale)
+: IInstancedMeshSceneNode(parent, mgr, id, position, rotation, scale), Mesh(0),
+	BoxDirty(true), CulledTests(0), CullerDirty(true), DrawnInstances(0), DrawnInstanceCount(0), DrawCalls(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CInstancedMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CInstancedMeshSceneNode::~CInstancedMeshSceneNode()
+{
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! frame
+void CInstancedMeshSceneNode::OnRegisterSceneNode()
+{
+	DrawCalls = 0;
+	DrawnInstances = 0;
+	DrawnInstanceCount = 0;
+
+	if (!IsVisible || !Mesh || Instances.empty())
+		return;
+
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (camera && AutomaticCullingState != EAC_OFF)
+	{
+		// instances are tested with their boxes, also for sphere culling
+		u32 tests = AutomaticCullingState & (EAC_BOX | EAC_FRUSTUM_BOX);
+		if (AutomaticCullingState & EAC_FRUSTUM_SPHERE)
+			tests |= EAC_FRUSTUM_BOX;
+
+		if (CullerDirty || tests != CulledTests || CulledTransformation != AbsoluteTransformation)
+			updateInstanceBoxes(tests);
+
+		Culler.cull(*camera->getViewFrustum());
+		collectVisibleInstances();
+	}
+	else
+	{
+		DrawnInstances = Instances.const_pointer();
+		DrawnInstanceCount = Instances.size();
+	}
+
+	if (!DrawnInstanceCount)
+		return;
+
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	bool solid = DebugDataVisible != 0;
+	bool transparent = false;
+	for (u32 i=0; i<Materials.size(); ++i)
+	{
+		if (driver->needsTransparentRenderPass(Materials[i]))
+			transparent = true;
+		else
+			solid = true;
+	}
+
+	if (solid)
+		SceneManager->registerNodeForRendering(this, ESNRP_SOLID);
+	if (transparent)
+		SceneManager->registerNodeForRendering(this, ESNRP_TRANSPARENT);
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+
+//! renders the node.
+void CInstancedMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!Mesh || !DrawnInstanceCount)
+		return;
+
+	const bool isTransparentPass = SceneManager->getSceneNodeRenderPass() == ESNRP_TRANSPARENT;
+
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+	driver->setInstanceData(DrawnInstances, DrawnInstanceCount);
+
+	for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+		if (!mb || driver->needsTransparentRenderPass(Materials[i]) != isTransparentPass)
+			continue;
+
+		driver->setMaterial(Materials[i]);
+		driver->drawMeshBuffer(mb);
+		++DrawCalls;
+	}
+
+	driver->setInstanceData(0, 0);
+
+	// for debug purposes only:
+	if (DebugDataVisible && !isTransparentPass)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & EDS_BBOX)
+			driver->draw3DBox(getBoundingBox(), video::SColor(255,255,255,255));
+		if (DebugDataVisible & EDS_BBOX_BUFFERS)
+		{
+			// the boxes of the drawn instances
+			for (u32 i=0; i<DrawnInstanceCount; ++i)
+			{
+				driver->setTransform(video::ETS_WORLD, AbsoluteTransformation * DrawnInstances[i].Transformation);
+				driver->draw3DBox(Mesh->getBoundingBox(), video::SColor(255,190,128,128));
+			}
+		}
+	}
+}
+
+
+//! returns the axis aligned bounding box of all instances
+const core::aabbox3d<f32>& CInstancedMeshSceneNode::getBoundingBox() const
+{
+	if (BoxDirty)
+	{
+		Box.reset(0.f, 0.f, 0.f);
+		if (Mesh)
+		{
+			for (u32 i=0; i<Instances.size(); ++i)
+			{
+				core::aabbox3df box = Mesh->getBoundingBox();
+				Instances[i].Transformation.transformBoxEx(box);
+				if (i == 0)
+					Box = box;
+				else
+					Box.addInternalBox(box);
+			}
+		}
+		BoxDirty = false;
+	}
+	return Box;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CInstancedMeshSceneNode::getMaterial(u32 i)
+{
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CInstancedMeshSceneNode::getMaterialCount() const
+{
+	return Materials.size();
+}
+
+
+//! Sets a new mesh to draw for every instance
+void CInstancedMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+		mesh->grab();
+	if (Mesh)
+		Mesh->drop();
+	Mesh = mesh;
+
+	Materials.set_used(0);
+	if (Mesh)
+	{
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			const IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			Materials.push_back(mb ? mb->getMaterial() : video::SMaterial());
+		}
+	}
+
+	BoxDirty = true;
+	CullerDirty = true;
+}
+
+
+//! Get the mesh drawn for every instance
+IMesh* CInstancedMeshSceneNode::getMesh()
+{
+	return Mesh;
+}
+
+
+//! Adds an instance
+u32 CInstancedMeshSceneNode::addInstance(const video::S3DInstance& instance)
+{
+	Instances.push_back(instance);
+	BoxDirty = true;
+	CullerDirty = true;
+	return Instances.size()-1;
+}
+
+
+//! Replaces all instances
+void CInstancedMeshSceneNode::setInstances(const video::S3DInstance* instances, u32 count)
+{
+	Instances.set_used(0);
+	Instances.reallocate(count);
+	for (u32 i=0; i<count; ++i)
+		Instances.push_back(instances[i]);
+	BoxDirty = true;
+	CullerDirty = true;
+}
+
+
+//! Changes an instance
+void CInstancedMeshSceneNode::setInstance(u32 index, const video::S3DInstance& instance)
+{
+	if (index >= Instances.size())
+		return;
+
+	Instances[index] = instance;
+	BoxDirty = true;
+	CullerDirty = true;
+}
+
+
+//! Get an instance
+const video::S3DInstance& CInstancedMeshSceneNode::getInstance(u32 index) const
+{
+	return Instances[index];
+}
+
+
+//! Removes an instance
+void CInstancedMeshSceneNode::removeInstance(u32 index)
+{
+	if (index >= Instances.size())
+		return;
+
+	const u32 last = Instances.size()-1;
+	if (index != last)
+		Instances[index] = Instances[last];
+	Instances.erase(last);
+	BoxDirty = true;
+	CullerDirty = true;
+}
+
+
+//! Removes all instances
+void CInstancedMeshSceneNode::clearInstances()
+{
+	Instances.clear();
+	VisibleInstances.clear();
+	Culler.reset();
+	BoxDirty = true;
+	CullerDirty = true;
+}
+
+
+//! Get the amount of instances
+u32 CInstancedMeshSceneNode::getInstanceCount() const
+{
+	return Instances.size();
+}
+
+
+//! Get the amount of instances which were not culled in the last frame
+u32 CInstancedMeshSceneNode::getVisibleInstanceCount() const
+{
+	return DrawnInstanceCount;
+}
+
+
+//! Get the amount of mesh buffers drawn in the last frame
+u32 CInstancedMeshSceneNode::getDrawCallCount() const
+{
+	return DrawCalls;
+}
+
+
+void CInstancedMeshSceneNode::updateInstanceBoxes(u32 tests)
+{
+	Culler.clear();
+	const core::aabbox3df& meshBox = Mesh->getBoundingBox();
+	for (u32 i=0; i<Instances.size(); ++i)
+	{
+		core::aabbox3df box = meshBox;
+		(AbsoluteTransformation * Instances[i].Transformation).transformBoxEx(box);
+		Culler.addBox(box, tests);
+	}
+	CulledTransformation = AbsoluteTransformation;
+	CulledTests = tests;
+	CullerDirty = false;
+}
+
+
+void CInstancedMeshSceneNode::collectVisibleInstances()
+{
+	const u32 count = Instances.size();
+	const u32* mask = Culler.getVisibilityMask();
+
+	// padding bits of the mask are never set
+	VisibleInstances.set_used(count);
+	u32 visible = 0;
+	for (u32 first=0; first<count; first+=32)
+	{
+		u32 bits = mask[first >> 5];
+		for (u32 i=first; bits; ++i, bits >>= 1)
+		{
+			if (bits & 1)
+				VisibleInstances[visible++] = Instances[i];
+		}
+	}
+
+	if (visible == count)
+	{
+		DrawnInstances = Instances.const_pointer();
+		DrawnInstanceCount = count;
+	}
+	else
+	{
+		VisibleInstances.set_used(visible);
+		DrawnInstances = VisibleInstances.const_pointer();
+		DrawnInstanceCount = visible;
+	}
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CInstancedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CInstancedMeshSceneNode* nb = new CInstancedMeshSceneNode(Mesh, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->Materials = Materials;
+	nb->Instances = Instances;
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
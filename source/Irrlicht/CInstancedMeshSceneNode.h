@@ -0,0 +1,114 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IInstancedMeshSceneNode.h"
+#include "CFrustumCuller.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	class CInstancedMeshSceneNode : public IInstancedMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CInstancedMeshSceneNode();
+
+		//! frame
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! returns the axis aligned bounding box of all instances
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		//! Returns if OnAnimate() of this node only changes the node and its children
+		virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
+		//! Sets a new mesh to draw for every instance
+		virtual void setMesh(IMesh* mesh) _IRR_OVERRIDE_;
+
+		//! Get the mesh drawn for every instance
+		virtual IMesh* getMesh() _IRR_OVERRIDE_;
+
+		//! Adds an instance
+		virtual u32 addInstance(const video::S3DInstance& instance) _IRR_OVERRIDE_;
+
+		//! Replaces all instances
+		virtual void setInstances(const video::S3DInstance* instances, u32 count) _IRR_OVERRIDE_;
+
+		//! Changes an instance
+		virtual void setInstance(u32 index, const video::S3DInstance& instance) _IRR_OVERRIDE_;
+
+		//! Get an instance
+		virtual const video::S3DInstance& getInstance(u32 index) const _IRR_OVERRIDE_;
+
+		//! Removes an instance
+		virtual void removeInstance(u32 index) _IRR_OVERRIDE_;
+
+		//! Removes all instances
+		virtual void clearInstances() _IRR_OVERRIDE_;
+
+		//! Get the amount of instances
+		virtual u32 getInstanceCount() const _IRR_OVERRIDE_;
+
+		//! Get the amount of instances which were not culled in the last frame
+		virtual u32 getVisibleInstanceCount() const _IRR_OVERRIDE_;
+
+		//! Get the amount of mesh buffers drawn in the last frame
+		virtual u32 getDrawCallCount() const _IRR_OVERRIDE_;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
+
+	private:
+
+		//! Fill the culler with the boxes of the instances in world space
+		void updateInstanceBoxes(u32 tests);
+
+		//! Collect the instances with a visible box
+		void collectVisibleInstances();
+
+		IMesh* Mesh;
+		core::array<video::SMaterial> Materials;
+		core::array<video::S3DInstance> Instances;
+
+		//! Box of all instances, rebuilt after instances changed
+		mutable core::aabbox3df Box;
+		mutable bool BoxDirty;
+
+		CFrustumCuller Culler;
+		core::matrix4 CulledTransformation;
+		u32 CulledTests;
+		bool CullerDirty;
+
+		//! Instances drawn in this frame, either Instances or VisibleInstances
+		const video::S3DInstance* DrawnInstances;
+		u32 DrawnInstanceCount;
+		core::array<video::S3DInstance> VisibleInstances;
+
+		u32 DrawCalls;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -98,6 +98,7 @@ void CIrrDeviceStub::createGUIAndScene()
 
 	// create Scene manager
 	SceneManager = scene::createSceneManager(VideoDriver, FileSystem, CursorControl, GUIEnvironment);
+	SceneManager->setParallelAnimation(CreationParams.ParallelAnimation);
 
 	setEventReceiver(UserReceiver);
 }
@@ -83,6 +83,7 @@ void CLightSceneNode::render()
 void CLightSceneNode::setLightData(const video::SLight& light)
 {
 	LightData = light;
+	setTransformationDirty();
 }
 
 
@@ -96,6 +97,9 @@ const video::SLight& CLightSceneNode::getLightData() const
 //! \return Returns the light data.
 video::SLight& CLightSceneNode::getLightData()
 {
+	// the caller may change the light, which is recalculated
+	// together with the absolute transformation
+	setTransformationDirty();
 	return LightData;
 }
 
@@ -147,6 +151,7 @@ f32 CLightSceneNode::getRadius() const
 void CLightSceneNode::setLightType(video::E_LIGHT_TYPE type)
 {
 	LightData.Type=type;
+	setTransformationDirty();
 }
 
 
@@ -49,6 +49,9 @@ public:
 	//! Returns type of the scene node
 	virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_LIGHT; }
 
+	//! Returns if OnAnimate() of this node only changes the node and its children
+	virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
 	//! Writes attributes of the scene node.
 	virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const _IRR_OVERRIDE_;
 
@@ -3,6 +3,8 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CLimitReadFile.h"
+#include "CMappedReadFile.h"
+#include "CReadFile.h"
 #include "irrString.h"
 
 namespace irr
@@ -47,8 +49,8 @@ size_t CLimitReadFile::read(void* buffer, size_t sizeToRead)
 	long toRead = core::min_(AreaEnd, r + (long)sizeToRead) - core::max_(AreaStart, r);
 	if (toRead < 0)
 		return 0;
-	File->seek(r);
-	r = (long)File->read(buffer, toRead);
+	// the file is shared with the other files opened from an archive
+	r = (long)readFileAt(File, r, buffer, toRead);
 	Pos += r;
 	return r;
 #else
@@ -118,6 +120,14 @@ const io::path& CLimitReadFile::getFileName() const
 
 IReadFile* createLimitReadFile(const io::path& fileName, IReadFile* alreadyOpenedFile, long pos, long areaSize)
 {
+	// parts of files in memory need no copy
+	if (getReadFileMemory(alreadyOpenedFile))
+	{
+		IReadFile* view = CMappedReadFile::createView(static_cast<IMemoryReadFile*>(alreadyOpenedFile), pos, areaSize, fileName);
+		if (view)
+			return view;
+	}
+
 	return new CLimitReadFile(alreadyOpenedFile, pos, areaSize, fileName);
 }
 
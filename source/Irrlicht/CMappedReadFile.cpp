@@ -0,0 +1,141 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMappedReadFile.h"
+
+#if !defined(_IRR_WINDOWS_API_) && !defined(_IRR_WCHAR_FILESYSTEM)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define _IRR_MAP_FILES_
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+
+CMappedReadFile::CMappedReadFile(const u8* data, long len, const io::path& fileName,
+		IReadFile* parent, void* mapping, size_t mappingSize)
+	: Data(data), Len(len), Pos(0), Filename(fileName), Parent(parent),
+	Mapping(mapping), MappingSize(mappingSize)
+{
+	#ifdef _DEBUG
+	setDebugName("CMappedReadFile");
+	#endif
+
+	if (Parent)
+		Parent->grab();
+}
+
+
+CMappedReadFile::~CMappedReadFile()
+{
+	if (Parent)
+		Parent->drop();
+
+#ifdef _IRR_MAP_FILES_
+	if (Mapping)
+		munmap(Mapping, MappingSize);
+#endif
+}
+
+
+//! Map a file into memory
+IReadFile* CMappedReadFile::createMappedReadFile(const io::path& fileName, long minSize)
+{
+#ifdef _IRR_MAP_FILES_
+	struct stat info;
+	if (stat(fileName.c_str(), &info) != 0 || !S_ISREG(info.st_mode)
+		|| info.st_size < minSize || info.st_size == 0 || info.st_size > 0x7fffffff)
+		return 0;
+
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	// the size may have changed since stat()
+	if (fstat(fd, &info) != 0 || info.st_size == 0 || info.st_size > 0x7fffffff)
+	{
+		close(fd);
+		return 0;
+	}
+
+	const size_t size = (size_t)info.st_size;
+	void* mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping stays valid without the descriptor
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return 0;
+
+	return new CMappedReadFile((const u8*)mapping, (long)size, fileName, 0, mapping, size);
+#else
+	return 0;
+#endif
+}
+
+
+//! Create a file of a part of a file in memory
+IReadFile* CMappedReadFile::createView(IMemoryReadFile* file, long pos, long areaSize, const io::path& fileName)
+{
+	if (pos < 0 || areaSize < 0 || pos > file->getSize() - areaSize)
+		return 0;
+
+	return new CMappedReadFile((const u8*)file->getBuffer() + pos, areaSize, fileName, file, 0, 0);
+}
+
+
+//! returns how much was read
+size_t CMappedReadFile::read(void* buffer, size_t sizeToRead)
+{
+	long amount = static_cast<long>(sizeToRead);
+	if (Pos + amount > Len)
+		amount = Len - Pos;
+
+	if (amount <= 0)
+		return 0;
+
+	memcpy(buffer, Data + Pos, amount);
+	Pos += amount;
+
+	return static_cast<size_t>(amount);
+}
+
+
+//! changes position in file, returns true if successful
+bool CMappedReadFile::seek(long finalPos, bool relativeMovement)
+{
+	const long pos = relativeMovement ? Pos + finalPos : finalPos;
+	if (pos < 0 || pos > Len)
+		return false;
+
+	Pos = pos;
+	return true;
+}
+
+
+//! returns size of file
+long CMappedReadFile::getSize() const
+{
+	return Len;
+}
+
+
+//! returns where in the file we are.
+long CMappedReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CMappedReadFile::getFileName() const
+{
+	return Filename;
+}
+
+
+} // end namespace io
+} // end namespace irr
@@ -0,0 +1,95 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MAPPED_READ_FILE_H_INCLUDED__
+#define __C_MAPPED_READ_FILE_H_INCLUDED__
+
+#include "IMemoryReadFile.h"
+#include "irrString.h"
+
+namespace irr
+{
+namespace io
+{
+
+	/*!
+		A file mapped into memory, or a part of a file in memory.
+		Reading copies out of the mapping, getBuffer() reads without a copy.
+		Parts of files in memory are used for files stored uncompressed in
+		archives which are in memory themselves.
+	*/
+	class CMappedReadFile : public IMemoryReadFile
+	{
+	public:
+
+		//! Map a file into memory
+		/** \param minSize Smaller files are not mapped.
+		\return 0 if the file is smaller than minSize or could not be
+		mapped, it can still be read with CReadFile then. */
+		static IReadFile* createMappedReadFile(const io::path& fileName, long minSize);
+
+		//! Create a file of a part of a file in memory, the part is not copied
+		/** \param file Keeps the memory of the part, grabbed.
+		\return 0 if the part is not in the file. */
+		static IReadFile* createView(IMemoryReadFile* file, long pos, long areaSize, const io::path& fileName);
+
+		//! Destructor
+		virtual ~CMappedReadFile();
+
+		//! returns how much was read
+		virtual size_t read(void* buffer, size_t sizeToRead) _IRR_OVERRIDE_;
+
+		//! changes position in file, returns true if successful
+		virtual bool seek(long finalPos, bool relativeMovement = false) _IRR_OVERRIDE_;
+
+		//! returns size of file
+		virtual long getSize() const _IRR_OVERRIDE_;
+
+		//! returns where in the file we are.
+		virtual long getPos() const _IRR_OVERRIDE_;
+
+		//! returns name of file
+		virtual const io::path& getFileName() const _IRR_OVERRIDE_;
+
+		//! Get the type of the class implementing this interface
+		virtual EREAD_FILE_TYPE getType() const _IRR_OVERRIDE_
+		{
+			return ERFT_MAPPED_READ_FILE;
+		}
+
+		//! Get direct access to the mapped memory
+		virtual const void *getBuffer() const _IRR_OVERRIDE_
+		{
+			return Data;
+		}
+
+	private:
+
+		CMappedReadFile(const u8* data, long len, const io::path& fileName,
+			IReadFile* parent, void* mapping, size_t mappingSize);
+
+		const u8* Data;
+		long Len;
+		long Pos;
+		io::path Filename;
+
+		//! File which keeps the memory of a view
+		IReadFile* Parent;
+		//! Mapping to unmap when the file is dropped
+		void* Mapping;
+		size_t MappingSize;
+	};
+
+	//! Get the memory holding all data of a file
+	/** \return 0 if the data of file is not in memory. */
+	inline const u8* getReadFileMemory(IReadFile* file)
+	{
+		if (file && (file->getType() == ERFT_MEMORY_READ_FILE || file->getType() == ERFT_MAPPED_READ_FILE))
+			return (const u8*)static_cast<IMemoryReadFile*>(file)->getBuffer();
+		return 0;
+	}
+
+} // end namespace io
+} // end namespace irr
+
+#endif
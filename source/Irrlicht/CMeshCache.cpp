@@ -5,6 +5,7 @@
 #include "CMeshCache.h"
 #include "IAnimatedMesh.h"
 #include "IMesh.h"
+#include "IMeshBuffer.h"
 
 namespace irr
 {
@@ -13,10 +14,75 @@ namespace scene
 
 static const io::SNamedPath emptyNamedPath;
 
+// sentinel for evictMeshes() when no entry has to be kept
+static const u32 noEntry = 0xffffffff;
+
+
+//! Bytes of vertex and index data of all mesh buffers
+static u64 getMeshBytes(const IMesh* mesh)
+{
+	if (!mesh)
+		return 0;
+
+	u64 bytes = 0;
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(i);
+		bytes += (u64)mb->getVertexCount() * video::getVertexPitchFromType(mb->getVertexType());
+		bytes += (u64)mb->getIndexCount() * (mb->getIndexType() == video::EIT_16BIT ? sizeof(u16) : sizeof(u32));
+	}
+	return bytes;
+}
+
+
+//! Frame 0 of a mesh, for meshes whose getMesh() only looks it up
+/** Skinned, MD2, MD3 and Half-Life meshes animate themselves in getMesh(),
+so they are only found by their own pointer. */
+static IMesh* getStaticFirstFrame(IAnimatedMesh* mesh)
+{
+	switch (mesh->getMeshType())
+	{
+	case EAMT_MD2:
+	case EAMT_MD3:
+	case EAMT_MDL_HALFLIFE:
+	case EAMT_SKINNED:
+		return 0;
+	default:
+		return mesh->getMesh(0);
+	}
+}
+
+
+//! FNV-1a over the characters of the path
+size_t CMeshCache::SPathHash::operator()(const io::path& path) const
+{
+	u32 hash = 2166136261u;
+	const fschar_t* c = path.c_str();
+	for (u32 i=0; i<path.size(); ++i)
+	{
+		hash ^= (u32)c[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+
+CMeshCache::CMeshCache()
+	: MemoryBudget(0), MemoryUsage(0), UseCounter(0)
+{
+}
+
 
 CMeshCache::~CMeshCache()
 {
 	clear();
+
+	std::unordered_map<io::path, core::array<IMeshLoadCallBack*>, SPathHash>::iterator it;
+	for (it = Loading.begin(); it != Loading.end(); ++it)
+	{
+		for (u32 i=0; i<it->second.size(); ++i)
+			it->second[i]->drop();
+	}
 }
 
 
@@ -27,25 +93,25 @@ void CMeshCache::addMesh(const io::path& filename, IAnimatedMesh* mesh)
 
 	MeshEntry e ( filename );
 	e.Mesh = mesh;
+	e.FirstFrame = getStaticFirstFrame(mesh);
+	e.Bytes = getMeshBytes(mesh);
+	e.LastUsed = ++UseCounter;
 
 	Meshes.push_back(e);
+	linkEntry(Meshes.size()-1);
+	MemoryUsage += e.Bytes;
+
+	// the caller still has to get its hands on the new mesh
+	evictMeshes(Meshes.size()-1);
 }
 
 
 //! Removes a mesh from the cache.
 void CMeshCache::removeMesh(const IMesh* const mesh)
 {
-	if ( !mesh )
-		return;
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-		{
-			Meshes[i].Mesh->drop();
-			Meshes.erase(i);
-			return;
-		}
-	}
+	const s32 index = findMesh(mesh);
+	if (index >= 0)
+		removeEntry((u32)index);
 }
 
 
@@ -59,13 +125,7 @@ u32 CMeshCache::getMeshCount() const
 //! Returns current number of the mesh
 s32 CMeshCache::getMeshIndex(const IMesh* const mesh) const
 {
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-			return (s32)i;
-	}
-
-	return -1;
+	return findMesh(mesh);
 }
 
 
@@ -82,9 +142,14 @@ IAnimatedMesh* CMeshCache::getMeshByIndex(u32 number)
 //! Returns a mesh based on its name.
 IAnimatedMesh* CMeshCache::getMeshByName(const io::path& name)
 {
-	MeshEntry e ( name );
-	s32 id = Meshes.binary_search(e);
-	return (id != -1) ? Meshes[id].Mesh : 0;
+	const io::SNamedPath namedPath(name);
+	std::unordered_multimap<io::path, u32, SPathHash>::const_iterator it = NameIndex.find(namedPath.getInternalName());
+	if (it == NameIndex.end())
+		return 0;
+
+	MeshEntry& e = Meshes[it->second];
+	e.LastUsed = ++UseCounter;
+	return e.Mesh;
 }
 
 
@@ -101,16 +166,11 @@ const io::SNamedPath& CMeshCache::getMeshName(u32 index) const
 //! Get the name of a loaded mesh, if there is any.
 const io::SNamedPath& CMeshCache::getMeshName(const IMesh* const mesh) const
 {
-	if (!mesh)
+	const s32 index = findMesh(mesh);
+	if (index < 0)
 		return emptyNamedPath;
 
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-			return Meshes[i].NamedPath;
-	}
-
-	return emptyNamedPath;
+	return Meshes[index].NamedPath;
 }
 
 //! Renames a loaded mesh.
@@ -119,8 +179,9 @@ bool CMeshCache::renameMesh(u32 index, const io::path& name)
 	if (index >= Meshes.size())
 		return false;
 
+	unlinkEntry(index);
 	Meshes[index].NamedPath.setPath(name);
-	Meshes.sort();
+	linkEntry(index);
 	return true;
 }
 
@@ -128,17 +189,11 @@ bool CMeshCache::renameMesh(u32 index, const io::path& name)
 //! Renames a loaded mesh.
 bool CMeshCache::renameMesh(const IMesh* const mesh, const io::path& name)
 {
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-		{
-			Meshes[i].NamedPath.setPath(name);
-			Meshes.sort();
-			return true;
-		}
-	}
+	const s32 index = findMesh(mesh);
+	if (index < 0)
+		return false;
 
-	return false;
+	return renameMesh((u32)index, name);
 }
 
 
@@ -149,6 +204,69 @@ bool CMeshCache::isMeshLoaded(const io::path& name)
 }
 
 
+//! Check if a mesh is being loaded in the background.
+bool CMeshCache::isMeshLoading(const io::path& name) const
+{
+	const io::SNamedPath namedPath(name);
+	return Loading.find(namedPath.getInternalName()) != Loading.end();
+}
+
+
+//! Get the amount of meshes being loaded in the background.
+u32 CMeshCache::getLoadingMeshCount() const
+{
+	return (u32)Loading.size();
+}
+
+
+bool CMeshCache::addLoadingMesh(const io::path& name, IMeshLoadCallBack* callBack)
+{
+	const io::SNamedPath namedPath(name);
+	std::unordered_map<io::path, core::array<IMeshLoadCallBack*>, SPathHash>::iterator it = Loading.find(namedPath.getInternalName());
+	const bool start = (it == Loading.end());
+	if (start)
+		it = Loading.insert(std::make_pair(namedPath.getInternalName(), core::array<IMeshLoadCallBack*>())).first;
+
+	if (callBack)
+	{
+		callBack->grab();
+		it->second.push_back(callBack);
+	}
+	return start;
+}
+
+
+IAnimatedMesh* CMeshCache::finishLoadingMesh(const io::path& name, IAnimatedMesh* mesh)
+{
+	if (mesh)
+	{
+		// a mesh of that name might have been loaded by getMesh() meanwhile
+		IAnimatedMesh* cached = getMeshByName(name);
+		if (cached)
+			mesh = cached;
+		else
+			addMesh(name, mesh);
+	}
+
+	const io::SNamedPath namedPath(name);
+	std::unordered_map<io::path, core::array<IMeshLoadCallBack*>, SPathHash>::iterator it = Loading.find(namedPath.getInternalName());
+	if (it == Loading.end())
+		return mesh;
+
+	// call backs may start other loads, which change Loading
+	core::array<IMeshLoadCallBack*> callBacks;
+	callBacks.swap(it->second);
+	Loading.erase(it);
+
+	for (u32 i=0; i<callBacks.size(); ++i)
+	{
+		callBacks[i]->OnMeshLoaded(name, mesh);
+		callBacks[i]->drop();
+	}
+	return mesh;
+}
+
+
 //! Clears the whole mesh cache, removing all meshes.
 void CMeshCache::clear()
 {
@@ -156,18 +274,167 @@ void CMeshCache::clear()
 		Meshes[i].Mesh->drop();
 
 	Meshes.clear();
+	NameIndex.clear();
+	MeshIndex.clear();
+	MemoryUsage = 0;
 }
 
 //! Clears all meshes that are held in the mesh cache but not used anywhere else.
 void CMeshCache::clearUnusedMeshes()
 {
-	for (u32 i=0; i<Meshes.size(); ++i)
+	for (u32 i=0; i<Meshes.size(); )
 	{
 		if (Meshes[i].Mesh->getReferenceCount() == 1)
+			removeEntry(i);	// moves another mesh to i
+		else
+			++i;
+	}
+}
+
+
+//! Limits the memory used by meshes which are only held by the cache.
+void CMeshCache::setMemoryBudget(u64 bytes)
+{
+	MemoryBudget = bytes;
+	evictMeshes(noEntry);
+}
+
+
+//! Get the memory budget set with setMemoryBudget(), 0 when there is none.
+u64 CMeshCache::getMemoryBudget() const
+{
+	return MemoryBudget;
+}
+
+
+//! Get the memory of all cached meshes as measured for the budget.
+u64 CMeshCache::getMemoryUsage() const
+{
+	return MemoryUsage;
+}
+
+
+s32 CMeshCache::findMesh(const IMesh* const mesh) const
+{
+	if (!mesh)
+		return -1;
+
+	s32 index = -1;
+	typedef std::unordered_multimap<const IMesh*, u32>::const_iterator Iterator;
+	const std::pair<Iterator, Iterator> range = MeshIndex.equal_range(mesh);
+	for (Iterator it = range.first; it != range.second; ++it)
+	{
+		if (index < 0 || it->second < (u32)index)
+			index = (s32)it->second;
+	}
+	return index;
+}
+
+
+void CMeshCache::linkEntry(u32 index)
+{
+	const MeshEntry& e = Meshes[index];
+	NameIndex.insert(std::make_pair(e.NamedPath.getInternalName(), index));
+	MeshIndex.insert(std::make_pair((const IMesh*)e.Mesh, index));
+	if (e.FirstFrame && e.FirstFrame != e.Mesh)
+		MeshIndex.insert(std::make_pair((const IMesh*)e.FirstFrame, index));
+}
+
+
+void CMeshCache::unlinkEntry(u32 index)
+{
+	const MeshEntry& e = Meshes[index];
+
+	typedef std::unordered_multimap<io::path, u32, SPathHash>::iterator NameIterator;
+	const std::pair<NameIterator, NameIterator> names = NameIndex.equal_range(e.NamedPath.getInternalName());
+	for (NameIterator it = names.first; it != names.second; ++it)
+	{
+		if (it->second == index)
+		{
+			NameIndex.erase(it);
+			break;
+		}
+	}
+
+	const IMesh* keys[2] = { e.Mesh, e.FirstFrame != e.Mesh ? e.FirstFrame : 0 };
+	for (u32 k=0; k<2; ++k)
+	{
+		if (!keys[k])
+			continue;
+
+		typedef std::unordered_multimap<const IMesh*, u32>::iterator MeshIterator;
+		const std::pair<MeshIterator, MeshIterator> meshes = MeshIndex.equal_range(keys[k]);
+		for (MeshIterator it = meshes.first; it != meshes.second; ++it)
 		{
-			Meshes[i].Mesh->drop();
-			Meshes.erase(i);
-			--i;
+			if (it->second == index)
+			{
+				MeshIndex.erase(it);
+				break;
+			}
+		}
+	}
+}
+
+
+void CMeshCache::removeEntry(u32 index)
+{
+	unlinkEntry(index);
+	MemoryUsage -= Meshes[index].Bytes;
+	Meshes[index].Mesh->drop();
+
+	const u32 last = Meshes.size()-1;
+	if (index != last)
+	{
+		unlinkEntry(last);
+		Meshes[index] = Meshes[last];
+		linkEntry(index);
+	}
+	Meshes.erase(last);
+}
+
+
+void CMeshCache::evictMeshes(u32 keep)
+{
+	if (!MemoryBudget)
+		return;
+
+	const IAnimatedMesh* kept = keep < Meshes.size() ? Meshes[keep].Mesh : 0;
+	bool removed = true;
+	core::array<SEvictCandidate> candidates;
+	typedef std::unordered_multimap<const IMesh*, u32>::const_iterator Iterator;
+
+	// again when dropped meshes released others which are cached
+	while (removed && MemoryUsage > MemoryBudget)
+	{
+		removed = false;
+
+		// meshes not used anywhere else, least recently used first
+		candidates.set_used(0);
+		for (u32 i=0; i<Meshes.size(); ++i)
+		{
+			if (Meshes[i].Mesh == kept || Meshes[i].Mesh->getReferenceCount() != 1)
+				continue;
+			SEvictCandidate candidate;
+			candidate.LastUsed = Meshes[i].LastUsed;
+			candidate.Mesh = Meshes[i].Mesh;
+			candidates.push_back(candidate);
+		}
+		candidates.sort();
+
+		for (u32 c=0; c<candidates.size() && MemoryUsage > MemoryBudget; ++c)
+		{
+			// removing moves entries, find the mesh again. The first
+			// frame of another entry may be the same mesh.
+			const std::pair<Iterator, Iterator> range = MeshIndex.equal_range(candidates[c].Mesh);
+			for (Iterator it = range.first; it != range.second; ++it)
+			{
+				if (Meshes[it->second].Mesh == candidates[c].Mesh)
+				{
+					removeEntry(it->second);
+					removed = true;
+					break;
+				}
+			}
 		}
 	}
 }
@@ -175,4 +442,3 @@ void CMeshCache::clearUnusedMeshes()
 
 } // end namespace scene
 } // end namespace irr
-
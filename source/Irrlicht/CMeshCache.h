@@ -6,7 +6,9 @@
 #define __C_MESH_CACHE_H_INCLUDED__
 
 #include "IMeshCache.h"
+#include "IMeshLoadCallBack.h"
 #include "irrArray.h"
+#include <unordered_map>
 
 namespace irr
 {
@@ -17,6 +19,9 @@ namespace scene
 	{
 	public:
 
+		//! constructor
+		CMeshCache();
+
 		virtual ~CMeshCache();
 
 		//! Adds a mesh to the internal list of loaded meshes.
@@ -88,31 +93,101 @@ namespace scene
 		//! returns if a mesh already was loaded
 		virtual bool isMeshLoaded(const io::path& name) _IRR_OVERRIDE_;
 
+		//! Check if a mesh is being loaded in the background.
+		virtual bool isMeshLoading(const io::path& name) const _IRR_OVERRIDE_;
+
+		//! Get the amount of meshes being loaded in the background.
+		virtual u32 getLoadingMeshCount() const _IRR_OVERRIDE_;
+
+		//! Start to wait for a mesh loaded in the background
+		/** \param callBack Optional, called by finishLoadingMesh().
+		\return True if the caller has to start the load, false if the
+		mesh is already loading and callBack waits for that load. */
+		bool addLoadingMesh(const io::path& name, IMeshLoadCallBack* callBack);
+
+		//! Finish a load started after addLoadingMesh()
+		/** Adds the mesh, unless a mesh of that name was added meanwhile,
+		and calls back everyone waiting for it.
+		\param mesh The loaded mesh, 0 if loading failed.
+		\return The mesh in the cache, 0 if mesh was 0. */
+		IAnimatedMesh* finishLoadingMesh(const io::path& name, IAnimatedMesh* mesh);
+
 		//! Clears the whole mesh cache, removing all meshes.
 		virtual void clear() _IRR_OVERRIDE_;
 
 		//! Clears all meshes that are held in the mesh cache but not used anywhere else.
 		virtual void clearUnusedMeshes() _IRR_OVERRIDE_;
 
+		//! Limits the memory used by meshes which are only held by the cache.
+		virtual void setMemoryBudget(u64 bytes) _IRR_OVERRIDE_;
+
+		//! Get the memory budget set with setMemoryBudget(), 0 when there is none.
+		virtual u64 getMemoryBudget() const _IRR_OVERRIDE_;
+
+		//! Get the memory of all cached meshes as measured for the budget.
+		virtual u64 getMemoryUsage() const _IRR_OVERRIDE_;
+
 	protected:
 
 		struct MeshEntry
 		{
 			MeshEntry ( const io::path& name )
-				: NamedPath ( name )
+				: NamedPath ( name ), Mesh(0), FirstFrame(0), Bytes(0), LastUsed(0)
 			{
 			}
 			io::SNamedPath NamedPath;
 			IAnimatedMesh* Mesh;
+			IMesh* FirstFrame;	// Mesh->getMesh(0) when that doesn't animate, else 0
+			u64 Bytes;			// vertex and index data of the mesh buffers of Mesh
+			u32 LastUsed;		// UseCounter of the last lookup
+		};
+
+		struct SPathHash
+		{
+			size_t operator()(const io::path& path) const;
+		};
 
-			bool operator < (const MeshEntry& other) const
+		//! A mesh evictMeshes() may remove, sorts least recently used first
+		struct SEvictCandidate
+		{
+			bool operator<(const SEvictCandidate& other) const
 			{
-				return (NamedPath < other.NamedPath);
+				return LastUsed < other.LastUsed;
 			}
+
+			u32 LastUsed;
+			IAnimatedMesh* Mesh;
 		};
 
+		//! Find the lowest index of a mesh or its first frame, -1 if not cached
+		s32 findMesh(const IMesh* const mesh) const;
+
+		//! Add the lookup keys of an entry
+		void linkEntry(u32 index);
+
+		//! Remove the lookup keys of an entry
+		void unlinkEntry(u32 index);
+
+		//! Drop a mesh and move the last entry into its place
+		void removeEntry(u32 index);
+
+		//! Remove least recently used meshes until the budget is met
+		/** \param keep Index of an entry which must not be removed. */
+		void evictMeshes(u32 keep);
+
 		//! loaded meshes
 		core::array<MeshEntry> Meshes;
+
+		//! Entry indices by internal name and by mesh and first frame pointer
+		std::unordered_multimap<io::path, u32, SPathHash> NameIndex;
+		std::unordered_multimap<const IMesh*, u32> MeshIndex;
+
+		//! Call backs waiting for meshes loading in the background, by internal name
+		std::unordered_map<io::path, core::array<IMeshLoadCallBack*>, SPathHash> Loading;
+
+		u64 MemoryBudget;
+		u64 MemoryUsage;
+		u32 UseCounter;
 	};
 
 
@@ -5,6 +5,7 @@
 #include "CMeshManipulator.h"
 #include "SMesh.h"
 #include "CMeshBuffer.h"
+#include "CDynamicMeshBuffer.h"
 #include "SAnimatedMesh.h"
 #include "os.h"
 #include "irrMap.h"
@@ -761,186 +762,213 @@ IMesh* CMeshManipulator::createMeshUniquePrimitives(IMesh* mesh) const
 }
 
 
-//! Creates a copy of a mesh, which will have identical vertices welded together
-// not yet 32bit
-IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
+namespace
 {
-	SMesh* clone = new SMesh();
-	clone->BoundingBox = mesh->getBoundingBox();
 
-	core::array<u16> redirects;
+// vertex comparisons used by createMeshWelded
+inline bool isWeldable(const video::S3DVertex& a, const video::S3DVertex& b, f32 tolerance)
+{
+	return a.Pos.equals(b.Pos, tolerance) &&
+		a.Normal.equals(b.Normal, tolerance) &&
+		a.TCoords.equals(b.TCoords) &&
+		(a.Color == b.Color);
+}
+
+inline bool isWeldable(const video::S3DVertex2TCoords& a, const video::S3DVertex2TCoords& b, f32 tolerance)
+{
+	return a.Pos.equals(b.Pos, tolerance) &&
+		a.Normal.equals(b.Normal, tolerance) &&
+		a.TCoords.equals(b.TCoords) &&
+		a.TCoords2.equals(b.TCoords2) &&
+		(a.Color == b.Color);
+}
 
-	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
-	{
-		const IMeshBuffer* const mb = mesh->getMeshBuffer(b);
-		// reset redirect list
-		redirects.set_used(mb->getVertexCount());
+inline bool isWeldable(const video::S3DVertexTangents& a, const video::S3DVertexTangents& b, f32 tolerance)
+{
+	return a.Pos.equals(b.Pos, tolerance) &&
+		a.Normal.equals(b.Normal, tolerance) &&
+		a.TCoords.equals(b.TCoords) &&
+		a.Tangent.equals(b.Tangent, tolerance) &&
+		a.Binormal.equals(b.Binormal, tolerance) &&
+		(a.Color == b.Color);
+}
 
-		const u16* indices = 0;
-		u32 indexCount = 0;
-		core::array<u16>* outIdx = 0;
+//! Finds for each vertex the first earlier vertex it can be welded with
+/** Vertices are hashed into a grid whose cells are at least tolerance wide,
+so all candidates of a vertex are in the 27 cells around it.
+\param redirects Receives the index of each vertex in the welded vertex list.
+\param unique Receives the input indices of the welded vertices. */
+template <class T>
+void weldVertices(const T* v, u32 vertexCount, f32 tolerance,
+	core::array<u32>& redirects, core::array<u32>& unique)
+{
+	redirects.set_used(vertexCount);
+	unique.set_used(0);
+	if (!vertexCount)
+		return;
 
-		switch(mb->getVertexType())
+	core::aabbox3df box(v[0].Pos);
+	for (u32 i=1; i<vertexCount; ++i)
+		box.addInternalPoint(v[i].Pos);
+
+	// bigger cells only cost more comparisons, so keep the grid coarse enough
+	// that cell coordinates stay small
+	const core::vector3df extent = box.getExtent();
+	f32 cellSize = core::max_(core::max_(extent.X, extent.Y, extent.Z) / 1024.f, tolerance);
+	if (!(cellSize > 0.f))
+		cellSize = 1.f;
+	const f32 invCellSize = 1.f / cellSize;
+
+	u32 tableSize = 64;
+	while (tableSize < vertexCount*2)
+		tableSize <<= 1;
+	const u32 mask = tableSize-1;
+
+	const u32 empty = 0xffffffff;
+	core::array<u32> heads;
+	heads.set_used(tableSize);
+	for (u32 i=0; i<tableSize; ++i)
+		heads[i] = empty;
+	core::array<u32> next;
+	next.set_used(vertexCount);
+
+	for (u32 i=0; i<vertexCount; ++i)
+	{
+		const s32 x = (s32)core::clamp((v[i].Pos.X-box.MinEdge.X)*invCellSize, 0.f, 2048.f);
+		const s32 y = (s32)core::clamp((v[i].Pos.Y-box.MinEdge.Y)*invCellSize, 0.f, 2048.f);
+		const s32 z = (s32)core::clamp((v[i].Pos.Z-box.MinEdge.Z)*invCellSize, 0.f, 2048.f);
+
+		// lowest matching index, like a linear scan over all earlier vertices
+		u32 match = empty;
+		for (s32 dz=-1; dz<=1; ++dz)
+		for (s32 dy=-1; dy<=1; ++dy)
+		for (s32 dx=-1; dx<=1; ++dx)
 		{
-		case video::EVT_STANDARD:
+			const u32 hash = ((u32)(x+dx)*73856093u ^ (u32)(y+dy)*19349663u ^ (u32)(z+dz)*83492791u) & mask;
+			for (u32 j=heads[hash]; j!=empty; j=next[j])
+			{
+				if (j < match && isWeldable(v[i], v[j], tolerance))
+					match = j;
+			}
+		}
+
+		if (match != empty)
 		{
-			SMeshBuffer* buffer = new SMeshBuffer();
-			buffer->BoundingBox = mb->getBoundingBox();
-			buffer->Material = mb->getMaterial();
-			clone->addMeshBuffer(buffer);
-			buffer->drop();
+			redirects[i] = redirects[match];
+		}
+		else
+		{
+			redirects[i] = unique.size();
+			unique.push_back(i);
+		}
 
-			video::S3DVertex* v =
-					(video::S3DVertex*)mb->getVertices();
+		const u32 hash = ((u32)x*73856093u ^ (u32)y*19349663u ^ (u32)z*83492791u) & mask;
+		next[i] = heads[hash];
+		heads[hash] = i;
+	}
+}
 
-			u32 vertexCount = mb->getVertexCount();
+//! Creates the welded copy of a mesh buffer with vertices of type T
+/** Uses 16 bit indices as long as the welded vertices fit, otherwise a
+CDynamicMeshBuffer with 32 bit indices. */
+template <class T>
+IMeshBuffer* createWeldedBuffer(const IMeshBuffer* mb, f32 tolerance)
+{
+	const T* v = static_cast<const T*>(mb->getVertices());
 
-			indices = mb->getIndices();
-			indexCount = mb->getIndexCount();
-			outIdx = &buffer->Indices;
+	core::array<u32> redirects;
+	core::array<u32> unique;
+	weldVertices(v, mb->getVertexCount(), tolerance, redirects, unique);
 
-			buffer->Vertices.reallocate(vertexCount);
+	// Clean up any degenerate tris
+	const u32 indexCount = mb->getIndexCount();
+	const u16* indices16 = mb->getIndices();
+	const u32* indices32 = (mb->getIndexType() == video::EIT_32BIT) ? reinterpret_cast<const u32*>(indices16) : 0;
 
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+	core::array<u32> indices;
+	indices.reallocate(indexCount);
+	for (u32 i = 0; i+2 < indexCount; i+=3)
+	{
+		const u32 a = redirects[indices32 ? indices32[i] : indices16[i]];
+		const u32 b = redirects[indices32 ? indices32[i+1] : indices16[i+1]];
+		const u32 c = redirects[indices32 ? indices32[i+2] : indices16[i+2]];
 
-			break;
-		}
-		case video::EVT_2TCOORDS:
-		{
-			SMeshBufferLightMap* buffer = new SMeshBufferLightMap();
-			buffer->BoundingBox = mb->getBoundingBox();
-			buffer->Material = mb->getMaterial();
-			clone->addMeshBuffer(buffer);
-			buffer->drop();
+		if (a == b || b == c || a == c)
+			continue;
 
-			video::S3DVertex2TCoords* v =
-					(video::S3DVertex2TCoords*)mb->getVertices();
+		indices.push_back(a);
+		indices.push_back(b);
+		indices.push_back(c);
+	}
 
-			u32 vertexCount = mb->getVertexCount();
+	if (unique.size() <= 0x10000)
+	{
+		CMeshBuffer<T>* buffer = new CMeshBuffer<T>();
+		buffer->BoundingBox = mb->getBoundingBox();
+		buffer->Material = mb->getMaterial();
 
-			indices = mb->getIndices();
-			indexCount = mb->getIndexCount();
-			outIdx = &buffer->Indices;
+		buffer->Vertices.reallocate(unique.size());
+		for (u32 i=0; i<unique.size(); ++i)
+			buffer->Vertices.push_back(v[unique[i]]);
 
-			buffer->Vertices.reallocate(vertexCount);
+		buffer->Indices.reallocate(indices.size());
+		for (u32 i=0; i<indices.size(); ++i)
+			buffer->Indices.push_back((u16)indices[i]);
 
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						 v[i].TCoords2.equals( v[j].TCoords2 ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
-			break;
-		}
-		case video::EVT_TANGENTS:
-		{
-			SMeshBufferTangents* buffer = new SMeshBufferTangents();
-			buffer->BoundingBox = mb->getBoundingBox();
-			buffer->Material = mb->getMaterial();
-			clone->addMeshBuffer(buffer);
-			buffer->drop();
+		return buffer;
+	}
 
-			video::S3DVertexTangents* v =
-					(video::S3DVertexTangents*)mb->getVertices();
+	CDynamicMeshBuffer* buffer = new CDynamicMeshBuffer(T::getType(), video::EIT_32BIT);
+	buffer->setBoundingBox(mb->getBoundingBox());
+	buffer->getMaterial() = mb->getMaterial();
 
-			u32 vertexCount = mb->getVertexCount();
+	IVertexBuffer& vertices = buffer->getVertexBuffer();
+	vertices.reallocate(unique.size());
+	for (u32 i=0; i<unique.size(); ++i)
+		vertices.push_back(v[unique[i]]);
 
-			indices = mb->getIndices();
-			indexCount = mb->getIndexCount();
-			outIdx = &buffer->Indices;
+	IIndexBuffer& outIndices = buffer->getIndexBuffer();
+	outIndices.reallocate(indices.size());
+	for (u32 i=0; i<indices.size(); ++i)
+		outIndices.push_back(indices[i]);
 
-			buffer->Vertices.reallocate(vertexCount);
+	return buffer;
+}
 
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						 v[i].Tangent.equals( v[j].Tangent, tolerance ) &&
-						 v[i].Binormal.equals( v[j].Binormal, tolerance ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+} // end anonymous namespace
+
+
+//! Creates a copy of a mesh, which will have identical vertices welded together
+IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
+{
+	SMesh* clone = new SMesh();
+	clone->BoundingBox = mesh->getBoundingBox();
+
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* const mb = mesh->getMeshBuffer(b);
+		IMeshBuffer* buffer = 0;
+
+		switch(mb->getVertexType())
+		{
+		case video::EVT_STANDARD:
+			buffer = createWeldedBuffer<video::S3DVertex>(mb, tolerance);
+			break;
+		case video::EVT_2TCOORDS:
+			buffer = createWeldedBuffer<video::S3DVertex2TCoords>(mb, tolerance);
+			break;
+		case video::EVT_TANGENTS:
+			buffer = createWeldedBuffer<video::S3DVertexTangents>(mb, tolerance);
 			break;
-		}
 		default:
 			os::Printer::log("Cannot create welded mesh, vertex type unsupported", ELL_ERROR);
 			break;
 		}
 
-		// Clean up any degenerate tris
- 		core::array<u16> &Indices = *outIdx;
-		Indices.clear();
-		Indices.reallocate(indexCount);
-		for (u32 i = 0; i < indexCount; i+=3)
- 		{
-			u16 a, b, c;
-			a = redirects[indices[i]];
-			b = redirects[indices[i+1]];
-			c = redirects[indices[i+2]];
-
-			bool drop = false;
-
-			if (a == b || b == c || a == c)
-				drop = true;
-
-			// Open for other checks
-
-			if (!drop)
-			{
-				Indices.push_back(a);
-				Indices.push_back(b);
-				Indices.push_back(c);
-			}
+		if (buffer)
+		{
+			clone->addMeshBuffer(buffer);
+			buffer->drop();
 		}
 	}
 	return clone;
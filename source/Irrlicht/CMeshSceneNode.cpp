@@ -83,7 +83,25 @@ void CMeshSceneNode::OnRegisterSceneNode()
 		// register according to material types counted
 
 		if (solidCount)
-			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+		{
+			// without shadow and debug data render() only draws the buffers,
+			// so let the scene manager sort and draw the solid ones
+			if (!Shadow && !DebugDataVisible)
+			{
+				for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+				{
+					scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+					if (!mb)
+						continue;
+
+					const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+					if (!driver->needsTransparentRenderPass(material))
+						SceneManager->registerMeshBufferForRendering(this, mb, material);
+				}
+			}
+			else
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+		}
 
 		if (transparentCount)
 			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
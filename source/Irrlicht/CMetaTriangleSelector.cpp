@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CMetaTriangleSelector.h"
+#include "ISceneCollisionManager.h"
 
 namespace irr
 {
@@ -220,6 +221,47 @@ const ITriangleSelector* CMetaTriangleSelector::getSelector(u32 index) const
 }
 
 
+//! True when all selectors in the collection support getNearestHit()
+bool CMetaTriangleSelector::hasNearestHitQuery() const
+{
+	if (TriangleSelectors.empty())
+		return false;
+
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		if (!TriangleSelectors[i]->hasNearestHitQuery())
+			return false;
+	}
+
+	return true;
+}
+
+
+//! Find the triangle which is hit first by a 3d line.
+bool CMetaTriangleSelector::getNearestHit(SCollisionHit& outHit, const core::line3d<f32>& line) const
+{
+	bool found = false;
+	f32 nearest = FLT_MAX;
+	SCollisionHit hit;
+
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		if (!TriangleSelectors[i]->getNearestHit(hit, line))
+			continue;
+
+		const f32 distance = hit.Intersection.getDistanceFromSQ(line.start);
+		if (distance < nearest)
+		{
+			nearest = distance;
+			outHit = hit;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+
 } // end namespace scene
 } // end namespace irr
 
@@ -66,6 +66,12 @@ public:
 	// Get the TriangleSelector based on index based on getSelectorCount
 	virtual const ITriangleSelector* getSelector(u32 index) const _IRR_OVERRIDE_;
 
+	//! True when all selectors in the collection support getNearestHit()
+	virtual bool hasNearestHitQuery() const _IRR_OVERRIDE_;
+
+	//! Find the triangle which is hit first by a 3d line.
+	virtual bool getNearestHit(SCollisionHit& outHit, const core::line3d<f32>& line) const _IRR_OVERRIDE_;
+
 private:
 
 	core::array<ITriangleSelector*> TriangleSelectors;
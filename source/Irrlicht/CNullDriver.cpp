@@ -16,6 +16,8 @@
 #include "CColorConverter.h"
 #include "IAttributeExchangingObject.h"
 #include "IRenderTarget.h"
+#include <chrono>
+#include <thread>
 
 
 namespace irr
@@ -84,11 +86,33 @@ IImageWriter* createImageWriterPNG();
 //! creates a writer which is able to save ppm images
 IImageWriter* createImageWriterPPM();
 
+namespace
+{
+	// Texture creation flags changed by the task a worker thread runs.
+	// Loaders change the flags around their getTexture() calls, which must
+	// not change the flags of the render thread. They are reset when the
+	// thread starts another task.
+	thread_local u32 WorkerFlagsTask = 0;
+	thread_local u32 WorkerFlagsMask = 0;
+	thread_local u32 WorkerFlagsValues = 0;
+
+	u32 getWorkerTextureCreationFlags(u32 flags)
+	{
+		if (WorkerFlagsTask != CWorkerPool::getTaskNumber())
+			return flags;
+		return (flags & ~WorkerFlagsMask) | (WorkerFlagsValues & WorkerFlagsMask);
+	}
+}
+
 //! constructor
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
-	: SharedRenderTarget(0), CurrentRenderTarget(0), CurrentRenderTargetSize(0, 0), FileSystem(io), MeshManipulator(0),
-	ViewPort(0, 0, 0, 0), ScreenSize(screenSize), PrimitivesDrawn(0), MinVertexCountForVBO(500),
-	TextureCreationFlags(0), OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
+	: TextureUploadBudgetBytes(0), TextureUploadBudgetTime(0),
+	SharedRenderTarget(0), CurrentRenderTarget(0), CurrentRenderTargetSize(0, 0), FileSystem(io), MeshManipulator(0),
+	ViewPort(0, 0, 0, 0), ScreenSize(screenSize), MinVertexCountForVBO(500),
+	StreamingBufferSize(0),
+	TextureCreationFlags(0), SkinningPalette(0), SkinningJointCount(0), SkinningVertexJoints(0),
+	InstanceData(0), InstanceCount(0),
+	OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CNullDriver");
@@ -298,6 +322,44 @@ IImageWriter* CNullDriver::getImageWriter(u32 n)
 //! deletes all textures
 void CNullDriver::deleteAllTextures()
 {
+	// loads still decoding use the image loaders and their texture, wait
+	// for the ones which already started
+	core::array<STextureLoad*> loads;
+	loads.swap(TextureLoads);
+	for (u32 i=0; i<loads.size(); ++i)
+	{
+		STextureLoad* load = loads[i];
+		if (!getWorkerPool().cancel(load))
+		{
+			while (!load->Decoded.load(std::memory_order_acquire))
+				std::this_thread::yield();
+		}
+	}
+
+	// the loads are given up, tell who waits for them
+	for (u32 i=0; i<loads.size(); ++i)
+	{
+		STextureLoad* load = loads[i];
+		if (load->File)
+			load->File->drop();
+		if (load->Image)
+			load->Image->drop();
+		for (u32 j=0; j<load->CallBacks.size(); ++j)
+		{
+			load->CallBacks[j]->OnTextureLoaded(load->Texture, false);
+			load->CallBacks[j]->drop();
+		}
+		load->Texture->drop();
+		delete load;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(DeferredTextureMutex);
+		for (u32 i=0; i<DeferredTextures.size(); ++i)
+			DeferredTextures[i]->drop();
+		DeferredTextures.clear();
+	}
+
 	// we need to remove previously set textures which might otherwise be kept in the
 	// last set material member. Could be optimized to reduce state changes.
 	setMaterial(SMaterial());
@@ -319,13 +381,17 @@ void CNullDriver::deleteAllTextures()
 
 bool CNullDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil, const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
 {
-	PrimitivesDrawn = 0;
+	FrameStatistics = SDriverFrameStatistics();
 	return true;
 }
 
 bool CNullDriver::endScene()
 {
-	FPSCounter.registerFrame(os::Timer::getRealTime(), PrimitivesDrawn);
+	FPSCounter.registerFrame(os::Timer::getRealTime(), FrameStatistics.PrimitivesDrawn);
+	os::Printer::flushLog();
+	uploadLoadedTextures();
+	FrameStatisticsRing.publish(FrameStatistics);
+	LastFrameStatistics = FrameStatistics;
 	updateAllHardwareBuffers();
 	updateAllOcclusionQueries();
 	return true;
@@ -369,6 +435,60 @@ const core::matrix4& CNullDriver::getTransform(E_TRANSFORMATION_STATE state) con
 //! sets a material
 void CNullDriver::setMaterial(const SMaterial& material)
 {
+	countMaterialChange(material);
+}
+
+
+//! Count the material change and texture binds of a setMaterial() call
+void CNullDriver::countMaterialChange(const SMaterial& material)
+{
+	++FrameStatistics.MaterialChanges;
+	if (material == CountedMaterial)
+		++FrameStatistics.RedundantMaterialChanges;
+
+	for (u32 i=0; i<MATERIAL_MAX_TEXTURES; ++i)
+	{
+		const ITexture* texture = material.getTexture(i);
+		if (texture != CountedMaterial.getTexture(i))
+			++FrameStatistics.TextureBinds;
+		else if (texture)
+			++FrameStatistics.RedundantTextureBinds;
+	}
+
+	CountedMaterial = material;
+}
+
+
+//! sets the joint palette and joint stream for hardware skinning
+void CNullDriver::setSkinningData(const core::matrix4* palette, u32 jointCount,
+	const S3DVertexJoints* vertexJoints)
+{
+	if (!palette || !jointCount || !vertexJoints || jointCount > MAX_SKINNING_JOINTS)
+	{
+		SkinningPalette = 0;
+		SkinningJointCount = 0;
+		SkinningVertexJoints = 0;
+		return;
+	}
+
+	SkinningPalette = palette;
+	SkinningJointCount = jointCount;
+	SkinningVertexJoints = vertexJoints;
+}
+
+
+//! sets the instances drawn by the following mesh buffer draw calls
+void CNullDriver::setInstanceData(const S3DInstance* instances, u32 instanceCount)
+{
+	if (!instances || !instanceCount)
+	{
+		InstanceData = 0;
+		InstanceCount = 0;
+		return;
+	}
+
+	InstanceData = instances;
+	InstanceCount = instanceCount;
 }
 
 
@@ -556,6 +676,10 @@ ITexture* CNullDriver::addTextureCubemap(const irr::u32 sideLen, const io::path&
 //! loads a Texture
 ITexture* CNullDriver::getTexture(const io::path& filename)
 {
+	// textures can only be created on the render thread
+	if (CWorkerPool::isWorkerThread())
+		return getDeferredTexture(filename);
+
 	// Identify textures by their absolute filenames if possible.
 	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
 
@@ -620,6 +744,9 @@ ITexture* CNullDriver::getTexture(io::IReadFile* file)
 {
 	ITexture* texture = 0;
 
+	if (file && CWorkerPool::isWorkerThread())
+		return getDeferredTexture(file->getFileName());
+
 	if (file)
 	{
 		texture = findTexture(file->getFileName());
@@ -647,6 +774,257 @@ ITexture* CNullDriver::getTexture(io::IReadFile* file)
 }
 
 
+//! loads a Texture in the background
+ITexture* CNullDriver::getTextureAsync(const io::path& filename, ITextureLoadCallBack* callBack)
+{
+	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
+
+	ITexture* texture = findTexture(absolutePath);
+	if (!texture)
+		texture = findTexture(filename);
+
+	io::IReadFile* file = 0;
+	if (!texture)
+	{
+		file = FileSystem->createAndOpenFile(absolutePath);
+		if (!file)
+			file = FileSystem->createAndOpenFile(filename);
+		if (!file)
+		{
+			os::Printer::log("Could not open file of texture", filename, ELL_WARNING);
+			return 0;
+		}
+
+		// Re-check name for actual archive names
+		texture = findTexture(file->getFileName());
+		if (texture)
+			file->drop();
+	}
+
+	if (texture)
+	{
+		texture->updateSource(ETS_FROM_CACHE);
+
+		if (callBack)
+		{
+			// still loading: call back together with the first request
+			for (u32 i=0; i<TextureLoads.size(); ++i)
+			{
+				if (TextureLoads[i]->Texture == texture)
+				{
+					callBack->grab();
+					TextureLoads[i]->CallBacks.push_back(callBack);
+					return texture;
+				}
+			}
+
+			callBack->OnTextureLoaded(texture, true);
+		}
+		return texture;
+	}
+
+	IImage* placeholder = new CImage(ECF_A8R8G8B8, core::dimension2d<u32>(1, 1));
+	placeholder->fill(SColor(0xffffffff));
+	texture = createDeviceDependentTexture(file->getFileName(), placeholder);
+	placeholder->drop();
+
+	if (!texture)
+	{
+		file->drop();
+		return 0;
+	}
+
+	texture->updateSource(ETS_FROM_FILE);
+	addTexture(texture);
+
+	// the load keeps the reference of the creation until the upload
+	STextureLoad* load = new STextureLoad(this, texture, file, TextureCreationFlags);
+	if (callBack)
+	{
+		callBack->grab();
+		load->CallBacks.push_back(callBack);
+	}
+	TextureLoads.push_back(load);
+
+	getWorkerPool().submit(load);
+
+	return texture;
+}
+
+
+void CNullDriver::STextureLoad::run()
+{
+	E_TEXTURE_TYPE type = ETT_2D;
+	core::array<IImage*> images = Driver->createImagesFromFile(File, &type);
+
+	// the worker is the only owner of the file
+	File->drop();
+	File = 0;
+
+	u32 i = 0;
+	if (type == ETT_2D && images.size() > 0 && images[0])
+		Image = images[i++];
+
+	for (; i < images.size(); ++i)
+	{
+		if (images[i])
+			images[i]->drop();
+	}
+
+	Decoded.store(true, std::memory_order_release);
+}
+
+
+void CNullDriver::setTextureUploadBudget(u32 bytes, u32 microseconds)
+{
+	TextureUploadBudgetBytes = bytes;
+	TextureUploadBudgetTime = microseconds;
+}
+
+
+u32 CNullDriver::getPendingTextureCount() const
+{
+	return TextureLoads.size();
+}
+
+
+ITexture* CNullDriver::getDeferredTexture(const io::path& filename)
+{
+	const u32 flags = getWorkerTextureCreationFlags(TextureCreationFlags);
+
+	std::lock_guard<std::mutex> lock(DeferredTextureMutex);
+	for (u32 i=0; i<DeferredTextures.size(); ++i)
+	{
+		if (DeferredTextures[i]->CreationFlags == flags && DeferredTextures[i]->getName().getPath() == filename)
+			return DeferredTextures[i];
+	}
+
+	SDeferredTexture* texture = new SDeferredTexture(filename, flags);
+	DeferredTextures.push_back(texture);
+	return texture;
+}
+
+
+ITexture* CNullDriver::resolveDeferredTexture(ITexture* texture)
+{
+	if (!texture)
+		return 0;
+
+	io::path filename;
+	u32 flags;
+	f32 amplitude;
+	{
+		std::lock_guard<std::mutex> lock(DeferredTextureMutex);
+		u32 i = 0;
+		while (i < DeferredTextures.size() && DeferredTextures[i] != texture)
+			++i;
+		if (i == DeferredTextures.size())
+			return texture;
+
+		filename = DeferredTextures[i]->getName().getPath();
+		flags = DeferredTextures[i]->CreationFlags;
+		amplitude = DeferredTextures[i]->NormalMapAmplitude;
+	}
+
+	const u32 previousFlags = TextureCreationFlags;
+	TextureCreationFlags = flags;
+	ITexture* result = getTextureAsync(filename);
+	TextureCreationFlags = previousFlags;
+
+	if (result && amplitude != 0.f)
+	{
+		for (u32 i=0; i<TextureLoads.size(); ++i)
+		{
+			if (TextureLoads[i]->Texture == result)
+			{
+				TextureLoads[i]->NormalMapAmplitude = amplitude;
+				return result;
+			}
+		}
+		makeNormalMapTexture(result, amplitude);
+	}
+
+	return result;
+}
+
+
+void CNullDriver::uploadLoadedTextures()
+{
+	if (TextureLoads.empty())
+		return;
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	u32 i = 0;
+	while (i < TextureLoads.size())
+	{
+		STextureLoad* load = TextureLoads[i];
+		if (!load->Decoded.load(std::memory_order_acquire))
+		{
+			++i;
+			continue;
+		}
+
+		bool success = false;
+		if (load->Image)
+		{
+			const u32 bytes = load->Image->getImageDataSizeInBytes();
+
+			// at least one upload per frame, so big images get through
+			if (FrameStatistics.TexturesUploaded > 0)
+			{
+				if (TextureUploadBudgetBytes && FrameStatistics.TextureUploadBytes + bytes > TextureUploadBudgetBytes)
+					break;
+				if (TextureUploadBudgetTime && std::chrono::duration_cast<std::chrono::microseconds>(
+						std::chrono::steady_clock::now() - start).count() >= TextureUploadBudgetTime)
+					break;
+			}
+
+			core::array<IImage*> images;
+			images.push_back(load->Image);
+			if (checkImage(images))
+			{
+				const u32 flags = TextureCreationFlags;
+				TextureCreationFlags = load->CreationFlags;
+				replaceTextureImage(load->Texture, load->Image);
+				TextureCreationFlags = flags;
+
+				if (load->NormalMapAmplitude != 0.f)
+					makeNormalMapTexture(load->Texture, load->NormalMapAmplitude);
+
+				++FrameStatistics.TexturesUploaded;
+				FrameStatistics.TextureUploadBytes += bytes;
+				success = true;
+			}
+			load->Image->drop();
+		}
+
+		TextureLoads.erase(i);
+
+		if (success)
+			os::Printer::log("Loaded texture", load->Texture->getName().getPath(), ELL_DEBUG);
+		else // the placeholder stays, materials may already use it
+			os::Printer::log("Could not load texture", load->Texture->getName().getPath(), ELL_ERROR);
+
+		for (u32 j=0; j<load->CallBacks.size(); ++j)
+		{
+			load->CallBacks[j]->OnTextureLoaded(load->Texture, success);
+			load->CallBacks[j]->drop();
+		}
+		load->Texture->drop();
+		delete load;
+	}
+
+	for (u32 j=0; j<TextureLoads.size(); ++j)
+	{
+		if (TextureLoads[j]->Decoded.load(std::memory_order_acquire))
+			++FrameStatistics.TextureUploadsPending;
+		else
+			++FrameStatistics.TextureLoadsPending;
+	}
+}
+
+
 //! opens the file and loads it into the surface
 video::ITexture* CNullDriver::loadTextureFromFile(io::IReadFile* file, const io::path& hashName )
 {
@@ -725,7 +1103,10 @@ video::ITexture* CNullDriver::findTexture(const io::path& filename)
 
 ITexture* CNullDriver::createDeviceDependentTexture(const io::path& name, IImage* image)
 {
-	return new SDummyTexture(name, ETT_2D);
+	SDummyTexture* texture = new SDummyTexture(name, ETT_2D);
+	if (image)
+		texture->setImageValues(image);
+	return texture;
 }
 
 ITexture* CNullDriver::createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image)
@@ -733,6 +1114,11 @@ ITexture* CNullDriver::createDeviceDependentTextureCubemap(const io::path& name,
 	return new SDummyTexture(name, ETT_CUBEMAP);
 }
 
+void CNullDriver::replaceTextureImage(ITexture* texture, IImage* image)
+{
+	static_cast<SDummyTexture*>(texture)->setImageValues(image);
+}
+
 bool CNullDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil)
 {
 	return false;
@@ -794,7 +1180,8 @@ void CNullDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
 {
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
-	PrimitivesDrawn += primitiveCount;
+	FrameStatistics.PrimitivesDrawn += InstanceData ? primitiveCount*InstanceCount : primitiveCount;
+	++FrameStatistics.DrawCalls;
 }
 
 
@@ -803,7 +1190,8 @@ void CNullDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCoun
 {
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
-	PrimitivesDrawn += primitiveCount;
+	FrameStatistics.PrimitivesDrawn += primitiveCount;
+	++FrameStatistics.DrawCalls;
 }
 
 
@@ -1051,6 +1439,34 @@ u32 CNullDriver::getPrimitiveCountDrawn( u32 param ) const
 }
 
 
+//! Returns amount of calls to setMaterial() in the last frame.
+u32 CNullDriver::getMaterialChangeCount(bool redundant) const
+{
+	return redundant ? LastFrameStatistics.RedundantMaterialChanges : LastFrameStatistics.MaterialChanges;
+}
+
+
+//! Returns amount of texture binds in the last frame.
+u32 CNullDriver::getTextureBindCount(bool redundant) const
+{
+	return redundant ? LastFrameStatistics.RedundantTextureBinds : LastFrameStatistics.TextureBinds;
+}
+
+
+//! Returns amount of draw calls in the last frame.
+u32 CNullDriver::getDrawCallCount() const
+{
+	return LastFrameStatistics.DrawCalls;
+}
+
+
+//! Get the counters of a past frame, can be called from any thread
+bool CNullDriver::getFrameStatistics(SDriverFrameStatistics& statistics, u32 framesAgo) const
+{
+	return FrameStatisticsRing.get(statistics, framesAgo);
+}
+
+
 
 //! Sets the dynamic ambient light color. The default color is
 //! (0,0,0,0) which means it is dark.
@@ -1297,6 +1713,19 @@ void CNullDriver::makeNormalMapTexture(video::ITexture* texture, f32 amplitude)
 	if (!texture)
 		return;
 
+	// a stand-in is converted after its texture was loaded
+	{
+		std::lock_guard<std::mutex> lock(DeferredTextureMutex);
+		for (u32 i=0; i<DeferredTextures.size(); ++i)
+		{
+			if (DeferredTextures[i] == texture)
+			{
+				DeferredTextures[i]->NormalMapAmplitude = amplitude;
+				return;
+			}
+		}
+	}
+
 	if (texture->getColorFormat() != ECF_A1R5G5B5 &&
 		texture->getColorFormat() != ECF_A8R8G8B8 )
 	{
@@ -1531,6 +1960,26 @@ void CNullDriver::setTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag, bool enab
 		setTextureCreationFlag(ETCF_OPTIMIZED_FOR_SPEED, false);
 	}
 
+	if (CWorkerPool::isWorkerThread())
+	{
+		if (WorkerFlagsTask != CWorkerPool::getTaskNumber())
+		{
+			WorkerFlagsTask = CWorkerPool::getTaskNumber();
+			WorkerFlagsMask = 0;
+		}
+
+		// keep a change only while it differs from the render thread
+		const u32 value = enabled ? (u32)flag : 0;
+		if ((TextureCreationFlags & flag) == value)
+			WorkerFlagsMask &= ~flag;
+		else
+		{
+			WorkerFlagsMask |= flag;
+			WorkerFlagsValues = (WorkerFlagsValues & ~flag) | value;
+		}
+		return;
+	}
+
 	// set flag
 	TextureCreationFlags = (TextureCreationFlags & (~flag)) |
 		((((u32)!enabled)-1) & flag);
@@ -1540,6 +1989,9 @@ void CNullDriver::setTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag, bool enab
 //! Returns if a texture creation flag is enabled or disabled.
 bool CNullDriver::getTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag) const
 {
+	if (CWorkerPool::isWorkerThread())
+		return (getWorkerTextureCreationFlags(TextureCreationFlags) & flag)!=0;
+
 	return (TextureCreationFlags & flag)!=0;
 }
 
@@ -1769,6 +2221,12 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 	if (!mb)
 		return;
 
+	if (InstanceData && !canDrawInstances(mb))
+	{
+		drawExpandedInstances(mb);
+		return;
+	}
+
 	//IVertexBuffer and IIndexBuffer later
 	SHWBufferLink *HWBuffer=getBufferLink(mb);
 
@@ -1779,6 +2237,116 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
+//! Draws the instances of a mesh buffer by expanding them on the CPU
+void CNullDriver::drawExpandedInstances(const scene::IMeshBuffer* mb)
+{
+	const S3DInstance* instances = InstanceData;
+	const u32 instanceCount = InstanceCount;
+
+	// the expanded geometry is drawn as a single instance
+	InstanceData = 0;
+	InstanceCount = 0;
+
+	const u32 vertexCount = mb->getVertexCount();
+	const u32 indexCount = mb->getIndexCount();
+	const scene::E_PRIMITIVE_TYPE pType = mb->getPrimitiveType();
+	const bool list = pType == scene::EPT_TRIANGLES || pType == scene::EPT_LINES || pType == scene::EPT_POINTS;
+
+	if (!list || !vertexCount || vertexCount > 65536)
+	{
+		// instances can't be merged, draw them one by one
+		const core::matrix4 world = getTransform(ETS_WORLD);
+		for (u32 i=0; i<instanceCount; ++i)
+		{
+			setTransform(ETS_WORLD, world * instances[i].Transformation);
+			drawMeshBuffer(mb);
+		}
+		setTransform(ETS_WORLD, world);
+
+		InstanceData = instances;
+		InstanceCount = instanceCount;
+		return;
+	}
+
+	// as many instances per draw call as 16 bit indices can address
+	const E_VERTEX_TYPE vType = mb->getVertexType();
+	const u32 pitch = getVertexPitchFromType(vType);
+	const u32 chunkInstances = core::min_(instanceCount, 65536u / vertexCount);
+	ExpandedVertices.set_used(chunkInstances * vertexCount * pitch);
+	ExpandedIndices.set_used(chunkInstances * indexCount);
+
+	// the indices are the same for all chunks
+	const u16* indices16 = mb->getIndexType() == EIT_16BIT ? mb->getIndices() : 0;
+	const u32* indices32 = mb->getIndexType() == EIT_32BIT ? reinterpret_cast<const u32*>(mb->getIndices()) : 0;
+	u16* index = ExpandedIndices.pointer();
+	for (u32 i=0; i<chunkInstances; ++i)
+	{
+		const u32 offset = i * vertexCount;
+		for (u32 j=0; j<indexCount; ++j)
+			*index++ = (u16)(offset + (indices16 ? indices16[j] : indices32[j]));
+	}
+
+	for (u32 first=0; first<instanceCount; first+=chunkInstances)
+	{
+		const u32 count = core::min_(chunkInstances, instanceCount - first);
+
+		u8* vertices = ExpandedVertices.pointer();
+		for (u32 i=0; i<count; ++i)
+		{
+			const S3DInstance& instance = instances[first + i];
+			const core::matrix4& m = instance.Transformation;
+			const bool modulate = instance.Color.color != 0xffffffff;
+
+			// scaled instances need the inverse transposed matrix for the
+			// normals, and all directions normalized again
+			const bool scaled = !m.getScale().equals(core::vector3df(1.f, 1.f, 1.f));
+			core::matrix4 normalMatrix(m);
+			if (scaled)
+			{
+				core::matrix4 inverse;
+				if (m.getInverse(inverse))
+					normalMatrix = inverse.getTransposed();
+			}
+
+			memcpy(vertices, mb->getVertices(), vertexCount * pitch);
+			for (u32 j=0; j<vertexCount; ++j, vertices+=pitch)
+			{
+				// all vertex types start with the members of S3DVertex
+				S3DVertex* v = reinterpret_cast<S3DVertex*>(vertices);
+				m.transformVect(v->Pos);
+				normalMatrix.rotateVect(v->Normal);
+				if (scaled)
+					v->Normal.normalize();
+				if (modulate)
+				{
+					v->Color.set((v->Color.getAlpha() * instance.Color.getAlpha()) / 255,
+						(v->Color.getRed() * instance.Color.getRed()) / 255,
+						(v->Color.getGreen() * instance.Color.getGreen()) / 255,
+						(v->Color.getBlue() * instance.Color.getBlue()) / 255);
+				}
+				if (vType == EVT_TANGENTS)
+				{
+					S3DVertexTangents* t = reinterpret_cast<S3DVertexTangents*>(vertices);
+					m.rotateVect(t->Tangent);
+					m.rotateVect(t->Binormal);
+					if (scaled)
+					{
+						t->Tangent.normalize();
+						t->Binormal.normalize();
+					}
+				}
+			}
+		}
+
+		drawVertexPrimitiveList(ExpandedVertices.const_pointer(), count * vertexCount,
+			ExpandedIndices.const_pointer(), count * mb->getPrimitiveCount(), vType, pType, EIT_16BIT);
+	}
+
+	InstanceData = instances;
+	InstanceCount = instanceCount;
+}
+
+
 //! Draws the normals of a mesh buffer
 void CNullDriver::drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length, SColor color)
 {
@@ -1803,9 +2371,9 @@ CNullDriver::SHWBufferLink *CNullDriver::getBufferLink(const scene::IMeshBuffer*
 		return 0;
 
 	//search for hardware links
-	core::map< const scene::IMeshBuffer*,SHWBufferLink* >::Node* node = HWBufferMap.find(mb);
-	if (node)
-		return node->getValue();
+	std::unordered_map< const scene::IMeshBuffer*,SHWBufferLink* >::const_iterator it = HWBufferMap.find(mb);
+	if (it != HWBufferMap.end())
+		return it->second;
 
 	return createHardwareBuffer(mb); //no hardware links, and mesh wants one, create it
 }
@@ -1814,29 +2382,38 @@ CNullDriver::SHWBufferLink *CNullDriver::getBufferLink(const scene::IMeshBuffer*
 //! Update all hardware buffers, remove unused ones
 void CNullDriver::updateAllHardwareBuffers()
 {
-	core::map<const scene::IMeshBuffer*,SHWBufferLink*>::ParentFirstIterator Iterator=HWBufferMap.getParentFirstIterator();
-
-	for (;!Iterator.atEnd();Iterator++)
+	for (u32 i=0; i<HWBufferLinks.size(); )
 	{
-		SHWBufferLink *Link=Iterator.getNode()->getValue();
+		SHWBufferLink *Link=HWBufferLinks[i];
 
 		Link->LastUsed++;
 		if (Link->LastUsed>20000)
-		{
-			deleteHardwareBuffer(Link);
-
-			// todo: needs better fix
-			Iterator = HWBufferMap.getParentFirstIterator();
-		}
+			deleteHardwareBuffer(Link); // moves the last link to i, which is checked next
+		else
+			++i;
 	}
 }
 
 
+void CNullDriver::addHardwareBufferLink(SHWBufferLink *HWBuffer)
+{
+	HWBuffer->ListIndex = HWBufferLinks.size();
+	HWBufferLinks.push_back(HWBuffer);
+	HWBufferMap[HWBuffer->MeshBuffer] = HWBuffer;
+}
+
+
 void CNullDriver::deleteHardwareBuffer(SHWBufferLink *HWBuffer)
 {
 	if (!HWBuffer)
 		return;
-	HWBufferMap.remove(HWBuffer->MeshBuffer);
+	HWBufferMap.erase(HWBuffer->MeshBuffer);
+
+	SHWBufferLink *last = HWBufferLinks.getLast();
+	last->ListIndex = HWBuffer->ListIndex;
+	HWBufferLinks[HWBuffer->ListIndex] = last;
+	HWBufferLinks.set_used(HWBufferLinks.size()-1);
+
 	delete HWBuffer;
 }
 
@@ -1844,17 +2421,17 @@ void CNullDriver::deleteHardwareBuffer(SHWBufferLink *HWBuffer)
 //! Remove hardware buffer
 void CNullDriver::removeHardwareBuffer(const scene::IMeshBuffer* mb)
 {
-	core::map<const scene::IMeshBuffer*,SHWBufferLink*>::Node* node = HWBufferMap.find(mb);
-	if (node)
-		deleteHardwareBuffer(node->getValue());
+	std::unordered_map<const scene::IMeshBuffer*,SHWBufferLink*>::const_iterator it = HWBufferMap.find(mb);
+	if (it != HWBufferMap.end())
+		deleteHardwareBuffer(it->second);
 }
 
 
 //! Remove all hardware buffers
 void CNullDriver::removeAllHardwareBuffers()
 {
-	while (HWBufferMap.size())
-		deleteHardwareBuffer(HWBufferMap.getRoot()->getValue());
+	while (HWBufferLinks.size())
+		deleteHardwareBuffer(HWBufferLinks.getLast());
 }
 
 
@@ -2728,6 +3305,18 @@ void CNullDriver::setMinHardwareBufferVertexCount(u32 count)
 }
 
 
+void CNullDriver::setStreamingBufferSize(u32 size)
+{
+	StreamingBufferSize = size;
+}
+
+
+u32 CNullDriver::getStreamingBufferSize() const
+{
+	return StreamingBufferSize;
+}
+
+
 SOverrideMaterial& CNullDriver::getOverrideMaterial()
 {
 	return OverrideMaterial;
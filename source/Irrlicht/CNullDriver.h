@@ -17,10 +17,15 @@
 #include "IMeshBuffer.h"
 #include "IMeshSceneNode.h"
 #include "CFPSCounter.h"
+#include "CFrameStatisticsRing.h"
 #include "S3DVertex.h"
 #include "SVertexIndex.h"
 #include "SLight.h"
 #include "SExposedVideoData.h"
+#include "CWorkerPool.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 #ifdef _MSC_VER
 #pragma warning( disable: 4996)
@@ -80,12 +85,40 @@ namespace video
 		//! sets a material
 		virtual void setMaterial(const SMaterial& material) _IRR_OVERRIDE_;
 
+		//! sets the joint palette and joint stream for hardware skinning
+		virtual void setSkinningData(const core::matrix4* palette, u32 jointCount,
+			const S3DVertexJoints* vertexJoints) _IRR_OVERRIDE_;
+
+		//! Returns the joint palette set with setSkinningData, or 0
+		const core::matrix4* getSkinningPalette() const { return SkinningPalette; }
+
+		//! Returns the amount of matrices in the skinning palette
+		u32 getSkinningJointCount() const { return SkinningJointCount; }
+
+		//! Returns the joint stream set with setSkinningData, or 0
+		const S3DVertexJoints* getSkinningVertexJoints() const { return SkinningVertexJoints; }
+
+		//! sets the instances drawn by the following mesh buffer draw calls
+		virtual void setInstanceData(const S3DInstance* instances, u32 instanceCount) _IRR_OVERRIDE_;
+
 		//! loads a Texture
 		virtual ITexture* getTexture(const io::path& filename) _IRR_OVERRIDE_;
 
 		//! loads a Texture
 		virtual ITexture* getTexture(io::IReadFile* file) _IRR_OVERRIDE_;
 
+		//! loads a Texture in the background
+		virtual ITexture* getTextureAsync(const io::path& filename, ITextureLoadCallBack* callBack=0) _IRR_OVERRIDE_;
+
+		//! Set how much texture data endScene() uploads per frame
+		virtual void setTextureUploadBudget(u32 bytes, u32 microseconds) _IRR_OVERRIDE_;
+
+		//! Get the amount of textures loading in the background
+		virtual u32 getPendingTextureCount() const _IRR_OVERRIDE_;
+
+		//! Get the texture a loader on a worker thread asked for
+		virtual ITexture* resolveDeferredTexture(ITexture* texture) _IRR_OVERRIDE_;
+
 		//! Returns a texture by index
 		virtual ITexture* getTextureByIndex(u32 index) _IRR_OVERRIDE_;
 
@@ -253,6 +286,18 @@ namespace video
 		//! very useful method for statistics.
 		virtual u32 getPrimitiveCountDrawn( u32 param = 0 ) const _IRR_OVERRIDE_;
 
+		//! Returns amount of calls to setMaterial() in the last frame.
+		virtual u32 getMaterialChangeCount(bool redundant=false) const _IRR_OVERRIDE_;
+
+		//! Returns amount of texture binds in the last frame.
+		virtual u32 getTextureBindCount(bool redundant=false) const _IRR_OVERRIDE_;
+
+		//! Returns amount of draw calls in the last frame.
+		virtual u32 getDrawCallCount() const _IRR_OVERRIDE_;
+
+		//! Get the counters of a past frame, can be called from any thread
+		virtual bool getFrameStatistics(SDriverFrameStatistics& statistics, u32 framesAgo=0) const _IRR_OVERRIDE_;
+
 		//! deletes all dynamic lights there are
 		virtual void deleteAllDynamicLights() _IRR_OVERRIDE_;
 
@@ -396,7 +441,7 @@ namespace video
 		{
 			SHWBufferLink(const scene::IMeshBuffer *_MeshBuffer)
 				:MeshBuffer(_MeshBuffer),
-				ChangedID_Vertex(0),ChangedID_Index(0),LastUsed(0),
+				ChangedID_Vertex(0),ChangedID_Index(0),LastUsed(0),ListIndex(0),
 				Mapped_Vertex(scene::EHM_NEVER),Mapped_Index(scene::EHM_NEVER)
 			{
 				if (MeshBuffer)
@@ -413,6 +458,7 @@ namespace video
 			u32 ChangedID_Vertex;
 			u32 ChangedID_Index;
 			u32 LastUsed;
+			u32 ListIndex; // position in HWBufferLinks
 			scene::E_HARDWARE_MAPPING Mapped_Vertex;
 			scene::E_HARDWARE_MAPPING Mapped_Index;
 		};
@@ -429,6 +475,9 @@ namespace video
 		//! Delete hardware buffer
 		virtual void deleteHardwareBuffer(SHWBufferLink *HWBuffer);
 
+		//! Register a new hardware buffer, called by createHardwareBuffer
+		void addHardwareBufferLink(SHWBufferLink *HWBuffer);
+
 		//! Create hardware buffer from mesh (only some drivers can)
 		virtual SHWBufferLink *createHardwareBuffer(const scene::IMeshBuffer* mb) {return 0;}
 
@@ -651,6 +700,12 @@ namespace video
 		/** \param count Number of vertices to set as minimum. */
 		virtual void setMinHardwareBufferVertexCount(u32 count) _IRR_OVERRIDE_;
 
+		//! Set the size of the buffer which streams vertices and indices from client memory
+		virtual void setStreamingBufferSize(u32 size) _IRR_OVERRIDE_;
+
+		//! Get the size of the buffer which streams vertices and indices from client memory
+		virtual u32 getStreamingBufferSize() const _IRR_OVERRIDE_;
+
 		//! Get the global Material, which might override local materials.
 		/** Depending on the enable flags, values from this Material
 		are used to override those of local materials of some
@@ -706,9 +761,63 @@ namespace video
 
 		virtual ITexture* createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image);
 
+		//! Replace the placeholder image of a texture from getTextureAsync()
+		/** The texture was created by createDeviceDependentTexture(). */
+		virtual void replaceTextureImage(ITexture* texture, IImage* image);
+
+		//! Upload the decoded textures from getTextureAsync() within the budget
+		void uploadLoadedTextures();
+
+		//! Get the stand-in for a texture asked for by a worker thread
+		ITexture* getDeferredTexture(const io::path& filename);
+
 		//! checks triangle count and print warning if wrong
 		bool checkPrimitiveCount(u32 prmcnt) const;
 
+		//! Count the material change and texture binds of a setMaterial() call
+		void countMaterialChange(const SMaterial& material);
+
+		//! Count a copy into a vertex or index hardware buffer
+		void countBufferUpload(u32 bytes)
+		{
+			++FrameStatistics.BufferUploads;
+			FrameStatistics.BufferUploadBytes += bytes;
+		}
+
+		//! Get the amount of indices a draw call reads
+		static u32 getIndexCount(scene::E_PRIMITIVE_TYPE pType, u32 primitiveCount)
+		{
+			switch (pType)
+			{
+				case scene::EPT_POINTS:
+				case scene::EPT_POINT_SPRITES:
+					return 0;
+				case scene::EPT_LINE_STRIP:
+					return primitiveCount+1;
+				case scene::EPT_LINE_LOOP:
+				case scene::EPT_POLYGON:
+					return primitiveCount;
+				case scene::EPT_LINES:
+					return primitiveCount*2;
+				case scene::EPT_TRIANGLE_STRIP:
+				case scene::EPT_TRIANGLE_FAN:
+					return primitiveCount+2;
+				case scene::EPT_TRIANGLES:
+					return primitiveCount*3;
+				case scene::EPT_QUAD_STRIP:
+					return primitiveCount*2+2;
+				case scene::EPT_QUADS:
+					return primitiveCount*4;
+			}
+			return 0;
+		}
+
+		//! Check if the driver draws the instances of a buffer with the current material in one call
+		virtual bool canDrawInstances(const scene::IMeshBuffer* mb) const { return false; }
+
+		//! Draw the instances of a buffer by expanding them on the CPU
+		void drawExpandedInstances(const scene::IMeshBuffer* mb);
+
 		bool checkImage(const core::array<IImage*>& image) const;
 
 		// adds a material renderer and drops it afterwards. To be used for internal creation
@@ -783,12 +892,60 @@ namespace video
 		{
 			SDummyTexture(const io::path& name, E_TEXTURE_TYPE type) : ITexture(name, type) {};
 
+			void setImageValues(const IImage* image)
+			{
+				OriginalSize = Size = image->getDimension();
+				OriginalColorFormat = ColorFormat = image->getColorFormat();
+				Pitch = image->getPitch();
+			}
+
 			virtual void* lock(E_TEXTURE_LOCK_MODE mode = ETLM_READ_WRITE, u32 mipmapLevel=0, u32 layer = 0, E_TEXTURE_LOCK_FLAGS lockFlags = ETLF_FLIP_Y_UP_RTT) _IRR_OVERRIDE_ { return 0; }
 			virtual void unlock()_IRR_OVERRIDE_ {}
 			virtual void regenerateMipMapLevels(void* data = 0, u32 layer = 0) _IRR_OVERRIDE_ {}
 		};
 		core::array<SSurface> Textures;
 
+		//! A texture requested with getTextureAsync()
+		struct STextureLoad : public IWorkerTask
+		{
+			STextureLoad(CNullDriver* driver, ITexture* texture, io::IReadFile* file, u32 creationFlags)
+				: Driver(driver), Texture(texture), File(file), CreationFlags(creationFlags),
+				Image(0), Decoded(false), NormalMapAmplitude(0.f) {}
+
+			//! Decodes the file on a worker thread
+			virtual void run() _IRR_OVERRIDE_;
+
+			CNullDriver* Driver;
+			ITexture* Texture;
+			//! Owned by the worker until Decoded is set, dropped by it
+			io::IReadFile* File;
+			core::array<ITextureLoadCallBack*> CallBacks;
+			u32 CreationFlags;
+			//! The decoded image, 0 if the file could not be loaded
+			IImage* Image;
+			//! Set by the worker when Image can be used by the render thread
+			std::atomic<bool> Decoded;
+			//! Amplitude for makeNormalMapTexture() after the upload, 0 for none
+			f32 NormalMapAmplitude;
+		};
+		//! Loads in the order of their request, until their upload
+		core::array<STextureLoad*> TextureLoads;
+		u32 TextureUploadBudgetBytes;
+		u32 TextureUploadBudgetTime;
+
+		//! Stand-in for a texture asked for by a worker thread, see resolveDeferredTexture()
+		struct SDeferredTexture : public SDummyTexture
+		{
+			SDeferredTexture(const io::path& name, u32 creationFlags)
+				: SDummyTexture(name, ETT_2D), CreationFlags(creationFlags), NormalMapAmplitude(0.f) {}
+
+			u32 CreationFlags;
+			f32 NormalMapAmplitude;
+		};
+		//! Stand-ins are kept until all textures are deleted, meshes still loading might use them
+		core::array<SDeferredTexture*> DeferredTextures;
+		mutable std::mutex DeferredTextureMutex;
+
 		struct SOccQuery
 		{
 			SOccQuery(scene::ISceneNode* node, const scene::IMesh* mesh=0) : Node(node), Mesh(mesh), PID(0), Result(0xffffffff), Run(0xffffffff)
@@ -860,8 +1017,9 @@ namespace video
 		core::array<SLight> Lights;
 		core::array<SMaterialRenderer> MaterialRenderers;
 
-		//core::array<SHWBufferLink*> HWBufferLinks;
-		core::map< const scene::IMeshBuffer* , SHWBufferLink* > HWBufferMap;
+		// all links for the garbage collection sweep, and by meshbuffer for drawing
+		core::array<SHWBufferLink*> HWBufferLinks;
+		std::unordered_map< const scene::IMeshBuffer* , SHWBufferLink* > HWBufferMap;
 
 		io::IFileSystem* FileSystem;
 
@@ -874,10 +1032,26 @@ namespace video
 
 		CFPSCounter FPSCounter;
 
-		u32 PrimitivesDrawn;
+		//! Counters of the current frame, published to FrameStatisticsRing in endScene()
+		SDriverFrameStatistics FrameStatistics;
+		SDriverFrameStatistics LastFrameStatistics;
+		CFrameStatisticsRing<SDriverFrameStatistics> FrameStatisticsRing;
+		SMaterial CountedMaterial;
 		u32 MinVertexCountForVBO;
+		u32 StreamingBufferSize;
+
+		//! Atomic as worker threads read it, see resolveDeferredTexture()
+		std::atomic<u32> TextureCreationFlags;
+
+		const core::matrix4* SkinningPalette;
+		u32 SkinningJointCount;
+		const S3DVertexJoints* SkinningVertexJoints;
 
-		u32 TextureCreationFlags;
+		const S3DInstance* InstanceData;
+		u32 InstanceCount;
+		//! Scratch buffers for drawExpandedInstances
+		core::array<u8> ExpandedVertices;
+		core::array<u16> ExpandedIndices;
 
 		f32 FogStart;
 		f32 FogEnd;
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "COBJMeshFileLoader.h"
+#include "CMappedReadFile.h"
 #include "CMeshTextureLoader.h"
 #include "IMeshManipulator.h"
 #include "IVideoDriver.h"
@@ -86,9 +87,16 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	const io::path fullName = file->getFileName();
 	const io::path relPath = FileSystem->getFileDir(fullName)+"/";
 
-	c8* buf = new c8[filesize];
-	memset(buf, 0, filesize);
-	file->read((void*)buf, filesize);
+	// a file in memory is parsed in place
+	c8* fileBuf = 0;
+	const c8* buf = (const c8*)io::getReadFileMemory(file);
+	if (!buf)
+	{
+		fileBuf = new c8[filesize];
+		memset(fileBuf, 0, filesize);
+		file->read((void*)fileBuf, filesize);
+		buf = fileBuf;
+	}
 	const c8* const bufEnd = buf+filesize;
 
 	// Process obj information
@@ -240,7 +248,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 				else
 				{
 					os::Printer::log("Invalid vertex index in this line:", wordBuffer.c_str(), ELL_ERROR);
-					delete [] buf;
+					delete [] fileBuf;
 					return 0;
 				}
 				if ( -1 != Idx[1] && Idx[1] < (irr::s32)textureCoordBuffer.size() )
@@ -347,7 +355,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	}
 
 	// Clean up the allocate obj file contents
-	delete [] buf;
+	delete [] fileBuf;
 	// more cleaning up
 	cleanUp();
 	mesh->drop();
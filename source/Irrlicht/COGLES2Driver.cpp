@@ -30,7 +30,7 @@ COGLES2Driver::COGLES2Driver(const SIrrlichtCreationParameters& params, io::IFil
 	CNullDriver(io, params.WindowSize), COGLES2ExtensionHandler(), CacheHandler(0),
 	Params(params), ResetRenderStates(true), LockRenderStateMode(false), AntiAlias(params.AntiAlias),
 	MaterialRenderer2DActive(0), MaterialRenderer2DTexture(0), MaterialRenderer2DNoTexture(0),
-	CurrentRenderMode(ERM_NONE), Transformation3DChanged(true),
+	SkinnedMaterialType(-1), InstancedMaterialType(-1), CurrentRenderMode(ERM_NONE), Transformation3DChanged(true),
 	OGLES2ShaderPath(params.OGLES2ShaderPath),
 	ColorFormat(ECF_R8G8B8)
 {
@@ -80,6 +80,10 @@ COGLES2Driver::~COGLES2Driver()
 	deleteAllTextures();
 	removeAllOcclusionQueries();
 	removeAllHardwareBuffers();
+	if (StreamVertexBuffer.ID)
+		glDeleteBuffers(1, &StreamVertexBuffer.ID);
+	if (StreamIndexBuffer.ID)
+		glDeleteBuffers(1, &StreamIndexBuffer.ID);
 
 	delete MaterialRenderer2DTexture;
 	delete MaterialRenderer2DNoTexture;
@@ -215,6 +219,8 @@ COGLES2Driver::~COGLES2Driver()
 		COGLES2MaterialSolidCB* TransparentAlphaChannelCB = new COGLES2MaterialSolidCB();
 		COGLES2MaterialSolidCB* TransparentAlphaChannelRefCB = new COGLES2MaterialSolidCB();
 		COGLES2MaterialSolidCB* TransparentVertexAlphaCB = new COGLES2MaterialSolidCB();
+		COGLES2MaterialSkinnedCB* SkinnedCB = new COGLES2MaterialSkinnedCB();
+		COGLES2MaterialSolidCB* InstancedCB = new COGLES2MaterialSolidCB();
 
 		// Create built-in materials.
 
@@ -260,6 +266,22 @@ COGLES2Driver::~COGLES2Driver()
 		addMaterialRenderer(getMaterialRenderer(0));
 		addMaterialRenderer(getMaterialRenderer(0));
 
+		// Skinned variant of EMT_SOLID, used while skinning data is set.
+
+		VertexShader = OGLES2ShaderPath + "COGLES2Skinned.vsh";
+		FragmentShader = OGLES2ShaderPath + "COGLES2Solid.fsh";
+		SkinnedMaterialType = addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
+			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, SkinnedCB, EMT_SOLID, 0);
+
+		// Instanced variant of EMT_SOLID, used while instances are set.
+
+		if (hasInstancing())
+		{
+			VertexShader = OGLES2ShaderPath + "COGLES2Instanced.vsh";
+			InstancedMaterialType = addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
+				EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, InstancedCB, EMT_SOLID, 0);
+		}
+
 		// Drop callbacks.
 
 		SolidCB->drop();
@@ -267,6 +289,8 @@ COGLES2Driver::~COGLES2Driver()
 		TransparentAlphaChannelCB->drop();
 		TransparentAlphaChannelRefCB->drop();
 		TransparentVertexAlphaCB->drop();
+		SkinnedCB->drop();
+		InstancedCB->drop();
 
 		// Create 2D material renderers
 
@@ -374,6 +398,7 @@ COGLES2Driver::~COGLES2Driver()
 		glBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
 
 		// copy data to graphics card
+		countBufferUpload(vertexCount * vertexSize);
 		if (!newBuffer)
 			glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * vertexSize, buffer.const_pointer());
 		else
@@ -439,6 +464,7 @@ COGLES2Driver::~COGLES2Driver()
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
 
 		// copy data to graphics card
+		countBufferUpload(indexCount * indexSize);
 		if (!newBuffer)
 			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount * indexSize, indices);
 		else
@@ -502,7 +528,7 @@ COGLES2Driver::~COGLES2Driver()
 		SHWBufferLink_opengl *HWBuffer = new SHWBufferLink_opengl(mb);
 
 		//add to map
-		HWBufferMap.insert(HWBuffer->MeshBuffer, HWBuffer);
+		addHardwareBufferLink(HWBuffer);
 
 		HWBuffer->ChangedID_Vertex = HWBuffer->MeshBuffer->getChangedID_Vertex();
 		HWBuffer->ChangedID_Index = HWBuffer->MeshBuffer->getChangedID_Index();
@@ -603,6 +629,59 @@ COGLES2Driver::~COGLES2Driver()
 	}
 
 
+	bool COGLES2Driver::streamVertices(const void*& vertices, u32 vertexCount,
+			const void*& indexList, u32 indexCount, E_VERTEX_TYPE vType, E_INDEX_TYPE iType)
+	{
+		if (!vertices || !StreamingBufferSize)
+			return false;
+
+		const u32 vertexSize = vertexCount*getVertexPitchFromType(vType);
+		const u32 indexSize = indexList ? indexCount*(iType == EIT_32BIT ? 4 : 2) : 0;
+		if (vertexSize > StreamingBufferSize || indexSize > StreamingBufferSize)
+		{
+			++FrameStatistics.StreamBufferOverflows;
+			return false;
+		}
+
+		// the colors are swizzled by the shaders, the data is copied as it is
+		const u32 vertexOffset = reserveStreamBuffer(StreamVertexBuffer, GL_ARRAY_BUFFER, vertexSize);
+		glBufferSubData(GL_ARRAY_BUFFER, vertexOffset, vertexSize, vertices);
+		vertices = buffer_offset(vertexOffset);
+		if (indexSize)
+		{
+			const u32 indexOffset = reserveStreamBuffer(StreamIndexBuffer, GL_ELEMENT_ARRAY_BUFFER, indexSize);
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexOffset, indexSize, indexList);
+			indexList = buffer_offset(indexOffset);
+		}
+		countBufferUpload(vertexSize + indexSize);
+
+		return true;
+	}
+
+
+	u32 COGLES2Driver::reserveStreamBuffer(SStreamBuffer& buffer, GLenum target, u32 size)
+	{
+		if (!buffer.ID)
+			glGenBuffers(1, &buffer.ID);
+		glBindBuffer(target, buffer.ID);
+
+		if (buffer.Allocated != StreamingBufferSize || buffer.Offset + size > buffer.Allocated)
+		{
+			// orphan the storage, the driver keeps it for the draws which still read from it
+			if (buffer.Allocated == StreamingBufferSize)
+				++FrameStatistics.StreamBufferWraps;
+			glBufferData(target, StreamingBufferSize, 0, GL_STREAM_DRAW);
+			buffer.Allocated = StreamingBufferSize;
+			buffer.Offset = 0;
+		}
+
+		// each block starts aligned
+		const u32 offset = buffer.Offset;
+		buffer.Offset += (size + 15) & ~15;
+		return offset;
+	}
+
+
 	//! draws a vertex primitive list
 	void COGLES2Driver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
 			const void* indexList, u32 primitiveCount,
@@ -618,6 +697,10 @@ COGLES2Driver::~COGLES2Driver()
 
 		CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 
+		// a stream offset of 0 leaves vertices 0, which takes the hardware buffer path below with the same offsets
+		const bool clientIndices = indexList != 0;
+		const bool streamed = streamVertices(vertices, vertexCount, indexList, getIndexCount(pType, primitiveCount), vType, iType);
+
 		setRenderStates3DMode();
 
 		glEnableVertexAttribArray(EVA_POSITION);
@@ -689,6 +772,40 @@ COGLES2Driver::~COGLES2Driver()
 			break;
 		}
 
+		// the joint stream always comes from client memory
+		const bool skinning = SkinningVertexJoints && Material.MaterialType == SkinnedMaterialType;
+		if (skinning)
+		{
+			if (!vertices || streamed)
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			glEnableVertexAttribArray(EVA_JOINT_INDICES);
+			glEnableVertexAttribArray(EVA_JOINT_WEIGHTS);
+			glVertexAttribPointer(EVA_JOINT_INDICES, 4, GL_UNSIGNED_SHORT, false, sizeof(S3DVertexJoints), SkinningVertexJoints[0].Joints);
+			glVertexAttribPointer(EVA_JOINT_WEIGHTS, 4, GL_FLOAT, false, sizeof(S3DVertexJoints), SkinningVertexJoints[0].Weights);
+		}
+
+		// the instances always come from client memory, one attribute value per instance
+		const bool instancing = InstanceData && canDrawInstances(pType);
+		if (instancing)
+		{
+			if (!vertices || streamed)
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			for (u32 i = EVA_INSTANCE_TRANSFORM0; i <= EVA_INSTANCE_CUSTOM; ++i)
+			{
+				glEnableVertexAttribArray(i);
+				irrGlVertexAttribDivisor(i, 1);
+			}
+			const f32* transformation = InstanceData[0].Transformation.pointer();
+			glVertexAttribPointer(EVA_INSTANCE_TRANSFORM0, 4, GL_FLOAT, false, sizeof(S3DInstance), transformation);
+			glVertexAttribPointer(EVA_INSTANCE_TRANSFORM1, 4, GL_FLOAT, false, sizeof(S3DInstance), transformation + 4);
+			glVertexAttribPointer(EVA_INSTANCE_TRANSFORM2, 4, GL_FLOAT, false, sizeof(S3DInstance), transformation + 8);
+			glVertexAttribPointer(EVA_INSTANCE_TRANSFORM3, 4, GL_FLOAT, false, sizeof(S3DInstance), transformation + 12);
+			glVertexAttribPointer(EVA_INSTANCE_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DInstance), &InstanceData[0].Color);
+			glVertexAttribPointer(EVA_INSTANCE_CUSTOM, 4, GL_FLOAT, false, sizeof(S3DInstance), InstanceData[0].Custom);
+		}
+
 		GLenum indexSize = 0;
 
 		switch (iType)
@@ -735,12 +852,22 @@ COGLES2Driver::~COGLES2Driver()
 				glDrawElements(GL_TRIANGLE_FAN, primitiveCount + 2, indexSize, indexList);
 				break;
 			case scene::EPT_TRIANGLES:
-				glDrawElements((LastMaterial.Wireframe) ? GL_LINES : (LastMaterial.PointCloud) ? GL_POINTS : GL_TRIANGLES, primitiveCount*3, indexSize, indexList);
+				if (instancing)
+					irrGlDrawElementsInstanced((LastMaterial.Wireframe) ? GL_LINES : (LastMaterial.PointCloud) ? GL_POINTS : GL_TRIANGLES, primitiveCount*3, indexSize, indexList, InstanceCount);
+				else
+					glDrawElements((LastMaterial.Wireframe) ? GL_LINES : (LastMaterial.PointCloud) ? GL_POINTS : GL_TRIANGLES, primitiveCount*3, indexSize, indexList);
 				break;
 			default:
 				break;
 		}
 
+		if (streamed)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			if (clientIndices)
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		}
+
 		switch (vType)
 		{
 		case EVT_2TCOORDS:
@@ -754,6 +881,21 @@ COGLES2Driver::~COGLES2Driver()
 			break;
 		}
 
+		if (skinning)
+		{
+			glDisableVertexAttribArray(EVA_JOINT_INDICES);
+			glDisableVertexAttribArray(EVA_JOINT_WEIGHTS);
+		}
+
+		if (instancing)
+		{
+			for (u32 i = EVA_INSTANCE_TRANSFORM0; i <= EVA_INSTANCE_CUSTOM; ++i)
+			{
+				irrGlVertexAttribDivisor(i, 0);
+				glDisableVertexAttribArray(i);
+			}
+		}
+
 		glDisableVertexAttribArray(EVA_POSITION);
 		glDisableVertexAttribArray(EVA_NORMAL);
 		glDisableVertexAttribArray(EVA_COLOR);
@@ -1452,12 +1594,27 @@ COGLES2Driver::~COGLES2Driver()
 		return texture;
 	}
 
+	void COGLES2Driver::replaceTextureImage(ITexture* texture, IImage* image)
+	{
+		core::array<IImage*> imageArray(1);
+		imageArray.push_back(image);
+
+		static_cast<COGLES2Texture*>(texture)->replaceImages(imageArray);
+	}
+
 	//! Sets a material.
 	void COGLES2Driver::setMaterial(const SMaterial& material)
 	{
+		countMaterialChange(material);
+
 		Material = material;
 		OverrideMaterial.apply(Material);
 
+		if (SkinningPalette && SkinnedMaterialType >= 0 && Material.MaterialType == EMT_SOLID)
+			Material.MaterialType = (E_MATERIAL_TYPE)SkinnedMaterialType;
+		else if (InstanceData && InstancedMaterialType >= 0 && Material.MaterialType == EMT_SOLID)
+			Material.MaterialType = (E_MATERIAL_TYPE)InstancedMaterialType;
+
 		for (u32 i = 0; i < Feature.MaxTextureUnits; ++i)
 		{
 			CacheHandler->getTextureCache().set(i, material.getTexture(i));
@@ -1465,6 +1622,45 @@ COGLES2Driver::~COGLES2Driver()
 		}
 	}
 
+	void COGLES2Driver::setSkinningData(const core::matrix4* palette, u32 jointCount,
+		const S3DVertexJoints* vertexJoints)
+	{
+		CNullDriver::setSkinningData(palette, jointCount, vertexJoints);
+
+		if (SkinnedMaterialType < 0)
+			return;
+
+		// swap the material in case it was set before the skinning data
+		if (SkinningPalette && Material.MaterialType == EMT_SOLID)
+			Material.MaterialType = (E_MATERIAL_TYPE)SkinnedMaterialType;
+		else if (!SkinningPalette && Material.MaterialType == SkinnedMaterialType)
+			Material.MaterialType = EMT_SOLID;
+	}
+
+	void COGLES2Driver::setInstanceData(const S3DInstance* instances, u32 instanceCount)
+	{
+		CNullDriver::setInstanceData(instances, instanceCount);
+
+		if (InstancedMaterialType < 0 || SkinningPalette)
+			return;
+
+		// swap the material in case it was set before the instances
+		if (InstanceData && Material.MaterialType == EMT_SOLID)
+			Material.MaterialType = (E_MATERIAL_TYPE)InstancedMaterialType;
+		else if (!InstanceData && Material.MaterialType == InstancedMaterialType)
+			Material.MaterialType = EMT_SOLID;
+	}
+
+	bool COGLES2Driver::canDrawInstances(const scene::IMeshBuffer* mb) const
+	{
+		return canDrawInstances(mb->getPrimitiveType());
+	}
+
+	bool COGLES2Driver::canDrawInstances(scene::E_PRIMITIVE_TYPE pType) const
+	{
+		return InstancedMaterialType >= 0 && Material.MaterialType == InstancedMaterialType && pType == scene::EPT_TRIANGLES;
+	}
+
 	//! prints error if an error happened.
 	bool COGLES2Driver::testGLError(int code)
 	{
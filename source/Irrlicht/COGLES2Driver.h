@@ -84,12 +84,24 @@ namespace video
 		//! queries the features of the driver, returns true if feature is available
 		virtual bool queryFeature(E_VIDEO_DRIVER_FEATURE feature) const _IRR_OVERRIDE_
 		{
+			if (feature == EVDF_HARDWARE_SKINNING)
+				return FeatureEnabled[feature] && SkinnedMaterialType >= 0;
+			if (feature == EVDF_HARDWARE_INSTANCING)
+				return FeatureEnabled[feature] && InstancedMaterialType >= 0;
+
 			return FeatureEnabled[feature] && COGLES2ExtensionHandler::queryFeature(feature);
 		}
 
 		//! Sets a material.
 		virtual void setMaterial(const SMaterial& material) _IRR_OVERRIDE_;
 
+		//! Sets the joint palette and joint stream for hardware skinning
+		virtual void setSkinningData(const core::matrix4* palette, u32 jointCount,
+			const S3DVertexJoints* vertexJoints) _IRR_OVERRIDE_;
+
+		//! Sets the instances drawn by the following mesh buffer draw calls
+		virtual void setInstanceData(const S3DInstance* instances, u32 instanceCount) _IRR_OVERRIDE_;
+
 		virtual void draw2DImage(const video::ITexture* texture,
 				const core::position2d<s32>& destPos,
 				const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect = 0,
@@ -326,6 +338,8 @@ namespace video
 
 		virtual ITexture* createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image) _IRR_OVERRIDE_;
 
+		virtual void replaceTextureImage(ITexture* texture, IImage* image) _IRR_OVERRIDE_;
+
 		//! Map Irrlicht wrap mode to OpenGL enum
 		GLint getTextureWrapMode(u8 clamp) const;
 
@@ -357,6 +371,33 @@ namespace video
 
 		void createMaterialRenderers();
 
+		//! Check if the instances of a buffer are drawn with one call
+		virtual bool canDrawInstances(const scene::IMeshBuffer* mb) const _IRR_OVERRIDE_;
+
+		//! Check if instances of the primitive type are drawn with one call
+		bool canDrawInstances(scene::E_PRIMITIVE_TYPE pType) const;
+
+		//! Copy vertices and indices from client memory into the streaming buffers
+		/** On success the streaming buffers are bound, vertices and
+		indexList (if there are indices) are offsets into them.
+		\return False if the draw has to read from client memory. */
+		bool streamVertices(const void*& vertices, u32 vertexCount,
+				const void*& indexList, u32 indexCount, E_VERTEX_TYPE vType, E_INDEX_TYPE iType);
+
+		//! Buffer for data from client memory, filled round robin
+		struct SStreamBuffer
+		{
+			SStreamBuffer() : ID(0), Allocated(0), Offset(0) {}
+
+			GLuint ID;
+			u32 Allocated;
+			u32 Offset;
+		};
+
+		//! Bind a streaming buffer to target and reserve size bytes in it
+		/** \return Offset of the reserved bytes. */
+		u32 reserveStreamBuffer(SStreamBuffer& buffer, GLenum target, u32 size);
+
 		void loadShaderData(const io::path& vertexShaderName, const io::path& fragmentShaderName, c8** vertexShaderData, c8** fragmentShaderData);
 
 		bool setMaterialTexture(irr::u32 layerIdx, const irr::video::ITexture* texture);
@@ -387,6 +428,12 @@ private:
 		COGLES2Renderer2D* MaterialRenderer2DTexture;
 		COGLES2Renderer2D* MaterialRenderer2DNoTexture;
 
+		//! Built-in material replacing EMT_SOLID while skinning data is set, -1 if not available
+		s32 SkinnedMaterialType;
+
+		//! Built-in material replacing EMT_SOLID while instances are set, -1 if not available
+		s32 InstancedMaterialType;
+
 		core::matrix4 Matrices[ETS_COUNT];
 
 		//! enumeration for rendering modes such as 2d and 3d for minimizing the switching of renderStates.
@@ -406,6 +453,10 @@ private:
 		//! Color buffer format
 		ECOLOR_FORMAT ColorFormat;
 
+		//! Streaming buffers, WebGL doesn't allow one buffer for vertices and indices
+		SStreamBuffer StreamVertexBuffer;
+		SStreamBuffer StreamIndexBuffer;
+
 		//! All the lights that have been requested; a hardware limited
 		//! number of them will be used at once.
 		struct RequestedLight
@@ -10,6 +10,7 @@
 #include "irrString.h"
 #include "SMaterial.h"
 #include "fast_atof.h"
+#include "EVertexAttributes.h"
 
 namespace irr
 {
@@ -48,6 +49,32 @@ namespace video
 		Feature.MaxTextureUnits = core::min_(Feature.MaxTextureUnits, static_cast<u8>(MATERIAL_MAX_TEXTURES));
 		Feature.MaxTextureUnits = core::min_(Feature.MaxTextureUnits, static_cast<u8>(MATERIAL_MAX_TEXTURES_USED));
 		Feature.ColorAttachment = 1;
+
+		// instancing is core in OpenGL ES 3.0, the functions are only loaded if
+		// all vertex attributes, including the instance ones, fit
+		glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &val);
+		if (val >= EVA_COUNT)
+		{
+			const c8* suffix = 0;
+			if (Version >= 300)
+				suffix = "";
+			else if (FeatureAvailable[IRR_GL_EXT_instanced_arrays])
+				suffix = "EXT";
+			else if (FeatureAvailable[IRR_GL_ANGLE_instanced_arrays])
+				suffix = "ANGLE";
+			else if (FeatureAvailable[IRR_GL_NV_instanced_arrays] && FeatureAvailable[IRR_GL_NV_draw_instanced])
+				suffix = "NV";
+
+			if (suffix)
+			{
+				core::stringc name("glDrawElementsInstanced");
+				name += suffix;
+				pGlDrawElementsInstanced = (PFNIRRGLDRAWELEMENTSINSTANCEDPROC)SDL_GL_GetProcAddress(name.c_str());
+				name = "glVertexAttribDivisor";
+				name += suffix;
+				pGlVertexAttribDivisor = (PFNIRRGLVERTEXATTRIBDIVISORPROC)SDL_GL_GetProcAddress(name.c_str());
+			}
+		}
 	}
 
 } // end namespace video
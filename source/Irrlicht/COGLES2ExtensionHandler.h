@@ -24,7 +24,8 @@ namespace video
 	class COGLES2ExtensionHandler : public COGLESCoreExtensionHandler
 	{
 	public:
-		COGLES2ExtensionHandler() : COGLESCoreExtensionHandler() {}
+		COGLES2ExtensionHandler() : COGLESCoreExtensionHandler(),
+			pGlDrawElementsInstanced(0), pGlVertexAttribDivisor(0) {}
 
 		void initExtensions();
 
@@ -183,6 +184,31 @@ namespace video
 		inline void irrGlBlendEquationSeparateIndexed(GLuint buf, GLenum modeRGB, GLenum modeAlpha)
 		{
 		}
+
+		//! Check if instanced draw calls are available, from OpenGL ES 3.0 or an extension
+		inline bool hasInstancing() const
+		{
+			return pGlDrawElementsInstanced && pGlVertexAttribDivisor;
+		}
+
+		inline void irrGlDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei primcount)
+		{
+			if (pGlDrawElementsInstanced)
+				pGlDrawElementsInstanced(mode, count, type, indices, primcount);
+		}
+
+		inline void irrGlVertexAttribDivisor(GLuint index, GLuint divisor)
+		{
+			if (pGlVertexAttribDivisor)
+				pGlVertexAttribDivisor(index, divisor);
+		}
+
+	protected:
+		typedef void (GL_APIENTRYP PFNIRRGLDRAWELEMENTSINSTANCEDPROC) (GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei primcount);
+		typedef void (GL_APIENTRYP PFNIRRGLVERTEXATTRIBDIVISORPROC) (GLuint index, GLuint divisor);
+
+		PFNIRRGLDRAWELEMENTSINSTANCEDPROC pGlDrawElementsInstanced;
+		PFNIRRGLVERTEXATTRIBDIVISORPROC pGlVertexAttribDivisor;
 	};
 
 }
@@ -6,6 +6,7 @@
 
 
 #include "IVideoDriver.h"
+#include "CNullDriver.h"
 #include "SLight.h"
 
 namespace irr
@@ -211,6 +212,31 @@ void COGLES2MaterialSolidCB::OnSetConstants(IMaterialRendererServices* services,
 	services->setPixelShaderConstant(TextureUnit0ID, &TextureUnit0, 1);
 }
 
+// EMT_SOLID with hardware skinning
+
+COGLES2MaterialSkinnedCB::COGLES2MaterialSkinnedCB() :
+	FirstUpdateSkinned(true), JointPaletteID(-1)
+{
+}
+
+void COGLES2MaterialSkinnedCB::OnSetConstants(IMaterialRendererServices* services, s32 userData)
+{
+	COGLES2MaterialSolidCB::OnSetConstants(services, userData);
+
+	// only used by COGLES2Driver, which is a CNullDriver
+	CNullDriver* driver = static_cast<CNullDriver*>(services->getVideoDriver());
+
+	if (FirstUpdateSkinned)
+	{
+		JointPaletteID = services->getVertexShaderConstantID("uJointPalette");
+
+		FirstUpdateSkinned = false;
+	}
+
+	if (driver->getSkinningPalette())
+		services->setVertexShaderConstant(JointPaletteID, driver->getSkinningPalette()[0].pointer(), driver->getSkinningJointCount()*16);
+}
+
 // EMT_SOLID_2_LAYER + EMT_DETAIL_MAP
 
 COGLES2MaterialSolid2CB::COGLES2MaterialSolid2CB() :
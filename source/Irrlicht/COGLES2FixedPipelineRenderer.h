@@ -102,6 +102,19 @@ protected:
 	s32 TextureUnit0;
 };
 
+class COGLES2MaterialSkinnedCB : public COGLES2MaterialSolidCB
+{
+public:
+	COGLES2MaterialSkinnedCB();
+
+	virtual void OnSetConstants(IMaterialRendererServices* services, s32 userData);
+
+protected:
+	bool FirstUpdateSkinned;
+
+	s32 JointPaletteID;
+};
+
 class COGLES2MaterialSolid2CB : public COGLES2MaterialBaseCB
 {
 public:
@@ -437,7 +437,7 @@ COGLES1Driver::SHWBufferLink *COGLES1Driver::createHardwareBuffer(const scene::I
 	SHWBufferLink_opengl *HWBuffer=new SHWBufferLink_opengl(mb);
 
 	//add to map
-	HWBufferMap.insert(HWBuffer->MeshBuffer, HWBuffer);
+	addHardwareBufferLink(HWBuffer);
 
 	HWBuffer->ChangedID_Vertex=HWBuffer->MeshBuffer->getChangedID_Vertex();
 	HWBuffer->ChangedID_Index=HWBuffer->MeshBuffer->getChangedID_Index();
@@ -1395,9 +1395,19 @@ ITexture* COGLES1Driver::createDeviceDependentTextureCubemap(const io::path& nam
 	return texture;
 }
 
+void COGLES1Driver::replaceTextureImage(ITexture* texture, IImage* image)
+{
+	core::array<IImage*> imageArray(1);
+	imageArray.push_back(image);
+
+	static_cast<COGLES1Texture*>(texture)->replaceImages(imageArray);
+}
+
 //! Sets a material. All 3d drawing functions draw geometry now using this material.
 void COGLES1Driver::setMaterial(const SMaterial& material)
 {
+	countMaterialChange(material);
+
 	Material = material;
 	OverrideMaterial.apply(Material);
 
@@ -305,6 +305,8 @@ namespace video
 
 		virtual ITexture* createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image) _IRR_OVERRIDE_;
 
+		virtual void replaceTextureImage(ITexture* texture, IImage* image) _IRR_OVERRIDE_;
+
 		//! creates a transposed matrix in supplied GLfloat array to pass to OGLES1
 		inline void getGLMatrix(GLfloat gl_matrix[16], const core::matrix4& m);
 		inline void getGLTextureMatrix(GLfloat gl_matrix[16], const core::matrix4& m);
@@ -24,6 +24,10 @@ typedef unsigned int GLhandleARB;
 typedef char GLchar;
 #endif
 
+#if !defined(GL_ARB_sync) && !defined(GL_VERSION_3_2)
+typedef struct __GLsync *GLsync;
+#endif
+
 // Blending definitions.
 
 #if !defined(GL_VERSION_1_4)
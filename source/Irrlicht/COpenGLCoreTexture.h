@@ -61,92 +61,9 @@ public:
 
 		getImageValues(images[0]);
 
-		const core::array<IImage*>* tmpImages = &images;
-
-		if (KeepImage || OriginalSize != Size || OriginalColorFormat != ColorFormat)
-		{
-			Images.set_used(images.size());
-
-			for (u32 i = 0; i < images.size(); ++i)
-			{
-				Images[i] = Driver->createImage(ColorFormat, Size);
-
-				if (images[i]->getDimension() == Size)
-					images[i]->copyTo(Images[i]);
-				else
-					images[i]->copyToScaling(Images[i]);
-
-				if ( images[i]->getMipMapsData() )
-				{
-					if ( OriginalSize == Size && OriginalColorFormat == ColorFormat )
-					{
-						Images[i]->setMipMapsData( images[i]->getMipMapsData(), false, true);
-					}
-					else
-					{
-						// TODO: handle at least mipmap with changing color format
-						os::Printer::log("COpenGLCoreTexture: Can't handle format changes for mipmap data. Mipmap data dropped", ELL_WARNING);
-					}
-				}
-			}
-
-			tmpImages = &Images;
-		}
-
 		glGenTextures(1, &TextureName);
 
-		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
-		Driver->getCacheHandler()->getTextureCache().set(0, this);
-
-		glTexParameteri(TextureType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(TextureType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-#ifdef GL_GENERATE_MIPMAP_HINT
-		if (HasMipMaps)
-		{
-			if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_SPEED))
-				glHint(GL_GENERATE_MIPMAP_HINT, GL_FASTEST);
-			else if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_QUALITY))
-				glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST);
-			else
-				glHint(GL_GENERATE_MIPMAP_HINT, GL_DONT_CARE);
-		}
-#endif
-
-#if !defined(IRR_OPENGL_HAS_glGenerateMipmap) && defined(GL_GENERATE_MIPMAP)
-		if (HasMipMaps)
-		{
-			LegacyAutoGenerateMipMaps = Driver->getTextureCreationFlag(ETCF_AUTO_GENERATE_MIP_MAPS)  &&
-										Driver->queryFeature(EVDF_MIP_MAP_AUTO_UPDATE);
-			glTexParameteri(TextureType, GL_GENERATE_MIPMAP, LegacyAutoGenerateMipMaps ? GL_TRUE : GL_FALSE);
-		}
-#endif
-
-		for (u32 i = 0; i < (*tmpImages).size(); ++i)
-			uploadTexture(true, i, 0, (*tmpImages)[i]->getData());
-
-		if (HasMipMaps && !LegacyAutoGenerateMipMaps)
-		{
-			// Create mipmaps (either from image mipmaps or generate them)
-			for (u32 i = 0; i < (*tmpImages).size(); ++i)
-			{
-				void* mipmapsData = (*tmpImages)[i]->getMipMapsData();
-				regenerateMipMapLevels(mipmapsData, i);
-			}
-		}
-
-		if (!KeepImage)
-		{
-			for (u32 i = 0; i < Images.size(); ++i)
-				Images[i]->drop();
-
-			Images.clear();
-		}
-
-
-		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
-
-		Driver->testGLError(__LINE__);
+		uploadImages(images);
 	}
 
 	COpenGLCoreTexture(const io::path& name, const core::dimension2d<u32>& size, E_TEXTURE_TYPE type, ECOLOR_FORMAT format, TOpenGLDriver* driver)
@@ -232,6 +149,28 @@ public:
 			Images[i]->drop();
 	}
 
+	//! Replace the images of the texture, keeps the texture name
+	/** Used by the driver to fill a placeholder with a texture loaded in
+	the background. The size and color format can change. */
+	void replaceImages(const core::array<IImage*>& images)
+	{
+		_IRR_DEBUG_BREAK_IF(images.size() == 0 || LockImage)
+
+		for (u32 i = 0; i < Images.size(); ++i)
+			Images[i]->drop();
+		Images.clear();
+
+		HasMipMaps = Driver->getTextureCreationFlag(ETCF_CREATE_MIP_MAPS);
+		KeepImage = Driver->getTextureCreationFlag(ETCF_ALLOW_MEMORY_COPY);
+
+		getImageValues(images[0]);
+
+		uploadImages(images);
+
+		// the filters were reset by the upload
+		StatesCache.IsCached = false;
+	}
+
 	virtual void* lock(E_TEXTURE_LOCK_MODE mode = ETLM_READ_WRITE, u32 mipmapLevel=0, u32 layer = 0, E_TEXTURE_LOCK_FLAGS lockFlags = ETLF_FLIP_Y_UP_RTT) _IRR_OVERRIDE_
 	{
 		if (LockImage)
@@ -459,6 +398,96 @@ public:
 
 protected:
 
+	//! Copy the images if needed and upload them into TextureName
+	void uploadImages(const core::array<IImage*>& images)
+	{
+		const core::array<IImage*>* tmpImages = &images;
+
+		if (KeepImage || OriginalSize != Size || OriginalColorFormat != ColorFormat)
+		{
+			Images.set_used(images.size());
+
+			for (u32 i = 0; i < images.size(); ++i)
+			{
+				Images[i] = Driver->createImage(ColorFormat, Size);
+
+				if (images[i]->getDimension() == Size)
+					images[i]->copyTo(Images[i]);
+				else
+					images[i]->copyToScaling(Images[i]);
+
+				if ( images[i]->getMipMapsData() )
+				{
+					if ( OriginalSize == Size && OriginalColorFormat == ColorFormat )
+					{
+						Images[i]->setMipMapsData( images[i]->getMipMapsData(), false, true);
+					}
+					else
+					{
+						// TODO: handle at least mipmap with changing color format
+						os::Printer::log("COpenGLCoreTexture: Can't handle format changes for mipmap data. Mipmap data dropped", ELL_WARNING);
+					}
+				}
+			}
+
+			tmpImages = &Images;
+		}
+
+		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
+		Driver->getCacheHandler()->getTextureCache().set(0, this);
+
+		glTexParameteri(TextureType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(TextureType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+#ifdef GL_GENERATE_MIPMAP_HINT
+		if (HasMipMaps)
+		{
+			if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_SPEED))
+				glHint(GL_GENERATE_MIPMAP_HINT, GL_FASTEST);
+			else if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_QUALITY))
+				glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST);
+			else
+				glHint(GL_GENERATE_MIPMAP_HINT, GL_DONT_CARE);
+		}
+#endif
+
+#if !defined(IRR_OPENGL_HAS_glGenerateMipmap) && defined(GL_GENERATE_MIPMAP)
+		if (HasMipMaps)
+		{
+			LegacyAutoGenerateMipMaps = Driver->getTextureCreationFlag(ETCF_AUTO_GENERATE_MIP_MAPS)  &&
+										Driver->queryFeature(EVDF_MIP_MAP_AUTO_UPDATE);
+			glTexParameteri(TextureType, GL_GENERATE_MIPMAP, LegacyAutoGenerateMipMaps ? GL_TRUE : GL_FALSE);
+		}
+#endif
+
+		for (u32 i = 0; i < (*tmpImages).size(); ++i)
+			uploadTexture(true, i, 0, (*tmpImages)[i]->getData());
+
+		if (HasMipMaps && !LegacyAutoGenerateMipMaps)
+		{
+			// Create mipmaps (either from image mipmaps or generate them)
+			for (u32 i = 0; i < (*tmpImages).size(); ++i)
+			{
+				void* mipmapsData = (*tmpImages)[i]->getMipMapsData();
+				regenerateMipMapLevels(mipmapsData, i);
+			}
+		}
+
+		if (!KeepImage)
+		{
+			for (u32 i = 0; i < Images.size(); ++i)
+				Images[i]->drop();
+
+			Images.clear();
+		}
+
+
+		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+
+		Driver->testGLError(__LINE__);
+	}
+
+
 	void * getLockImageData(irr::u32 miplevel) const
 	{
 		if ( KeepImage && MipLevelStored > 0
@@ -12,6 +12,7 @@
 #include "COpenGLMaterialRenderer.h"
 #include "COpenGLShaderMaterialRenderer.h"
 #include "COpenGLSLMaterialRenderer.h"
+#include "IShaderConstantSetCallBack.h"
 
 #include "COpenGLCoreTexture.h"
 #include "COpenGLCoreRenderTarget.h"
@@ -28,11 +29,15 @@ COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params, io::IFil
 	: CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(), CacheHandler(0),
 	CurrentRenderMode(ERM_NONE), ResetRenderStates(true), Transformation3DChanged(true),
 	AntiAlias(params.AntiAlias), ColorFormat(ECF_R8G8B8), FixedPipelineState(EOFPS_ENABLE),
-	Params(params)
+	StreamBufferID(0), StreamBufferPointer(0), StreamBufferAllocated(0), StreamBufferOffset(0),
+	StreamSegment(0), StreamFencedSegment(0), Params(params)
 {
 #ifdef _DEBUG
 	setDebugName("COpenGLDriver");
 #endif
+	for (u32 i=0; i<STREAM_BUFFER_SEGMENTS; ++i)
+		StreamFences[i] = 0;
+
 	ExposedData.context = SDL_GL_GetCurrentContext();
 	ExposedData.window = SDL_GL_GetCurrentWindow();
 	SDL_GL_MakeCurrent(ExposedData.window, ExposedData.context);
@@ -56,6 +61,7 @@ COpenGLDriver::~COpenGLDriver()
 	deleteAllTextures();
 	removeAllOcclusionQueries();
 	removeAllHardwareBuffers();
+	deleteStreamingBuffer();
 
 	delete CacheHandler;
 }
@@ -181,6 +187,196 @@ bool COpenGLDriver::genericDriverInit()
 }
 
 
+namespace
+{
+	// Built-in skinning material, a GLSL version of EMT_SOLID. Joint indices
+	// and weights are passed as texture coordinates 3 and 4.
+	const c8* const SkinnedVertexShader =
+		"#define MAX_JOINTS 64\n"
+		"#define MAX_LIGHTS 8\n"
+		"uniform mat4 uJointPalette[MAX_JOINTS];\n"
+		"uniform int uLighting;\n"
+		"uniform int uLightEnabled[MAX_LIGHTS];\n"
+		"void main()\n"
+		"{\n"
+		"	vec4 Indices = gl_MultiTexCoord3;\n"
+		"	vec4 Weights = gl_MultiTexCoord4;\n"
+		"	mat4 Skin = uJointPalette[int(Indices.x)] * Weights.x + uJointPalette[int(Indices.y)] * Weights.y +\n"
+		"		uJointPalette[int(Indices.z)] * Weights.z + uJointPalette[int(Indices.w)] * Weights.w;\n"
+		"	vec4 Position = Skin * gl_Vertex;\n"
+		"	vec3 EyePosition = (gl_ModelViewMatrix * Position).xyz;\n"
+		"	gl_Position = gl_ModelViewProjectionMatrix * Position;\n"
+		"	gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+		"	gl_FogFragCoord = length(EyePosition);\n"
+		"	gl_FrontColor = gl_Color;\n"
+		"	if (uLighting != 0)\n"
+		"	{\n"
+		"		vec3 Normal = normalize(gl_NormalMatrix * (Skin * vec4(gl_Normal, 0.0)).xyz);\n"
+		"		vec4 Diffuse = vec4(0.0);\n"
+		"		vec4 Ambient = gl_LightModel.ambient;\n"
+		"		for (int i = 0; i < MAX_LIGHTS; ++i)\n"
+		"		{\n"
+		"			if (uLightEnabled[i] == 0)\n"
+		"				continue;\n"
+		"			vec3 L = gl_LightSource[i].position.xyz;\n"
+		"			float Attenuation = 1.0;\n"
+		"			if (gl_LightSource[i].position.w != 0.0)\n"
+		"			{\n"
+		"				L -= EyePosition;\n"
+		"				float D = length(L);\n"
+		"				Attenuation = 1.0 / (gl_LightSource[i].constantAttenuation +\n"
+		"					gl_LightSource[i].linearAttenuation * D + gl_LightSource[i].quadraticAttenuation * D * D);\n"
+		"			}\n"
+		"			Ambient += gl_LightSource[i].ambient * Attenuation;\n"
+		"			Diffuse += gl_LightSource[i].diffuse * max(dot(Normal, normalize(L)), 0.0) * Attenuation;\n"
+		"		}\n"
+		"		gl_FrontColor = clamp(gl_FrontMaterial.emission + Ambient * gl_FrontMaterial.ambient + Diffuse * gl_Color, 0.0, 1.0);\n"
+		"		gl_FrontColor.a = gl_Color.a;\n"
+		"	}\n"
+		"}\n";
+
+	const c8* const SkinnedPixelShader =
+		"uniform sampler2D uTexture0;\n"
+		"uniform int uTextureUsage0;\n"
+		"uniform int uFogEnable;\n"
+		"void main()\n"
+		"{\n"
+		"	vec4 Color = gl_Color;\n"
+		"	if (uTextureUsage0 != 0)\n"
+		"		Color *= texture2D(uTexture0, gl_TexCoord[0].xy);\n"
+		"	if (uFogEnable != 0)\n"
+		"		Color.rgb = mix(gl_Fog.color.rgb, Color.rgb, clamp((gl_Fog.end - gl_FogFragCoord) * gl_Fog.scale, 0.0, 1.0));\n"
+		"	gl_FragColor = Color;\n"
+		"}\n";
+
+	// Built-in instancing material, the same GLSL version of EMT_SOLID with
+	// the instance transformation and color from generic vertex attributes.
+	// Colors are BGRA bytes, like S3DInstance::Color in memory.
+	const c8* const InstancedVertexShader =
+		"#define MAX_LIGHTS 8\n"
+		"attribute vec4 inInstanceTransform0;\n"
+		"attribute vec4 inInstanceTransform1;\n"
+		"attribute vec4 inInstanceTransform2;\n"
+		"attribute vec4 inInstanceTransform3;\n"
+		"attribute vec4 inInstanceColor;\n"
+		"uniform int uLighting;\n"
+		"uniform int uLightEnabled[MAX_LIGHTS];\n"
+		"void main()\n"
+		"{\n"
+		"	mat4 Instance = mat4(inInstanceTransform0, inInstanceTransform1, inInstanceTransform2, inInstanceTransform3);\n"
+		"	vec4 InstanceColor = inInstanceColor.zyxw;\n"
+		"	vec4 Position = Instance * gl_Vertex;\n"
+		"	vec3 EyePosition = (gl_ModelViewMatrix * Position).xyz;\n"
+		"	gl_Position = gl_ModelViewProjectionMatrix * Position;\n"
+		"	gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+		"	gl_FogFragCoord = length(EyePosition);\n"
+		"	gl_FrontColor = gl_Color * InstanceColor;\n"
+		"	if (uLighting != 0)\n"
+		"	{\n"
+		"		vec3 Normal = normalize(gl_NormalMatrix * (Instance * vec4(gl_Normal, 0.0)).xyz);\n"
+		"		vec4 Diffuse = vec4(0.0);\n"
+		"		vec4 Ambient = gl_LightModel.ambient;\n"
+		"		for (int i = 0; i < MAX_LIGHTS; ++i)\n"
+		"		{\n"
+		"			if (uLightEnabled[i] == 0)\n"
+		"				continue;\n"
+		"			vec3 L = gl_LightSource[i].position.xyz;\n"
+		"			float Attenuation = 1.0;\n"
+		"			if (gl_LightSource[i].position.w != 0.0)\n"
+		"			{\n"
+		"				L -= EyePosition;\n"
+		"				float D = length(L);\n"
+		"				Attenuation = 1.0 / (gl_LightSource[i].constantAttenuation +\n"
+		"					gl_LightSource[i].linearAttenuation * D + gl_LightSource[i].quadraticAttenuation * D * D);\n"
+		"			}\n"
+		"			Ambient += gl_LightSource[i].ambient * Attenuation;\n"
+		"			Diffuse += gl_LightSource[i].diffuse * max(dot(Normal, normalize(L)), 0.0) * Attenuation;\n"
+		"		}\n"
+		"		vec4 Color = gl_Color * InstanceColor;\n"
+		"		gl_FrontColor = clamp(gl_FrontMaterial.emission + Ambient * gl_FrontMaterial.ambient + Diffuse * Color, 0.0, 1.0);\n"
+		"		gl_FrontColor.a = Color.a;\n"
+		"	}\n"
+		"}\n";
+
+	//! Names of the instance attributes, in the order of COpenGLDriver::InstanceAttributes
+	const c8* const InstanceAttributeNames[] =
+	{
+		"inInstanceTransform0",
+		"inInstanceTransform1",
+		"inInstanceTransform2",
+		"inInstanceTransform3",
+		"inInstanceColor",
+		"inInstanceCustom"
+	};
+
+	// also used by the instanced material, which has no joint palette
+	class COpenGLSkinnedCB : public IShaderConstantSetCallBack
+	{
+	public:
+		COpenGLSkinnedCB() : FirstUpdate(true), JointPaletteID(-1), LightingID(-1), LightEnabledID(-1),
+			Texture0ID(-1), TextureUsage0ID(-1), FogEnableID(-1), Lighting(0), TextureUsage0(0), FogEnable(0)
+		{
+		}
+
+		virtual void OnSetMaterial(const SMaterial& material) _IRR_OVERRIDE_
+		{
+			Lighting = material.Lighting ? 1 : 0;
+			TextureUsage0 = material.getTexture(0) ? 1 : 0;
+			FogEnable = material.FogEnable ? 1 : 0;
+		}
+
+		virtual void OnSetConstants(IMaterialRendererServices* services, s32 userData) _IRR_OVERRIDE_
+		{
+			// only used by COpenGLDriver, which is a CNullDriver
+			CNullDriver* driver = static_cast<CNullDriver*>(services->getVideoDriver());
+
+			if (FirstUpdate)
+			{
+				// arrays are reported with or without subscript depending on the driver
+				JointPaletteID = services->getVertexShaderConstantID("uJointPalette[0]");
+				if (JointPaletteID < 0)
+					JointPaletteID = services->getVertexShaderConstantID("uJointPalette");
+				LightEnabledID = services->getVertexShaderConstantID("uLightEnabled[0]");
+				if (LightEnabledID < 0)
+					LightEnabledID = services->getVertexShaderConstantID("uLightEnabled");
+				LightingID = services->getVertexShaderConstantID("uLighting");
+				Texture0ID = services->getPixelShaderConstantID("uTexture0");
+				TextureUsage0ID = services->getPixelShaderConstantID("uTextureUsage0");
+				FogEnableID = services->getPixelShaderConstantID("uFogEnable");
+
+				FirstUpdate = false;
+			}
+
+			if (JointPaletteID >= 0 && driver->getSkinningPalette())
+				services->setVertexShaderConstant(JointPaletteID, driver->getSkinningPalette()[0].pointer(), driver->getSkinningJointCount()*16);
+
+			s32 lightEnabled[8];
+			for (u32 i=0; i<8; ++i)
+				lightEnabled[i] = glIsEnabled(GL_LIGHT0 + i) ? 1 : 0;
+
+			const s32 texture0 = 0;
+			services->setVertexShaderConstant(LightingID, &Lighting, 1);
+			services->setVertexShaderConstant(LightEnabledID, lightEnabled, 8);
+			services->setPixelShaderConstant(Texture0ID, &texture0, 1);
+			services->setPixelShaderConstant(TextureUsage0ID, &TextureUsage0, 1);
+			services->setPixelShaderConstant(FogEnableID, &FogEnable, 1);
+		}
+
+	private:
+		bool FirstUpdate;
+		s32 JointPaletteID;
+		s32 LightingID;
+		s32 LightEnabledID;
+		s32 Texture0ID;
+		s32 TextureUsage0ID;
+		s32 FogEnableID;
+		s32 Lighting;
+		s32 TextureUsage0;
+		s32 FogEnable;
+	};
+} // end anonymous namespace
+
+
 void COpenGLDriver::createMaterialRenderers()
 {
 	// create OpenGL material renderers
@@ -203,6 +399,31 @@ void COpenGLDriver::createMaterialRenderers()
 	addAndDropMaterialRenderer(new COpenGLMaterialRenderer_TRANSPARENT_ALPHA_CHANNEL_REF(this));
 	addAndDropMaterialRenderer(new COpenGLMaterialRenderer_TRANSPARENT_VERTEX_ALPHA(this));
 	solid->drop();
+
+	// skinned EMT_SOLID, needs two spare texture coordinate sets for the joint stream
+	GLint coordSets = 0;
+#if defined(GL_MAX_TEXTURE_COORDS)
+	glGetIntegerv(GL_MAX_TEXTURE_COORDS, &coordSets);
+#endif
+	if (queryFeature(EVDF_ARB_GLSL) && coordSets >= 5)
+	{
+		COpenGLSkinnedCB* skinnedCB = new COpenGLSkinnedCB();
+		SkinnedMaterialType = addHighLevelShaderMaterial(SkinnedVertexShader, "main", EVST_VS_1_1,
+			SkinnedPixelShader, "main", EPST_PS_1_1, 0, "main", EGST_GS_4_0,
+			scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, skinnedCB, EMT_SOLID, 0);
+		skinnedCB->drop();
+	}
+
+	// instanced EMT_SOLID, needs OpenGL 2.0 for the generic vertex attributes
+	if (queryFeature(EVDF_ARB_GLSL) && Version >= 200 &&
+		FeatureAvailable[IRR_ARB_draw_instanced] && FeatureAvailable[IRR_ARB_instanced_arrays])
+	{
+		COpenGLSkinnedCB* instancedCB = new COpenGLSkinnedCB();
+		InstancedMaterialType = addHighLevelShaderMaterial(InstancedVertexShader, "main", EVST_VS_1_1,
+			SkinnedPixelShader, "main", EPST_PS_1_1, 0, "main", EGST_GS_4_0,
+			scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, instancedCB, EMT_SOLID, 0);
+		instancedCB->drop();
+	}
 }
 
 bool COpenGLDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil, const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
@@ -363,6 +584,7 @@ bool COpenGLDriver::updateVertexHardwareBuffer(SHWBufferLink_opengl *HWBuffer)
 	extGlBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
 
 	// copy data to graphics card
+	countBufferUpload(vertexCount * vertexSize);
 	if (!newBuffer)
 		extGlBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * vertexSize, vbuf);
 	else
@@ -437,6 +659,7 @@ bool COpenGLDriver::updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffer)
 	extGlBindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
 
 	// copy data to graphics card
+	countBufferUpload(indexCount * indexSize);
 	if (!newBuffer)
 		extGlBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount * indexSize, indices);
 	else
@@ -506,7 +729,7 @@ COpenGLDriver::SHWBufferLink *COpenGLDriver::createHardwareBuffer(const scene::I
 	SHWBufferLink_opengl *HWBuffer=new SHWBufferLink_opengl(mb);
 
 	//add to map
-	HWBufferMap.insert(HWBuffer->MeshBuffer, HWBuffer);
+	addHardwareBufferLink(HWBuffer);
 
 	HWBuffer->ChangedID_Vertex=HWBuffer->MeshBuffer->getChangedID_Vertex();
 	HWBuffer->ChangedID_Index=HWBuffer->MeshBuffer->getChangedID_Index();
@@ -740,7 +963,11 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 
 	CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 
-	if (vertices && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
+	// a stream offset of 0 leaves vertices 0, which takes the hardware buffer path below with the same offsets
+	const bool clientIndices = indexList != 0;
+	const bool streamed = streamVertices(vertices, vertexCount, indexList, getIndexCount(pType, primitiveCount), vType, iType);
+
+	if (vertices && !streamed && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
 		getColorBuffer(vertices, vertexCount, vType);
 
 	// draw everything
@@ -760,7 +987,7 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 #endif
 	if (vertices)
 	{
-		if (FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
+		if (streamed || FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
 		{
 			switch (vType)
 			{
@@ -870,7 +1097,86 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 			break;
 	}
 
-	renderArray(indexList, primitiveCount, pType, iType);
+	// the joint stream always comes from client memory
+	const bool skinning = SkinningVertexJoints && Material.MaterialType == SkinnedMaterialType;
+	if (skinning)
+	{
+#if defined(GL_ARB_vertex_buffer_object)
+		if (!vertices || streamed)
+			extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+		CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 3);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(4, GL_SHORT, sizeof(S3DVertexJoints), SkinningVertexJoints[0].Joints);
+		CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 4);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(4, GL_FLOAT, sizeof(S3DVertexJoints), SkinningVertexJoints[0].Weights);
+		CacheHandler->setClientActiveTexture(GL_TEXTURE0);
+	}
+
+	// the instances always come from client memory, one attribute value per instance
+	const bool instancing = InstanceData && canDrawInstances(pType);
+	if (instancing)
+	{
+#if defined(GL_ARB_vertex_buffer_object)
+		if (!vertices || streamed)
+			extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+		if (InstanceAttributes[0] == -2)
+		{
+			// the attributes are looked up once, the program of the material never changes
+			GLint program = 0;
+			glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+			for (u32 i=0; i<6; ++i)
+				InstanceAttributes[i] = extGlGetAttribLocation(program, InstanceAttributeNames[i]);
+		}
+
+		const void* attributes[6] =
+		{
+			InstanceData[0].Transformation.pointer(),
+			InstanceData[0].Transformation.pointer() + 4,
+			InstanceData[0].Transformation.pointer() + 8,
+			InstanceData[0].Transformation.pointer() + 12,
+			&InstanceData[0].Color,
+			InstanceData[0].Custom
+		};
+		for (u32 i=0; i<6; ++i)
+		{
+			if (InstanceAttributes[i] < 0)
+				continue;
+			extGlEnableVertexAttribArray(InstanceAttributes[i]);
+			if (i == 4)
+				extGlVertexAttribPointer(InstanceAttributes[i], 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(S3DInstance), attributes[i]);
+			else
+				extGlVertexAttribPointer(InstanceAttributes[i], 4, GL_FLOAT, GL_FALSE, sizeof(S3DInstance), attributes[i]);
+			extGlVertexAttribDivisor(InstanceAttributes[i], 1);
+		}
+
+		extGlDrawElementsInstanced(GL_TRIANGLES, primitiveCount*3, iType == EIT_32BIT ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT,
+			indexList, InstanceCount);
+
+		for (u32 i=0; i<6; ++i)
+		{
+			if (InstanceAttributes[i] < 0)
+				continue;
+			extGlVertexAttribDivisor(InstanceAttributes[i], 0);
+			extGlDisableVertexAttribArray(InstanceAttributes[i]);
+		}
+	}
+	else
+		renderArray(indexList, primitiveCount, pType, iType);
+
+	if (streamed)
+		unbindStreamingBuffer(clientIndices);
+
+	if (skinning)
+	{
+		CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 4);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 3);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		CacheHandler->setClientActiveTexture(GL_TEXTURE0);
+	}
 
 	if (Feature.MaxTextureUnits > 0)
 	{
@@ -889,6 +1195,210 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 }
 
 
+bool COpenGLDriver::streamVertices(const void*& vertices, u32 vertexCount,
+		const void*& indexList, u32 indexCount, E_VERTEX_TYPE vType, E_INDEX_TYPE iType)
+{
+#if defined(GL_ARB_vertex_buffer_object)
+	if (!vertices || !StreamingBufferSize || !FeatureAvailable[IRR_ARB_vertex_buffer_object])
+		return false;
+
+	// each block starts aligned, the indices follow the vertices
+	const u32 vertexPitch = getVertexPitchFromType(vType);
+	const u32 indexSize = iType == EIT_32BIT ? 4 : 2;
+	const u32 vertexBytes = (vertexCount*vertexPitch + 15) & ~15;
+	const u32 indexBytes = indexList ? (indexCount*indexSize + 15) & ~15 : 0;
+	const u32 size = vertexBytes + indexBytes;
+	if (size > StreamingBufferSize)
+	{
+		++FrameStatistics.StreamBufferOverflows;
+		return false;
+	}
+
+	if (StreamBufferAllocated != StreamingBufferSize)
+		createStreamingBuffer();
+	else
+		extGlBindBuffer(GL_ARRAY_BUFFER, StreamBufferID);
+
+	u8* target = 0;
+	if (StreamBufferPointer)
+		target = StreamBufferPointer + reserveStreamingBuffer(size);
+	else
+	{
+		if (StreamBufferOffset + size > StreamBufferAllocated)
+		{
+			// orphan the storage, the driver keeps it for the draws which still read from it
+			++FrameStatistics.StreamBufferWraps;
+			extGlBufferData(GL_ARRAY_BUFFER, StreamBufferAllocated, 0, GL_STREAM_DRAW);
+			StreamBufferOffset = 0;
+		}
+#if defined(GL_ARB_map_buffer_range)
+		// nothing after StreamBufferOffset was used since the storage was created
+		if (FeatureAvailable[IRR_ARB_map_buffer_range])
+			target = static_cast<u8*>(extGlMapBufferRange(GL_ARRAY_BUFFER, StreamBufferOffset, size,
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+#endif
+	}
+	const bool mapped = target != 0;
+	if (!mapped)
+	{
+		StreamStagingBuffer.set_used(size);
+		target = StreamStagingBuffer.pointer();
+	}
+
+	if (FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
+		memcpy(target, vertices, vertexCount*vertexPitch);
+	else
+	{
+		// convert the colors while copying, they are at the same offset in all vertex types
+		const u8* source = static_cast<const u8*>(vertices);
+		u8* dest = target;
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			memcpy(dest, source, 24);
+			reinterpret_cast<const SColor*>(source+24)->toOpenGLColor(dest+24);
+			memcpy(dest+28, source+28, vertexPitch-28);
+			source += vertexPitch;
+			dest += vertexPitch;
+		}
+	}
+	if (indexBytes)
+		memcpy(target+vertexBytes, indexList, indexCount*indexSize);
+
+	if (!mapped)
+		extGlBufferSubData(GL_ARRAY_BUFFER, StreamBufferOffset, size, target);
+	else if (!StreamBufferPointer && !extGlUnmapBuffer(GL_ARRAY_BUFFER))
+	{
+		// the storage got lost, draw from client memory
+		extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+		StreamBufferAllocated = 0;
+		return false;
+	}
+	countBufferUpload(size);
+
+	vertices = buffer_offset(StreamBufferOffset);
+	if (indexBytes)
+	{
+		extGlBindBuffer(GL_ELEMENT_ARRAY_BUFFER, StreamBufferID);
+		indexList = buffer_offset(StreamBufferOffset + vertexBytes);
+	}
+	StreamBufferOffset += size;
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+void COpenGLDriver::createStreamingBuffer()
+{
+#if defined(GL_ARB_vertex_buffer_object)
+	deleteStreamingBuffer();
+
+	extGlGenBuffers(1, &StreamBufferID);
+	extGlBindBuffer(GL_ARRAY_BUFFER, StreamBufferID);
+	StreamBufferAllocated = StreamingBufferSize;
+	StreamBufferOffset = 0;
+	StreamSegment = 0;
+	StreamFencedSegment = 0;
+
+#if defined(GL_ARB_buffer_storage) && defined(GL_ARB_sync)
+	// stays mapped, fences tell when the GPU is done with a segment
+	if (FeatureAvailable[IRR_ARB_buffer_storage] && FeatureAvailable[IRR_ARB_sync])
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		extGlBufferStorage(GL_ARRAY_BUFFER, StreamBufferAllocated, 0, flags);
+		StreamBufferPointer = static_cast<u8*>(extGlMapBufferRange(GL_ARRAY_BUFFER, 0, StreamBufferAllocated, flags));
+		if (StreamBufferPointer)
+			return;
+
+		// the storage is immutable, start over with a buffer to orphan
+		extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+		extGlDeleteBuffers(1, &StreamBufferID);
+		extGlGenBuffers(1, &StreamBufferID);
+		extGlBindBuffer(GL_ARRAY_BUFFER, StreamBufferID);
+	}
+#endif
+	extGlBufferData(GL_ARRAY_BUFFER, StreamBufferAllocated, 0, GL_STREAM_DRAW);
+#endif
+}
+
+
+void COpenGLDriver::deleteStreamingBuffer()
+{
+#if defined(GL_ARB_vertex_buffer_object)
+#if defined(GL_ARB_sync)
+	for (u32 i=0; i<STREAM_BUFFER_SEGMENTS; ++i)
+	{
+		if (StreamFences[i])
+			extGlDeleteSync(StreamFences[i]);
+		StreamFences[i] = 0;
+	}
+#endif
+	// deleting the buffer unmaps it
+	if (StreamBufferID)
+		extGlDeleteBuffers(1, &StreamBufferID);
+	StreamBufferID = 0;
+	StreamBufferPointer = 0;
+	StreamBufferAllocated = 0;
+#endif
+}
+
+
+u32 COpenGLDriver::reserveStreamingBuffer(u32 size)
+{
+#if defined(GL_ARB_sync)
+	const u32 segmentSize = StreamBufferAllocated / STREAM_BUFFER_SEGMENTS;
+	const u32 offset = StreamBufferOffset;
+	if (offset + size <= (StreamSegment+1)*segmentSize)
+		return offset;
+
+	// a draw which does not fit into the current segment starts at the next
+	// one, so a segment is fenced after the last draw reading from it
+	u32 first = StreamSegment+1;
+	if (first*segmentSize + size > StreamBufferAllocated)
+	{
+		++FrameStatistics.StreamBufferWraps;
+		first = 0;
+	}
+	const u32 last = (first*segmentSize + size - 1) / segmentSize;
+
+	for (u32 i=StreamFencedSegment; i<=StreamSegment; ++i)
+		StreamFences[i] = extGlFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	for (u32 i=first; i<=last; ++i)
+	{
+		if (!StreamFences[i])
+			continue;
+		if (extGlClientWaitSync(StreamFences[i], 0, 0) == GL_TIMEOUT_EXPIRED)
+		{
+			++FrameStatistics.StreamBufferStalls;
+			while (extGlClientWaitSync(StreamFences[i], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED)
+				;
+		}
+		extGlDeleteSync(StreamFences[i]);
+		StreamFences[i] = 0;
+	}
+
+	StreamFencedSegment = first;
+	StreamSegment = last;
+	StreamBufferOffset = first*segmentSize;
+	return StreamBufferOffset;
+#else
+	return StreamBufferOffset;
+#endif
+}
+
+
+void COpenGLDriver::unbindStreamingBuffer(bool indices)
+{
+#if defined(GL_ARB_vertex_buffer_object)
+	extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+	if (indices)
+		extGlBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+#endif
+}
+
+
 void COpenGLDriver::getColorBuffer(const void* vertices, u32 vertexCount, E_VERTEX_TYPE vType)
 {
 	// convert colors to gl color format.
@@ -1056,7 +1566,11 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 
 	CNullDriver::draw2DVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 
-	if (vertices && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
+	// a stream offset of 0 leaves vertices 0, which takes the hardware buffer path below with the same offsets
+	const bool clientIndices = indexList != 0;
+	const bool streamed = streamVertices(vertices, vertexCount, indexList, getIndexCount(pType, primitiveCount), vType, iType);
+
+	if (vertices && !streamed && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
 		getColorBuffer(vertices, vertexCount, vType);
 
 	// draw everything
@@ -1077,7 +1591,7 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 #endif
 	if (vertices)
 	{
-		if (FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
+		if (streamed || FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
 		{
 			switch (vType)
 			{
@@ -1166,6 +1680,9 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 
 	renderArray(indexList, primitiveCount, pType, iType);
 
+	if (streamed)
+		unbindStreamingBuffer(clientIndices);
+
 	if (Feature.MaxTextureUnits > 0)
 	{
 		if ((vType!=EVT_STANDARD) || CacheHandler->getTextureCache()[1])
@@ -1926,6 +2443,14 @@ ITexture* COpenGLDriver::createDeviceDependentTextureCubemap(const io::path& nam
 	return texture;
 }
 
+void COpenGLDriver::replaceTextureImage(ITexture* texture, IImage* image)
+{
+	core::array<IImage*> imageArray(1);
+	imageArray.push_back(image);
+
+	static_cast<COpenGLTexture*>(texture)->replaceImages(imageArray);
+}
+
 void COpenGLDriver::disableFeature(E_VIDEO_DRIVER_FEATURE feature, bool flag)
 {
 	CNullDriver::disableFeature(feature, flag);
@@ -1942,9 +2467,16 @@ void COpenGLDriver::disableFeature(E_VIDEO_DRIVER_FEATURE feature, bool flag)
 //! Sets a material. All 3d drawing functions draw geometry now using this material.
 void COpenGLDriver::setMaterial(const SMaterial& material)
 {
+	countMaterialChange(material);
+
 	Material = material;
 	OverrideMaterial.apply(Material);
 
+	if (SkinningPalette && SkinnedMaterialType >= 0 && Material.MaterialType == EMT_SOLID)
+		Material.MaterialType = (E_MATERIAL_TYPE)SkinnedMaterialType;
+	else if (InstanceData && InstancedMaterialType >= 0 && Material.MaterialType == EMT_SOLID)
+		Material.MaterialType = (E_MATERIAL_TYPE)InstancedMaterialType;
+
 	for (u32 i = 0; i < Feature.MaxTextureUnits; ++i)
 	{
 		const ITexture* texture = Material.getTexture(i);
@@ -1957,6 +2489,53 @@ void COpenGLDriver::setMaterial(const SMaterial& material)
 }
 
 
+//! Sets the joint palette and joint stream for hardware skinning
+void COpenGLDriver::setSkinningData(const core::matrix4* palette, u32 jointCount,
+	const S3DVertexJoints* vertexJoints)
+{
+	CNullDriver::setSkinningData(palette, jointCount, vertexJoints);
+
+	if (SkinnedMaterialType < 0)
+		return;
+
+	// swap the material in case it was set before the skinning data
+	if (SkinningPalette && Material.MaterialType == EMT_SOLID)
+		Material.MaterialType = (E_MATERIAL_TYPE)SkinnedMaterialType;
+	else if (!SkinningPalette && Material.MaterialType == SkinnedMaterialType)
+		Material.MaterialType = EMT_SOLID;
+}
+
+
+//! Sets the instances drawn by the following mesh buffer draw calls
+void COpenGLDriver::setInstanceData(const S3DInstance* instances, u32 instanceCount)
+{
+	CNullDriver::setInstanceData(instances, instanceCount);
+
+	if (InstancedMaterialType < 0 || SkinningPalette)
+		return;
+
+	// swap the material in case it was set before the instances
+	if (InstanceData && Material.MaterialType == EMT_SOLID)
+		Material.MaterialType = (E_MATERIAL_TYPE)InstancedMaterialType;
+	else if (!InstanceData && Material.MaterialType == InstancedMaterialType)
+		Material.MaterialType = EMT_SOLID;
+}
+
+
+//! Check if the instances of a buffer are drawn with one call
+bool COpenGLDriver::canDrawInstances(const scene::IMeshBuffer* mb) const
+{
+	return canDrawInstances(mb->getPrimitiveType());
+}
+
+
+//! Check if instances of the primitive type are drawn with one call
+bool COpenGLDriver::canDrawInstances(scene::E_PRIMITIVE_TYPE pType) const
+{
+	return InstancedMaterialType >= 0 && Material.MaterialType == InstancedMaterialType && pType == scene::EPT_TRIANGLES;
+}
+
+
 //! prints error if an error happened.
 bool COpenGLDriver::testGLError(int code)
 {
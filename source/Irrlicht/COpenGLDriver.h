@@ -109,6 +109,11 @@ namespace video
 		//! queries the features of the driver, returns true if feature is available
 		virtual bool queryFeature(E_VIDEO_DRIVER_FEATURE feature) const _IRR_OVERRIDE_
 		{
+			if (feature == EVDF_HARDWARE_SKINNING)
+				return FeatureEnabled[feature] && SkinnedMaterialType >= 0;
+			if (feature == EVDF_HARDWARE_INSTANCING)
+				return FeatureEnabled[feature] && InstancedMaterialType >= 0;
+
 			return FeatureEnabled[feature] && COpenGLExtensionHandler::queryFeature(feature);
 		}
 
@@ -120,6 +125,13 @@ namespace video
 		//! \param material: Material to be used from now on.
 		virtual void setMaterial(const SMaterial& material) _IRR_OVERRIDE_;
 
+		//! Sets the joint palette and joint stream for hardware skinning
+		virtual void setSkinningData(const core::matrix4* palette, u32 jointCount,
+			const S3DVertexJoints* vertexJoints) _IRR_OVERRIDE_;
+
+		//! Sets the instances drawn by the following mesh buffer draw calls
+		virtual void setInstanceData(const S3DInstance* instances, u32 instanceCount) _IRR_OVERRIDE_;
+
 		virtual void draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
 			const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect = 0,
 			SColor color = SColor(255, 255, 255, 255), bool useAlphaChannelOfTexture = false) _IRR_OVERRIDE_;
@@ -408,6 +420,8 @@ namespace video
 		virtual ITexture* createDeviceDependentTexture(const io::path& name, IImage* image) _IRR_OVERRIDE_;
 
 		virtual ITexture* createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image) _IRR_OVERRIDE_;
+
+		virtual void replaceTextureImage(ITexture* texture, IImage* image) _IRR_OVERRIDE_;
 		
 		//! creates a transposed matrix in supplied GLfloat array to pass to OpenGL
 		inline void getGLMatrix(GLfloat gl_matrix[16], const core::matrix4& m);
@@ -424,11 +438,38 @@ namespace video
 
 		void createMaterialRenderers();
 
+		//! Check if the instances of a buffer are drawn with one call
+		virtual bool canDrawInstances(const scene::IMeshBuffer* mb) const _IRR_OVERRIDE_;
+
+		//! Check if instances of the primitive type are drawn with one call
+		bool canDrawInstances(scene::E_PRIMITIVE_TYPE pType) const;
+
 		//! Assign a hardware light to the specified requested light, if any
 		//! free hardware lights exist.
 		//! \param[in] lightIndex: the index of the requesting light
 		void assignHardwareLight(u32 lightIndex);
 
+		//! Copy vertices and indices from client memory into the streaming buffer
+		/** On success the streaming buffer is bound, vertices and
+		indexList (if there are indices) are offsets into it and the
+		colors are in the format glColorPointer expects.
+		\return False if the draw has to read from client memory. */
+		bool streamVertices(const void*& vertices, u32 vertexCount,
+				const void*& indexList, u32 indexCount, E_VERTEX_TYPE vType, E_INDEX_TYPE iType);
+
+		//! Unbind the streaming buffer after a draw with streamed vertices
+		void unbindStreamingBuffer(bool indices);
+
+		//! (Re)create the streaming buffer with the size set by setStreamingBufferSize()
+		void createStreamingBuffer();
+
+		//! Release the streaming buffer and its fences
+		void deleteStreamingBuffer();
+
+		//! Get the offset of size bytes in the persistently mapped streaming buffer
+		/** Waits until the GPU is done with the segments the bytes are in. */
+		u32 reserveStreamingBuffer(u32 size);
+
 		//! helper function for render setup.
 		void getColorBuffer(const void* vertices, u32 vertexCount, E_VERTEX_TYPE vType);
 
@@ -475,6 +516,22 @@ namespace video
 
 		E_OPENGL_FIXED_PIPELINE_STATE FixedPipelineState;
 
+		//! Buffer for vertices and indices from client memory, filled round robin
+		/** With ARB_buffer_storage the buffer stays mapped at StreamBufferPointer
+		and is split into segments which are fenced when the draws leave them,
+		otherwise the storage is orphaned when it is full. */
+		GLuint StreamBufferID;
+		u8* StreamBufferPointer;
+		u32 StreamBufferAllocated;
+		u32 StreamBufferOffset;
+		enum { STREAM_BUFFER_SEGMENTS = 4 };
+		GLsync StreamFences[STREAM_BUFFER_SEGMENTS];
+		//! Segment of the last draw, segments from StreamFencedSegment to it have no fence yet
+		u32 StreamSegment;
+		u32 StreamFencedSegment;
+		//! Copy of a streamed draw when the buffer can't be mapped
+		core::array<u8> StreamStagingBuffer;
+
 		SIrrlichtCreationParameters Params;
 
 		//! All the lights that have been requested; a hardware limited
@@ -494,6 +551,15 @@ namespace video
 		S3DVertex Quad2DVertices[4];
 		static const u16 Quad2DIndices[4];
 
+		//! Built-in GLSL material replacing EMT_SOLID while skinning data is set, -1 if not available
+		s32 SkinnedMaterialType = -1;
+
+		//! Built-in GLSL material replacing EMT_SOLID while instances are set, -1 if not available
+		s32 InstancedMaterialType = -1;
+
+		//! Locations of the instance attributes in the instanced material, -2 until looked up
+		GLint InstanceAttributes[6] = { -2, -2, -2, -2, -2, -2 };
+
 		SDL_Window *Window = nullptr;
 		SDL_GLContext Context = 0;
 	};
@@ -66,10 +66,11 @@ COpenGLExtensionHandler::COpenGLExtensionHandler() :
 	// MRTs
 	pGlDrawBuffersARB(0), pGlDrawBuffersATI(0),
 	pGlGenBuffersARB(0), pGlBindBufferARB(0), pGlBufferDataARB(0), pGlDeleteBuffersARB(0),
-	pGlBufferSubDataARB(0), pGlGetBufferSubDataARB(0), pGlMapBufferARB(0), pGlUnmapBufferARB(0),
+	pGlBufferSubDataARB(0), pGlGetBufferSubDataARB(0), pGlMapBufferARB(0), pGlMapBufferRange(0), pGlBufferStorage(0), pGlUnmapBufferARB(0),
 	pGlIsBufferARB(0), pGlGetBufferParameterivARB(0), pGlGetBufferPointervARB(0),
 	pGlProvokingVertexARB(0), pGlProvokingVertexEXT(0),
 	pGlProgramParameteriARB(0), pGlProgramParameteriEXT(0),
+	pGlFenceSync(0), pGlClientWaitSync(0), pGlDeleteSync(0),
 	pGlGenQueriesARB(0), pGlDeleteQueriesARB(0), pGlIsQueryARB(0),
 	pGlBeginQueryARB(0), pGlEndQueryARB(0), pGlGetQueryivARB(0),
 	pGlGetQueryObjectivARB(0), pGlGetQueryObjectuivARB(0),
@@ -77,6 +78,10 @@ COpenGLExtensionHandler::COpenGLExtensionHandler() :
 	pGlIsOcclusionQueryNV(0), pGlBeginOcclusionQueryNV(0),
 	pGlEndOcclusionQueryNV(0), pGlGetOcclusionQueryivNV(0),
 	pGlGetOcclusionQueryuivNV(0),
+	// Generic vertex attributes and instancing
+	pGlGetAttribLocation(0), pGlEnableVertexAttribArray(0), pGlDisableVertexAttribArray(0),
+	pGlVertexAttribPointer(0), pGlVertexAttribDivisorARB(0),
+	pGlDrawElementsInstancedARB(0), pGlDrawArraysInstancedARB(0),
 	// Blend
 	pGlBlendFuncSeparateEXT(0), pGlBlendFuncSeparate(0),
 	pGlBlendEquationEXT(0), pGlBlendEquation(0), pGlBlendEquationSeparateEXT(0), pGlBlendEquationSeparate(0),
@@ -492,6 +497,8 @@ void COpenGLExtensionHandler::initExtensions(bool stencilBuffer)
 	pGlBufferSubDataARB= (PFNGLBUFFERSUBDATAARBPROC) IRR_OGL_LOAD_EXTENSION("glBufferSubDataARB");
 	pGlGetBufferSubDataARB= (PFNGLGETBUFFERSUBDATAARBPROC)IRR_OGL_LOAD_EXTENSION("glGetBufferSubDataARB");
 	pGlMapBufferARB= (PFNGLMAPBUFFERARBPROC) IRR_OGL_LOAD_EXTENSION("glMapBufferARB");
+	pGlMapBufferRange= (PFNGLMAPBUFFERRANGEPROC) IRR_OGL_LOAD_EXTENSION("glMapBufferRange");
+	pGlBufferStorage= (PFNGLBUFFERSTORAGEPROC) IRR_OGL_LOAD_EXTENSION("glBufferStorage");
 	pGlUnmapBufferARB= (PFNGLUNMAPBUFFERARBPROC) IRR_OGL_LOAD_EXTENSION("glUnmapBufferARB");
 	pGlIsBufferARB= (PFNGLISBUFFERARBPROC) IRR_OGL_LOAD_EXTENSION("glIsBufferARB");
 	pGlGetBufferParameterivARB= (PFNGLGETBUFFERPARAMETERIVARBPROC) IRR_OGL_LOAD_EXTENSION("glGetBufferParameterivARB");
@@ -501,6 +508,11 @@ void COpenGLExtensionHandler::initExtensions(bool stencilBuffer)
 	pGlProgramParameteriARB= (PFNGLPROGRAMPARAMETERIARBPROC) IRR_OGL_LOAD_EXTENSION("glProgramParameteriARB");
 	pGlProgramParameteriEXT= (PFNGLPROGRAMPARAMETERIEXTPROC) IRR_OGL_LOAD_EXTENSION("glProgramParameteriEXT");
 
+	// sync objects
+	pGlFenceSync = (PFNGLFENCESYNCPROC) IRR_OGL_LOAD_EXTENSION("glFenceSync");
+	pGlClientWaitSync = (PFNGLCLIENTWAITSYNCPROC) IRR_OGL_LOAD_EXTENSION("glClientWaitSync");
+	pGlDeleteSync = (PFNGLDELETESYNCPROC) IRR_OGL_LOAD_EXTENSION("glDeleteSync");
+
 	// occlusion query
 	pGlGenQueriesARB = (PFNGLGENQUERIESARBPROC) IRR_OGL_LOAD_EXTENSION("glGenQueriesARB");
 	pGlDeleteQueriesARB = (PFNGLDELETEQUERIESARBPROC) IRR_OGL_LOAD_EXTENSION("glDeleteQueriesARB");
@@ -518,6 +530,15 @@ void COpenGLExtensionHandler::initExtensions(bool stencilBuffer)
 	pGlGetOcclusionQueryivNV = (PFNGLGETOCCLUSIONQUERYIVNVPROC) IRR_OGL_LOAD_EXTENSION("glGetOcclusionQueryivNV");
 	pGlGetOcclusionQueryuivNV = (PFNGLGETOCCLUSIONQUERYUIVNVPROC) IRR_OGL_LOAD_EXTENSION("glGetOcclusionQueryuivNV");
 
+	// generic vertex attributes and instancing
+	pGlGetAttribLocation = (PFNGLGETATTRIBLOCATIONPROC) IRR_OGL_LOAD_EXTENSION("glGetAttribLocation");
+	pGlEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC) IRR_OGL_LOAD_EXTENSION("glEnableVertexAttribArray");
+	pGlDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC) IRR_OGL_LOAD_EXTENSION("glDisableVertexAttribArray");
+	pGlVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC) IRR_OGL_LOAD_EXTENSION("glVertexAttribPointer");
+	pGlVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC) IRR_OGL_LOAD_EXTENSION("glVertexAttribDivisorARB");
+	pGlDrawElementsInstancedARB = (PFNGLDRAWELEMENTSINSTANCEDARBPROC) IRR_OGL_LOAD_EXTENSION("glDrawElementsInstancedARB");
+	pGlDrawArraysInstancedARB = (PFNGLDRAWARRAYSINSTANCEDARBPROC) IRR_OGL_LOAD_EXTENSION("glDrawArraysInstancedARB");
+
 	// blend
 	pGlBlendFuncSeparateEXT = (PFNGLBLENDFUNCSEPARATEEXTPROC) IRR_OGL_LOAD_EXTENSION("glBlendFuncSeparateEXT");
 	pGlBlendFuncSeparate = (PFNGLBLENDFUNCSEPARATEPROC) IRR_OGL_LOAD_EXTENSION("glBlendFuncSeparate");
@@ -1165,6 +1165,8 @@ class COpenGLExtensionHandler
 	void extGlBufferSubData (GLenum target, GLintptrARB offset, GLsizeiptrARB size, const GLvoid *data);
 	void extGlGetBufferSubData (GLenum target, GLintptrARB offset, GLsizeiptrARB size, GLvoid *data);
 	void *extGlMapBuffer (GLenum target, GLenum access);
+	void *extGlMapBufferRange (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+	void extGlBufferStorage (GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
 	GLboolean extGlUnmapBuffer (GLenum target);
 	GLboolean extGlIsBuffer (GLuint buffer);
 	void extGlGetBufferParameteriv (GLenum target, GLenum pname, GLint *params);
@@ -1172,6 +1174,20 @@ class COpenGLExtensionHandler
 	void extGlProvokingVertex(GLenum mode);
 	void extGlProgramParameteri(GLuint program, GLenum pname, GLint value);
 
+	// generic vertex attributes and instancing
+	GLint extGlGetAttribLocation(GLuint program, const char *name);
+	void extGlEnableVertexAttribArray(GLuint index);
+	void extGlDisableVertexAttribArray(GLuint index);
+	void extGlVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer);
+	void extGlVertexAttribDivisor(GLuint index, GLuint divisor);
+	void extGlDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount);
+	void extGlDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount);
+
+	// sync objects
+	GLsync extGlFenceSync(GLenum condition, GLbitfield flags);
+	GLenum extGlClientWaitSync(GLsync sync, GLbitfield flags, u64 timeout);
+	void extGlDeleteSync(GLsync sync);
+
 	// occlusion query
 	void extGlGenQueries(GLsizei n, GLuint *ids);
 	void extGlDeleteQueries(GLsizei n, const GLuint *ids);
@@ -1320,6 +1336,8 @@ class COpenGLExtensionHandler
 		PFNGLBUFFERSUBDATAARBPROC pGlBufferSubDataARB;
 		PFNGLGETBUFFERSUBDATAARBPROC pGlGetBufferSubDataARB;
 		PFNGLMAPBUFFERARBPROC pGlMapBufferARB;
+		PFNGLMAPBUFFERRANGEPROC pGlMapBufferRange;
+		PFNGLBUFFERSTORAGEPROC pGlBufferStorage;
 		PFNGLUNMAPBUFFERARBPROC pGlUnmapBufferARB;
 		PFNGLISBUFFERARBPROC pGlIsBufferARB;
 		PFNGLGETBUFFERPARAMETERIVARBPROC pGlGetBufferParameterivARB;
@@ -1328,6 +1346,9 @@ class COpenGLExtensionHandler
 		PFNGLPROVOKINGVERTEXEXTPROC pGlProvokingVertexEXT;
 		PFNGLPROGRAMPARAMETERIARBPROC pGlProgramParameteriARB;
 		PFNGLPROGRAMPARAMETERIEXTPROC pGlProgramParameteriEXT;
+		PFNGLFENCESYNCPROC pGlFenceSync;
+		PFNGLCLIENTWAITSYNCPROC pGlClientWaitSync;
+		PFNGLDELETESYNCPROC pGlDeleteSync;
 		PFNGLGENQUERIESARBPROC pGlGenQueriesARB;
 		PFNGLDELETEQUERIESARBPROC pGlDeleteQueriesARB;
 		PFNGLISQUERYARBPROC pGlIsQueryARB;
@@ -1343,6 +1364,14 @@ class COpenGLExtensionHandler
 		PFNGLENDOCCLUSIONQUERYNVPROC pGlEndOcclusionQueryNV;
 		PFNGLGETOCCLUSIONQUERYIVNVPROC pGlGetOcclusionQueryivNV;
 		PFNGLGETOCCLUSIONQUERYUIVNVPROC pGlGetOcclusionQueryuivNV;
+		// Generic vertex attributes and instancing
+		PFNGLGETATTRIBLOCATIONPROC pGlGetAttribLocation;
+		PFNGLENABLEVERTEXATTRIBARRAYPROC pGlEnableVertexAttribArray;
+		PFNGLDISABLEVERTEXATTRIBARRAYPROC pGlDisableVertexAttribArray;
+		PFNGLVERTEXATTRIBPOINTERPROC pGlVertexAttribPointer;
+		PFNGLVERTEXATTRIBDIVISORARBPROC pGlVertexAttribDivisorARB;
+		PFNGLDRAWELEMENTSINSTANCEDARBPROC pGlDrawElementsInstancedARB;
+		PFNGLDRAWARRAYSINSTANCEDARBPROC pGlDrawArraysInstancedARB;
 		// Blend
 		PFNGLBLENDFUNCSEPARATEEXTPROC pGlBlendFuncSeparateEXT;
 		PFNGLBLENDFUNCSEPARATEPROC pGlBlendFuncSeparate;
@@ -2494,6 +2523,32 @@ inline void *COpenGLExtensionHandler::extGlMapBuffer(GLenum target, GLenum acces
 #endif
 }
 
+inline void *COpenGLExtensionHandler::extGlMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlMapBufferRange)
+		return pGlMapBufferRange(target, offset, length, access);
+	return 0;
+#elif defined(GL_ARB_map_buffer_range)
+	return glMapBufferRange(target, offset, length, access);
+#else
+	os::Printer::log("glMapBufferRange not supported", ELL_ERROR);
+	return 0;
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlBufferStorage)
+		pGlBufferStorage(target, size, data, flags);
+#elif defined(GL_ARB_buffer_storage)
+	glBufferStorage(target, size, data, flags);
+#else
+	os::Printer::log("glBufferStorage not supported", ELL_ERROR);
+#endif
+}
+
 inline GLboolean COpenGLExtensionHandler::extGlUnmapBuffer(GLenum target)
 {
 #ifdef _IRR_OPENGL_USE_EXTPOINTER_
@@ -2584,6 +2639,46 @@ inline void COpenGLExtensionHandler::extGlProgramParameteri(GLuint program, GLen
 #endif
 }
 
+inline GLsync COpenGLExtensionHandler::extGlFenceSync(GLenum condition, GLbitfield flags)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlFenceSync)
+		return pGlFenceSync(condition, flags);
+	return 0;
+#elif defined(GL_ARB_sync)
+	return glFenceSync(condition, flags);
+#else
+	os::Printer::log("glFenceSync not supported", ELL_ERROR);
+	return 0;
+#endif
+}
+
+inline GLenum COpenGLExtensionHandler::extGlClientWaitSync(GLsync sync, GLbitfield flags, u64 timeout)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlClientWaitSync)
+		return pGlClientWaitSync(sync, flags, timeout);
+	return GL_WAIT_FAILED;
+#elif defined(GL_ARB_sync)
+	return glClientWaitSync(sync, flags, timeout);
+#else
+	os::Printer::log("glClientWaitSync not supported", ELL_ERROR);
+	return 0;
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDeleteSync(GLsync sync)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlDeleteSync)
+		pGlDeleteSync(sync);
+#elif defined(GL_ARB_sync)
+	glDeleteSync(sync);
+#else
+	os::Printer::log("glDeleteSync not supported", ELL_ERROR);
+#endif
+}
+
 inline void COpenGLExtensionHandler::extGlGenQueries(GLsizei n, GLuint *ids)
 {
 #ifdef _IRR_OPENGL_USE_EXTPOINTER_
@@ -2709,6 +2804,91 @@ inline void COpenGLExtensionHandler::extGlGetQueryObjectuiv(GLuint id, GLenum pn
 #endif
 }
 
+inline GLint COpenGLExtensionHandler::extGlGetAttribLocation(GLuint program, const char *name)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlGetAttribLocation)
+		return pGlGetAttribLocation(program, name);
+#elif defined(GL_VERSION_2_0)
+	return glGetAttribLocation(program, name);
+#else
+	os::Printer::log("glGetAttribLocation not supported", ELL_ERROR);
+#endif
+	return -1;
+}
+
+inline void COpenGLExtensionHandler::extGlEnableVertexAttribArray(GLuint index)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlEnableVertexAttribArray)
+		pGlEnableVertexAttribArray(index);
+#elif defined(GL_VERSION_2_0)
+	glEnableVertexAttribArray(index);
+#else
+	os::Printer::log("glEnableVertexAttribArray not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDisableVertexAttribArray(GLuint index)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlDisableVertexAttribArray)
+		pGlDisableVertexAttribArray(index);
+#elif defined(GL_VERSION_2_0)
+	glDisableVertexAttribArray(index);
+#else
+	os::Printer::log("glDisableVertexAttribArray not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlVertexAttribPointer)
+		pGlVertexAttribPointer(index, size, type, normalized, stride, pointer);
+#elif defined(GL_VERSION_2_0)
+	glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+#else
+	os::Printer::log("glVertexAttribPointer not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlVertexAttribDivisorARB)
+		pGlVertexAttribDivisorARB(index, divisor);
+#elif defined(GL_ARB_instanced_arrays)
+	glVertexAttribDivisorARB(index, divisor);
+#else
+	os::Printer::log("glVertexAttribDivisor not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlDrawElementsInstancedARB)
+		pGlDrawElementsInstancedARB(mode, count, type, indices, primcount);
+#elif defined(GL_ARB_draw_instanced)
+	glDrawElementsInstancedARB(mode, count, type, indices, primcount);
+#else
+	os::Printer::log("glDrawElementsInstanced not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlDrawArraysInstancedARB)
+		pGlDrawArraysInstancedARB(mode, first, count, primcount);
+#elif defined(GL_ARB_draw_instanced)
+	glDrawArraysInstancedARB(mode, first, count, primcount);
+#else
+	os::Printer::log("glDrawArraysInstanced not supported", ELL_ERROR);
+#endif
+}
+
 inline void COpenGLExtensionHandler::irrGlBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha)
 {
 #ifdef _IRR_OPENGL_USE_EXTPOINTER_
@@ -43,6 +43,9 @@ public:
 	//! creates/loads an animated mesh from the file.
 	virtual IAnimatedMesh* createMesh(io::IReadFile* file) _IRR_OVERRIDE_;
 
+	//! loads only the file, can run on a worker thread
+	virtual bool canLoadInBackground() const _IRR_OVERRIDE_ { return true; }
+
 private:
 
 	struct SPLYProperty
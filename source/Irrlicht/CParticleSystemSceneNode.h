@@ -213,6 +213,9 @@ public:
 	//! Returns type of the scene node
 	virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_PARTICLE_SYSTEM; }
 
+	//! Returns if OnAnimate() of this node only changes the node and its children
+	virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
 private:
 
 	void reallocateBuffers();
@@ -4,6 +4,8 @@
 
 #include "CProfiler.h"
 #include "CTimer.h"
+#include "IWriteFile.h"
+#include <stdio.h>
 
 namespace irr
 {
@@ -13,6 +15,84 @@ IRRLICHT_API IProfiler& IRRCALLCONV getProfiler()
 	return profiler;
 }
 
+namespace
+{
+	// buffers of the profiler the calling thread used last
+	thread_local const CProfiler* ThreadProfiler = 0;
+	thread_local void* ThreadProfilerData = 0;
+
+	// collects output and writes it in large blocks
+	class CTraceWriter
+	{
+	public:
+		CTraceWriter(io::IWriteFile* file) : File(file), Failed(false) {}
+
+		~CTraceWriter()
+		{
+			flush();
+		}
+
+		void write(const void* data, size_t size)
+		{
+			const c8* bytes = (const c8*)data;
+			for (size_t i=0; i<size; ++i)
+				Buffer.push_back(bytes[i]);
+			if (Buffer.size() >= 65536)
+				flush();
+		}
+
+		void write(const c8* text)
+		{
+			write(text, strlen(text));
+		}
+
+		//! Write a string as JSON string with quotes
+		void writeJsonString(const core::stringc& text)
+		{
+			write("\"");
+			for (u32 i=0; i<text.size(); ++i)
+			{
+				const c8 c = text[i];
+				if (c == '"' || c == '\\')
+				{
+					const c8 escaped[2] = { '\\', c };
+					write(escaped, 2);
+				}
+				else if ((u8)c < 0x20)
+				{
+					c8 escaped[8];
+					snprintf(escaped, sizeof(escaped), "\\u%04x", (u32)(u8)c);
+					write(escaped);
+				}
+				else
+					write(&c, 1);
+			}
+			write("\"");
+		}
+
+		bool flush()
+		{
+			if (Buffer.size() && File->write(Buffer.const_pointer(), Buffer.size()) != Buffer.size())
+				Failed = true;
+			Buffer.set_used(0);
+			return !Failed;
+		}
+
+	private:
+		io::IWriteFile* File;
+		core::array<c8> Buffer;
+		bool Failed;
+	};
+
+	core::stringc toUTF8(const core::stringw& text)
+	{
+		core::array<c8> buffer(text.size()*4+1);
+		buffer.set_used(text.size()*4+1);
+		core::wcharToUtf8(text.c_str(), buffer.pointer(), buffer.size());
+		return core::stringc(buffer.const_pointer());
+	}
+}
+
 CProfiler::CProfiler()
 {
 	Timer = new CTimer(true);
@@ -24,6 +104,239 @@ CProfiler::~CProfiler()
 {
 	if ( Timer )
 		Timer->drop();
+
+	for ( u32 i=0; i<Threads.size(); ++i )
+		delete Threads[i];
+}
+
+//! Buffers of the calling thread
+CProfiler::SThreadData* CProfiler::getThreadData()
+{
+	if ( ThreadProfiler == this )
+		return (SThreadData*)ThreadProfilerData;
+
+	const std::thread::id id = std::this_thread::get_id();
+	std::lock_guard<std::mutex> lock(ThreadsMutex);
+
+	SThreadData* data = 0;
+	for ( u32 i=0; i<Threads.size() && !data; ++i )
+	{
+		if ( Threads[i]->Id == id )
+			data = Threads[i];
+	}
+	if ( !data )
+	{
+		data = new SThreadData();
+		data->Id = id;
+		data->Number = Threads.size()+1;
+		Threads.push_back(data);
+	}
+
+	ThreadProfiler = this;
+	ThreadProfilerData = data;
+	return data;
+}
+
+void CProfiler::startOtherThread(u32 index)
+{
+	SThreadData* data = getThreadData();
+	std::lock_guard<std::mutex> lock(data->Mutex);
+
+	// ids have to be added before other threads use them, so the
+	// amount of profile data can't change while this is read
+	while ( data->Slots.size() < ProfileDatas.size() )
+		data->Slots.push_back(SThreadSlot());
+
+	SThreadSlot& slot = data->Slots[index];
+	if ( ++slot.StartStopCounter == 1 )
+		slot.LastTimeStarted = getTime();
+}
+
+void CProfiler::stopOtherThread(u32 index, u64 time)
+{
+	SThreadData* data = getThreadData();
+	std::lock_guard<std::mutex> lock(data->Mutex);
+
+	if ( index >= data->Slots.size() )
+		return;
+
+	SThreadSlot& slot = data->Slots[index];
+	--slot.StartStopCounter;
+	if ( slot.StartStopCounter == 0 )
+	{
+		const u64 diffTime = time - slot.LastTimeStarted;
+		++slot.CountCalls;
+		slot.TimeSum += diffTime;
+		if ( diffTime > slot.LongestTime )
+			slot.LongestTime = diffTime;
+
+		if ( Tracing.load(std::memory_order_relaxed) )
+		{
+			if ( data->Events.size() < TraceEventLimit.load(std::memory_order_relaxed) )
+			{
+				SProfileEvent event;
+				event.Index = index;
+				event.Thread = data->Number;
+				event.Start = slot.LastTimeStarted;
+				event.Duration = diffTime;
+				data->Events.push_back(event);
+			}
+			else
+				++data->DroppedEvents;
+		}
+	}
+	else if ( slot.StartStopCounter < 0 )
+	{
+		slot.StartStopCounter = 0;
+	}
+}
+
+//! Add the calls which other threads finished to the profile data
+void CProfiler::collectThreadData()
+{
+	std::lock_guard<std::mutex> lock(ThreadsMutex);
+	for ( u32 i=0; i<Threads.size(); ++i )
+	{
+		SThreadData* data = Threads[i];
+		std::lock_guard<std::mutex> threadLock(data->Mutex);
+		for ( u32 j=0; j<data->Slots.size(); ++j )
+		{
+			SThreadSlot& slot = data->Slots[j];
+			if ( !slot.CountCalls )
+				continue;
+
+			addTime(j, slot.CountCalls, slot.TimeSum, slot.LongestTime);
+			slot.CountCalls = 0;
+			slot.TimeSum = 0;
+			slot.LongestTime = 0;
+		}
+	}
+}
+
+//! Start or stop recording every profile call for writeTrace()
+void CProfiler::setTracing(bool enable, u32 maxEventsPerThread)
+{
+	if ( enable )
+	{
+		clearTrace();
+		TraceStart = getTime();
+	}
+	TraceEventLimit.store(maxEventsPerThread, std::memory_order_relaxed);
+	Tracing.store(enable, std::memory_order_relaxed);
+}
+
+//! Remove the recorded profile calls of all threads
+void CProfiler::clearTrace()
+{
+	TraceEvents.clear();
+	DroppedTraceEvents = 0;
+
+	std::lock_guard<std::mutex> lock(ThreadsMutex);
+	for ( u32 i=0; i<Threads.size(); ++i )
+	{
+		std::lock_guard<std::mutex> threadLock(Threads[i]->Mutex);
+		Threads[i]->Events.clear();
+		Threads[i]->DroppedEvents = 0;
+	}
+}
+
+//! Write the recorded profile calls of all threads
+bool CProfiler::writeTrace(io::IWriteFile* file, E_PROFILER_TRACE_FORMAT format)
+{
+	if ( !file )
+		return false;
+
+	core::array<SProfileEvent> events(TraceEvents);
+	u32 dropped = DroppedTraceEvents;
+	{
+		std::lock_guard<std::mutex> lock(ThreadsMutex);
+		for ( u32 i=0; i<Threads.size(); ++i )
+		{
+			std::lock_guard<std::mutex> threadLock(Threads[i]->Mutex);
+			for ( u32 j=0; j<Threads[i]->Events.size(); ++j )
+				events.push_back(Threads[i]->Events[j]);
+			dropped += Threads[i]->DroppedEvents;
+		}
+	}
+
+	if ( format == EPTF_BINARY )
+		return writeBinaryTrace(file, events, dropped);
+	return writeChromeTrace(file, events, dropped);
+}
+
+bool CProfiler::writeChromeTrace(io::IWriteFile* file, const core::array<SProfileEvent>& events, u32 dropped) const
+{
+	CTraceWriter writer(file);
+	c8 number[128];
+
+	writer.write("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+	// name the threads
+	u32 threadCount = 1;
+	for ( u32 i=0; i<events.size(); ++i )
+		threadCount = core::max_(threadCount, events[i].Thread+1);
+	for ( u32 i=0; i<threadCount; ++i )
+	{
+		snprintf(number, sizeof(number), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":", i);
+		writer.write(number);
+		snprintf(number, sizeof(number), i ? "thread %u" : "main", i);
+		writer.writeJsonString(number);
+		writer.write("}},\n");
+	}
+
+	// complete events with times in microseconds
+	for ( u32 i=0; i<events.size(); ++i )
+	{
+		const SProfileEvent& event = events[i];
+		const SProfileData& data = ProfileDatas[event.Index];
+		writer.write("{\"name\":");
+		writer.writeJsonString(toUTF8(data.getName()));
+		writer.write(",\"cat\":");
+		writer.writeJsonString(toUTF8(ProfileGroups[data.getGroupIndex()].getName()));
+		snprintf(number, sizeof(number), ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+			event.Thread, (event.Start - TraceStart) / 1000.0, event.Duration / 1000.0);
+		writer.write(number);
+	}
+
+	snprintf(number, sizeof(number), "{\"name\":\"dropped_events\",\"ph\":\"M\",\"pid\":0,\"args\":{\"count\":%u}}\n]}\n", dropped);
+	writer.write(number);
+	return writer.flush();
+}
+
+bool CProfiler::writeBinaryTrace(io::IWriteFile* file, const core::array<SProfileEvent>& events, u32 dropped) const
+{
+	CTraceWriter writer(file);
+
+	writer.write("IRRTRACE", 8);
+	const u32 header[4] = { 1, ProfileDatas.size(), events.size(), dropped };
+	writer.write(header, sizeof(header));
+	writer.write(&TraceStart, sizeof(TraceStart));
+
+	for ( u32 i=0; i<ProfileDatas.size(); ++i )
+	{
+		const SProfileData& data = ProfileDatas[i];
+		const s32 id = data.getId();
+		writer.write(&id, sizeof(id));
+
+		const core::stringc name = toUTF8(data.getName());
+		const u32 nameLength = name.size();
+		writer.write(&nameLength, sizeof(nameLength));
+		writer.write(name.c_str(), nameLength);
+
+		const core::stringc group = toUTF8(ProfileGroups[data.getGroupIndex()].getName());
+		const u32 groupLength = group.size();
+		writer.write(&groupLength, sizeof(groupLength));
+		writer.write(group.c_str(), groupLength);
+	}
+
+	for ( u32 i=0; i<events.size(); ++i )
+	{
+		writer.write(&events[i].Index, sizeof(u32));
+		writer.write(&events[i].Thread, sizeof(u32));
+		writer.write(&events[i].Start, sizeof(u64));
+		writer.write(&events[i].Duration, sizeof(u64));
+	}
+	return writer.flush();
 }
 
 void CProfiler::printAll(core::stringw &ostream, bool includeOverview, bool suppressUncalled) const
@@ -79,9 +392,9 @@ core::stringw CProfiler::getAsString(const SProfileData& data) const
 		// Can't use swprintf as it fails on some platforms (especially mobile platforms)
 		// Can't use Irrlicht functions because we have no string formatting.
 		char dummy[1023];
-		sprintf(dummy, "%-15.15s%-12u%-12u%-12u%-12u",
-			core::stringc(data.getName()).c_str(), data.getCallsCounter(), data.getTimeSum(),
-			data.getTimeSum() / data.getCallsCounter(), data.getLongestTime());
+		sprintf(dummy, "%-15.15s%-12u%-12.3f%-12.3f%-12.3f",
+			core::stringc(data.getName()).c_str(), data.getCallsCounter(), data.getTimeSumNs() / 1000000.0,
+			data.getTimeSumNs() / 1000000.0 / data.getCallsCounter(), data.getLongestTimeNs() / 1000000.0);
 		dummy[1022] = 0;
 
 		return core::stringw(dummy);
@@ -98,7 +411,7 @@ core::stringw CProfiler::getAsString(const SProfileData& data) const
 //! Return a string which describes the columns returned by getAsString
 core::stringw CProfiler::makeTitleString() const
 {
-	return core::stringw("name           calls       time(sum)   time(avg)   time(max)");
+	return core::stringw("name           calls       ms(sum)     ms(avg)     ms(max)");
 }
 
 } // namespace irr
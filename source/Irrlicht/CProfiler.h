@@ -6,6 +6,7 @@
 #define __C_PROFILER_H_INCLUDED__
 
 #include "IProfiler.h"
+#include <mutex>
 
 namespace irr
 {
@@ -16,6 +17,18 @@ public:
 	CProfiler();
 	virtual ~CProfiler();
 
+	//! Add the calls which other threads finished to the profile data
+	virtual void collectThreadData() _IRR_OVERRIDE_;
+
+	//! Start or stop recording every profile call for writeTrace()
+	virtual void setTracing(bool enable, u32 maxEventsPerThread) _IRR_OVERRIDE_;
+
+	//! Remove the recorded profile calls of all threads
+	virtual void clearTrace() _IRR_OVERRIDE_;
+
+	//! Write the recorded profile calls of all threads
+	virtual bool writeTrace(io::IWriteFile* file, E_PROFILER_TRACE_FORMAT format) _IRR_OVERRIDE_;
+
 	//! Write all profile-data into a string
 	virtual void printAll(core::stringw &result, bool includeOverview,bool suppressUncalled) const  _IRR_OVERRIDE_;
 
@@ -25,6 +38,47 @@ public:
 protected:
 	core::stringw makeTitleString() const;
 	core::stringw getAsString(const SProfileData& data) const;
+
+	virtual void startOtherThread(u32 index) _IRR_OVERRIDE_;
+	virtual void stopOtherThread(u32 index, u64 time) _IRR_OVERRIDE_;
+
+private:
+
+	//! State and finished calls of a profile data in another thread than the owning one
+	struct SThreadSlot
+	{
+		SThreadSlot() : StartStopCounter(0), LastTimeStarted(0),
+			CountCalls(0), TimeSum(0), LongestTime(0) {}
+
+		s32 StartStopCounter;
+		u64 LastTimeStarted;
+		u32 CountCalls;
+		u64 TimeSum;
+		u64 LongestTime;
+	};
+
+	//! Buffers of another thread, only locked by it and when collecting
+	struct SThreadData
+	{
+		SThreadData() : Number(0), DroppedEvents(0) {}
+
+		std::thread::id Id;
+		u32 Number;
+		std::mutex Mutex;
+		core::array<SThreadSlot> Slots;
+		core::array<SProfileEvent> Events;
+		u32 DroppedEvents;
+	};
+
+	//! Buffers of the calling thread
+	SThreadData* getThreadData();
+
+	//! Write a trace in one of the formats
+	bool writeChromeTrace(io::IWriteFile* file, const core::array<SProfileEvent>& events, u32 dropped) const;
+	bool writeBinaryTrace(io::IWriteFile* file, const core::array<SProfileEvent>& events, u32 dropped) const;
+
+	core::array<SThreadData*> Threads;
+	std::mutex ThreadsMutex;
 };
 } // namespace irr
 
@@ -42,6 +42,9 @@ public:
 	//! Returns type of the scene node
 	virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_Q3SHADER_SCENE_NODE; }
 
+	//! Returns if OnAnimate() of this node only changes the node and its children
+	virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
 	virtual void setMesh(IMesh* mesh)_IRR_OVERRIDE_ {}
 	virtual IMesh* getMesh() _IRR_OVERRIDE_ { return Mesh; }
 	virtual void setReadOnlyMaterials(bool readonly) _IRR_OVERRIDE_ {}
@@ -3,12 +3,21 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CReadFile.h"
+#include "CMappedReadFile.h"
+#include <string.h>
 
 namespace irr
 {
 namespace io
 {
 
+namespace
+{
+	// files of other types which archives are opened from, like files
+	// in other archives. Recursive, as those read from their own files.
+	std::recursive_mutex SharedFileLock;
+}
+
 
 CReadFile::CReadFile(const io::path& fileName)
 : File(0), FileSize(0), Filename(fileName)
@@ -108,6 +117,39 @@ IReadFile* CReadFile::createReadFile(const io::path& fileName)
 }
 
 
+//! Seek and read under the lock of the file
+size_t CReadFile::readAt(long pos, void* buffer, size_t sizeToRead)
+{
+	std::lock_guard<std::mutex> lock(Lock);
+	if (!seek(pos))
+		return 0;
+	return read(buffer, sizeToRead);
+}
+
+
+//! Read from a position of a file which files opened from an archive share
+size_t readFileAt(IReadFile* file, long pos, void* buffer, size_t sizeToRead)
+{
+	const u8* memory = getReadFileMemory(file);
+	if (memory)
+	{
+		if (pos < 0 || pos >= file->getSize())
+			return 0;
+		const size_t size = core::min_((size_t)(file->getSize() - pos), sizeToRead);
+		memcpy(buffer, memory + pos, size);
+		return size;
+	}
+
+	if (file->getType() == ERFT_READ_FILE)
+		return static_cast<CReadFile*>(file)->readAt(pos, buffer, sizeToRead);
+
+	std::lock_guard<std::recursive_mutex> lock(SharedFileLock);
+	if (!file->seek(pos))
+		return 0;
+	return file->read(buffer, sizeToRead);
+}
+
+
 } // end namespace io
 } // end namespace irr
 
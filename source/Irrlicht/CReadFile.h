@@ -6,6 +6,7 @@
 #define __C_READ_FILE_H_INCLUDED__
 
 #include <stdio.h>
+#include <mutex>
 #include "IReadFile.h"
 #include "irrString.h"
 
@@ -56,6 +57,9 @@ namespace io
 		//! create read file on disk.
 		static IReadFile* createReadFile(const io::path& fileName);
 
+		//! Seek and read under the lock of the file, see readFileAt()
+		size_t readAt(long pos, void* buffer, size_t sizeToRead);
+
 	private:
 
 		//! opens the file
@@ -64,8 +68,18 @@ namespace io
 		FILE* File;
 		long FileSize;
 		io::path Filename;
+		//! Held by readAt()
+		std::mutex Lock;
 	};
 
+	//! Read from a position of a file which files opened from an archive share
+	/** The files opened from an archive may be read by several threads,
+	which all seek the file of the archive before they read from it. The
+	seek and the read are done together under a lock of the file, files
+	in memory are copied from without seeking.
+	\return Amount of bytes read. */
+	size_t readFileAt(IReadFile* file, long pos, void* buffer, size_t sizeToRead);
+
 } // end namespace io
 } // end namespace irr
 
@@ -0,0 +1,176 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CRenderQueue.h"
+#include "SMaterial.h"
+#include <string.h>
+
+namespace irr
+{
+namespace scene
+{
+
+// bits of the fields in the sort key, from most to least significant
+static const u32 PassBits = 4;
+static const u32 RendererBits = 10;
+static const u32 TextureBits = 22;
+static const u32 BlendBits = 8;
+static const u32 DepthBits = 20;
+
+static const u32 DepthShift = 0;
+static const u32 BlendShift = DepthShift + DepthBits;
+static const u32 TextureShift = BlendShift + BlendBits;
+static const u32 RendererShift = TextureShift + TextureBits;
+static const u32 PassShift = RendererShift + RendererBits;
+
+// below this size insertion sort beats the radix passes
+static const u32 MinRadixSortSize = 32;
+
+
+//! Index of the highest set bit of the pass, passes are single bits
+static u32 getPassIndex(E_SCENE_NODE_RENDER_PASS pass)
+{
+	u32 index = 0;
+	for (u32 p=(u32)pass; p>1; p>>=1)
+		++index;
+	return index;
+}
+
+
+//! Hash of the textures of all layers, folded to the bits available in the key
+static u32 getTextureSetHash(const video::SMaterial& material)
+{
+	u64 hash = 14695981039346656037ull;
+	for (u32 i=0; i<video::MATERIAL_MAX_TEXTURES; ++i)
+	{
+		hash ^= (u64)(size_t)material.getTexture(i);
+		hash *= 1099511628211ull;
+	}
+	hash ^= hash >> 32;
+	hash ^= hash >> TextureBits;
+	return (u32)hash & ((1u << TextureBits) - 1);
+}
+
+
+u64 CRenderQueue::makeKey(E_SCENE_NODE_RENDER_PASS pass, const video::SMaterial& material, f32 depth)
+{
+	const u64 pass64 = getPassIndex(pass) & ((1u << PassBits) - 1);
+
+	// custom material types which don't fit are sorted together
+	const u64 renderer = core::min_((u32)material.MaterialType, (1u << RendererBits) - 1);
+
+	const u64 blend = (u64)material.BlendOperation
+		| ((u64)material.ZWriteEnable << 4)
+		| ((u64)material.BackfaceCulling << 6)
+		| ((u64)material.FrontfaceCulling << 7);
+
+	const u64 depth64 = (u64)(core::clamp(depth, 0.f, 1.f) * (f32)((1u << DepthBits) - 1));
+
+	return (pass64 << PassShift)
+		| (renderer << RendererShift)
+		| ((u64)getTextureSetHash(material) << TextureShift)
+		| (blend << BlendShift)
+		| (depth64 << DepthShift);
+}
+
+
+void CRenderQueue::add(u64 key, ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial* material)
+{
+	SRenderQueueEntry entry;
+	entry.Node = node;
+	entry.MeshBuffer = meshBuffer;
+	entry.Material = material;
+
+	SSortItem item;
+	item.Key = key;
+	item.Index = Entries.size();
+
+	Entries.push_back(entry);
+	Items.push_back(item);
+}
+
+
+//! Stable LSD radix sort over the bytes of the keys
+void CRenderQueue::sort()
+{
+	const u32 count = Items.size();
+	if (count < 2)
+		return;
+
+	SSortItem* items = Items.pointer();
+
+	if (count < MinRadixSortSize)
+	{
+		for (u32 i=1; i<count; ++i)
+		{
+			const SSortItem item = items[i];
+			u32 j = i;
+			for (; j>0 && items[j-1].Key > item.Key; --j)
+				items[j] = items[j-1];
+			items[j] = item;
+		}
+		return;
+	}
+
+	// histograms of all digits in one go
+	u32 histograms[8][256];
+	memset(histograms, 0, sizeof(histograms));
+	for (u32 i=0; i<count; ++i)
+	{
+		const u64 key = items[i].Key;
+		for (u32 d=0; d<8; ++d)
+			++histograms[d][(key >> (d*8)) & 0xff];
+	}
+
+	Scratch.set_used(count);
+	SSortItem* src = items;
+	SSortItem* dst = Scratch.pointer();
+
+	for (u32 d=0; d<8; ++d)
+	{
+		const u32 shift = d*8;
+		u32* histogram = histograms[d];
+
+		// nothing to do when all keys share this digit, which is
+		// common for the pass and renderer bytes
+		if (histogram[(src[0].Key >> shift) & 0xff] == count)
+			continue;
+
+		u32 offset = 0;
+		for (u32 b=0; b<256; ++b)
+		{
+			const u32 n = histogram[b];
+			histogram[b] = offset;
+			offset += n;
+		}
+
+		for (u32 i=0; i<count; ++i)
+			dst[histogram[(src[i].Key >> shift) & 0xff]++] = src[i];
+
+		SSortItem* swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	if (src != items)
+		memcpy(items, src, count*sizeof(SSortItem));
+}
+
+
+void CRenderQueue::clear()
+{
+	Entries.set_used(0);
+	Items.set_used(0);
+}
+
+
+void CRenderQueue::reset()
+{
+	Entries.clear();
+	Items.clear();
+	Scratch.clear();
+}
+
+
+} // end namespace scene
+} // end namespace irr
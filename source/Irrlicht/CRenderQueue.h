@@ -0,0 +1,91 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_RENDER_QUEUE_H_INCLUDED__
+#define __C_RENDER_QUEUE_H_INCLUDED__
+
+#include "irrArray.h"
+#include "ISceneManager.h"
+
+namespace irr
+{
+namespace video
+{
+	class SMaterial;
+}
+namespace scene
+{
+	class ISceneNode;
+	class IMeshBuffer;
+
+	//! Something the scene manager draws in a render pass
+	/** Either a single mesh buffer which the scene manager draws with the
+	absolute transformation of Node, or (when MeshBuffer is 0) a whole node
+	which renders itself. */
+	struct SRenderQueueEntry
+	{
+		ISceneNode* Node;
+		IMeshBuffer* MeshBuffer;
+		const video::SMaterial* Material;
+	};
+
+	//! Render queue which orders its entries by a packed 64 bit key
+	/** The key holds, from the most to the least significant bits, the
+	render pass, the material renderer (shader materials are material
+	renderers too), a hash of the texture set, the blend state and the
+	quantized depth. Sorting the keys groups draws with the same state, so
+	the driver sees fewer state changes, and draws near the camera first
+	within each group. Entries with equal keys keep the order in which
+	they were added. */
+	class CRenderQueue
+	{
+	public:
+
+		//! Build the sort key for a material
+		/** \param pass Render pass of the entry.
+		\param material Material the entry is drawn with.
+		\param depth Distance to the camera, scaled to 0..1. Values
+		outside are clamped. */
+		static u64 makeKey(E_SCENE_NODE_RENDER_PASS pass, const video::SMaterial& material, f32 depth);
+
+		//! Add an entry
+		void add(u64 key, ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial* material);
+
+		//! Sort the entries by their keys
+		void sort();
+
+		//! Remove all entries, but keep the memory
+		void clear();
+
+		//! Remove all entries and free the memory
+		void reset();
+
+		//! Amount of entries
+		u32 size() const
+		{
+			return Items.size();
+		}
+
+		//! Access an entry, in sorted order after sort() was called
+		const SRenderQueueEntry& operator[](u32 index) const
+		{
+			return Entries[Items[index].Index];
+		}
+
+	private:
+
+		struct SSortItem
+		{
+			u64 Key;
+			u32 Index;
+		};
+
+		core::array<SRenderQueueEntry> Entries;
+		core::array<SSortItem> Items;
+		core::array<SSortItem> Scratch;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
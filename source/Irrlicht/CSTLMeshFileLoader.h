@@ -29,6 +29,9 @@ public:
 	//! See IReferenceCounted::drop() for more information.
 	virtual IAnimatedMesh* createMesh(io::IReadFile* file) _IRR_OVERRIDE_;
 
+	//! loads only the file, can run on a worker thread
+	virtual bool canLoadInBackground() const _IRR_OVERRIDE_ { return true; }
+
 private:
 
 	// skips to the first non-space character available
@@ -7,6 +7,7 @@
 #include "ICameraSceneNode.h"
 #include "ITriangleSelector.h"
 #include "SViewFrustum.h"
+#include "CWorkerPool.h"
 
 #include "os.h"
 #include "irrMath.h"
@@ -337,22 +338,22 @@ ISceneNode* CSceneCollisionManager::getSceneNodeFromCameraBB(
 	return getSceneNodeFromRayBB(core::line3d<f32>(start, end), idBitMask, noDebugObjects);
 }
 
-bool CSceneCollisionManager::getCollisionPoint(SCollisionHit& hitResult, const core::line3d<f32>& ray, ITriangleSelector* selector)
+// Ray test against all triangles the selector returns for the ray.
+// The arrays are scratch memory so several threads can run this
+// at the same time, each with its own arrays.
+static bool getNearestTriangleHit(SCollisionHit& hitResult, const core::line3d<f32>& ray,
+	ITriangleSelector* selector, core::array<core::triangle3df>& triangles,
+	core::array<SCollisionTriangleRange>& outTriangleInfo)
 {
-	if (!selector)
-	{
-		return false;
-	}
-
 	s32 totalcnt = selector->getTriangleCount();
 	if ( totalcnt <= 0 )
 		return false;
 
-	Triangles.set_used(totalcnt);
+	triangles.set_used(totalcnt);
 
 	s32 cnt = 0;
-	irr::core::array<SCollisionTriangleRange> outTriangleInfo;
-	selector->getTriangles(Triangles.pointer(), totalcnt, cnt, ray, 0, true, &outTriangleInfo);
+	outTriangleInfo.set_used(0);
+	selector->getTriangles(triangles.pointer(), totalcnt, cnt, ray, 0, true, &outTriangleInfo);
 
 	const core::vector3df linevect = ray.getVector().normalize();
 	core::vector3df intersection;
@@ -369,7 +370,7 @@ bool CSceneCollisionManager::getCollisionPoint(SCollisionHit& hitResult, const c
 
 	for (s32 i=0; i<cnt; ++i)
 	{
-		const core::triangle3df & triangle = Triangles[i];
+		const core::triangle3df & triangle = triangles[i];
 
 		if(minX > triangle.pointA.X && minX > triangle.pointB.X && minX > triangle.pointC.X)
 			continue;
@@ -421,6 +422,107 @@ bool CSceneCollisionManager::getCollisionPoint(SCollisionHit& hitResult, const c
 	return false;
 }
 
+
+namespace
+{
+	// Casts a range of rays of a batch, each thread with its own buffers
+	class CRayBatchJob : public IWorkerJob
+	{
+	public:
+		CRayBatchJob(SCollisionHit* hitResults, bool* hitFound, const core::line3d<f32>* rays,
+			ITriangleSelector* selector, core::array<CSceneCollisionManager::SQueryBuffers>& scratch)
+			: HitResults(hitResults), HitFound(hitFound), Rays(rays), Selector(selector),
+			Scratch(scratch), UseHierarchy(selector->hasNearestHitQuery()), HitCount(0)
+		{
+		}
+
+		virtual void run(u32 begin, u32 end, u32 thread) _IRR_OVERRIDE_
+		{
+			CSceneCollisionManager::SQueryBuffers& scratch = Scratch[thread];
+
+			u32 hits = 0;
+			for (u32 i=begin; i<end; ++i)
+			{
+				SCollisionHit& hit = HitResults[i];
+				hit = SCollisionHit();
+
+				bool found;
+				if (UseHierarchy)
+					found = Selector->getNearestHit(hit, Rays[i]);
+				else
+					found = getNearestTriangleHit(hit, Rays[i], Selector, scratch.Triangles, scratch.TriangleInfo);
+
+				if (found)
+					++hits;
+				else
+					hit = SCollisionHit();
+				if (HitFound)
+					HitFound[i] = found;
+			}
+			HitCount += hits;
+		}
+
+		u32 getHitCount() const { return HitCount; }
+
+	private:
+		SCollisionHit* HitResults;
+		bool* HitFound;
+		const core::line3d<f32>* Rays;
+		ITriangleSelector* Selector;
+		core::array<CSceneCollisionManager::SQueryBuffers>& Scratch;
+		bool UseHierarchy;
+		std::atomic<u32> HitCount;
+	};
+}
+
+bool CSceneCollisionManager::getCollisionPoint(SCollisionHit& hitResult, const core::line3d<f32>& ray, ITriangleSelector* selector)
+{
+	if (!selector)
+	{
+		return false;
+	}
+
+	// selectors with their own hierarchy don't need to copy triangles
+	if (selector->hasNearestHitQuery())
+		return selector->getNearestHit(hitResult, ray);
+
+	return getNearestTriangleHit(hitResult, ray, selector, Buffers.Triangles, Buffers.TriangleInfo);
+}
+
+//! Finds the nearest collision points of many lines and lots of triangles.
+u32 CSceneCollisionManager::getCollisionPoints(SCollisionHit* hitResults, bool* hitFound,
+		const core::line3d<f32>* rays, u32 rayCount, ITriangleSelector* selector)
+{
+	if (!hitResults || !rays || !rayCount)
+		return 0;
+
+	if (!selector)
+	{
+		for (u32 i=0; i<rayCount; ++i)
+		{
+			hitResults[i] = SCollisionHit();
+			if (hitFound)
+				hitFound[i] = false;
+		}
+		return 0;
+	}
+
+	CWorkerPool& pool = getWorkerPool();
+	while (ThreadBuffers.size() < pool.getThreadCount())
+		ThreadBuffers.push_back(SQueryBuffers());
+
+	// The first ray runs alone: selectors built from animated nodes or
+	// bounding boxes refresh their triangles there and are only read
+	// afterwards.
+	CRayBatchJob first(hitResults, hitFound, rays, selector, ThreadBuffers);
+	first.run(0, 1, 0);
+
+	CRayBatchJob rest(hitResults+1, hitFound ? hitFound+1 : 0, rays+1, selector, ThreadBuffers);
+	pool.parallelFor(rest, rayCount-1, 16);
+
+	return first.getHitCount() + rest.getHitCount();
+}
+
 //! Collides a moving ellipsoid with a 3d world with gravity and returns
 //! the resulting new position of the ellipsoid.
 core::vector3df CSceneCollisionManager::getCollisionResultPosition(
@@ -435,15 +537,65 @@ core::vector3df CSceneCollisionManager::getCollisionResultPosition(
 		const core::vector3df& gravity)
 {
 	return collideEllipsoidWithWorld(selector, position,
-		radius, direction, slidingSpeed, gravity, triout, hitPosition, outFalling, outNode);
+		radius, direction, slidingSpeed, gravity, triout, hitPosition, outFalling, outNode, Buffers);
 }
 
 
-bool CSceneCollisionManager::testTriangleIntersection(SCollisionData* colData,
-			const core::triangle3df& triangle)
+// Moves a range of ellipsoids of a batch, each thread with its own buffers
+class CSceneCollisionManager::CMoveBatchJob : public IWorkerJob
 {
-	const core::plane3d<f32> trianglePlane = triangle.getPlane();
+public:
+	CMoveBatchJob(CSceneCollisionManager& manager, ITriangleSelector* selector, SCollisionMove* moves)
+		: Manager(manager), Selector(selector), Moves(moves)
+	{
+	}
 
+	virtual void run(u32 begin, u32 end, u32 thread) _IRR_OVERRIDE_
+	{
+		SQueryBuffers& buffers = Manager.ThreadBuffers[thread];
+
+		for (u32 i=begin; i<end; ++i)
+		{
+			SCollisionMove& move = Moves[i];
+			move.Node = 0;
+			move.ResultPosition = Manager.collideEllipsoidWithWorld(Selector, move.Position,
+				move.Radius, move.DirectionAndSpeed, move.SlidingSpeed, move.Gravity,
+				move.Triangle, move.HitPosition, move.Falling, move.Node, buffers, &move.Collided);
+		}
+	}
+
+private:
+	CSceneCollisionManager& Manager;
+	ITriangleSelector* Selector;
+	SCollisionMove* Moves;
+};
+
+
+//! Collides many moving ellipsoids with a 3d world with gravity.
+void CSceneCollisionManager::getCollisionResultPositions(ITriangleSelector* selector,
+	SCollisionMove* moves, u32 moveCount)
+{
+	if (!moves || !moveCount)
+		return;
+
+	CWorkerPool& pool = getWorkerPool();
+	while (ThreadBuffers.size() < pool.getThreadCount())
+		ThreadBuffers.push_back(SQueryBuffers());
+
+	// The first move runs alone: selectors built from animated nodes or
+	// bounding boxes refresh their triangles there and are only read
+	// afterwards.
+	CMoveBatchJob first(*this, selector, moves);
+	first.run(0, 1, 0);
+
+	CMoveBatchJob rest(*this, selector, moves+1);
+	pool.parallelFor(rest, moveCount-1, 4);
+}
+
+
+bool CSceneCollisionManager::testTriangleIntersection(SCollisionData* colData,
+			const core::triangle3df& triangle, const core::plane3d<f32>& trianglePlane) const
+{
 	// only check front facing polygons
 	if ( !trianglePlane.isFrontFacing(colData->normalizedVelocity) )
 		return false;
@@ -699,8 +851,13 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 		core::triangle3df& triout,
 		core::vector3df& hitPosition,
 		bool& outFalling,
-		ISceneNode*& outNode)
+		ISceneNode*& outNode,
+		SQueryBuffers& buffers,
+		bool* outCollided) const
 {
+	if (outCollided)
+		*outCollided = false;
+
 	if (!selector || radius.X == 0.0f || radius.Y == 0.0f || radius.Z == 0.0f)
 		return position;
 
@@ -722,6 +879,7 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 
 	// iterate until we have our final position
 
+	getCollisionCandidates(colData, buffers);
 	core::vector3df finalPos = collideWithWorld(
 		0, colData, eSpacePosition, eSpaceVelocity);
 
@@ -737,6 +895,7 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 
 		eSpaceVelocity = gravity/colData.eRadius;
 
+		getCollisionCandidates(colData, buffers);
 		finalPos = collideWithWorld(0, colData,
 			finalPos, eSpaceVelocity);
 
@@ -750,6 +909,8 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 		triout.pointB *= colData.eRadius;
 		triout.pointC *= colData.eRadius;
 		outNode = colData.node;
+		if (outCollided)
+			*outCollided = true;
 	}
 
 	finalPos *= colData.eRadius;
@@ -758,23 +919,8 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 }
 
 
-core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
-	SCollisionData &colData, const core::vector3df& pos, const core::vector3df& vel)
+void CSceneCollisionManager::getCollisionCandidates(SCollisionData& colData, SQueryBuffers& buffers) const
 {
-	f32 veryCloseDistance = colData.slidingSpeed;
-
-	if (recursionDepth > 5)
-		return pos;
-
-	colData.velocity = vel;
-	colData.normalizedVelocity = vel;
-	colData.normalizedVelocity.normalize();
-	colData.basePoint = pos;
-	colData.foundCollision = false;
-	colData.nearestDistance = FLT_MAX;
-
-	//------------------ collide with world
-
 	// get all triangles with which we might collide
 	core::aabbox3d<f32> box(colData.R3Position);
 	box.addInternalPoint(colData.R3Position + colData.R3Velocity);
@@ -782,7 +928,7 @@ core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
 	box.MaxEdge += colData.eRadius;
 
 	s32 totalTriangleCnt = colData.selector->getTriangleCount();
-	Triangles.set_used(totalTriangleCnt);
+	buffers.Triangles.set_used(totalTriangleCnt);
 
 	core::matrix4 scaleMatrix;
 	scaleMatrix.setScale(
@@ -790,26 +936,53 @@ core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
 					1.0f / colData.eRadius.Y,
 					1.0f / colData.eRadius.Z));
 
-	irr::core::array<SCollisionTriangleRange> outTriangleInfo;
+	buffers.TriangleInfo.set_used(0);
 	s32 triangleCnt = 0;
-	colData.selector->getTriangles(Triangles.pointer(), totalTriangleCnt, triangleCnt, box, &scaleMatrix, true, &outTriangleInfo);
+	colData.selector->getTriangles(buffers.Triangles.pointer(), totalTriangleCnt, triangleCnt, box, &scaleMatrix, true, &buffers.TriangleInfo);
+
+	buffers.Planes.set_used(triangleCnt);
+	for (s32 i=0; i<triangleCnt; ++i)
+		buffers.Planes[i] = buffers.Triangles[i].getPlane();
+
+	colData.candidates = &buffers;
+	colData.candidateCount = triangleCnt;
+}
+
+
+core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
+	SCollisionData &colData, const core::vector3df& pos, const core::vector3df& vel) const
+{
+	f32 veryCloseDistance = colData.slidingSpeed;
+
+	if (recursionDepth > 5)
+		return pos;
+
+	colData.velocity = vel;
+	colData.normalizedVelocity = vel;
+	colData.normalizedVelocity.normalize();
+	colData.basePoint = pos;
+	colData.foundCollision = false;
+	colData.nearestDistance = FLT_MAX;
+
+	//------------------ collide with world
 
 	// Find closest intersection
+	const SQueryBuffers& candidates = *colData.candidates;
 	irr::s32 nearestTriangleIndex = -1;
-	for (s32 i=0; i<triangleCnt; ++i)
+	for (s32 i=0; i<colData.candidateCount; ++i)
 	{
-		if(testTriangleIntersection(&colData, Triangles[i]))
+		if(testTriangleIntersection(&colData, candidates.Triangles[i], candidates.Planes[i]))
 		{
 			nearestTriangleIndex = i;
 		}
 	}
 	if ( nearestTriangleIndex >= 0 )
 	{
-		for ( irr::u32 t=0; t<outTriangleInfo.size(); ++t )
+		for ( irr::u32 t=0; t<candidates.TriangleInfo.size(); ++t )
 		{
-			if ( outTriangleInfo[t].isIndexInRange(nearestTriangleIndex) )
+			if ( candidates.TriangleInfo[t].isIndexInRange(nearestTriangleIndex) )
 			{
-				colData.node = outTriangleInfo[t].SceneNode;
+				colData.node = candidates.TriangleInfo[t].SceneNode;
 				break;
 			}
 		}
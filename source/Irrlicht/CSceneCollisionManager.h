@@ -45,6 +45,11 @@ namespace scene
 		virtual bool getCollisionPoint(SCollisionHit& hitResult, const core::line3d<f32>& ray,
 				ITriangleSelector* selector)  _IRR_OVERRIDE_;
 
+		//! Finds the nearest collision points of many lines and lots of triangles.
+		virtual u32 getCollisionPoints(SCollisionHit* hitResults, bool* hitFound,
+				const core::line3d<f32>* rays, u32 rayCount,
+				ITriangleSelector* selector) _IRR_OVERRIDE_;
+
 		//! Collides a moving ellipsoid with a 3d world with gravity and returns
 		//! the resulting new position of the ellipsoid.
 		virtual core::vector3df getCollisionResultPosition(
@@ -76,6 +81,18 @@ namespace scene
 								ISceneNode * collisionRootNode = 0,
 								bool noDebugObjects = false)  _IRR_OVERRIDE_;
 
+		//! Collides many moving ellipsoids with a 3d world with gravity.
+		virtual void getCollisionResultPositions(ITriangleSelector* selector,
+			SCollisionMove* moves, u32 moveCount) _IRR_OVERRIDE_;
+
+		//! Triangle buffers used by one thread for collision queries
+		struct SQueryBuffers
+		{
+			core::array<core::triangle3df> Triangles;
+			core::array<SCollisionTriangleRange> TriangleInfo;
+			core::array<core::plane3d<f32> > Planes;
+		};
+
 	private:
 
 		//! recursive method for going through all scene nodes
@@ -115,6 +132,10 @@ namespace scene
 			f32 slidingSpeed;
 
 			ITriangleSelector* selector;
+
+			// candidates of the current pass, in ellipsoid space
+			const SQueryBuffers* candidates;
+			s32 candidateCount;
 		};
 
 		//! Tests the current collision data against an individual triangle.
@@ -123,7 +144,12 @@ namespace scene
 		\param triangle: the triangle to test against.
 		\return true if the triangle is hit (and is the closest hit), false otherwise */
 		bool testTriangleIntersection(SCollisionData* colData,
-			const core::triangle3df& triangle);
+			const core::triangle3df& triangle, const core::plane3d<f32>& trianglePlane) const;
+
+		//! Collects the triangles which can be hit during one pass of collideWithWorld.
+		/** The box only depends on the whole move, so all sliding
+		iterations of the pass share the candidates and their planes. */
+		void getCollisionCandidates(SCollisionData& colData, SQueryBuffers& buffers) const;
 
 		//! recursive method for doing collision response
 		core::vector3df collideEllipsoidWithWorld(ITriangleSelector* selector,
@@ -133,16 +159,22 @@ namespace scene
 			const core::vector3df& gravity, core::triangle3df& triout,
 			core::vector3df& hitPosition,
 			bool& outFalling,
-			ISceneNode*& outNode);
+			ISceneNode*& outNode,
+			SQueryBuffers& buffers,
+			bool* outCollided=0) const;
 
 		core::vector3df collideWithWorld(s32 recursionDepth, SCollisionData &colData,
-			const core::vector3df& pos, const core::vector3df& vel);
+			const core::vector3df& pos, const core::vector3df& vel) const;
 
 		inline bool getLowestRoot(f32 a, f32 b, f32 c, f32 maxR, f32* root) const;
 
+		// moves a range of ellipsoids of getCollisionResultPositions()
+		class CMoveBatchJob;
+
 		ISceneManager* SceneManager;
 		video::IVideoDriver* Driver;
-		core::array<core::triangle3df> Triangles; // triangle buffer
+		SQueryBuffers Buffers; // buffers of single queries
+		core::array<SQueryBuffers> ThreadBuffers; // per thread buffers of batched queries
 	};
 
 
@@ -179,12 +179,15 @@
 #include "CTextSceneNode.h"
 #include "CQuake3ShaderSceneNode.h"
 #include "CVolumeLightSceneNode.h"
+#include "CStaticBatchSceneNode.h"
+#include "CInstancedMeshSceneNode.h"
 
 #include "CDefaultSceneNodeFactory.h"
 
 #include "CSceneCollisionManager.h"
 #include "CTriangleSelector.h"
 #include "COctreeTriangleSelector.h"
+#include "CBVHTriangleSelector.h"
 #include "CTriangleBBSelector.h"
 #include "CMetaTriangleSelector.h"
 #ifdef _IRR_COMPILE_WITH_TERRAIN_SCENENODE_
@@ -203,21 +206,32 @@
 #include "CDefaultSceneNodeAnimatorFactory.h"
 
 #include "CGeometryCreator.h"
+#include "CWorkerPool.h"
 
 #include <locale.h>
+#include <thread>
 
 namespace irr
 {
 namespace scene
 {
 
+namespace
+{
+	// Subtrees animated in parallel per thread, more of them balance the load better
+	const u32 ANIMATION_TASKS_PER_THREAD = 16;
+}
+
 //! constructor
 CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 		gui::ICursorControl* cursorControl, IMeshCache* cache,
 		gui::IGUIEnvironment* gui)
 : ISceneNode(0, 0), Driver(driver), FileSystem(fs), GUIEnvironment(gui),
 	CursorControl(cursorControl), CollisionManager(0),
-	ActiveCamera(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0), Parameters(0),
+	ActiveCamera(0), RenderQueueDepthScale(0.f), LastRegisteredNode(0),
+	LastRegisteredTaken(0), LastRegisteredBox(0), BatchCulling(false),
+	TransformationUpdates(0), ParallelAnimation(false),
+	ShadowColor(150,0,0,0), AmbientLight(0,0,0,0), Parameters(0),
 	MeshCache(cache), CurrentRenderPass(ESNRP_NONE), LightManager(0),
 	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
 {
@@ -358,6 +372,7 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 			getProfiler().add(EPID_SM_RENDER_EFFECT, L"effectnodes", L"Irrlicht scene");
 			getProfiler().add(EPID_SM_RENDER_GUI_NODES, L"guinodes", L"Irrlicht scene");
 			getProfiler().add(EPID_SM_REGISTER, L"reg.render.node", L"Irrlicht scene");
+			getProfiler().add(EPID_SM_CULL, L"cull.nodes", L"Irrlicht scene");
 		}
  	)
 }
@@ -366,7 +381,26 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 //! destructor
 CSceneManager::~CSceneManager()
 {
+	// loads on the worker threads use the loaders, the cache and the driver
+	while (MeshLoads.size())
+	{
+		SMeshLoad* load = MeshLoads.getLast();
+		MeshLoads.erase(MeshLoads.size()-1);
+		if (getWorkerPool().cancel(load))
+		{
+			load->File->drop();
+			load->File = 0;
+		}
+		else
+		{
+			while (!load->Done.load(std::memory_order_acquire))
+				std::this_thread::yield();
+		}
+		finishMeshLoad(load);
+	}
+
 	clearDeletionList();
+	NodeIndex.clear();
 
 	//! force to remove hardwareTextures from the driver
 	//! because Scenes may hold internally data bounded to sceneNodes
@@ -393,6 +427,9 @@ CSceneManager::~CSceneManager()
 	for (i=0; i<MeshLoaderList.size(); ++i)
 		MeshLoaderList[i]->drop();
 
+	for (i=0; i<MeshLoaderLocks.size(); ++i)
+		delete MeshLoaderLocks[i];
+
 	for (i=0; i<SceneLoaderList.size(); ++i)
 		SceneLoaderList[i]->drop();
 
@@ -434,6 +471,13 @@ IAnimatedMesh* CSceneManager::getMesh(const io::path& filename, const io::path&
 	if (msh)
 		return msh;
 
+	if (MeshCache->isMeshLoading(cacheName))
+	{
+		msh = waitForMeshLoad(cacheName);
+		if (msh)
+			return msh;
+	}
+
 	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
 	if (!file)
 	{
@@ -460,11 +504,203 @@ IAnimatedMesh* CSceneManager::getMesh(io::IReadFile* file)
 	if (msh)
 		return msh;
 
+	if (MeshCache->isMeshLoading(name))
+	{
+		msh = waitForMeshLoad(name);
+		if (msh)
+			return msh;
+	}
+
 	msh = getUncachedMesh(file, name, name);
 
 	return msh;
 }
 
+
+//! Load a mesh on a worker thread
+bool CSceneManager::getMeshAsync(const io::path& filename, IMeshLoadCallBack* callBack,
+		const io::path& alternativeCacheName)
+{
+	const io::path cacheName = alternativeCacheName.empty() ? filename : alternativeCacheName;
+	IAnimatedMesh* msh = MeshCache->getMeshByName(cacheName);
+	if (msh)
+	{
+		if (callBack)
+			callBack->OnMeshLoaded(cacheName, msh);
+		return true;
+	}
+
+	CMeshCache* cache = getLoadingMeshCache();
+	if (!cache->addLoadingMesh(cacheName, callBack))
+		return true;
+
+	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
+	if (!file)
+	{
+		os::Printer::log("Could not load mesh, because file could not be opened: ", filename, ELL_ERROR);
+		cache->finishLoadingMesh(cacheName, 0);
+		return false;
+	}
+
+	SMeshLoad* load = new SMeshLoad(file, filename, cacheName);
+	bool background = true;
+
+	// iterate the list in reverse order so user-added loaders can override the built-in ones
+	for (s32 i=MeshLoaderList.size()-1; i>=0; --i)
+	{
+		if (MeshLoaderList[i]->isALoadableFileExtension(filename))
+		{
+			load->Loaders.push_back(MeshLoaderList[i]);
+			load->Locks.push_back(getMeshLoaderLock(i));
+			background = background && MeshLoaderList[i]->canLoadInBackground();
+		}
+	}
+
+	if (background)
+	{
+		MeshLoads.push_back(load);
+		getWorkerPool().submit(load);
+
+		// without worker threads the load ran already
+		if (load->Done.load(std::memory_order_acquire))
+		{
+			MeshLoads.erase(MeshLoads.size()-1);
+			finishMeshLoad(load);
+		}
+	}
+	else
+	{
+		load->run();
+		finishMeshLoad(load);
+	}
+
+	return true;
+}
+
+
+//! Try the loaders until one creates the mesh, then drops the file
+void CSceneManager::SMeshLoad::run()
+{
+	for (u32 i=0; i<Loaders.size() && !Mesh; ++i)
+	{
+		std::lock_guard<std::recursive_mutex> lock(*Locks[i]);
+		// reset file to avoid side effects of previous calls to createMesh
+		File->seek(0);
+		Mesh = Loaders[i]->createMesh(File);
+	}
+
+	File->drop();
+	File = 0;
+
+	Done.store(true, std::memory_order_release);
+}
+
+
+//! The mesh cache with the bookkeeping of the loads
+CMeshCache* CSceneManager::getLoadingMeshCache() const
+{
+	return static_cast<CMeshCache*>(MeshCache);
+}
+
+
+//! Get the lock which keeps a mesh loader from loading two files at once
+std::recursive_mutex* CSceneManager::getMeshLoaderLock(u32 index)
+{
+	while (MeshLoaderLocks.size() <= index)
+		MeshLoaderLocks.push_back(new std::recursive_mutex());
+	return MeshLoaderLocks[index];
+}
+
+
+//! Add the meshes of the loads which are done to the cache
+void CSceneManager::finishMeshLoads()
+{
+	// call backs may start or wait for other loads
+	for (u32 i=0; i<MeshLoads.size();)
+	{
+		SMeshLoad* load = MeshLoads[i];
+		if (!load->Done.load(std::memory_order_acquire))
+		{
+			++i;
+			continue;
+		}
+
+		MeshLoads.erase(i);
+		finishMeshLoad(load);
+	}
+}
+
+
+//! Add the mesh of a done load to the cache and call back, deletes the load
+void CSceneManager::finishMeshLoad(SMeshLoad* load)
+{
+	if (load->Mesh)
+	{
+		if (Driver)
+		{
+			resolveMeshTextures(load->Mesh);
+			// single frame meshes keep their buffers in another mesh
+			IMesh* frame = load->Mesh->getMesh(0);
+			if (frame && frame != load->Mesh)
+				resolveMeshTextures(frame);
+		}
+
+		os::Printer::log("Loaded mesh", load->Filename, ELL_DEBUG);
+	}
+	else
+		os::Printer::log("Could not load mesh, file format seems to be unsupported", load->Filename, ELL_ERROR);
+
+	getLoadingMeshCache()->finishLoadingMesh(load->CacheName, load->Mesh);
+
+	if (load->Mesh)
+		load->Mesh->drop();
+	delete load;
+}
+
+
+//! Wait for the load of a mesh and add it to the cache
+IAnimatedMesh* CSceneManager::waitForMeshLoad(const io::path& cacheName)
+{
+	const io::path name = io::SNamedPath(cacheName).getInternalName();
+	for (u32 i=0; i<MeshLoads.size(); ++i)
+	{
+		SMeshLoad* load = MeshLoads[i];
+		if (io::SNamedPath(load->CacheName).getInternalName() != name)
+			continue;
+
+		// a load still queued is faster done here than waiting for a worker
+		if (getWorkerPool().cancel(load))
+			load->run();
+		else
+		{
+			while (!load->Done.load(std::memory_order_acquire))
+				std::this_thread::yield();
+		}
+
+		MeshLoads.erase(i);
+		finishMeshLoad(load);
+		return MeshCache->getMeshByName(cacheName);
+	}
+
+	return 0;
+}
+
+
+//! Replace the texture stand-ins a mesh got on a worker thread by the textures
+void CSceneManager::resolveMeshTextures(IMesh* mesh)
+{
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		video::SMaterial& material = mesh->getMeshBuffer(i)->getMaterial();
+		for (u32 j=0; j<video::MATERIAL_MAX_TEXTURES; ++j)
+		{
+			video::ITexture* texture = material.getTexture(j);
+			if (texture)
+				material.setTexture(j, Driver->resolveDeferredTexture(texture));
+		}
+	}
+}
+
 // load and create a mesh which we know already isn't in the cache and put it in there
 IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::path& filename, const io::path& cachename)
 {
@@ -476,6 +712,8 @@ IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::pat
 	{
 		if (MeshLoaderList[i]->isALoadableFileExtension(filename))
 		{
+			// a loader may be busy with a mesh of getMeshAsync()
+			std::lock_guard<std::recursive_mutex> lock(*getMeshLoaderLock(i));
 			// reset file to avoid side effects of previous calls to createMesh
 			file->seek(0);
 			msh = MeshLoaderList[i]->createMesh(file);
@@ -745,6 +983,43 @@ IOctreeSceneNode* CSceneManager::addOctreeSceneNode(IMesh* mesh, ISceneNode* par
 }
 
 
+//! Merges static mesh scene nodes into few large mesh buffers
+IStaticBatchSceneNode* CSceneManager::addStaticBatchSceneNode(const core::array<IMeshSceneNode*>& nodes,
+		f32 chunkSize, ISceneNode* parent, s32 id)
+{
+	if (!parent)
+		parent = this;
+
+	CStaticBatchSceneNode* node = new CStaticBatchSceneNode(parent, this, id);
+	node->drop();
+
+	if (!node->build(nodes, chunkSize))
+	{
+		node->remove();
+		return 0;
+	}
+
+	return node;
+}
+
+
+//! Adds a scene node drawing many copies of a mesh
+IInstancedMeshSceneNode* CSceneManager::addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation, const core::vector3df& scale)
+{
+	if (!mesh)
+		return 0;
+
+	if (!parent)
+		parent = this;
+
+	IInstancedMeshSceneNode* node = new CInstancedMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
 //! Adds a camera scene node to the tree and sets it as active camera.
 //! \param position: Position of the space relative to its parent where the camera will be placed.
 //! \param lookat: Position where the camera will look at. Also known as target.
@@ -1230,6 +1505,207 @@ const core::aabbox3d<f32>& CSceneManager::getBoundingBox() const
 }
 
 
+//! Keep a scene node in the spatial index of the scene manager.
+bool CSceneManager::addToSceneIndex(ISceneNode* node)
+{
+	if (!node || node->getSceneManager() != this)
+		return false;
+
+	return NodeIndex.add(node);
+}
+
+
+//! Reach a scene node through its parent again
+bool CSceneManager::removeFromSceneIndex(ISceneNode* node)
+{
+	return NodeIndex.remove(node);
+}
+
+
+//! Get the culling counters of the last drawAll()
+const SCullingStatistics& CSceneManager::getCullingStatistics() const
+{
+	return CullingStatistics;
+}
+
+
+//! Get the amount of absolute transformations recalculated during the last drawAll()
+u32 CSceneManager::getTransformationUpdateCount() const
+{
+	return TransformationUpdates;
+}
+
+
+//! Get the counters of a past drawAll(), can be called from any thread
+bool CSceneManager::getFrameStatistics(SSceneFrameStatistics& statistics, u32 framesAgo) const
+{
+	return FrameStatisticsRing.get(statistics, framesAgo);
+}
+
+
+//! Animate independent subtrees of the scene on the worker threads
+void CSceneManager::setParallelAnimation(bool enable)
+{
+	ParallelAnimation = enable;
+}
+
+
+//! Check if independent subtrees are animated on the worker threads
+bool CSceneManager::getParallelAnimation() const
+{
+	return ParallelAnimation;
+}
+
+
+//! Nodes whose OnAnimate() is the one of ISceneNode, so they can be animated before their children
+static bool isAnimationGroup(const ISceneNode* node)
+{
+	const ESCENE_NODE_TYPE type = node->getType();
+	return type == ESNT_EMPTY || type == ESNT_DUMMY_TRANSFORMATION || type == ESNT_SCENE_MANAGER;
+}
+
+
+//! The part of ISceneNode::OnAnimate() before the children are animated
+static void animateGroupNode(ISceneNode* node, u32 timeMs)
+{
+	const ISceneNodeAnimatorList& animators = node->getAnimators();
+	if (!animators.empty())
+		node->setTransformationDirty();
+
+	// continue to the next animator before calling animateNode(),
+	// the animator may remove itself from the node
+	ISceneNodeAnimatorList::ConstIterator ait = animators.begin();
+	while (ait != animators.end())
+	{
+		ISceneNodeAnimator* anim = *ait;
+		++ait;
+		if (anim->isEnabled())
+			anim->animateNode(node, timeMs);
+	}
+
+	if (node->isTransformationDirty())
+		node->updateAbsolutePosition();
+}
+
+
+//! Checks if a subtree can be animated at the same time as others
+static bool isSubtreeAnimationThreadSafe(const ISceneNode* node)
+{
+	if (!node->isAnimationThreadSafe())
+		return false;
+
+	const ISceneNodeAnimatorList& animators = node->getAnimators();
+	ISceneNodeAnimatorList::ConstIterator ait = animators.begin();
+	for (; ait != animators.end(); ++ait)
+		if (!(*ait)->isThreadSafe())
+			return false;
+
+	// invisible nodes are not animated
+	const ISceneNodeList& children = node->getChildren();
+	ISceneNodeList::ConstIterator it = children.begin();
+	for (; it != children.end(); ++it)
+		if ((*it)->isVisible() && !isSubtreeAnimationThreadSafe(*it))
+			return false;
+
+	return true;
+}
+
+
+//! Animates a range of subtrees, and leaves the ones which opted out to the calling thread
+class CSceneManager::CAnimateJob : public IWorkerJob
+{
+public:
+	CAnimateJob(CSceneManager& manager, u32 timeMs) : Manager(manager), TimeMs(timeMs) {}
+
+	virtual void run(u32 begin, u32 end, u32 thread) _IRR_OVERRIDE_
+	{
+		for (u32 i=begin; i<end; ++i)
+		{
+			ISceneNode* node = Manager.AnimationTasks[i];
+			if (isSubtreeAnimationThreadSafe(node))
+				node->OnAnimate(TimeMs);
+			else
+				Manager.DeferredAnimation[thread].push_back(node);
+		}
+	}
+
+private:
+	CSceneManager& Manager;
+	u32 TimeMs;
+};
+
+
+//! OnAnimate() for the whole scene, with independent subtrees on the worker threads
+void CSceneManager::animateParallel(u32 timeMs)
+{
+	CWorkerPool& pool = getWorkerPool();
+	const u32 threadCount = pool.getThreadCount();
+	if (threadCount == 1)
+	{
+		OnAnimate(timeMs);
+		return;
+	}
+
+	// Split the scene into subtrees, breadth first. Groups are animated
+	// here before their children are queued, that keeps parents before
+	// children. Everything else is a subtree animated with OnAnimate().
+	const u32 maxTasks = threadCount * ANIMATION_TASKS_PER_THREAD;
+	AnimationQueue.set_used(0);
+	AnimationTasks.set_used(0);
+	AnimationQueue.push_back(this);
+
+	for (u32 i=0; i<AnimationQueue.size(); ++i)
+	{
+		ISceneNode* node = AnimationQueue[i];
+		if (!node->isVisible())
+			continue;
+
+		if (isAnimationGroup(node) && !node->getChildren().empty()
+			&& AnimationTasks.size() + AnimationQueue.size() - i < maxTasks)
+		{
+			animateGroupNode(node, timeMs);
+
+			ISceneNodeList::ConstIterator it = node->getChildren().begin();
+			for (; it != node->getChildren().end(); ++it)
+				AnimationQueue.push_back(*it);
+		}
+		else
+			AnimationTasks.push_back(node);
+	}
+
+	while (DeferredAnimation.size() < threadCount)
+		DeferredAnimation.push_back(core::array<ISceneNode*>());
+
+	CAnimateJob job(*this, timeMs);
+	pool.parallelFor(job, AnimationTasks.size(), core::max_(1u, AnimationTasks.size() / maxTasks));
+
+	// subtrees with animators or nodes which touch shared state
+	for (u32 t=0; t<DeferredAnimation.size(); ++t)
+	{
+		for (u32 i=0; i<DeferredAnimation[t].size(); ++i)
+			DeferredAnimation[t][i]->OnAnimate(timeMs);
+		DeferredAnimation[t].set_used(0);
+	}
+}
+
+
+//! checks if the bounding sphere of a node is outside the bounding sphere of a frustum
+static bool isOutsideFrustumSphere(const ISceneNode* node, const SViewFrustum* frustum)
+{
+	const core::aabbox3df nbox = node->getTransformedBoundingBox();
+	const float rad = nbox.getRadius();
+	const core::vector3df center = nbox.getCenter();
+
+	const float camrad = frustum->getBoundingRadius();
+	const core::vector3df camcenter = frustum->getBoundingCenter();
+
+	const float dist = (center - camcenter).getLengthSQ();
+	const float maxdist = (rad + camrad) * (rad + camrad);
+
+	return dist > maxdist;
+}
+
+
 //! returns if node is culled
 bool CSceneManager::isCulled(const ISceneNode* node) const
 {
@@ -1257,17 +1733,7 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 	// can be seen by a bounding sphere
 	if (!result && (node->getAutomaticCulling() & scene::EAC_FRUSTUM_SPHERE))
 	{
-		const core::aabbox3df nbox = node->getTransformedBoundingBox();
-		const float rad = nbox.getRadius();
-		const core::vector3df center = nbox.getCenter();
-
-		const float camrad = cam->getViewFrustum()->getBoundingRadius();
-		const core::vector3df camcenter = cam->getViewFrustum()->getBoundingCenter();
-
-		const float dist = (center - camcenter).getLengthSQ();
-		const float maxdist = (rad + camrad) * (rad + camrad);
-
-		result = dist > maxdist;
+		result = isOutsideFrustumSphere(node, cam->getViewFrustum());
 	}
 
 	// can be seen by cam pyramid planes ?
@@ -1307,6 +1773,16 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 }
 
 
+//! Index of a render pass in SSceneFrameStatistics, automatic registrations count as solid
+static u32 getFrameStatisticsPass(E_SCENE_NODE_RENDER_PASS pass)
+{
+	u32 index = 0;
+	while (index < EFSP_COUNT-1 && !(pass & (1u << index)))
+		++index;
+	return index;
+}
+
+
 //! registers a node for rendering it at a specific time.
 u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
 {
@@ -1349,83 +1825,211 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 		taken = 1;
 		break;
 	case ESNRP_SOLID:
-		if (!isCulled(node))
+	case ESNRP_TRANSPARENT:
+	case ESNRP_TRANSPARENT_EFFECT:
+	case ESNRP_AUTOMATIC:
+	case ESNRP_SHADOW:
+	case ESNRP_GUI:
+		if (BatchCulling)
 		{
-			SolidNodeList.push_back(node);
-			taken = 1;
+			taken = addCullRegistration(node, pass, 0, 0);
 		}
-		break;
-	case ESNRP_TRANSPARENT:
-		if (!isCulled(node))
+		else if (!isCulled(node))
 		{
-			TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			addToRenderPass(node, pass, 0, 0);
 			taken = 1;
 		}
 		break;
-	case ESNRP_TRANSPARENT_EFFECT:
-		if (!isCulled(node))
+
+	case ESNRP_NONE: // ignore this one
+		break;
+	}
+
+	if (pass != ESNRP_NONE)
+	{
+		const u32 statisticsPass = getFrameStatisticsPass(pass);
+		++FrameStatistics.NodesRegistered[statisticsPass];
+		if (!taken)
+			++FrameStatistics.NodesCulled[statisticsPass];
+	}
+
+	return taken;
+}
+
+//! registers a single solid mesh buffer of a node for rendering
+u32 CSceneManager::registerMeshBufferForRendering(ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial& material)
+{
+	IRR_PROFILE(CProfileScope p1(EPID_SM_REGISTER);)
+
+	if (!node || !meshBuffer)
+		return 0;
+
+	u32 taken = 0;
+	if (BatchCulling)
+	{
+		taken = addCullRegistration(node, ESNRP_SOLID, meshBuffer, &material);
+	}
+	else
+	{
+		// nodes register all their buffers in a row, so culling is
+		// only tested for the first one
+		if (node != LastRegisteredNode)
 		{
-			TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
-			taken = 1;
+			LastRegisteredNode = node;
+			LastRegisteredTaken = isCulled(node) ? 0 : 1;
+		}
+
+		taken = LastRegisteredTaken;
+		if (taken)
+			addToRenderPass(node, ESNRP_SOLID, meshBuffer, &material);
+	}
+
+	++FrameStatistics.NodesRegistered[EFSP_SOLID];
+	if (!taken)
+		++FrameStatistics.NodesCulled[EFSP_SOLID];
+
+	return taken;
+}
+
+//! adds a node (or one of its mesh buffers) which passed culling to the list of its render pass
+void CSceneManager::addToRenderPass(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass,
+	IMeshBuffer* meshBuffer, const video::SMaterial* material)
+{
+	if (meshBuffer)
+	{
+		SolidRenderQueue.add(CRenderQueue::makeKey(ESNRP_SOLID, *material, getRenderQueueDepth(node)), node, meshBuffer, material);
+		return;
+	}
+
+	switch(pass)
+	{
+	case ESNRP_SOLID:
+		{
+			const video::SMaterial& first = node->getMaterialCount() ? node->getMaterial(0) : video::IdentityMaterial;
+			SolidRenderQueue.add(CRenderQueue::makeKey(ESNRP_SOLID, first, getRenderQueueDepth(node)), node, 0, 0);
 		}
 		break;
+	case ESNRP_TRANSPARENT:
+		TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+		break;
+	case ESNRP_TRANSPARENT_EFFECT:
+		TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+		break;
 	case ESNRP_AUTOMATIC:
-		if (!isCulled(node))
 		{
 			const u32 count = node->getMaterialCount();
-
-			taken = 0;
 			for (u32 i=0; i<count; ++i)
 			{
 				if (Driver->needsTransparentRenderPass(node->getMaterial(i)))
 				{
 					// register as transparent node
-					TransparentNodeEntry e(node, camWorldPos);
-					TransparentNodeList.push_back(e);
-					taken = 1;
-					break;
+					TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+					return;
 				}
 			}
 
 			// not transparent, register as solid
-			if (!taken)
-			{
-				SolidNodeList.push_back(node);
-				taken = 1;
-			}
+			const video::SMaterial& first = count ? node->getMaterial(0) : video::IdentityMaterial;
+			SolidRenderQueue.add(CRenderQueue::makeKey(ESNRP_SOLID, first, getRenderQueueDepth(node)), node, 0, 0);
 		}
 		break;
 	case ESNRP_SHADOW:
-		if (!isCulled(node))
-		{
-			ShadowNodeList.push_back(node);
-			taken = 1;
-		}
+		ShadowNodeList.push_back(node);
 		break;
-
 	case ESNRP_GUI:
-		if (!isCulled(node))
+		GuiNodeList.push_back(node);
+		break;
+	default:
+		break;
+	}
+}
+
+//! queues a registration until all nodes registered in drawAll() are culled at once
+u32 CSceneManager::addCullRegistration(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass,
+	IMeshBuffer* meshBuffer, const video::SMaterial* material)
+{
+	// nodes register all their passes and buffers in a row, so each
+	// of them only adds one box
+	if (node != LastRegisteredNode)
+	{
+		LastRegisteredNode = node;
+
+		// occlusion queries and spheres are tested right away, the
+		// boxes are left to the batch
+		const u32 culling = node->getAutomaticCulling();
+		bool culled = false;
+		if (culling & scene::EAC_OCC_QUERY)
+			culled = (Driver->getOcclusionQueryResult(node)==0);
+		if (!culled && (culling & scene::EAC_FRUSTUM_SPHERE))
+			culled = isOutsideFrustumSphere(node, ActiveCamera->getViewFrustum());
+
+		++CullingStatistics.NodesVisited;
+		LastRegisteredTaken = culled ? 0 : 1;
+		if (culled)
 		{
-			GuiNodeList.push_back(node);
-			taken = 1;
+			++CullingStatistics.NodesCulled;
 		}
+		else
+		{
+			const u32 tests = culling & (scene::EAC_BOX | scene::EAC_FRUSTUM_BOX);
+			LastRegisteredBox = Culler.addBox(tests ? node->getTransformedBoundingBox() : core::aabbox3df(), tests);
+		}
+	}
 
-	case ESNRP_NONE: // ignore this one
-		break;
+	if (LastRegisteredTaken)
+	{
+		SCullRegistration registration;
+		registration.Node = node;
+		registration.MeshBuffer = meshBuffer;
+		registration.Material = material;
+		registration.Box = LastRegisteredBox;
+		registration.Pass = pass;
+		CullRegistrations.push_back(registration);
 	}
 
-#ifdef _IRR_SCENEMANAGER_DEBUG
-	s32 index = Parameters->findAttribute("calls");
-	Parameters->setAttribute(index, Parameters->getAttributeAsInt(index)+1);
+	return LastRegisteredTaken;
+}
 
-	if (!taken)
+//! tests the boxes of all queued registrations and adds the visible ones to their render pass
+void CSceneManager::cullRegisteredNodes()
+{
+	BatchCulling = false;
+	LastRegisteredNode = 0;
+
+	if (!CullRegistrations.size())
 	{
-		index = Parameters->findAttribute("culled");
-		Parameters->setAttribute(index, Parameters->getAttributeAsInt(index)+1);
+		Culler.clear();
+		return;
 	}
-#endif
 
-	return taken;
+	IRR_PROFILE(CProfileScope p1(EPID_SM_CULL);)
+	Culler.cull(*ActiveCamera->getViewFrustum());
+
+	for (u32 i=0; i<Culler.size(); ++i)
+	{
+		if (Culler.isVisible(i))
+			++CullingStatistics.NodesDrawn;
+		else
+			++CullingStatistics.NodesCulled;
+	}
+
+	for (u32 i=0; i<CullRegistrations.size(); ++i)
+	{
+		const SCullRegistration& registration = CullRegistrations[i];
+		if (Culler.isVisible(registration.Box))
+			addToRenderPass(registration.Node, registration.Pass, registration.MeshBuffer, registration.Material);
+		else
+			++FrameStatistics.NodesCulled[getFrameStatisticsPass(registration.Pass)];
+	}
+
+	CullRegistrations.set_used(0);
+	Culler.clear();
+}
+
+//! Distance of a node to the camera, scaled for the sort key of the render queue
+f32 CSceneManager::getRenderQueueDepth(const ISceneNode* node) const
+{
+	return (f32)(node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camWorldPos) * RenderQueueDepthScale);
 }
 
 void CSceneManager::clearAllRegisteredNodesForRendering()
@@ -1433,7 +2037,11 @@ void CSceneManager::clearAllRegisteredNodesForRendering()
 	CameraList.clear();
 	LightList.clear();
 	SkyBoxList.clear();
-	SolidNodeList.clear();
+	SolidRenderQueue.reset();
+	CullRegistrations.clear();
+	Culler.reset();
+	BatchCulling = false;
+	LastRegisteredNode = 0;
 	TransparentNodeList.clear();
 	TransparentEffectNodeList.clear();
 	ShadowNodeList.clear();
@@ -1449,14 +2057,12 @@ void CSceneManager::drawAll()
 	if (!Driver)
 		return;
 
-#ifdef _IRR_SCENEMANAGER_DEBUG
-	// reset attributes
-	Parameters->setAttribute("culled", 0);
-	Parameters->setAttribute("calls", 0);
-	Parameters->setAttribute("drawn_solid", 0);
-	Parameters->setAttribute("drawn_transparent", 0);
-	Parameters->setAttribute("drawn_transparent_effect", 0);
-#endif
+	os::Printer::flushLog();
+	finishMeshLoads();
+
+	const u32 transformationUpdates = TransformationUpdateCounter.load(std::memory_order_relaxed);
+
+	FrameStatistics = SSceneFrameStatistics();
 
 	u32 i; // new ISO for scoping problem in some compilers
 
@@ -1472,7 +2078,10 @@ void CSceneManager::drawAll()
 
 	// do animations and other stuff.
 	IRR_PROFILE(getProfiler().start(EPID_SM_ANIMATE));
-	OnAnimate(os::Timer::getTime());
+	if (ParallelAnimation)
+		animateParallel(os::Timer::getTime());
+	else
+		OnAnimate(os::Timer::getTime());
 	IRR_PROFILE(getProfiler().stop(EPID_SM_ANIMATE));
 
 	/*!
@@ -1481,15 +2090,25 @@ void CSceneManager::drawAll()
 	*/
 	IRR_PROFILE(getProfiler().start(EPID_SM_RENDER_CAMERAS));
 	camWorldPos.set(0,0,0);
+	RenderQueueDepthScale = 0.f;
 	if (ActiveCamera)
 	{
 		ActiveCamera->render();
 		camWorldPos = ActiveCamera->getAbsolutePosition();
+		const f32 farValue = ActiveCamera->getFarValue();
+		if (farValue > 0.f)
+			RenderQueueDepthScale = 1.f / (farValue*farValue);
 	}
 	IRR_PROFILE(getProfiler().stop(EPID_SM_RENDER_CAMERAS));
 
-	// let all nodes register themselves
+	// let all nodes register themselves, the culling of their boxes
+	// is done for all of them at once afterwards
+	CullingStatistics = SCullingStatistics();
+	LastRegisteredNode = 0;
+	BatchCulling = (ActiveCamera != 0);
 	OnRegisterSceneNode();
+	NodeIndex.registerNodes(this, ActiveCamera ? ActiveCamera->getViewFrustum() : 0, CullingStatistics);
+	cullRegisteredNodes();
 
 	if (LightManager)
 		LightManager->OnPreRender(LightList);
@@ -1506,6 +2125,7 @@ void CSceneManager::drawAll()
 		for (i=0; i<CameraList.size(); ++i)
 			CameraList[i]->render();
 
+		FrameStatistics.NodesDrawn[EFSP_CAMERA] = CameraList.size();
 		CameraList.set_used(0);
 
 		if (LightManager)
@@ -1553,6 +2173,8 @@ void CSceneManager::drawAll()
 		for (i=0; i< maxLights; ++i)
 			LightList[i]->render();
 
+		FrameStatistics.NodesDrawn[EFSP_LIGHT] = maxLights;
+
 		if (LightManager)
 			LightManager->OnRenderPassPostRender(CurrentRenderPass);
 	}
@@ -1580,6 +2202,7 @@ void CSceneManager::drawAll()
 				SkyBoxList[i]->render();
 		}
 
+		FrameStatistics.NodesDrawn[EFSP_SKY_BOX] = SkyBoxList.size();
 		SkyBoxList.set_used(0);
 
 		if (LightManager)
@@ -1593,29 +2216,62 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_SOLID;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		SolidNodeList.sort(); // sort by textures
+		SolidRenderQueue.sort(); // sort by render state, then front to back
 
 		if (LightManager)
-		{
 			LightManager->OnRenderPassPreRender(CurrentRenderPass);
-			for (i=0; i<SolidNodeList.size(); ++i)
+
+		// mesh buffers in a row often share node or material, the
+		// driver state only changes when they differ
+		ISceneNode* currentNode = 0;
+		const video::SMaterial* currentMaterial = 0;
+
+		for (i=0; i<SolidRenderQueue.size(); ++i)
+		{
+			const SRenderQueueEntry& entry = SolidRenderQueue[i];
+
+			if (!entry.MeshBuffer)
 			{
-				ISceneNode* node = SolidNodeList[i].Node;
-				LightManager->OnNodePreRender(node);
-				node->render();
-				LightManager->OnNodePostRender(node);
+				// the node renders itself and might change any state
+				if (LightManager)
+				{
+					if (currentNode)
+						LightManager->OnNodePostRender(currentNode);
+					LightManager->OnNodePreRender(entry.Node);
+				}
+				entry.Node->render();
+				if (LightManager)
+					LightManager->OnNodePostRender(entry.Node);
+				currentNode = 0;
+				currentMaterial = 0;
+				continue;
 			}
-		}
-		else
-		{
-			for (i=0; i<SolidNodeList.size(); ++i)
-				SolidNodeList[i].Node->render();
+
+			if (entry.Node != currentNode)
+			{
+				if (LightManager)
+				{
+					if (currentNode)
+						LightManager->OnNodePostRender(currentNode);
+					LightManager->OnNodePreRender(entry.Node);
+				}
+				currentNode = entry.Node;
+				Driver->setTransform(video::ETS_WORLD, currentNode->getAbsoluteTransformation());
+			}
+
+			if (!currentMaterial || (entry.Material != currentMaterial && *entry.Material != *currentMaterial))
+			{
+				Driver->setMaterial(*entry.Material);
+				currentMaterial = entry.Material;
+			}
+			Driver->drawMeshBuffer(entry.MeshBuffer);
 		}
 
-#ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters->setAttribute("drawn_solid", (s32) SolidNodeList.size() );
-#endif
-		SolidNodeList.set_used(0);
+		if (LightManager && currentNode)
+			LightManager->OnNodePostRender(currentNode);
+
+		FrameStatistics.NodesDrawn[EFSP_SOLID] = SolidRenderQueue.size();
+		SolidRenderQueue.clear();
 
 		if (LightManager)
 			LightManager->OnRenderPassPostRender(CurrentRenderPass);
@@ -1648,6 +2304,7 @@ void CSceneManager::drawAll()
 			Driver->drawStencilShadow(true,ShadowColor, ShadowColor,
 				ShadowColor, ShadowColor);
 
+		FrameStatistics.NodesDrawn[EFSP_SHADOW] = ShadowNodeList.size();
 		ShadowNodeList.set_used(0);
 
 		if (LightManager)
@@ -1679,9 +2336,7 @@ void CSceneManager::drawAll()
 				TransparentNodeList[i].Node->render();
 		}
 
-#ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters->setAttribute ( "drawn_transparent", (s32) TransparentNodeList.size() );
-#endif
+		FrameStatistics.NodesDrawn[EFSP_TRANSPARENT] = TransparentNodeList.size();
 		TransparentNodeList.set_used(0);
 
 		if (LightManager)
@@ -1713,9 +2368,7 @@ void CSceneManager::drawAll()
 			for (i=0; i<TransparentEffectNodeList.size(); ++i)
 				TransparentEffectNodeList[i].Node->render();
 		}
-#ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters->setAttribute("drawn_transparent_effect", (s32) TransparentEffectNodeList.size());
-#endif
+		FrameStatistics.NodesDrawn[EFSP_TRANSPARENT_EFFECT] = TransparentEffectNodeList.size();
 		TransparentEffectNodeList.set_used(0);
 	}
 
@@ -1742,9 +2395,7 @@ void CSceneManager::drawAll()
 			for (i=0; i<GuiNodeList.size(); ++i)
 				GuiNodeList[i]->render();
 		}
-#ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters->setAttribute("drawn_gui_nodes", (s32) GuiNodeList.size());
-#endif
+		FrameStatistics.NodesDrawn[EFSP_GUI] = GuiNodeList.size();
 		GuiNodeList.set_used(0);
 	}
 	
@@ -1756,6 +2407,12 @@ void CSceneManager::drawAll()
 	clearDeletionList();
 
 	CurrentRenderPass = ESNRP_NONE;
+	TransformationUpdates = TransformationUpdateCounter.load(std::memory_order_relaxed) - transformationUpdates;
+
+	FrameStatistics.CellsVisited = CullingStatistics.CellsVisited;
+	FrameStatistics.CellsCulled = CullingStatistics.CellsCulled;
+	FrameStatistics.TransformationUpdates = TransformationUpdates;
+	FrameStatisticsRing.publish(FrameStatistics);
 }
 
 void CSceneManager::setLightManager(ILightManager* lightManager)
@@ -2005,6 +2662,24 @@ ITriangleSelector* CSceneManager::createOctreeTriangleSelector(IMeshBuffer* mesh
 	return new COctreeTriangleSelector(meshBuffer, materialIndex, node, minimalPolysPerNode);
 }
 
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IMesh* mesh,
+							ISceneNode* node, u32 maxTrianglesPerLeaf)
+{
+	if (!mesh)
+		return 0;
+
+	return new CBVHTriangleSelector(mesh, node, maxTrianglesPerLeaf);
+}
+
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+			ISceneNode* node, u32 maxTrianglesPerLeaf)
+{
+	if ( !meshBuffer)
+		return 0;
+
+	return new CBVHTriangleSelector(meshBuffer, materialIndex, node, maxTrianglesPerLeaf);
+}
+
 //! Creates a meta triangle selector.
 IMetaTriangleSelector* CSceneManager::createMetaTriangleSelector()
 {
@@ -2159,6 +2834,7 @@ bool CSceneManager::postEventFromUser(const SEvent& event)
 //! Removes all children of this scene node
 void CSceneManager::removeAll()
 {
+	NodeIndex.clear();
 	ISceneNode::removeAll();
 	setActiveCamera(0);
 	// Make sure the driver is reset, might need a more complex method at some point
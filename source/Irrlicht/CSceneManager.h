@@ -13,6 +13,12 @@
 #include "IMeshLoader.h"
 #include "CAttributes.h"
 #include "ILightManager.h"
+#include "CRenderQueue.h"
+#include "CFrustumCuller.h"
+#include "CSceneNodeIndex.h"
+#include "CFrameStatisticsRing.h"
+#include "CWorkerPool.h"
+#include <mutex>
 
 namespace irr
 {
@@ -23,6 +29,7 @@ namespace io
 namespace scene
 {
 	class IMeshCache;
+	class CMeshCache;
 	class IGeometryCreator;
 
 	/*!
@@ -46,6 +53,10 @@ namespace scene
 		//! gets an animateable mesh. loads it if needed. returned pointer must not be dropped.
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) _IRR_OVERRIDE_;
 
+		//! Load a mesh on a worker thread
+		virtual bool getMeshAsync(const io::path& filename, IMeshLoadCallBack* callBack=0,
+			const io::path& alternativeCacheName=io::path("")) _IRR_OVERRIDE_;
+
 		//! Returns an interface to the mesh cache which is shared between all existing scene managers.
 		virtual IMeshCache* getMeshCache() _IRR_OVERRIDE_;
 
@@ -111,6 +122,9 @@ namespace scene
 		//! registers a node for rendering it at a specific time.
 		virtual u32 registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass = ESNRP_AUTOMATIC) _IRR_OVERRIDE_;
 
+		//! registers a single solid mesh buffer of a node for rendering
+		virtual u32 registerMeshBufferForRendering(ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial& material) _IRR_OVERRIDE_;
+
 		//! Clear all nodes which are currently registered for rendering
 		virtual void clearAllRegisteredNodesForRendering() _IRR_OVERRIDE_;
 
@@ -129,6 +143,16 @@ namespace scene
 		virtual IOctreeSceneNode* addOctreeSceneNode(IMesh* mesh, ISceneNode* parent=0,
 			s32 id=-1, s32 minimalPolysPerNode=128, bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
 
+		//! Merges static mesh scene nodes into few large mesh buffers
+		virtual IStaticBatchSceneNode* addStaticBatchSceneNode(const core::array<IMeshSceneNode*>& nodes,
+			f32 chunkSize=256.f, ISceneNode* parent=0, s32 id=-1) _IRR_OVERRIDE_;
+
+		//! Adds a scene node drawing many copies of a mesh
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) _IRR_OVERRIDE_;
+
 		//! Adds a camera scene node to the tree and sets it as active camera.
 		//! \param position: Position of the space relative to its parent where the camera will be placed.
 		//! \param lookat: Position where the camera will look at. Also known as target.
@@ -365,6 +389,14 @@ namespace scene
 		virtual ITriangleSelector* createOctreeTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
 			ISceneNode* node, s32 minimalPolysPerNode=32) _IRR_OVERRIDE_;
 
+		//! Creates a ITriangleSelector optimized by a bounding volume hierarchy, based on a mesh.
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh,
+			ISceneNode* node, u32 maxTrianglesPerLeaf) _IRR_OVERRIDE_;
+
+		//! Creates a ITriangleSelector optimized by a bounding volume hierarchy, based on a meshbuffer.
+		virtual ITriangleSelector* createBVHTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+			ISceneNode* node, u32 maxTrianglesPerLeaf=4) _IRR_OVERRIDE_;
+
 		//! Creates a simple dynamic ITriangleSelector, based on a axis aligned bounding box.
 		virtual ITriangleSelector* createTriangleSelectorFromBoundingBox(
 			ISceneNode* node) _IRR_OVERRIDE_;
@@ -534,34 +566,105 @@ namespace scene
 		//! returns if node is culled
 		virtual bool isCulled(const ISceneNode* node) const _IRR_OVERRIDE_;
 
+		//! Keep a scene node in the spatial index of the scene manager.
+		virtual bool addToSceneIndex(ISceneNode* node) _IRR_OVERRIDE_;
+
+		//! Reach a scene node through its parent again
+		virtual bool removeFromSceneIndex(ISceneNode* node) _IRR_OVERRIDE_;
+
+		//! Get the culling counters of the last drawAll()
+		virtual const SCullingStatistics& getCullingStatistics() const _IRR_OVERRIDE_;
+
+		//! Get the amount of absolute transformations recalculated during the last drawAll()
+		virtual u32 getTransformationUpdateCount() const _IRR_OVERRIDE_;
+
+		//! Get the counters of a past drawAll(), can be called from any thread
+		virtual bool getFrameStatistics(SSceneFrameStatistics& statistics, u32 framesAgo=0) const _IRR_OVERRIDE_;
+
+		//! Animate independent subtrees of the scene on the worker threads
+		virtual void setParallelAnimation(bool enable) _IRR_OVERRIDE_;
+
+		//! Check if independent subtrees are animated on the worker threads
+		virtual bool getParallelAnimation() const _IRR_OVERRIDE_;
+
 	private:
 
+		class CAnimateJob;
+
 		// load and create a mesh which we know already isn't in the cache and put it in there
 		IAnimatedMesh* getUncachedMesh(io::IReadFile* file, const io::path& filename, const io::path& cachename);
 
+		//! A mesh loaded by getMeshAsync()
+		struct SMeshLoad : public IWorkerTask
+		{
+			SMeshLoad(io::IReadFile* file, const io::path& filename, const io::path& cacheName)
+				: File(file), Filename(filename), CacheName(cacheName), Mesh(0), Done(false) {}
+
+			//! Try the loaders until one creates the mesh, then drops the file
+			virtual void run() _IRR_OVERRIDE_;
+
+			io::IReadFile* File;
+			io::path Filename;
+			io::path CacheName;
+			//! Loaders for the extension of the file in the order they are tried, with their locks
+			core::array<IMeshLoader*> Loaders;
+			core::array<std::recursive_mutex*> Locks;
+			IAnimatedMesh* Mesh;
+			std::atomic<bool> Done;
+		};
+
+		//! The mesh cache with the bookkeeping of the loads
+		/** Scene managers only get caches created by the first one. */
+		CMeshCache* getLoadingMeshCache() const;
+
+		//! Get the lock which keeps a mesh loader from loading two files at once
+		std::recursive_mutex* getMeshLoaderLock(u32 index);
+
+		//! Add the meshes of the loads which are done to the cache
+		void finishMeshLoads();
+
+		//! Add the mesh of a done load to the cache and call back, deletes the load
+		void finishMeshLoad(SMeshLoad* load);
+
+		//! Wait for the load of a mesh and add it to the cache
+		/** \return The loaded mesh, 0 if it failed or this scene manager
+		does not load a mesh of that name. */
+		IAnimatedMesh* waitForMeshLoad(const io::path& cacheName);
+
+		//! Replace the texture stand-ins a mesh got on a worker thread by the textures
+		void resolveMeshTextures(IMesh* mesh);
+
 		//! clears the deletion list
 		void clearDeletionList();
 
 		//! writes a scene node
 		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
 
-		struct DefaultNodeEntry
-		{
-			DefaultNodeEntry(ISceneNode* n) :
-				Node(n), TextureValue(0)
-			{
-				if (n->getMaterialCount())
-					TextureValue = (n->getMaterial(0).getTexture(0));
-			}
+		//! Distance of a node to the camera, scaled for the sort key of the render queue
+		f32 getRenderQueueDepth(const ISceneNode* node) const;
 
-			bool operator < (const DefaultNodeEntry& other) const
-			{
-				return (TextureValue < other.TextureValue);
-			}
+		//! adds a node (or one of its mesh buffers) which passed culling to the list of its render pass
+		void addToRenderPass(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass,
+			IMeshBuffer* meshBuffer, const video::SMaterial* material);
+
+		//! queues a registration until all nodes registered in drawAll() are culled at once
+		u32 addCullRegistration(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass,
+			IMeshBuffer* meshBuffer, const video::SMaterial* material);
 
+		//! tests the boxes of all queued registrations and adds the visible ones to their render pass
+		void cullRegisteredNodes();
+
+		//! OnAnimate() for the whole scene, with independent subtrees on the worker threads
+		void animateParallel(u32 timeMs);
+
+		//! registration waiting for the batch culling
+		struct SCullRegistration
+		{
 			ISceneNode* Node;
-			private:
-			void* TextureValue;
+			IMeshBuffer* MeshBuffer;
+			const video::SMaterial* Material;
+			u32 Box;
+			E_SCENE_NODE_RENDER_PASS Pass;
 		};
 
 		//! sort on distance (center) to camera
@@ -629,12 +732,16 @@ namespace scene
 		core::array<ISceneNode*> LightList;
 		core::array<ISceneNode*> ShadowNodeList;
 		core::array<ISceneNode*> SkyBoxList;
-		core::array<DefaultNodeEntry> SolidNodeList;
+		CRenderQueue SolidRenderQueue;
 		core::array<TransparentNodeEntry> TransparentNodeList;
 		core::array<TransparentNodeEntry> TransparentEffectNodeList;
 		core::array<ISceneNode*> GuiNodeList;
 
 		core::array<IMeshLoader*> MeshLoaderList;
+		//! Per mesh loader, created when a mesh is loaded the first time
+		core::array<std::recursive_mutex*> MeshLoaderLocks;
+		//! Loads of getMeshAsync() not yet added to the cache
+		core::array<SMeshLoad*> MeshLoads;
 		core::array<ISceneLoader*> SceneLoaderList;
 		core::array<ISceneNode*> DeletionList;
 		core::array<ISceneNodeFactory*> SceneNodeFactoryList;
@@ -643,6 +750,32 @@ namespace scene
 		//! current active camera
 		ICameraSceneNode* ActiveCamera;
 		core::vector3df camWorldPos; // Position of camera for transparent nodes.
+		f32 RenderQueueDepthScale; // 1 / far value squared of the camera
+
+		//! culling result of the node which registered last
+		const ISceneNode* LastRegisteredNode;
+		u32 LastRegisteredTaken;
+		u32 LastRegisteredBox;
+
+		//! boxes of the nodes registered in drawAll(), culled in one batch
+		CFrustumCuller Culler;
+		core::array<SCullRegistration> CullRegistrations;
+		bool BatchCulling;
+
+		//! loose octree of the nodes added with addToSceneIndex()
+		CSceneNodeIndex NodeIndex;
+		SCullingStatistics CullingStatistics;
+		u32 TransformationUpdates;
+
+		//! counters of the current drawAll(), published to FrameStatisticsRing at its end
+		SSceneFrameStatistics FrameStatistics;
+		CFrameStatisticsRing<SSceneFrameStatistics> FrameStatisticsRing;
+
+		//! subtrees animated as one job each, and per thread the ones which opted out
+		core::array<ISceneNode*> AnimationQueue;
+		core::array<ISceneNode*> AnimationTasks;
+		core::array<core::array<ISceneNode*> > DeferredAnimation;
+		bool ParallelAnimation;
 
 		video::SColor ShadowColor;
 		video::SColorf AmbientLight;
@@ -97,6 +97,12 @@ namespace scene
 			return ESNAT_CAMERA_FPS;
 		}
 
+		//! Reads the input state and moves the cursor
+		virtual bool isThreadSafe() const _IRR_OVERRIDE_
+		{
+			return false;
+		}
+
 		//! Creates a clone of this animator.
 		/** Please note that you will have to drop
 		(IReferenceCounted::drop()) the returned pointer once you're
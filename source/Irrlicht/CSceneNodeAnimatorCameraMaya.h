@@ -82,6 +82,12 @@ namespace scene
 			return ESNAT_CAMERA_MAYA;
 		}
 
+		//! Reads the input state
+		virtual bool isThreadSafe() const _IRR_OVERRIDE_
+		{
+			return false;
+		}
+
 		//! Creates a clone of this animator.
 		/** Please note that you will have to drop
 		(IReferenceCounted::drop()) the returned pointer after calling
@@ -87,6 +87,9 @@ namespace scene
 		//! Returns type of the scene node animator
 		virtual ESCENE_NODE_ANIMATOR_TYPE getType() const _IRR_OVERRIDE_ { return ESNAT_COLLISION_RESPONSE; }
 
+		//! Queries the world and calls the collision callback
+		virtual bool isThreadSafe() const _IRR_OVERRIDE_ { return false; }
+
 		//! Creates a clone of this animator.
 		/** Please note that you will have to drop
 		(IReferenceCounted::drop()) the returned pointer after calling
@@ -27,6 +27,12 @@ namespace scene
 			return ESNAT_DELETION;
 		}
 
+		//! Queues the node in the scene manager for deletion
+		virtual bool isThreadSafe() const _IRR_OVERRIDE_
+		{
+			return false;
+		}
+
 		//! Creates a clone of this animator.
 		/** Please note that you will have to drop
 		(IReferenceCounted::drop()) the returned pointer after calling
@@ -33,6 +33,9 @@ namespace scene
 		//! Returns type of the scene node animator
 		virtual ESCENE_NODE_ANIMATOR_TYPE getType() const _IRR_OVERRIDE_ { return ESNAT_FLY_STRAIGHT; }
 
+		//! Only changes the animated node and the state of this animator
+		virtual bool isThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
 		//! Creates a clone of this animator.
 		/** Please note that you will have to drop
 		(IReferenceCounted::drop()) the returned pointer after calling this. */
@@ -0,0 +1,426 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeIndex.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	// Size of the cells on level 0, larger nodes are kept in an extra list
+	const f32 ROOT_CELL_SIZE = 65536.f;
+	// Cells on the deepest level are ROOT_CELL_SIZE / 2^MAX_LEVEL large
+	const u32 MAX_LEVEL = 16;
+}
+
+
+//! Combines the coordinates and mixes the bits with the MurmurHash3 finalizer
+size_t CSceneNodeIndex::SCellKeyHash::operator()(const SCellKey& key) const
+{
+	u64 hash = (u64)(u32)key.X | ((u64)(u32)key.Z << 32);
+	hash ^= ((u64)(u32)key.Y << 16) ^ ((u64)key.Level << 58);
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return (size_t)hash;
+}
+
+
+CSceneNodeIndex::CSceneNodeIndex() : EmptyCells(0), Registering(false)
+{
+}
+
+
+CSceneNodeIndex::~CSceneNodeIndex()
+{
+	clear();
+}
+
+
+bool CSceneNodeIndex::add(ISceneNode* node)
+{
+	if (!node || node->getAutomaticCulling() == EAC_OFF)
+		return false;
+
+	ISceneNodeIndex* index = node->getSceneNodeIndex();
+	if (index && index != this)
+		return false;
+
+	if (index)
+	{
+		// refit, the bounding box might have changed
+		SEntry& entry = Entries[node];
+		unlink(entry);
+		link(node, entry);
+		return true;
+	}
+
+	node->grab();
+	node->setSceneNodeIndex(this);
+
+	SEntry& entry = Entries[node];
+	entry.Moved = false;
+	link(node, entry);
+	return true;
+}
+
+
+bool CSceneNodeIndex::remove(ISceneNode* node)
+{
+	EntryMap::iterator it = Entries.find(node);
+	if (it == Entries.end())
+		return false;
+
+	unlink(it->second);
+	Entries.erase(it);
+
+	// a moved node stays in the Moved list, but is skipped there
+	node->setSceneNodeIndex(0);
+	node->drop();
+	return true;
+}
+
+
+void CSceneNodeIndex::clear()
+{
+	for (EntryMap::iterator it = Entries.begin(); it != Entries.end(); ++it)
+	{
+		it->first->setSceneNodeIndex(0);
+		it->first->drop();
+	}
+
+	Entries.clear();
+	Cells.clear();
+	RootCells.clear();
+	Oversized.clear();
+	Moved.clear();
+	EmptyCells = 0;
+}
+
+
+void CSceneNodeIndex::registerNodes(const ISceneNode* root, const SViewFrustum* frustum, SCullingStatistics& statistics)
+{
+	updateMovedNodes();
+	if (EmptyCells > Entries.size())
+		pruneCells();
+
+	Registering = true;
+	for (u32 i=0; i<RootCells.size(); ++i)
+		registerCell(*RootCells[i], root, frustum, statistics);
+	registerList(Oversized, root);
+	Registering = false;
+
+	// nodes which were removed from the scene are not registered and
+	// leave the index now
+	for (u32 i=0; i<Detached.size(); ++i)
+		remove(Detached[i]);
+	Detached.set_used(0);
+}
+
+
+void CSceneNodeIndex::onSceneNodeRemoved(ISceneNode* node)
+{
+	if (Registering)
+		Detached.push_back(node);
+	else
+		remove(node);
+}
+
+
+void CSceneNodeIndex::onSceneNodeMoved(ISceneNode* node)
+{
+	// the entry of a node is only touched by the thread animating it
+	EntryMap::iterator it = Entries.find(node);
+	if (it != Entries.end() && !it->second.Moved)
+	{
+		it->second.Moved = true;
+		std::lock_guard<std::mutex> lock(MovedMutex);
+		Moved.push_back(node);
+	}
+}
+
+
+bool CSceneNodeIndex::getCellKey(const core::aabbox3df& box, SCellKey& key, f32& cellSize)
+{
+	const core::vector3df extent = box.getExtent();
+	const f32 size = core::max_(extent.X, extent.Y, extent.Z);
+	if (size > ROOT_CELL_SIZE)
+		return false;
+
+	// deepest level with cells at least as large as the node
+	u32 level = 0;
+	cellSize = ROOT_CELL_SIZE;
+	while (level < MAX_LEVEL && size <= cellSize*0.5f)
+	{
+		cellSize *= 0.5f;
+		++level;
+	}
+
+	const core::vector3df center = box.getCenter();
+	key.X = core::floor32(center.X / cellSize);
+	key.Y = core::floor32(center.Y / cellSize);
+	key.Z = core::floor32(center.Z / cellSize);
+	key.Level = level;
+	return true;
+}
+
+
+void CSceneNodeIndex::link(ISceneNode* node, SEntry& entry)
+{
+	SCellKey key;
+	f32 cellSize;
+	if (!getCellKey(node->getTransformedBoundingBox(), key, cellSize))
+	{
+		entry.Cell = 0;
+		entry.Slot = Oversized.size();
+		Oversized.push_back(node);
+		return;
+	}
+
+	SCell* cell = getCell(key, cellSize);
+	entry.Cell = cell;
+	entry.Slot = cell->Nodes.size();
+	cell->Nodes.push_back(node);
+
+	for (; cell; cell = cell->Parent)
+	{
+		if (!cell->SubtreeNodes++)
+			--EmptyCells;
+	}
+}
+
+
+void CSceneNodeIndex::unlink(const SEntry& entry)
+{
+	if (!entry.Cell)
+	{
+		removeSlot(Oversized, entry.Slot);
+		return;
+	}
+
+	removeSlot(entry.Cell->Nodes, entry.Slot);
+
+	for (SCell* cell = entry.Cell; cell; cell = cell->Parent)
+	{
+		if (!--cell->SubtreeNodes)
+			++EmptyCells;
+	}
+}
+
+
+void CSceneNodeIndex::pruneCells()
+{
+	// all ancestors of a used cell are used, so only the links from used
+	// cells to empty children need to be cut before erasing
+	RootCells.set_used(0);
+	for (CellMap::iterator it = Cells.begin(); it != Cells.end(); ++it)
+	{
+		SCell& cell = it->second;
+		if (!cell.SubtreeNodes)
+			continue;
+
+		if (!cell.Parent)
+			RootCells.push_back(&cell);
+		for (u32 i=0; i<8; ++i)
+		{
+			if (cell.Children[i] && !cell.Children[i]->SubtreeNodes)
+				cell.Children[i] = 0;
+		}
+	}
+
+	for (CellMap::iterator it = Cells.begin(); it != Cells.end(); )
+	{
+		if (it->second.SubtreeNodes)
+			++it;
+		else
+			it = Cells.erase(it);
+	}
+	EmptyCells = 0;
+}
+
+
+void CSceneNodeIndex::removeSlot(core::array<ISceneNode*>& nodes, u32 slot)
+{
+	const u32 last = nodes.size()-1;
+	if (slot != last)
+	{
+		nodes[slot] = nodes[last];
+		Entries[nodes[slot]].Slot = slot;
+	}
+	nodes.erase(last);
+}
+
+
+CSceneNodeIndex::SCell* CSceneNodeIndex::getCell(const SCellKey& key, f32 cellSize)
+{
+	CellMap::iterator it = Cells.find(key);
+	if (it != Cells.end())
+		return &it->second;
+
+	SCell* cell = &Cells[key];
+
+	const f32 loose = cellSize*0.5f;
+	cell->Box.MinEdge.set(key.X*cellSize - loose, key.Y*cellSize - loose, key.Z*cellSize - loose);
+	cell->Box.MaxEdge.set((key.X+1)*cellSize + loose, (key.Y+1)*cellSize + loose, (key.Z+1)*cellSize + loose);
+	for (u32 i=0; i<8; ++i)
+		cell->Children[i] = 0;
+	cell->Key = key;
+	cell->SubtreeNodes = 0;
+	++EmptyCells;
+
+	if (key.Level == 0)
+	{
+		cell->Parent = 0;
+		RootCells.push_back(cell);
+	}
+	else
+	{
+		cell->Parent = getCell(getParentKey(key), cellSize*2.f);
+		cell->Parent->Children[getChildIndex(key)] = cell;
+	}
+	return cell;
+}
+
+
+void CSceneNodeIndex::updateMovedNodes()
+{
+	for (u32 i=0; i<Moved.size(); ++i)
+	{
+		EntryMap::iterator it = Entries.find(Moved[i]);
+		if (it == Entries.end() || !it->second.Moved)
+			continue;
+
+		SEntry& entry = it->second;
+		entry.Moved = false;
+
+		SCellKey key;
+		f32 cellSize;
+		if (!entry.Cell || !getCellKey(it->first->getTransformedBoundingBox(), key, cellSize))
+		{
+			unlink(entry);
+			link(it->first, entry);
+			continue;
+		}
+
+		// most moves stay inside the loose cell
+		SCell* from = entry.Cell;
+		if (key == from->Key)
+			continue;
+
+		SCell* to = getCell(key, cellSize);
+		removeSlot(from->Nodes, entry.Slot);
+		entry.Cell = to;
+		entry.Slot = to->Nodes.size();
+		to->Nodes.push_back(it->first);
+
+		// the subtree counts only change below the common ancestor
+		while (from != to)
+		{
+			if (from && (!to || from->Key.Level >= to->Key.Level))
+			{
+				if (!--from->SubtreeNodes)
+					++EmptyCells;
+				from = from->Parent;
+			}
+			else
+			{
+				if (!to->SubtreeNodes++)
+					--EmptyCells;
+				to = to->Parent;
+			}
+		}
+	}
+	Moved.set_used(0);
+}
+
+
+void CSceneNodeIndex::registerCell(const SCell& cell, const ISceneNode* root, const SViewFrustum* frustum, SCullingStatistics& statistics)
+{
+	if (!cell.SubtreeNodes)
+		return;
+
+	++statistics.CellsVisited;
+	if (frustum && isOutside(cell.Box, *frustum))
+	{
+		++statistics.CellsCulled;
+		statistics.NodesCulled += cell.SubtreeNodes;
+		return;
+	}
+
+	registerList(cell.Nodes, root);
+
+	for (u32 i=0; i<8; ++i)
+	{
+		if (cell.Children[i])
+			registerCell(*cell.Children[i], root, frustum, statistics);
+	}
+}
+
+
+void CSceneNodeIndex::registerList(const core::array<ISceneNode*>& nodes, const ISceneNode* root)
+{
+	for (u32 i=0; i<nodes.size(); ++i)
+	{
+		// like isTrulyVisible(), but also finds out if the node is still in the scene
+		ISceneNode* node = nodes[i];
+		bool visible = node->isVisible();
+		const ISceneNode* ancestor = node;
+		while (ancestor->getParent())
+		{
+			ancestor = ancestor->getParent();
+			visible = visible && ancestor->isVisible();
+		}
+
+		if (ancestor != root)
+			Detached.push_back(node);
+		else if (visible)
+			node->OnRegisterSceneNode();
+	}
+}
+
+
+CSceneNodeIndex::SCellKey CSceneNodeIndex::getParentKey(const SCellKey& key)
+{
+	// arithmetic shifts round towards negative infinity, like the cell coordinates
+	SCellKey parent;
+	parent.X = key.X >> 1;
+	parent.Y = key.Y >> 1;
+	parent.Z = key.Z >> 1;
+	parent.Level = key.Level-1;
+	return parent;
+}
+
+
+u32 CSceneNodeIndex::getChildIndex(const SCellKey& key)
+{
+	return (key.X & 1) | ((key.Y & 1) << 1) | ((key.Z & 1) << 2);
+}
+
+
+//! Same tests as the batch culling: the frustum box and the nearest corner per plane
+bool CSceneNodeIndex::isOutside(const core::aabbox3df& box, const SViewFrustum& frustum)
+{
+	if (!box.intersectsWithBox(frustum.getBoundingBox()))
+		return true;
+
+	for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+	{
+		const core::plane3df& plane = frustum.planes[i];
+		const core::vector3df corner(
+			plane.Normal.X > 0.f ? box.MinEdge.X : box.MaxEdge.X,
+			plane.Normal.Y > 0.f ? box.MinEdge.Y : box.MaxEdge.Y,
+			plane.Normal.Z > 0.f ? box.MinEdge.Z : box.MaxEdge.Z);
+		if (plane.Normal.dotProduct(corner) + plane.D > core::ROUNDING_ERROR_f32)
+			return true;
+	}
+	return false;
+}
+
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,158 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_INDEX_H_INCLUDED__
+#define __C_SCENE_NODE_INDEX_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "ISceneManager.h"
+#include "SViewFrustum.h"
+#include <unordered_map>
+#include <mutex>
+
+namespace irr
+{
+namespace scene
+{
+
+//! Loose octree over scene nodes
+/** Cells are stored in a hash map by level and integer coordinates, so
+the octree has no fixed bounds. A node goes into the deepest cell which
+is at least as large as the node's bounding box, at the position of the
+box center. The cells are loose: their box is twice the cell size, so
+every node fits into the cell box it is stored in. Each cell counts the
+nodes in its subtree. Empty cells are skipped and kept for nodes moving
+back into them, until there are more empty cells than nodes. */
+class CSceneNodeIndex : public ISceneNodeIndex
+{
+public:
+
+	CSceneNodeIndex();
+
+	virtual ~CSceneNodeIndex();
+
+	//! Add a node to the index, or update its cell when it is indexed already
+	bool add(ISceneNode* node);
+
+	//! Remove a node from the index
+	bool remove(ISceneNode* node);
+
+	//! Remove all nodes
+	void clear();
+
+	//! Call OnRegisterSceneNode() of the nodes which are in cells intersecting the frustum
+	/** Nodes which are no longer below the root without having been
+	removed from their parent, like children of nodes which override
+	removeChild(), are removed from the index when their cell is visited.
+	\param root Root of the scene.
+	\param frustum View frustum, or 0 to register all visible nodes.
+	\param statistics Cell counters and nodes culled with their cells
+	are added to it. */
+	void registerNodes(const ISceneNode* root, const SViewFrustum* frustum, SCullingStatistics& statistics);
+
+	//! Remember to move the node to its new cell before the next registerNodes()
+	/** Thread safe for different nodes, as long as no nodes are added or removed. */
+	virtual void onSceneNodeMoved(ISceneNode* node) _IRR_OVERRIDE_;
+
+	//! Remove the node, it left the scene
+	/** Deferred to the end of registerNodes() when called from there. */
+	virtual void onSceneNodeRemoved(ISceneNode* node) _IRR_OVERRIDE_;
+
+	//! Amount of indexed nodes
+	u32 size() const
+	{
+		return (u32)Entries.size();
+	}
+
+private:
+
+	struct SCellKey
+	{
+		bool operator==(const SCellKey& other) const
+		{
+			return X == other.X && Y == other.Y && Z == other.Z && Level == other.Level;
+		}
+
+		s32 X;
+		s32 Y;
+		s32 Z;
+		u32 Level;
+	};
+
+	struct SCellKeyHash
+	{
+		size_t operator()(const SCellKey& key) const;
+	};
+
+	struct SCell
+	{
+		//! Loose box of the cell
+		core::aabbox3df Box;
+		//! Nodes stored in this cell
+		core::array<ISceneNode*> Nodes;
+		//! Cells are never moved in the map, so they can link each other
+		SCell* Parent;
+		SCell* Children[8];
+		SCellKey Key;
+		//! Nodes in this cell and all cells below it
+		u32 SubtreeNodes;
+	};
+
+	struct SEntry
+	{
+		//! Cell the node is stored in, 0 when it is in Oversized
+		SCell* Cell;
+		//! Index in the node list of the cell or in Oversized
+		u32 Slot;
+		//! In the Moved list
+		bool Moved;
+	};
+
+	typedef std::unordered_map<SCellKey, SCell, SCellKeyHash> CellMap;
+	typedef std::unordered_map<ISceneNode*, SEntry> EntryMap;
+
+	//! Get the cell key for a bounding box
+	/** \return False if the box is too large for the cells. */
+	static bool getCellKey(const core::aabbox3df& box, SCellKey& key, f32& cellSize);
+
+	//! Put a node into the cell for its current bounding box
+	void link(ISceneNode* node, SEntry& entry);
+
+	//! Take a node out of its cell
+	void unlink(const SEntry& entry);
+
+	//! Remove the empty cells
+	void pruneCells();
+
+	//! Remove a node from the node list of a cell or from Oversized
+	void removeSlot(core::array<ISceneNode*>& nodes, u32 slot);
+
+	//! Find a cell, creating it and its missing ancestors
+	SCell* getCell(const SCellKey& key, f32 cellSize);
+
+	//! Move nodes which moved since the last registerNodes() to their new cells
+	void updateMovedNodes();
+
+	void registerCell(const SCell& cell, const ISceneNode* root, const SViewFrustum* frustum, SCullingStatistics& statistics);
+	void registerList(const core::array<ISceneNode*>& nodes, const ISceneNode* root);
+
+	static SCellKey getParentKey(const SCellKey& key);
+	static u32 getChildIndex(const SCellKey& key);
+	static bool isOutside(const core::aabbox3df& box, const SViewFrustum& frustum);
+
+	CellMap Cells;
+	EntryMap Entries;
+	core::array<SCell*> RootCells;
+	core::array<ISceneNode*> Oversized;
+	core::array<ISceneNode*> Moved;
+	std::mutex MovedMutex;
+	core::array<ISceneNode*> Detached;
+	u32 EmptyCells;
+	//! In registerNodes(), the cells must not change
+	bool Registering;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -5,8 +5,17 @@
 #include "CSkinnedMesh.h"
 #include "CBoneSceneNode.h"
 #include "IAnimatedMeshSceneNode.h"
+#include "CWorkerPool.h"
 #include "os.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define _IRR_SKINNING_SSE_
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define _IRR_SKINNING_NEON_
+#endif
+
 namespace
 {
 	// Frames must always be increasing, so we remove objects where this isn't the case
@@ -79,6 +88,161 @@ namespace
 	{
 		return a.rotation == b.rotation;
 	}
+
+	// Returns the index of the first key at or after frame, -1 if there is none.
+	// The hint and the key after it are checked first, as animations
+	// usually move forward. Otherwise the keys are binary searched.
+	template <class T> // T = objects containing a "frame" variable
+	irr::s32 findKeyIndex(const irr::core::array<T>& keys, irr::f32 frame, irr::s32& hint)
+	{
+		const irr::s32 size = (irr::s32)keys.size();
+
+		if (hint>=0 && hint<size)
+		{
+			//check this hint
+			if (hint>0 && keys[hint].frame>=frame && keys[hint-1].frame<frame)
+				return hint;
+
+			//check the next index
+			if (hint+1<size && keys[hint+1].frame>=frame && keys[hint].frame<frame)
+				return ++hint;
+		}
+
+		//The hint test failed, keys are sorted by frame
+		irr::s32 low = 0;
+		irr::s32 high = size;
+		while (low < high)
+		{
+			const irr::s32 mid = low + (high-low)/2;
+			if (keys[mid].frame < frame)
+				low = mid+1;
+			else
+				high = mid;
+		}
+
+		if (low == size)
+			return -1;
+
+		hint = low;
+		return low;
+	}
+
+	// Buffers with fewer skinned vertices are not worth waking the worker threads
+	const irr::u32 SKINNING_PARALLEL_MIN_VERTICES = 4096;
+	const irr::u32 SKINNING_PARALLEL_MIN_GRAIN = 1024;
+
+	// Skins a range of vertices from a per vertex influence table.
+	// For each vertex the (up to) 4 joint matrices are blended by weight
+	// and the static position and normal are transformed by the result,
+	// which is the same sum the per joint path builds one weight at a time.
+	class CSkinInfluencesJob : public irr::IWorkerJob
+	{
+	public:
+		const irr::u32* Vertex;
+		const irr::u16* Joint[4];
+		const irr::f32* Weight[4];
+		const irr::core::vector3df* StaticPos;
+		const irr::core::vector3df* StaticNormal;
+		const irr::core::matrix4* Palette;
+		irr::u8* Vertices;
+		irr::u32 Pitch;
+		bool Normals;
+
+		virtual void run(irr::u32 begin, irr::u32 end, irr::u32 thread) _IRR_OVERRIDE_
+		{
+			using namespace irr;
+
+			for (u32 i=begin; i<end; ++i)
+			{
+				video::S3DVertex* v = (video::S3DVertex*)(Vertices + Pitch*Vertex[i]);
+				const f32* m0 = Palette[Joint[0][i]].pointer();
+				const f32* m1 = Palette[Joint[1][i]].pointer();
+				const f32* m2 = Palette[Joint[2][i]].pointer();
+				const f32* m3 = Palette[Joint[3][i]].pointer();
+				const core::vector3df& p = StaticPos[i];
+
+#if defined(_IRR_SKINNING_SSE_)
+				const __m128 w0 = _mm_set1_ps(Weight[0][i]);
+				const __m128 w1 = _mm_set1_ps(Weight[1][i]);
+				const __m128 w2 = _mm_set1_ps(Weight[2][i]);
+				const __m128 w3 = _mm_set1_ps(Weight[3][i]);
+
+				__m128 c[4];
+				for (u32 k=0; k<4; ++k)
+				{
+					c[k] = _mm_mul_ps(_mm_loadu_ps(m0+4*k), w0);
+					c[k] = _mm_add_ps(c[k], _mm_mul_ps(_mm_loadu_ps(m1+4*k), w1));
+					c[k] = _mm_add_ps(c[k], _mm_mul_ps(_mm_loadu_ps(m2+4*k), w2));
+					c[k] = _mm_add_ps(c[k], _mm_mul_ps(_mm_loadu_ps(m3+4*k), w3));
+				}
+
+				f32 out[4];
+				__m128 r = _mm_add_ps(_mm_mul_ps(c[0], _mm_set1_ps(p.X)), c[3]);
+				r = _mm_add_ps(r, _mm_mul_ps(c[1], _mm_set1_ps(p.Y)));
+				r = _mm_add_ps(r, _mm_mul_ps(c[2], _mm_set1_ps(p.Z)));
+				_mm_storeu_ps(out, r);
+				v->Pos.set(out[0], out[1], out[2]);
+
+				if (Normals)
+				{
+					const core::vector3df& n = StaticNormal[i];
+					r = _mm_mul_ps(c[0], _mm_set1_ps(n.X));
+					r = _mm_add_ps(r, _mm_mul_ps(c[1], _mm_set1_ps(n.Y)));
+					r = _mm_add_ps(r, _mm_mul_ps(c[2], _mm_set1_ps(n.Z)));
+					_mm_storeu_ps(out, r);
+					v->Normal.set(out[0], out[1], out[2]);
+				}
+#elif defined(_IRR_SKINNING_NEON_)
+				float32x4_t c[4];
+				for (u32 k=0; k<4; ++k)
+				{
+					c[k] = vmulq_n_f32(vld1q_f32(m0+4*k), Weight[0][i]);
+					c[k] = vmlaq_n_f32(c[k], vld1q_f32(m1+4*k), Weight[1][i]);
+					c[k] = vmlaq_n_f32(c[k], vld1q_f32(m2+4*k), Weight[2][i]);
+					c[k] = vmlaq_n_f32(c[k], vld1q_f32(m3+4*k), Weight[3][i]);
+				}
+
+				f32 out[4];
+				float32x4_t r = vmlaq_n_f32(c[3], c[0], p.X);
+				r = vmlaq_n_f32(r, c[1], p.Y);
+				r = vmlaq_n_f32(r, c[2], p.Z);
+				vst1q_f32(out, r);
+				v->Pos.set(out[0], out[1], out[2]);
+
+				if (Normals)
+				{
+					const core::vector3df& n = StaticNormal[i];
+					r = vmulq_n_f32(c[0], n.X);
+					r = vmlaq_n_f32(r, c[1], n.Y);
+					r = vmlaq_n_f32(r, c[2], n.Z);
+					vst1q_f32(out, r);
+					v->Normal.set(out[0], out[1], out[2]);
+				}
+#else
+				const f32 w0 = Weight[0][i];
+				const f32 w1 = Weight[1][i];
+				const f32 w2 = Weight[2][i];
+				const f32 w3 = Weight[3][i];
+
+				f32 c[16];
+				for (u32 k=0; k<16; ++k)
+					c[k] = m0[k]*w0 + m1[k]*w1 + m2[k]*w2 + m3[k]*w3;
+
+				v->Pos.set(p.X*c[0] + p.Y*c[4] + p.Z*c[8] + c[12],
+					p.X*c[1] + p.Y*c[5] + p.Z*c[9] + c[13],
+					p.X*c[2] + p.Y*c[6] + p.Z*c[10] + c[14]);
+
+				if (Normals)
+				{
+					const core::vector3df& n = StaticNormal[i];
+					v->Normal.set(n.X*c[0] + n.Y*c[4] + n.Z*c[8],
+						n.X*c[1] + n.Y*c[5] + n.Z*c[9],
+						n.X*c[2] + n.Y*c[6] + n.Z*c[10]);
+				}
+#endif
+			}
+		}
+	};
 };
 
 namespace irr
@@ -89,11 +253,14 @@ namespace scene
 
 //! constructor
 CSkinnedMesh::CSkinnedMesh()
-: SkinningBuffers(0), EndFrame(0.f), FramesPerSecond(25.f),
+: SkinningBuffers(0),
+	PosesUsed(0), PoseCacheSize(0), PoseFrameTolerance(0.f), PoseSceneTime(0),
+	AppliedPose(-1), PoseHits(0), PoseMisses(0), PoseChanges(0),
+	EndFrame(0.f), FramesPerSecond(25.f), SampleRate(0.f),
 	LastAnimatedFrame(-1), SkinnedLastFrame(false),
-	InterpolationMode(EIM_LINEAR),
+	InterpolationMode(EIM_LINEAR), SkinningMode(ESM_JOINTS),
 	HasAnimation(false), PreparedForSkinning(false),
-	AnimateNormals(true), HardwareSkinning(false)
+	AnimateNormals(true), HardwareSkinning(false), HasInfluences(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CSkinnedMesh");
@@ -169,10 +336,15 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 
 	LastAnimatedFrame=frame;
 	SkinnedLastFrame=false;
+	AppliedPose=-1;
+	++PoseChanges;
 
 	if (blend<=0.f)
 		return; //No need to animate
 
+	// the sampled poses are interpolated linearly
+	const bool useSamples = InterpolationMode==EIM_LINEAR && JointSamples.size()==AllJoints.size();
+
 	for (u32 i=0; i<AllJoints.size(); ++i)
 	{
 		//The joints can be animated here with no input from their
@@ -188,10 +360,13 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 		core::vector3df scale = oldScale;
 		core::quaternion rotation = oldRotation;
 
-		getFrameData(frame, joint,
-				position, joint->positionHint,
-				scale, joint->scaleHint,
-				rotation, joint->rotationHint);
+		if (!useSamples || !getSampledFrameData(frame, i, position, scale, rotation))
+		{
+			getFrameData(frame, joint,
+					position, joint->positionHint,
+					scale, joint->scaleHint,
+					rotation, joint->rotationHint);
+		}
 
 		if (blend==1.0f)
 		{
@@ -320,197 +495,370 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 				core::vector3df &scale, s32 &scaleHint,
 				core::quaternion &rotation, s32 &rotationHint)
 {
-	s32 foundPositionIndex = -1;
-	s32 foundScaleIndex = -1;
-	s32 foundRotationIndex = -1;
-
 	if (joint->UseAnimationFrom)
 	{
 		const core::array<SPositionKey> &PositionKeys=joint->UseAnimationFrom->PositionKeys;
 		const core::array<SScaleKey> &ScaleKeys=joint->UseAnimationFrom->ScaleKeys;
 		const core::array<SRotationKey> &RotationKeys=joint->UseAnimationFrom->RotationKeys;
 
-		if (PositionKeys.size())
-		{
-			foundPositionIndex = -1;
+		const s32 foundPositionIndex = findKeyIndex(PositionKeys, frame, positionHint);
 
-			//Test the Hints...
-			if (positionHint>=0 && (u32)positionHint < PositionKeys.size())
-			{
-				//check this hint
-				if (positionHint>0 && PositionKeys[positionHint].frame>=frame && PositionKeys[positionHint-1].frame<frame )
-					foundPositionIndex=positionHint;
-				else if (positionHint+1 < (s32)PositionKeys.size())
-				{
-					//check the next index
-					if ( PositionKeys[positionHint+1].frame>=frame &&
-							PositionKeys[positionHint+0].frame<frame)
-					{
-						positionHint++;
-						foundPositionIndex=positionHint;
-					}
-				}
-			}
-
-			//The hint test failed, do a full scan...
-			if (foundPositionIndex==-1)
+		//Do interpolation...
+		if (foundPositionIndex!=-1)
+		{
+			if (InterpolationMode==EIM_CONSTANT || foundPositionIndex==0)
 			{
-				for (u32 i=0; i<PositionKeys.size(); ++i)
-				{
-					if (PositionKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundPositionIndex=i;
-						positionHint=i;
-						break;
-					}
-				}
+				position = PositionKeys[foundPositionIndex].position;
 			}
-
-			//Do interpolation...
-			if (foundPositionIndex!=-1)
+			else if (InterpolationMode==EIM_LINEAR)
 			{
-				if (InterpolationMode==EIM_CONSTANT || foundPositionIndex==0)
-				{
-					position = PositionKeys[foundPositionIndex].position;
-				}
-				else if (InterpolationMode==EIM_LINEAR)
-				{
-					const SPositionKey& KeyA = PositionKeys[foundPositionIndex];
-					const SPositionKey& KeyB = PositionKeys[foundPositionIndex-1];
+				const SPositionKey& KeyA = PositionKeys[foundPositionIndex];
+				const SPositionKey& KeyB = PositionKeys[foundPositionIndex-1];
 
-					const f32 fd1 = frame - KeyA.frame;
-					const f32 fd2 = KeyB.frame - frame;
-					position = ((KeyB.position-KeyA.position)/(fd1+fd2))*fd1 + KeyA.position;
-				}
+				const f32 fd1 = frame - KeyA.frame;
+				const f32 fd2 = KeyB.frame - frame;
+				position = ((KeyB.position-KeyA.position)/(fd1+fd2))*fd1 + KeyA.position;
 			}
 		}
 
 		//------------------------------------------------------------
 
-		if (ScaleKeys.size())
-		{
-			foundScaleIndex = -1;
+		const s32 foundScaleIndex = findKeyIndex(ScaleKeys, frame, scaleHint);
 
-			//Test the Hints...
-			if (scaleHint>=0 && (u32)scaleHint < ScaleKeys.size())
+		//Do interpolation...
+		if (foundScaleIndex!=-1)
+		{
+			if (InterpolationMode==EIM_CONSTANT || foundScaleIndex==0)
 			{
-				//check this hint
-				if (scaleHint>0 && ScaleKeys[scaleHint].frame>=frame && ScaleKeys[scaleHint-1].frame<frame )
-					foundScaleIndex=scaleHint;
-				else if (scaleHint+1 < (s32)ScaleKeys.size())
-				{
-					//check the next index
-					if ( ScaleKeys[scaleHint+1].frame>=frame &&
-							ScaleKeys[scaleHint+0].frame<frame)
-					{
-						scaleHint++;
-						foundScaleIndex=scaleHint;
-					}
-				}
+				scale = ScaleKeys[foundScaleIndex].scale;
 			}
+			else if (InterpolationMode==EIM_LINEAR)
+			{
+				const SScaleKey& KeyA = ScaleKeys[foundScaleIndex];
+				const SScaleKey& KeyB = ScaleKeys[foundScaleIndex-1];
 
+				const f32 fd1 = frame - KeyA.frame;
+				const f32 fd2 = KeyB.frame - frame;
+				scale = ((KeyB.scale-KeyA.scale)/(fd1+fd2))*fd1 + KeyA.scale;
+			}
+		}
 
-			//The hint test failed, do a full scan...
-			if (foundScaleIndex==-1)
+		//-------------------------------------------------------------
+
+		const s32 foundRotationIndex = findKeyIndex(RotationKeys, frame, rotationHint);
+
+		//Do interpolation...
+		if (foundRotationIndex!=-1)
+		{
+			if (InterpolationMode==EIM_CONSTANT || foundRotationIndex==0)
 			{
-				for (u32 i=0; i<ScaleKeys.size(); ++i)
-				{
-					if (ScaleKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundScaleIndex=i;
-						scaleHint=i;
-						break;
-					}
-				}
+				rotation = RotationKeys[foundRotationIndex].rotation;
 			}
-
-			//Do interpolation...
-			if (foundScaleIndex!=-1)
+			else if (InterpolationMode==EIM_LINEAR)
 			{
-				if (InterpolationMode==EIM_CONSTANT || foundScaleIndex==0)
-				{
-					scale = ScaleKeys[foundScaleIndex].scale;
-				}
-				else if (InterpolationMode==EIM_LINEAR)
-				{
-					const SScaleKey& KeyA = ScaleKeys[foundScaleIndex];
-					const SScaleKey& KeyB = ScaleKeys[foundScaleIndex-1];
+				const SRotationKey& KeyA = RotationKeys[foundRotationIndex];
+				const SRotationKey& KeyB = RotationKeys[foundRotationIndex-1];
 
-					const f32 fd1 = frame - KeyA.frame;
-					const f32 fd2 = KeyB.frame - frame;
-					scale = ((KeyB.scale-KeyA.scale)/(fd1+fd2))*fd1 + KeyA.scale;
-				}
+				const f32 fd1 = frame - KeyA.frame;
+				const f32 fd2 = KeyB.frame - frame;
+				const f32 t = fd1/(fd1+fd2);
+
+				/*
+				f32 t = 0;
+				if (KeyA.frame!=KeyB.frame)
+					t = (frame-KeyA.frame) / (KeyB.frame - KeyA.frame);
+				*/
+
+				rotation.slerp(KeyA.rotation, KeyB.rotation, t);
 			}
 		}
+	}
+}
 
-		//-------------------------------------------------------------
 
-		if (RotationKeys.size())
+//! Reads a joint's pose from the pre-sampled animation
+/** Returns false when frame is outside of the sampled range. */
+bool CSkinnedMesh::getSampledFrameData(f32 frame, u32 jointIndex,
+				core::vector3df &position, core::vector3df &scale, core::quaternion &rotation) const
+{
+	if (frame < 0.f || frame > EndFrame)
+		return false;
+
+	const SJointSamples& samples = JointSamples[jointIndex];
+	const f32 s = frame * SampleRate;
+	const u32 i = (u32)s;
+	const f32 t = s - (f32)i;
+
+	if (samples.Position.size())
+	{
+		const u32 last = samples.Position.size()-1;
+		position = core::lerp(samples.Position[core::min_(i, last)], samples.Position[core::min_(i+1, last)], t);
+	}
+
+	if (samples.Scale.size())
+	{
+		const u32 last = samples.Scale.size()-1;
+		scale = core::lerp(samples.Scale[core::min_(i, last)], samples.Scale[core::min_(i+1, last)], t);
+	}
+
+	if (samples.Rotation.size())
+	{
+		const u32 last = samples.Rotation.size()-1;
+		rotation.slerp(samples.Rotation[core::min_(i, last)], samples.Rotation[core::min_(i+1, last)], t);
+	}
+
+	return true;
+}
+
+
+void CSkinnedMesh::sampleAnimation()
+{
+	JointSamples.clear();
+	if (SampleRate <= 0.f || !HasAnimation)
+		return;
+
+	const u32 count = core::floor32(EndFrame*SampleRate) + 2;
+
+	JointSamples.reallocate(AllJoints.size());
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		JointSamples.push_back(SJointSamples());
+
+		SJoint *joint = AllJoints[i];
+		if (!joint->UseAnimationFrom)
+			continue;
+
+		SJointSamples& samples = JointSamples.getLast();
+		const bool hasPosition = joint->UseAnimationFrom->PositionKeys.size() != 0;
+		const bool hasScale = joint->UseAnimationFrom->ScaleKeys.size() != 0;
+		const bool hasRotation = joint->UseAnimationFrom->RotationKeys.size() != 0;
+
+		if (hasPosition)
+			samples.Position.reallocate(count);
+		if (hasScale)
+			samples.Scale.reallocate(count);
+		if (hasRotation)
+			samples.Rotation.reallocate(count);
+
+		s32 positionHint = -1;
+		s32 scaleHint = -1;
+		s32 rotationHint = -1;
+		for (u32 n=0; n<count; ++n)
 		{
-			foundRotationIndex = -1;
+			core::vector3df position = joint->Animatedposition;
+			core::vector3df scale = joint->Animatedscale;
+			core::quaternion rotation = joint->Animatedrotation;
+
+			getFrameData(core::min_((f32)n / SampleRate, EndFrame), joint,
+					position, positionHint,
+					scale, scaleHint,
+					rotation, rotationHint);
+
+			if (hasPosition)
+				samples.Position.push_back(position);
+			if (hasScale)
+				samples.Scale.push_back(scale);
+			if (hasRotation)
+				samples.Rotation.push_back(rotation);
+		}
+	}
+}
 
-			//Test the Hints...
-			if (rotationHint>=0 && (u32)rotationHint < RotationKeys.size())
-			{
-				//check this hint
-				if (rotationHint>0 && RotationKeys[rotationHint].frame>=frame && RotationKeys[rotationHint-1].frame<frame )
-					foundRotationIndex=rotationHint;
-				else if (rotationHint+1 < (s32)RotationKeys.size())
-				{
-					//check the next index
-					if ( RotationKeys[rotationHint+1].frame>=frame &&
-							RotationKeys[rotationHint+0].frame<frame)
-					{
-						rotationHint++;
-						foundRotationIndex=rotationHint;
-					}
-				}
-			}
 
+//! Pre-samples the joint animations at a fixed rate
+void CSkinnedMesh::setAnimationSampleRate(f32 samplesPerFrame)
+{
+	SampleRate = core::max_(samplesPerFrame, 0.f);
+	sampleAnimation();
+	invalidatePoseCache();
 
-			//The hint test failed, do a full scan...
-			if (foundRotationIndex==-1)
-			{
-				for (u32 i=0; i<RotationKeys.size(); ++i)
-				{
-					if (RotationKeys[i].frame >= frame) //Keys should be sorted by frame
-					{
-						foundRotationIndex=i;
-						rotationHint=i;
-						break;
-					}
-				}
-			}
+	LastAnimatedFrame=-1;
+	SkinnedLastFrame=false;
+}
 
-			//Do interpolation...
-			if (foundRotationIndex!=-1)
-			{
-				if (InterpolationMode==EIM_CONSTANT || foundRotationIndex==0)
-				{
-					rotation = RotationKeys[foundRotationIndex].rotation;
-				}
-				else if (InterpolationMode==EIM_LINEAR)
-				{
-					const SRotationKey& KeyA = RotationKeys[foundRotationIndex];
-					const SRotationKey& KeyB = RotationKeys[foundRotationIndex-1];
 
-					const f32 fd1 = frame - KeyA.frame;
-					const f32 fd2 = KeyB.frame - frame;
-					const f32 t = fd1/(fd1+fd2);
+//! Returns the memory used by the pre-sampled joint animations in bytes
+u32 CSkinnedMesh::getAnimationSampleMemory() const
+{
+	u32 bytes = JointSamples.allocated_size() * sizeof(SJointSamples);
+	for (u32 i=0; i<JointSamples.size(); ++i)
+	{
+		bytes += JointSamples[i].Position.allocated_size() * sizeof(core::vector3df);
+		bytes += JointSamples[i].Scale.allocated_size() * sizeof(core::vector3df);
+		bytes += JointSamples[i].Rotation.allocated_size() * sizeof(core::quaternion);
+	}
+	return bytes;
+}
+
+//--------------------------------------------------------------------------
+//				Pose Cache
+//--------------------------------------------------------------------------
 
-					/*
-					f32 t = 0;
-					if (KeyA.frame!=KeyB.frame)
-						t = (frame-KeyA.frame) / (KeyB.frame - KeyA.frame);
-					*/
+//! Enables sharing of animated poses between scene nodes using this mesh
+void CSkinnedMesh::setPoseCache(u32 maxPoses, f32 frameTolerance)
+{
+	PoseCacheSize = maxPoses;
+	PoseFrameTolerance = core::max_(frameTolerance, 0.f);
+	invalidatePoseCache();
+	if (Poses.size() > PoseCacheSize)
+		Poses.erase(PoseCacheSize, Poses.size()-PoseCacheSize);
+}
 
-					rotation.slerp(KeyA.rotation, KeyB.rotation, t);
-				}
-			}
+
+//! Gets the pose cache counters of the current scene frame
+void CSkinnedMesh::getPoseCacheStatistics(u32& hits, u32& misses) const
+{
+	hits = PoseHits;
+	misses = PoseMisses;
+}
+
+
+//! Drops all cached poses, keeping their memory for reuse
+void CSkinnedMesh::invalidatePoseCache()
+{
+	PosesUsed = 0;
+	AppliedPose = -1;
+	++PoseChanges;
+}
+
+
+//! Animates and skins the mesh, reusing a pose cached in the same scene frame
+void CSkinnedMesh::animateAndSkinShared(f32 frame, f32 blend, u32 sceneTimeMs)
+{
+	// blended poses depend on the previous pose, so they can't be shared
+	if (!PoseCacheSize || !HasAnimation || HardwareSkinning || blend != 1.f)
+	{
+		animateMesh(frame, blend);
+		skinMesh();
+		return;
+	}
+
+	if (sceneTimeMs != PoseSceneTime)
+	{
+		PoseSceneTime = sceneTimeMs;
+		PoseHits = 0;
+		PoseMisses = 0;
+		invalidatePoseCache();
+	}
+
+	if (PoseFrameTolerance > 0.f)
+		frame = core::round_(frame / PoseFrameTolerance) * PoseFrameTolerance;
+
+	// mesh is still in the requested pose
+	if (AppliedPose >= 0 && Poses[AppliedPose].Frame == frame)
+	{
+		++PoseHits;
+		return;
+	}
+
+	for (u32 i=0; i<PosesUsed; ++i)
+	{
+		if (Poses[i].Frame == frame)
+		{
+			restorePose(Poses[i]);
+			AppliedPose = i;
+			++PoseHits;
+			return;
 		}
 	}
+
+	++PoseMisses;
+	animateMesh(frame, blend);
+	skinMesh();
+
+	if (PosesUsed < PoseCacheSize)
+	{
+		if (Poses.size() <= PosesUsed)
+			Poses.push_back(SPose());
+		storePose(Poses[PosesUsed], frame);
+		AppliedPose = PosesUsed++;
+	}
 }
 
+
+void CSkinnedMesh::storePose(SPose& pose, f32 frame) const
+{
+	pose.Frame = frame;
+	pose.BoundingBox = BoundingBox;
+
+	pose.Joints.set_used(AllJoints.size());
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		const SJoint* joint = AllJoints[i];
+		SPoseJoint& state = pose.Joints[i];
+		state.LocalAnimatedMatrix = joint->LocalAnimatedMatrix;
+		state.GlobalAnimatedMatrix = joint->GlobalAnimatedMatrix;
+		state.Animatedposition = joint->Animatedposition;
+		state.Animatedscale = joint->Animatedscale;
+		state.Animatedrotation = joint->Animatedrotation;
+	}
+
+	const core::array<SSkinMeshBuffer*>& buffers = *SkinningBuffers;
+	while (pose.Buffers.size() < buffers.size())
+		pose.Buffers.push_back(SPoseBuffer());
+
+	for (u32 b=0; b<buffers.size(); ++b)
+	{
+		SSkinMeshBuffer* buffer = buffers[b];
+		SPoseBuffer& state = pose.Buffers[b];
+		const u32 count = buffer->getVertexCount();
+
+		state.Transformation = buffer->Transformation;
+		state.BoundingBox = buffer->BoundingBox;
+		state.Positions.set_used(count);
+		state.Normals.set_used(AnimateNormals ? count : 0);
+		for (u32 v=0; v<count; ++v)
+		{
+			const video::S3DVertex* vertex = buffer->getVertex(v);
+			state.Positions[v] = vertex->Pos;
+			if (AnimateNormals)
+				state.Normals[v] = vertex->Normal;
+		}
+	}
+}
+
+
+void CSkinnedMesh::restorePose(const SPose& pose)
+{
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		SJoint* joint = AllJoints[i];
+		const SPoseJoint& state = pose.Joints[i];
+		joint->LocalAnimatedMatrix = state.LocalAnimatedMatrix;
+		joint->GlobalAnimatedMatrix = state.GlobalAnimatedMatrix;
+		joint->Animatedposition = state.Animatedposition;
+		joint->Animatedscale = state.Animatedscale;
+		joint->Animatedrotation = state.Animatedrotation;
+	}
+
+	core::array<SSkinMeshBuffer*>& buffers = *SkinningBuffers;
+	for (u32 b=0; b<buffers.size(); ++b)
+	{
+		SSkinMeshBuffer* buffer = buffers[b];
+		const SPoseBuffer& state = pose.Buffers[b];
+		const u32 count = buffer->getVertexCount();
+
+		for (u32 v=0; v<count; ++v)
+		{
+			video::S3DVertex* vertex = buffer->getVertex(v);
+			vertex->Pos = state.Positions[v];
+			if (state.Normals.size())
+				vertex->Normal = state.Normals[v];
+		}
+
+		buffer->Transformation = state.Transformation;
+		buffer->BoundingBox = state.BoundingBox;
+		buffer->BoundingBoxNeedsRecalculated = false;
+		buffer->setDirty(EBT_VERTEX);
+	}
+
+	BoundingBox = pose.BoundingBox;
+	LastAnimatedFrame = pose.Frame;
+	SkinnedLastFrame = true;
+	++PoseChanges;
+}
+
+
 //--------------------------------------------------------------------------
 //				Software Skinning
 //--------------------------------------------------------------------------
@@ -527,29 +875,43 @@ void CSkinnedMesh::skinMesh()
 	//-----------------
 
 	SkinnedLastFrame=true;
-	if (!HardwareSkinning)
-	{
-		//Software skin....
-		u32 i;
+	++PoseChanges;
 
-		//rigid animation
-		for (i=0; i<AllJoints.size(); ++i)
+	u32 i;
+
+	//rigid animation
+	for (i=0; i<AllJoints.size(); ++i)
+	{
+		for (u32 j=0; j<AllJoints[i]->AttachedMeshes.size(); ++j)
 		{
-			for (u32 j=0; j<AllJoints[i]->AttachedMeshes.size(); ++j)
-			{
-				SSkinMeshBuffer* Buffer=(*SkinningBuffers)[ AllJoints[i]->AttachedMeshes[j] ];
-				Buffer->Transformation=AllJoints[i]->GlobalAnimatedMatrix;
-			}
+			SSkinMeshBuffer* Buffer=(*SkinningBuffers)[ AllJoints[i]->AttachedMeshes[j] ];
+			Buffer->Transformation=AllJoints[i]->GlobalAnimatedMatrix;
 		}
+	}
 
-		//clear skinning helper array
-		for (i=0; i<Vertices_Moved.size(); ++i)
-			for (u32 j=0; j<Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j]=false;
-
-		//skin starting with the root joints
-		for (i=0; i<RootJoints.size(); ++i)
-			skinJoint(RootJoints[i], 0);
+	if (HardwareSkinning)
+	{
+		// the driver skins the static pose with the palette
+		buildJointPalette();
+	}
+	else
+	{
+		//Software skin....
+		if (SkinningMode==ESM_VERTEX_INFLUENCES && HasInfluences)
+		{
+			skinInfluences();
+		}
+		else
+		{
+			//clear skinning helper array
+			for (i=0; i<Vertices_Moved.size(); ++i)
+				for (u32 j=0; j<Vertices_Moved[i].size(); ++j)
+					Vertices_Moved[i][j]=false;
+
+			//skin starting with the root joints
+			for (i=0; i<RootJoints.size(); ++i)
+				skinJoint(RootJoints[i], 0);
+		}
 
 		for (i=0; i<SkinningBuffers->size(); ++i)
 			(*SkinningBuffers)[i]->setDirty(EBT_VERTEX);
@@ -612,6 +974,149 @@ void CSkinnedMesh::skinJoint(SJoint *joint, SJoint *parentJoint)
 }
 
 
+void CSkinnedMesh::buildSkinningPalette()
+{
+	SkinningPalette.set_used(AllJoints.size());
+	for (u32 i=0; i<AllJoints.size(); ++i)
+		SkinningPalette[i].setbyproduct(AllJoints[i]->GlobalAnimatedMatrix, AllJoints[i]->GlobalInversedMatrix);
+}
+
+
+void CSkinnedMesh::skinInfluences()
+{
+	buildSkinningPalette();
+
+	CWorkerPool& pool = getWorkerPool();
+
+	for (u32 b=0; b<Influences.size(); ++b)
+	{
+		const SSkinInfluences& influences = Influences[b];
+		const u32 count = influences.Vertex.size();
+		if (!count)
+			continue;
+
+		SSkinMeshBuffer* buffer = (*SkinningBuffers)[b];
+
+		CSkinInfluencesJob job;
+		job.Vertex = influences.Vertex.const_pointer();
+		for (u32 k=0; k<4; ++k)
+		{
+			job.Joint[k] = influences.Joint[k].const_pointer();
+			job.Weight[k] = influences.Weight[k].const_pointer();
+		}
+		job.StaticPos = influences.StaticPos.const_pointer();
+		job.StaticNormal = influences.StaticNormal.const_pointer();
+		job.Palette = SkinningPalette.const_pointer();
+		job.Vertices = (u8*)buffer->getVertices();
+		job.Pitch = video::getVertexPitchFromType(buffer->getVertexType());
+		job.Normals = AnimateNormals;
+
+		if (count >= SKINNING_PARALLEL_MIN_VERTICES)
+			pool.parallelFor(job, count, core::max_(SKINNING_PARALLEL_MIN_GRAIN, count/(pool.getThreadCount()*4)));
+		else
+			job.run(0, count, 0);
+
+		buffer->boundingBoxNeedsRecalculated();
+	}
+}
+
+
+bool CSkinnedMesh::buildInfluences()
+{
+	Influences.clear();
+	HasInfluences = false;
+
+	// count the joints pulling on each vertex
+	core::array< core::array<u8> > counts;
+	counts.reallocate(LocalBuffers.size());
+	for (u32 b=0; b<LocalBuffers.size(); ++b)
+	{
+		counts.push_back(core::array<u8>());
+		counts[b].set_used(LocalBuffers[b]->getVertexCount());
+		for (u32 v=0; v<counts[b].size(); ++v)
+			counts[b][v] = 0;
+	}
+
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		const core::array<SWeight>& weights = AllJoints[i]->Weights;
+		for (u32 j=0; j<weights.size(); ++j)
+		{
+			if (weights[j].buffer_id>=counts.size() || weights[j].vertex_id>=counts[weights[j].buffer_id].size())
+				return false;
+
+			u8& count = counts[weights[j].buffer_id][weights[j].vertex_id];
+			if (count == 4)
+				return false;
+			++count;
+		}
+	}
+
+	// one table entry per skinned vertex, in vertex order
+	core::array< core::array<s32> > slots;
+	slots.reallocate(LocalBuffers.size());
+	Influences.reallocate(LocalBuffers.size());
+	for (u32 b=0; b<LocalBuffers.size(); ++b)
+	{
+		Influences.push_back(SSkinInfluences());
+		slots.push_back(core::array<s32>());
+		slots[b].set_used(counts[b].size());
+
+		SSkinInfluences& influences = Influences[b];
+		u32 skinned = 0;
+		for (u32 v=0; v<counts[b].size(); ++v)
+		{
+			if (counts[b][v])
+				slots[b][v] = skinned++;
+			else
+				slots[b][v] = -1;
+		}
+
+		influences.Vertex.set_used(skinned);
+		influences.StaticPos.set_used(skinned);
+		influences.StaticNormal.set_used(skinned);
+		for (u32 k=0; k<4; ++k)
+		{
+			influences.Joint[k].set_used(skinned);
+			influences.Weight[k].set_used(skinned);
+			for (u32 n=0; n<skinned; ++n)
+			{
+				influences.Joint[k][n] = 0;
+				influences.Weight[k][n] = 0.f;
+			}
+		}
+
+		for (u32 v=0; v<counts[b].size(); ++v)
+		{
+			if (slots[b][v] >= 0)
+				influences.Vertex[slots[b][v]] = v;
+			counts[b][v] = 0; // reused as fill level below
+		}
+	}
+
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		const core::array<SWeight>& weights = AllJoints[i]->Weights;
+		for (u32 j=0; j<weights.size(); ++j)
+		{
+			const SWeight& weight = weights[j];
+			SSkinInfluences& influences = Influences[weight.buffer_id];
+			const s32 slot = slots[weight.buffer_id][weight.vertex_id];
+			u8& k = counts[weight.buffer_id][weight.vertex_id];
+
+			influences.Joint[k][slot] = (u16)i;
+			influences.Weight[k][slot] = weight.strength;
+			influences.StaticPos[slot] = weight.StaticPos;
+			influences.StaticNormal[slot] = weight.StaticNormal;
+			++k;
+		}
+	}
+
+	HasInfluences = true;
+	return true;
+}
+
+
 E_ANIMATED_MESH_TYPE CSkinnedMesh::getMeshType() const
 {
 	return EAMT_SKINNED;
@@ -743,6 +1248,8 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 	}
 
 	checkForAnimation();
+	sampleAnimation();
+	invalidatePoseCache();
 
 	return !unmatched;
 }
@@ -754,6 +1261,7 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 void CSkinnedMesh::updateNormalsWhenAnimating(bool on)
 {
 	AnimateNormals = on;
+	invalidatePoseCache();
 }
 
 
@@ -761,6 +1269,30 @@ void CSkinnedMesh::updateNormalsWhenAnimating(bool on)
 void CSkinnedMesh::setInterpolationMode(E_INTERPOLATION_MODE mode)
 {
 	InterpolationMode = mode;
+	invalidatePoseCache();
+}
+
+
+//! Selects the software skinning implementation
+bool CSkinnedMesh::setSkinningMode(E_SKINNING_MODE mode)
+{
+	if (mode==ESM_VERTEX_INFLUENCES && !HasInfluences)
+		return false;
+
+	if (SkinningMode!=mode)
+	{
+		SkinningMode = mode;
+		SkinnedLastFrame=false;
+		invalidatePoseCache();
+	}
+	return true;
+}
+
+
+//! Gets the software skinning implementation in use
+E_SKINNING_MODE CSkinnedMesh::getSkinningMode() const
+{
+	return SkinningMode;
 }
 
 
@@ -782,13 +1314,18 @@ const core::array<CSkinnedMesh::SJoint*> &CSkinnedMesh::getAllJoints() const
 }
 
 
-//! (This feature is not implemented in irrlicht yet)
+//! Enables hardware skinning, see ISkinnedMesh::setHardwareSkinning
 bool CSkinnedMesh::setHardwareSkinning(bool on)
 {
 	if (HardwareSkinning!=on)
 	{
 		if (on)
 		{
+			if (!HasInfluences || !buildVertexJoints())
+			{
+				os::Printer::log("Skinned Mesh - hardware skinning needs at most 4 joints per vertex and less than MAX_SKINNING_JOINTS weighted joints", ELL_WARNING);
+				return false;
+			}
 
 			//set mesh to static pose...
 			for (u32 i=0; i<AllJoints.size(); ++i)
@@ -805,12 +1342,118 @@ bool CSkinnedMesh::setHardwareSkinning(bool on)
 			}
 		}
 
+		else
+		{
+			JointPalette.clear();
+			PaletteJoints.clear();
+			VertexJoints.clear();
+		}
+
 		HardwareSkinning=on;
+		SkinnedLastFrame=false;
+		invalidatePoseCache();
 	}
 	return HardwareSkinning;
 }
 
 
+//! Returns if hardware skinning is enabled
+bool CSkinnedMesh::getHardwareSkinning() const
+{
+	return HardwareSkinning;
+}
+
+
+const core::array<core::matrix4>& CSkinnedMesh::getJointPalette() const
+{
+	return JointPalette;
+}
+
+
+const video::S3DVertexJoints* CSkinnedMesh::getVertexJoints(u32 buffer) const
+{
+	if (!HardwareSkinning || buffer >= VertexJoints.size() || VertexJoints[buffer].empty())
+		return 0;
+	return VertexJoints[buffer].const_pointer();
+}
+
+
+bool CSkinnedMesh::buildVertexJoints()
+{
+	JointPalette.clear();
+	PaletteJoints.clear();
+	VertexJoints.clear();
+
+	// palette entry of each joint, joints without weights get none
+	core::array<u16> entries;
+	entries.set_used(AllJoints.size());
+	for (u32 i=0; i<entries.size(); ++i)
+		entries[i] = 0;
+
+	VertexJoints.reallocate(Influences.size());
+	for (u32 b=0; b<Influences.size(); ++b)
+	{
+		VertexJoints.push_back(core::array<video::S3DVertexJoints>());
+
+		const SSkinInfluences& influences = Influences[b];
+		if (influences.Vertex.empty())
+			continue;
+
+		// vertices without influence only use the identity entry
+		core::array<video::S3DVertexJoints>& joints = VertexJoints[b];
+		joints.set_used(LocalBuffers[b]->getVertexCount());
+		for (u32 v=0; v<joints.size(); ++v)
+		{
+			for (u32 k=0; k<4; ++k)
+			{
+				joints[v].Joints[k] = 0;
+				joints[v].Weights[k] = 0.f;
+			}
+			joints[v].Weights[0] = 1.f;
+		}
+
+		for (u32 n=0; n<influences.Vertex.size(); ++n)
+		{
+			video::S3DVertexJoints& vertex = joints[influences.Vertex[n]];
+			for (u32 k=0; k<4; ++k)
+			{
+				const f32 weight = influences.Weight[k][n];
+				const u16 joint = influences.Joint[k][n];
+				if (weight != 0.f && !entries[joint])
+				{
+					if (PaletteJoints.size()+2 > video::MAX_SKINNING_JOINTS)
+					{
+						PaletteJoints.clear();
+						VertexJoints.clear();
+						return false;
+					}
+					PaletteJoints.push_back(joint);
+					entries[joint] = (u16)PaletteJoints.size();
+				}
+
+				vertex.Joints[k] = (weight != 0.f) ? entries[joint] : 0;
+				vertex.Weights[k] = weight;
+			}
+		}
+	}
+
+	buildJointPalette();
+	return true;
+}
+
+
+void CSkinnedMesh::buildJointPalette()
+{
+	JointPalette.set_used(PaletteJoints.size()+1);
+	JointPalette[0].makeIdentity();
+	for (u32 i=0; i<PaletteJoints.size(); ++i)
+	{
+		const SJoint* joint = AllJoints[PaletteJoints[i]];
+		JointPalette[i+1].setbyproduct(joint->GlobalAnimatedMatrix, joint->GlobalInversedMatrix);
+	}
+}
+
+
 void CSkinnedMesh::calculateGlobalMatrices(SJoint *joint,SJoint *parentJoint)
 {
 	if (!joint && parentJoint) // bit of protection from endless loops
@@ -961,6 +1604,7 @@ void CSkinnedMesh::finalize()
 	// Make sure we recalc the next frame
 	LastAnimatedFrame=-1;
 	SkinnedLastFrame=false;
+	invalidatePoseCache();
 
 	//calculate bounding box
 	for (i=0; i<LocalBuffers.size(); ++i)
@@ -1012,6 +1656,12 @@ void CSkinnedMesh::finalize()
 
 	checkForAnimation();
 
+	if (PreparedForSkinning && AllJoints.size() <= 0x10000)
+	{
+		if (!buildInfluences())
+			os::Printer::log("Skinned Mesh - more than 4 joints per vertex, vertex influence skinning disabled", ELL_DEBUG);
+	}
+
 	if (HasAnimation)
 	{
 		irr::u32 redundantPosKeys = 0;
@@ -1125,6 +1775,8 @@ void CSkinnedMesh::finalize()
 		}
 	}
 
+	sampleAnimation();
+
 	//Needed for animation and skinning...
 
 	calculateGlobalMatrices(0,0);
@@ -1347,6 +1999,8 @@ void CSkinnedMesh::transferJointsToMesh(const core::array<IBoneSceneNode*> &join
 	// Make sure we recalc the next frame
 	LastAnimatedFrame=-1;
 	SkinnedLastFrame=false;
+	AppliedPose=-1;
+	++PoseChanges;
 }
 
 
@@ -104,15 +104,42 @@ namespace scene
 		//! Sets Interpolation Mode
 		virtual void setInterpolationMode(E_INTERPOLATION_MODE mode) _IRR_OVERRIDE_;
 
+		//! Selects the software skinning implementation
+		virtual bool setSkinningMode(E_SKINNING_MODE mode) _IRR_OVERRIDE_;
+
+		//! Gets the software skinning implementation in use
+		virtual E_SKINNING_MODE getSkinningMode() const _IRR_OVERRIDE_;
+
+		//! Pre-samples the joint animations at a fixed rate
+		virtual void setAnimationSampleRate(f32 samplesPerFrame) _IRR_OVERRIDE_;
+
+		//! Returns the memory used by the pre-sampled joint animations in bytes
+		virtual u32 getAnimationSampleMemory() const _IRR_OVERRIDE_;
+
+		//! Enables sharing of animated poses between scene nodes using this mesh
+		virtual void setPoseCache(u32 maxPoses, f32 frameTolerance=0.f) _IRR_OVERRIDE_;
+
+		//! Gets the pose cache counters of the current scene frame
+		virtual void getPoseCacheStatistics(u32& hits, u32& misses) const _IRR_OVERRIDE_;
+
 		//! Convertes the mesh to contain tangent information
 		virtual void convertMeshToTangents() _IRR_OVERRIDE_;
 
 		//! Does the mesh have no animation
 		virtual bool isStatic() _IRR_OVERRIDE_;
 
-		//! (This feature is not implemented in irrlicht yet)
+		//! Enables hardware skinning, see ISkinnedMesh::setHardwareSkinning
 		virtual bool setHardwareSkinning(bool on) _IRR_OVERRIDE_;
 
+		//! Returns if hardware skinning is enabled
+		virtual bool getHardwareSkinning() const _IRR_OVERRIDE_;
+
+		//! Returns the joint palette of the last skinned frame
+		virtual const core::array<core::matrix4>& getJointPalette() const _IRR_OVERRIDE_;
+
+		//! Returns the joint influences of the vertices of a mesh buffer
+		virtual const video::S3DVertexJoints* getVertexJoints(u32 buffer) const _IRR_OVERRIDE_;
+
 		//Interface for the mesh loaders (finalize should lock these functions, and they should have some prefix like loader_
 		//these functions will use the needed arrays, set values, etc to help the loaders
 
@@ -146,6 +173,16 @@ namespace scene
 
 		virtual void updateBoundingBox(void);
 
+		//! Animates and skins the mesh, reusing a pose cached in the same scene frame
+		/** \param sceneTimeMs Time of the current scene frame, cached poses
+		of other frames are dropped. */
+		void animateAndSkinShared(f32 frame, f32 blend, u32 sceneTimeMs);
+
+		//! Counts the changes of the animated joints and vertices
+		/** A scene node can tell by it if the mesh is still in the pose
+		the node applied. */
+		u32 getPoseChangeCount() const { return PoseChanges; }
+
 		//! Recovers the joints from the mesh
 		void recoverJointsFromMesh(core::array<IBoneSceneNode*> &jointChildSceneNodes);
 
@@ -161,6 +198,56 @@ namespace scene
 				ISceneManager* smgr);
 
 private:
+		//! Joint influences on the vertices of one buffer, one entry per skinned vertex
+		struct SSkinInfluences
+		{
+			core::array<u32> Vertex;
+			core::array<u16> Joint[4];
+			core::array<f32> Weight[4];
+			core::array<core::vector3df> StaticPos;
+			core::array<core::vector3df> StaticNormal;
+		};
+
+		//! Poses of one joint sampled at SampleRate, empty for channels without keys
+		struct SJointSamples
+		{
+			core::array<core::vector3df> Position;
+			core::array<core::vector3df> Scale;
+			core::array<core::quaternion> Rotation;
+		};
+
+		//! Joint state of a cached pose
+		struct SPoseJoint
+		{
+			core::matrix4 LocalAnimatedMatrix;
+			core::matrix4 GlobalAnimatedMatrix;
+			core::vector3df Animatedposition;
+			core::vector3df Animatedscale;
+			core::quaternion Animatedrotation;
+		};
+
+		//! Skinned buffer state of a cached pose
+		struct SPoseBuffer
+		{
+			core::array<core::vector3df> Positions;
+			core::array<core::vector3df> Normals;
+			core::matrix4 Transformation;
+			core::aabbox3df BoundingBox;
+		};
+
+		//! Animated and skinned state of the mesh at one frame
+		struct SPose
+		{
+			f32 Frame;
+			core::array<SPoseJoint> Joints;
+			core::array<SPoseBuffer> Buffers;
+			core::aabbox3df BoundingBox;
+		};
+
+		void storePose(SPose& pose, f32 frame) const;
+		void restorePose(const SPose& pose);
+		void invalidatePoseCache();
+
 		void checkForAnimation();
 
 		void normalizeWeights();
@@ -174,10 +261,26 @@ private:
 				core::vector3df &scale, s32 &scaleHint,
 				core::quaternion &rotation, s32 &rotationHint);
 
+		bool getSampledFrameData(f32 frame, u32 jointIndex,
+				core::vector3df &position, core::vector3df &scale,
+				core::quaternion &rotation) const;
+
+		void sampleAnimation();
+
 		void calculateGlobalMatrices(SJoint *Joint,SJoint *ParentJoint);
 
 		void skinJoint(SJoint *Joint, SJoint *ParentJoint);
 
+		bool buildInfluences();
+
+		void buildSkinningPalette();
+
+		void skinInfluences();
+
+		bool buildVertexJoints();
+
+		void buildJointPalette();
+
 		void calculateTangents(core::vector3df& normal,
 			core::vector3df& tangent, core::vector3df& binormal,
 			const core::vector3df& vt1, const core::vector3df& vt2, const core::vector3df& vt3,
@@ -192,20 +295,42 @@ private:
 
 		core::array< core::array<bool> > Vertices_Moved;
 
+		core::array<SSkinInfluences> Influences;
+		core::array<core::matrix4> SkinningPalette;
+		core::array<SJointSamples> JointSamples;
+
+		// hardware skinning: palette entry 0 is identity, PaletteJoints maps entries 1.. to joints
+		core::array<core::matrix4> JointPalette;
+		core::array<u16> PaletteJoints;
+		core::array< core::array<video::S3DVertexJoints> > VertexJoints;
+
+		core::array<SPose> Poses;
+		u32 PosesUsed;
+		u32 PoseCacheSize;
+		f32 PoseFrameTolerance;
+		u32 PoseSceneTime;
+		s32 AppliedPose;
+		u32 PoseHits;
+		u32 PoseMisses;
+		u32 PoseChanges;
+
 		core::aabbox3d<f32> BoundingBox;
 
 		f32 EndFrame;
 		f32 FramesPerSecond;
 
+		f32 SampleRate;
 		f32 LastAnimatedFrame;
 		bool SkinnedLastFrame;
 
 		E_INTERPOLATION_MODE InterpolationMode:8;
+		E_SKINNING_MODE SkinningMode:8;
 
 		bool HasAnimation;
 		bool PreparedForSkinning;
 		bool AnimateNormals;
 		bool HardwareSkinning;
+		bool HasInfluences;
 	};
 
 } // end namespace scene
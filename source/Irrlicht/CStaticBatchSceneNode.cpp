@@ -0,0 +1,433 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CStaticBatchSceneNode.h"
+#include "IMeshSceneNode.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "IVideoDriver.h"
+#include "CDynamicMeshBuffer.h"
+#include "os.h"
+#include <string.h>
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+CStaticBatchSceneNode::CStaticBatchSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id)
+: IStaticBatchSceneNode(parent, mgr, id), CulledTests(0), SourceDrawCalls(0), DrawCalls(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CStaticBatchSceneNode");
+	#endif
+}
+
+
+//! destructor
+CStaticBatchSceneNode::~CStaticBatchSceneNode()
+{
+	for (u32 i=0; i<Sources.size(); ++i)
+		Sources[i]->drop();
+}
+
+
+bool CStaticBatchSceneNode::build(const core::array<IMeshSceneNode*>& nodes, f32 chunkSize)
+{
+	if (chunkSize <= 0.f)
+		return false;
+
+	// the geometry is baked into the space of the batch node
+	core::matrix4 toLocal;
+	getWorldTransformation(this).getInverse(toLocal);
+
+	core::array<SSortSource> sorted;
+	for (u32 i=0; i<nodes.size(); ++i)
+	{
+		if (!isMergeable(nodes[i]))
+			continue;
+
+		SSortSource source;
+		source.Transformation = toLocal * getWorldTransformation(nodes[i]);
+
+		core::aabbox3df box = nodes[i]->getMesh()->getBoundingBox();
+		source.Transformation.transformBoxEx(box);
+		const core::vector3df center = box.getCenter();
+		source.X = core::floor32(center.X / chunkSize);
+		source.Y = core::floor32(center.Y / chunkSize);
+		source.Z = core::floor32(center.Z / chunkSize);
+		source.Source = Sources.size();
+
+		nodes[i]->grab();
+		Sources.push_back(nodes[i]);
+		sorted.push_back(source);
+	}
+
+	if (sorted.empty())
+		return false;
+
+	// nodes in the same chunk are next to each other after sorting
+	sorted.sort();
+
+	for (u32 i=0; i<sorted.size(); )
+	{
+		SChunk chunk;
+		chunk.FirstBuffer = Mesh.getMeshBufferCount();
+		chunk.BufferCount = 0;
+
+		const SSortSource& first = sorted[i];
+		for (; i<sorted.size() && first.isSameChunk(sorted[i]); ++i)
+		{
+			const SSortSource& source = sorted[i];
+			IMeshSceneNode* node = Sources[source.Source];
+			IMesh* mesh = node->getMesh();
+
+			core::matrix4 normalTransformation;
+			source.Transformation.getInverse(normalTransformation);
+			normalTransformation = normalTransformation.getTransposed();
+
+			for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+			{
+				const IMeshBuffer* mb = mesh->getMeshBuffer(b);
+				if (!mb->getIndexCount())
+					continue;
+
+				const video::SMaterial& material = node->getMaterial(b);
+				++SourceDrawCalls;
+
+				// one merged buffer per material and vertex type
+				u32 target = chunk.FirstBuffer;
+				for (; target<chunk.FirstBuffer+chunk.BufferCount; ++target)
+				{
+					const IMeshBuffer* merged = Mesh.getMeshBuffer(target);
+					if (merged->getVertexType() == mb->getVertexType() && merged->getMaterial() == material)
+						break;
+				}
+
+				if (target == chunk.FirstBuffer+chunk.BufferCount)
+				{
+					CDynamicMeshBuffer* merged = new CDynamicMeshBuffer(mb->getVertexType(), video::EIT_32BIT);
+					merged->getMaterial() = material;
+					merged->setHardwareMappingHint(EHM_STATIC);
+					Mesh.addMeshBuffer(merged);
+					merged->drop();
+
+					SourceRanges.push_back(core::array<SSourceRange>());
+					++chunk.BufferCount;
+				}
+
+				IDynamicMeshBuffer* merged = static_cast<IDynamicMeshBuffer*>(Mesh.getMeshBuffer(target));
+				core::array<SSourceRange>& ranges = SourceRanges[target];
+				if (ranges.empty() || ranges.getLast().Source != source.Source)
+				{
+					SSourceRange range;
+					range.FirstTriangle = merged->getIndexCount() / 3;
+					range.Source = source.Source;
+					ranges.push_back(range);
+				}
+
+				appendBuffer(*merged, *mb, source.Transformation, normalTransformation);
+			}
+
+			node->setVisible(false);
+		}
+
+		if (!chunk.BufferCount)
+			continue;
+
+		for (u32 b=chunk.FirstBuffer; b<chunk.FirstBuffer+chunk.BufferCount; ++b)
+		{
+			IDynamicMeshBuffer* mb = static_cast<IDynamicMeshBuffer*>(Mesh.getMeshBuffer(b));
+			mb->getVertexBuffer().reallocate(mb->getVertexBuffer().size());
+			mb->getIndexBuffer().reallocate(mb->getIndexBuffer().size());
+			mb->recalculateBoundingBox();
+			if (b == chunk.FirstBuffer)
+				chunk.Box = mb->getBoundingBox();
+			else
+				chunk.Box.addInternalBox(mb->getBoundingBox());
+		}
+		Chunks.push_back(chunk);
+	}
+
+	if (Chunks.empty())
+		return false;
+
+	Mesh.recalculateBoundingBox();
+
+	char tmp[128];
+	snprintf_irr(tmp, 128, "Static batch: %u nodes, %u draw calls merged into %u buffers in %u chunks",
+		Sources.size(), SourceDrawCalls, Mesh.getMeshBufferCount(), Chunks.size());
+	os::Printer::log(tmp, ELL_INFORMATION);
+	return true;
+}
+
+
+bool CStaticBatchSceneNode::isMergeable(IMeshSceneNode* node)
+{
+	if (!node || !node->getMesh() || !node->isTrulyVisible() || !node->getAnimators().empty())
+		return false;
+
+	// merged nodes are made invisible, which would hide their children
+	if (!node->getChildren().empty())
+		return false;
+
+	const IMesh* mesh = node->getMesh();
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(i);
+		if (!mb || mb->getPrimitiveType() != EPT_TRIANGLES)
+			return false;
+	}
+	return true;
+}
+
+
+core::matrix4 CStaticBatchSceneNode::getWorldTransformation(const ISceneNode* node)
+{
+	// the absolute transformations might not be updated yet before the first frame
+	core::matrix4 transformation;
+	for (; node; node = node->getParent())
+		transformation = node->getRelativeTransformation() * transformation;
+	return transformation;
+}
+
+
+void CStaticBatchSceneNode::appendBuffer(IDynamicMeshBuffer& target, const IMeshBuffer& source,
+	const core::matrix4& transformation, const core::matrix4& normalTransformation)
+{
+	IVertexBuffer& vertices = target.getVertexBuffer();
+	const u32 base = vertices.size();
+	const u32 count = source.getVertexCount();
+	const u32 stride = vertices.stride();
+	// grow geometrically, set_used() only allocates what is needed
+	if (vertices.allocated_size() < base + count)
+		vertices.reallocate(core::max_(base + count, vertices.allocated_size()*2));
+	vertices.set_used(base + count);
+
+	u8* data = static_cast<u8*>(vertices.getData()) + base*stride;
+	memcpy(data, source.getVertices(), count*stride);
+
+	for (u32 i=0; i<count; ++i, data+=stride)
+	{
+		video::S3DVertex& v = *reinterpret_cast<video::S3DVertex*>(data);
+		transformation.transformVect(v.Pos);
+		normalTransformation.rotateVect(v.Normal);
+		v.Normal.normalize();
+
+		if (vertices.getType() == video::EVT_TANGENTS)
+		{
+			video::S3DVertexTangents& t = static_cast<video::S3DVertexTangents&>(v);
+			transformation.rotateVect(t.Tangent);
+			t.Tangent.normalize();
+			transformation.rotateVect(t.Binormal);
+			t.Binormal.normalize();
+		}
+	}
+
+	IIndexBuffer& indices = target.getIndexBuffer();
+	const u32 first = indices.size();
+	const u32 indexCount = source.getIndexCount();
+	if (indices.allocated_size() < first + indexCount)
+		indices.reallocate(core::max_(first + indexCount, indices.allocated_size()*2));
+	indices.set_used(first + indexCount);
+
+	u32* out = static_cast<u32*>(indices.getData()) + first;
+	if (source.getIndexType() == video::EIT_32BIT)
+	{
+		const u32* in = reinterpret_cast<const u32*>(source.getIndices());
+		for (u32 i=0; i<indexCount; ++i)
+			out[i] = base + in[i];
+	}
+	else
+	{
+		const u16* in = source.getIndices();
+		for (u32 i=0; i<indexCount; ++i)
+			out[i] = base + in[i];
+	}
+
+	target.setDirty();
+}
+
+
+void CStaticBatchSceneNode::updateChunkBoxes(u32 tests)
+{
+	Culler.clear();
+	for (u32 i=0; i<Chunks.size(); ++i)
+	{
+		core::aabbox3df box = Chunks[i].Box;
+		AbsoluteTransformation.transformBoxEx(box);
+		Culler.addBox(box, tests);
+	}
+	CulledTransformation = AbsoluteTransformation;
+	CulledTests = tests;
+}
+
+
+//! frame
+void CStaticBatchSceneNode::OnRegisterSceneNode()
+{
+	DrawCalls = 0;
+	TransparentBuffers.set_used(0);
+
+	if (!IsVisible)
+		return;
+
+	// chunks are tested with their boxes, also for sphere culling
+	u32 tests = AutomaticCullingState & (EAC_BOX | EAC_FRUSTUM_BOX);
+	if (AutomaticCullingState & EAC_FRUSTUM_SPHERE)
+		tests |= EAC_FRUSTUM_BOX;
+
+	if (Culler.size() != Chunks.size() || tests != CulledTests || CulledTransformation != AbsoluteTransformation)
+		updateChunkBoxes(tests);
+
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	const bool cull = camera && AutomaticCullingState != EAC_OFF;
+	if (cull)
+		Culler.cull(*camera->getViewFrustum());
+
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	for (u32 i=0; i<Chunks.size(); ++i)
+	{
+		if (cull && !Culler.isVisible(i))
+			continue;
+
+		const SChunk& chunk = Chunks[i];
+		for (u32 b=chunk.FirstBuffer; b<chunk.FirstBuffer+chunk.BufferCount; ++b)
+		{
+			IMeshBuffer* mb = Mesh.getMeshBuffer(b);
+			if (driver->needsTransparentRenderPass(mb->getMaterial()))
+				TransparentBuffers.push_back(mb);
+			else
+				SceneManager->registerMeshBufferForRendering(this, mb, mb->getMaterial());
+			++DrawCalls;
+		}
+	}
+
+	if (!TransparentBuffers.empty())
+		SceneManager->registerNodeForRendering(this, ESNRP_TRANSPARENT);
+	if (DebugDataVisible)
+		SceneManager->registerNodeForRendering(this, ESNRP_SOLID);
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+
+//! renders the node.
+void CStaticBatchSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+	if (SceneManager->getSceneNodeRenderPass() == ESNRP_TRANSPARENT)
+	{
+		for (u32 i=0; i<TransparentBuffers.size(); ++i)
+		{
+			driver->setMaterial(TransparentBuffers[i]->getMaterial());
+			driver->drawMeshBuffer(TransparentBuffers[i]);
+		}
+		return;
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible & (EDS_BBOX | EDS_BBOX_BUFFERS))
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & EDS_BBOX)
+			driver->draw3DBox(Mesh.getBoundingBox(), video::SColor(255,255,255,255));
+		if (DebugDataVisible & EDS_BBOX_BUFFERS)
+		{
+			for (u32 i=0; i<Chunks.size(); ++i)
+				driver->draw3DBox(Chunks[i].Box, video::SColor(255,190,128,128));
+		}
+	}
+}
+
+
+//! returns the axis aligned bounding box of this node
+const core::aabbox3d<f32>& CStaticBatchSceneNode::getBoundingBox() const
+{
+	return Mesh.getBoundingBox();
+}
+
+
+//! returns the material of a merged buffer
+video::SMaterial& CStaticBatchSceneNode::getMaterial(u32 i)
+{
+	if (i >= Mesh.getMeshBufferCount())
+		return ISceneNode::getMaterial(i);
+
+	return Mesh.getMeshBuffer(i)->getMaterial();
+}
+
+
+//! returns amount of merged buffers
+u32 CStaticBatchSceneNode::getMaterialCount() const
+{
+	return Mesh.getMeshBufferCount();
+}
+
+
+IMesh* CStaticBatchSceneNode::getMesh()
+{
+	return &Mesh;
+}
+
+
+IMeshSceneNode* CStaticBatchSceneNode::getSourceNode(u32 bufferIndex, u32 triangleIndex) const
+{
+	if (bufferIndex >= SourceRanges.size() || triangleIndex >= Mesh.getMeshBuffer(bufferIndex)->getIndexCount()/3)
+		return 0;
+
+	// last range starting at or before the triangle
+	const core::array<SSourceRange>& ranges = SourceRanges[bufferIndex];
+	u32 low = 0;
+	u32 high = ranges.size();
+	while (high - low > 1)
+	{
+		const u32 middle = (low + high) / 2;
+		if (ranges[middle].FirstTriangle <= triangleIndex)
+			low = middle;
+		else
+			high = middle;
+	}
+	return Sources[ranges[low].Source];
+}
+
+
+u32 CStaticBatchSceneNode::getSourceNodeCount() const
+{
+	return Sources.size();
+}
+
+
+IMeshSceneNode* CStaticBatchSceneNode::getSourceNode(u32 index) const
+{
+	return index < Sources.size() ? Sources[index] : 0;
+}
+
+
+u32 CStaticBatchSceneNode::getChunkCount() const
+{
+	return Chunks.size();
+}
+
+
+u32 CStaticBatchSceneNode::getSourceDrawCallCount() const
+{
+	return SourceDrawCalls;
+}
+
+
+u32 CStaticBatchSceneNode::getDrawCallCount() const
+{
+	return DrawCalls;
+}
+
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,146 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+#define __C_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+
+#include "IStaticBatchSceneNode.h"
+#include "SMesh.h"
+#include "CFrustumCuller.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IDynamicMeshBuffer;
+
+	class CStaticBatchSceneNode : public IStaticBatchSceneNode
+	{
+	public:
+
+		//! constructor
+		CStaticBatchSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id);
+
+		//! destructor
+		virtual ~CStaticBatchSceneNode();
+
+		//! Merge the source nodes
+		/** \return False if no node could be merged. */
+		bool build(const core::array<IMeshSceneNode*>& nodes, f32 chunkSize);
+
+		//! frame
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! returns the axis aligned bounding box of this node
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		//! returns the material of a merged buffer
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		//! returns amount of merged buffers
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		//! Returns if OnAnimate() of this node only changes the node and its children
+		virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
+		//! Get the merged geometry
+		virtual IMesh* getMesh() _IRR_OVERRIDE_;
+
+		//! Get the source node a triangle of a merged buffer came from
+		virtual IMeshSceneNode* getSourceNode(u32 bufferIndex, u32 triangleIndex) const _IRR_OVERRIDE_;
+
+		//! Get the amount of merged source nodes
+		virtual u32 getSourceNodeCount() const _IRR_OVERRIDE_;
+
+		//! Get a merged source node
+		virtual IMeshSceneNode* getSourceNode(u32 index) const _IRR_OVERRIDE_;
+
+		//! Get the amount of chunks
+		virtual u32 getChunkCount() const _IRR_OVERRIDE_;
+
+		//! Get the amount of draw calls the source nodes needed
+		virtual u32 getSourceDrawCallCount() const _IRR_OVERRIDE_;
+
+		//! Get the amount of merged buffers drawn in the last frame
+		virtual u32 getDrawCallCount() const _IRR_OVERRIDE_;
+
+	private:
+
+		struct SChunk
+		{
+			core::aabbox3df Box;
+			//! Buffers of the chunk are Mesh buffers [FirstBuffer, FirstBuffer+BufferCount)
+			u32 FirstBuffer;
+			u32 BufferCount;
+		};
+
+		//! Triangles of a buffer starting with FirstTriangle came from source Source
+		struct SSourceRange
+		{
+			u32 FirstTriangle;
+			u32 Source;
+		};
+
+		//! Source node with the chunk it goes into, sorts by chunk and keeps the order of the nodes in a chunk
+		struct SSortSource
+		{
+			bool operator<(const SSortSource& other) const
+			{
+				if (X != other.X)
+					return X < other.X;
+				if (Y != other.Y)
+					return Y < other.Y;
+				if (Z != other.Z)
+					return Z < other.Z;
+				return Source < other.Source;
+			}
+
+			bool isSameChunk(const SSortSource& other) const
+			{
+				return X == other.X && Y == other.Y && Z == other.Z;
+			}
+
+			s32 X;
+			s32 Y;
+			s32 Z;
+			u32 Source;
+			core::matrix4 Transformation;
+		};
+
+		//! Check if a node can be merged
+		static bool isMergeable(IMeshSceneNode* node);
+
+		//! Get the absolute transformation of a node from its relative transformations
+		static core::matrix4 getWorldTransformation(const ISceneNode* node);
+
+		//! Append the transformed buffer of a source node to a merged buffer
+		static void appendBuffer(IDynamicMeshBuffer& target, const IMeshBuffer& source,
+			const core::matrix4& transformation, const core::matrix4& normalTransformation);
+
+		//! Fill the culler with the boxes of the chunks in world space
+		void updateChunkBoxes(u32 tests);
+
+		SMesh Mesh;
+		core::array<SChunk> Chunks;
+		core::array<IMeshSceneNode*> Sources;
+		//! Per buffer, the source ranges sorted by their first triangle
+		core::array<core::array<SSourceRange> > SourceRanges;
+
+		CFrustumCuller Culler;
+		core::matrix4 CulledTransformation;
+		u32 CulledTests;
+
+		//! Merged transparent buffers to draw in the transparent pass
+		core::array<IMeshBuffer*> TransparentBuffers;
+
+		u32 SourceDrawCalls;
+		u32 DrawCalls;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
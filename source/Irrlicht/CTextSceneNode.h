@@ -61,6 +61,9 @@ namespace scene
 		//! Returns type of the scene node
 		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_TEXT; }
 
+		//! Returns if OnAnimate() of this node only changes the node and its children
+		virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
 	private:
 
 		core::stringw Text;
@@ -85,6 +88,12 @@ namespace scene
 		//! sets the vertex positions etc
 		virtual void OnAnimate(u32 timeMs) _IRR_OVERRIDE_;
 
+		//! Reads the active camera, which may be animated at the same time
+		virtual bool isAnimationThreadSafe() const _IRR_OVERRIDE_
+		{
+			return false;
+		}
+
 		//! registers the node into the transparent pass
 		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
 
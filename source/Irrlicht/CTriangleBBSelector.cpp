@@ -19,6 +19,8 @@ CTriangleBBSelector::CTriangleBBSelector(ISceneNode* node)
 	#endif
 
 	Triangles.set_used(12); // a box has 12 triangles.
+	if (SceneNode)
+		buildTriangles(SceneNode->getBoundingBox());
 }
 
 //! Gets all triangles.
@@ -55,35 +57,41 @@ void CTriangleBBSelector::getTriangles(core::triangle3df* triangles,
 
 void CTriangleBBSelector::fillTriangles() const
 {
-	if (SceneNode)
-	{
-		// construct triangles
-		const core::aabbox3d<f32>& box = SceneNode->getBoundingBox();
-		BoundingBox = box;
-		core::vector3df edges[8];
-		box.getEdges(edges);
+	if (!SceneNode)
+		return;
+
+	// Only write when the box changed, so selectors which are already up
+	// to date can be queried from several threads at once.
+	const core::aabbox3d<f32>& box = SceneNode->getBoundingBox();
+	if (box != BoundingBox)
+		buildTriangles(box);
+}
 
-		// yeah, not really const... Triangles are mutable
-		Triangles[0].set( edges[3], edges[0], edges[2]);
-		Triangles[1].set( edges[3], edges[1], edges[0]);
+void CTriangleBBSelector::buildTriangles(const core::aabbox3d<f32>& box) const
+{
+	BoundingBox = box;
+	core::vector3df edges[8];
+	box.getEdges(edges);
 
-		Triangles[2].set( edges[3], edges[2], edges[7]);
-		Triangles[3].set( edges[7], edges[2], edges[6]);
+	// yeah, not really const... Triangles are mutable
+	Triangles[0].set( edges[3], edges[0], edges[2]);
+	Triangles[1].set( edges[3], edges[1], edges[0]);
 
-		Triangles[4].set( edges[7], edges[6], edges[4]);
-		Triangles[5].set( edges[5], edges[7], edges[4]);
+	Triangles[2].set( edges[3], edges[2], edges[7]);
+	Triangles[3].set( edges[7], edges[2], edges[6]);
 
-		Triangles[6].set( edges[5], edges[4], edges[0]);
-		Triangles[7].set( edges[5], edges[0], edges[1]);
+	Triangles[4].set( edges[7], edges[6], edges[4]);
+	Triangles[5].set( edges[5], edges[7], edges[4]);
 
-		Triangles[8].set( edges[1], edges[3], edges[7]);
-		Triangles[9].set( edges[1], edges[7], edges[5]);
+	Triangles[6].set( edges[5], edges[4], edges[0]);
+	Triangles[7].set( edges[5], edges[0], edges[1]);
 
-		Triangles[10].set(edges[0], edges[6], edges[2]);
-		Triangles[11].set(edges[0], edges[4], edges[6]);
-	}
-}
+	Triangles[8].set( edges[1], edges[3], edges[7]);
+	Triangles[9].set( edges[1], edges[7], edges[5]);
 
+	Triangles[10].set(edges[0], edges[6], edges[2]);
+	Triangles[11].set(edges[0], edges[4], edges[6]);
+}
 
 } // end namespace scene
 } // end namespace irr
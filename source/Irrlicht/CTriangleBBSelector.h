@@ -38,6 +38,7 @@ public:
 
 protected:
 	void fillTriangles() const;
+	void buildTriangles(const core::aabbox3d<f32>& box) const;
 
 };
 
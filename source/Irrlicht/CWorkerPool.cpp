@@ -0,0 +1,249 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CWorkerPool.h"
+
+namespace irr
+{
+
+namespace
+{
+	// index of the current thread inside its pool, 0 for all other threads
+	thread_local u32 ThreadIndex = 0;
+	// set while the current thread executes a job
+	thread_local bool InsideJob = false;
+	// set for the threads owned by a pool
+	thread_local bool IsWorker = false;
+	// tasks run by the current thread, see getTaskNumber()
+	thread_local u32 TaskCount = 0;
+	thread_local u32 TaskNumber = 0;
+}
+
+CWorkerPool& getWorkerPool()
+{
+	static CWorkerPool pool;
+	return pool;
+}
+
+CWorkerPool::CWorkerPool(u32 threadCount)
+	: Current(0), Generation(0), Active(0), Quit(false), Threaded(false)
+{
+	startWorkers(threadCount);
+}
+
+CWorkerPool::~CWorkerPool()
+{
+	stopWorkers();
+}
+
+void CWorkerPool::setThreadCount(u32 threadCount)
+{
+	std::lock_guard<std::mutex> submit(SubmitMutex);
+	stopWorkers();
+	startWorkers(threadCount);
+}
+
+bool CWorkerPool::isWorkerThread()
+{
+	return IsWorker;
+}
+
+u32 CWorkerPool::getTaskNumber()
+{
+	return TaskNumber;
+}
+
+void CWorkerPool::startWorkers(u32 threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0)
+		threadCount = 1;
+
+	Quit = false;
+	for (u32 i=1; i<threadCount; ++i)
+		Workers.push_back(std::thread(&CWorkerPool::workerMain, this, i));
+
+	// tasks queued for the old workers have nobody left to run them
+	std::deque<IWorkerTask*> tasks;
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Threaded = !Workers.empty();
+		if (!Threaded)
+			tasks.swap(Tasks);
+	}
+	WakeUp.notify_all();
+
+	for (size_t i=0; i<tasks.size(); ++i)
+		runTask(tasks[i]);
+}
+
+void CWorkerPool::stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Quit = true;
+	}
+	WakeUp.notify_all();
+
+	for (size_t i=0; i<Workers.size(); ++i)
+		Workers[i].join();
+	Workers.clear();
+}
+
+void CWorkerPool::runInline(IWorkerJob& job, u32 count)
+{
+	const bool wasInside = InsideJob;
+	InsideJob = true;
+	job.run(0, count, ThreadIndex);
+	InsideJob = wasInside;
+}
+
+void CWorkerPool::runBatch(SBatch& batch, u32 thread)
+{
+	const bool wasInside = InsideJob;
+	InsideJob = true;
+
+	for (;;)
+	{
+		const u32 begin = batch.Next.fetch_add(batch.Grain);
+		if (begin >= batch.Count)
+			break;
+		const u32 end = (batch.Count - begin > batch.Grain) ? begin + batch.Grain : batch.Count;
+		batch.Job->run(begin, end, thread);
+	}
+
+	InsideJob = wasInside;
+}
+
+void CWorkerPool::runTask(IWorkerTask* task)
+{
+	const bool wasInside = InsideJob;
+	const u32 previousTask = TaskNumber;
+	InsideJob = true;
+	TaskNumber = ++TaskCount;
+	if (TaskNumber == 0)
+		TaskNumber = ++TaskCount;
+	task->run();
+	TaskNumber = previousTask;
+	InsideJob = wasInside;
+}
+
+void CWorkerPool::workerMain(u32 thread)
+{
+	ThreadIndex = thread;
+	IsWorker = true;
+
+	u32 seen = 0;
+	std::unique_lock<std::mutex> lock(Mutex);
+	for (;;)
+	{
+		WakeUp.wait(lock, [&]{ return Quit || (Current && Generation != seen) || !Tasks.empty(); });
+		if (Quit)
+			return;
+
+		if (!Current || Generation == seen)
+		{
+			IWorkerTask* task = Tasks.front();
+			Tasks.pop_front();
+			lock.unlock();
+
+			runTask(task);
+
+			lock.lock();
+			continue;
+		}
+
+		seen = Generation;
+		SBatch* batch = Current;
+		++Active;
+		lock.unlock();
+
+		runBatch(*batch, thread);
+
+		lock.lock();
+		if (--Active == 0)
+			Finished.notify_all();
+	}
+}
+
+void CWorkerPool::submit(IWorkerTask* task)
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		if (Threaded)
+		{
+			Tasks.push_back(task);
+			WakeUp.notify_one();
+			return;
+		}
+	}
+
+	runTask(task);
+}
+
+bool CWorkerPool::cancel(IWorkerTask* task)
+{
+	std::lock_guard<std::mutex> lock(Mutex);
+	for (std::deque<IWorkerTask*>::iterator it=Tasks.begin(); it!=Tasks.end(); ++it)
+	{
+		if (*it == task)
+		{
+			Tasks.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+u32 CWorkerPool::getQueuedTaskCount()
+{
+	std::lock_guard<std::mutex> lock(Mutex);
+	return (u32)Tasks.size();
+}
+
+void CWorkerPool::parallelFor(IWorkerJob& job, u32 count, u32 grain)
+{
+	if (count == 0)
+		return;
+	if (grain == 0)
+		grain = 1;
+
+	// nothing to share or nested call: run inline
+	if (count <= grain || InsideJob)
+	{
+		runInline(job, count);
+		return;
+	}
+
+	// Workers only changes under SubmitMutex, see setThreadCount()
+	std::unique_lock<std::mutex> submit(SubmitMutex);
+	if (Workers.empty())
+	{
+		submit.unlock();
+		runInline(job, count);
+		return;
+	}
+
+	SBatch batch;
+	batch.Job = &job;
+	batch.Count = count;
+	batch.Grain = grain;
+	batch.Next = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Current = &batch;
+		++Generation;
+	}
+	WakeUp.notify_all();
+
+	runBatch(batch, 0);
+
+	// all chunks are taken, wait for workers still busy with theirs
+	std::unique_lock<std::mutex> lock(Mutex);
+	Current = 0;
+	Finished.wait(lock, [&]{ return Active == 0; });
+}
+
+} // end namespace irr
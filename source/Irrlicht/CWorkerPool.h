@@ -0,0 +1,128 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_WORKER_POOL_H_INCLUDED__
+#define __C_WORKER_POOL_H_INCLUDED__
+
+#include "irrTypes.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace irr
+{
+
+//! A piece of work which can be split into independent index ranges
+class IWorkerJob
+{
+public:
+	virtual ~IWorkerJob() {}
+
+	//! Process the items [begin, end)
+	/** \param thread Index of the executing thread, 0 for the calling
+	thread and 1..getThreadCount()-1 for the workers. Can be used to
+	address per-thread scratch memory. All threads outside of the pool
+	get index 0, so jobs using scratch memory must only be started from
+	one thread at a time, usually the render thread. */
+	virtual void run(u32 begin, u32 end, u32 thread) = 0;
+};
+
+//! A piece of work which runs on its own in the background
+class IWorkerTask
+{
+public:
+	virtual ~IWorkerTask() {}
+
+	//! Do the work, called once by a worker thread
+	virtual void run() = 0;
+};
+
+//! Small pool of worker threads used by the engine internally
+/** The calling thread always takes part in the work, so a pool with
+a thread count of 1 runs everything inline. Calls from inside a job
+are executed inline as well, so jobs may use parallelFor themselves.
+Besides the parallelFor batches the workers run background tasks in the
+order they were submitted, batches go first. */
+class CWorkerPool
+{
+public:
+
+	//! Creates a pool with threadCount threads (including the caller).
+	/** 0 picks one thread per hardware core. */
+	explicit CWorkerPool(u32 threadCount=0);
+
+	~CWorkerPool();
+
+	//! Number of threads taking part in a parallelFor, including the caller
+	u32 getThreadCount() const { return (u32)Workers.size()+1; }
+
+	//! Restarts the pool with a new number of threads. 0 means one per core.
+	void setThreadCount(u32 threadCount);
+
+	//! Runs job over [0, count) split into chunks of at least grain items.
+	/** Returns when all items have been processed. Can be called from
+	any thread, but see IWorkerJob::run() about per-thread scratch. */
+	void parallelFor(IWorkerJob& job, u32 count, u32 grain);
+
+	//! Queues a task to run on a worker thread
+	/** Returns at once. The pool does not own the task, it has to stay
+	valid until it ran or was cancelled. Without worker threads the
+	task runs inline. */
+	void submit(IWorkerTask* task);
+
+	//! Removes a task from the queue
+	/** \return True if the task had not started yet and will not run,
+	false if it is running or already done. */
+	bool cancel(IWorkerTask* task);
+
+	//! Number of tasks waiting for a worker
+	u32 getQueuedTaskCount();
+
+	//! True when called from one of the pool's worker threads
+	static bool isWorkerThread();
+
+	//! Number of the task the calling thread runs, 0 outside of tasks
+	/** Changes with every task a thread runs, so state kept per thread
+	can tell when a new task started. */
+	static u32 getTaskNumber();
+
+private:
+
+	struct SBatch
+	{
+		IWorkerJob* Job;
+		u32 Count;
+		u32 Grain;
+		std::atomic<u32> Next;
+	};
+
+	void startWorkers(u32 threadCount);
+	void stopWorkers();
+	void workerMain(u32 thread);
+	static void runInline(IWorkerJob& job, u32 count);
+	static void runBatch(SBatch& batch, u32 thread);
+	static void runTask(IWorkerTask* task);
+
+	std::vector<std::thread> Workers;
+	std::mutex Mutex;
+	std::condition_variable WakeUp;
+	std::condition_variable Finished;
+	std::mutex SubmitMutex;
+	SBatch* Current;
+	std::deque<IWorkerTask*> Tasks;
+	u32 Generation;
+	u32 Active;
+	bool Quit;
+	//! Submitted tasks are queued for the workers, else they run inline
+	bool Threaded;
+};
+
+//! Returns the pool shared by all engine subsystems
+CWorkerPool& getWorkerPool();
+
+} // end namespace irr
+
+#endif // __C_WORKER_POOL_H_INCLUDED__
@@ -15,6 +15,8 @@ extern "C" void bz_internal_error(int errorCode)
 
 #include "CFileList.h"
 #include "CReadFile.h"
+#include "CInflateReadFile.h"
+#include "CMappedReadFile.h"
 #include "coreutil.h"
 
 #ifdef _IRR_COMPILE_WITH_ZLIB_
@@ -136,7 +138,8 @@ bool CArchiveLoaderZIP::isALoadableFileFormat(io::IReadFile* file) const
 // -----------------------------------------------------------------------------
 
 CZipReader::CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip)
- : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), FileSystem(fs), File(file), IsGZip(isGZip)
+ : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), FileSystem(fs), File(file), IsGZip(isGZip),
+	StreamMinSize(0xffffffff), StreamWindowSize(32768)
 {
 	#ifdef _DEBUG
 	setDebugName("CZipReader");
@@ -163,6 +166,14 @@ CZipReader::~CZipReader()
 }
 
 
+//! Set when deflated files are inflated while they are read
+void CZipReader::setStreamingThresholds(u32 minStreamSize, u32 windowSize)
+{
+	StreamMinSize = minStreamSize;
+	StreamWindowSize = windowSize;
+}
+
+
 //! get the archive type
 E_FILE_ARCHIVE_TYPE CZipReader::getType() const
 {
@@ -538,11 +549,12 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 		os::Printer::log("Reading encrypted file.");
 		u8 salt[16]={0};
 		const u16 saltSize = (((e.header.Sig & 0x00ff0000) >>16)+1)*4;
-		File->seek(e.Offset);
-		File->read(salt, saltSize);
+		// files opened from the archive may be read by other threads
+		long pos = e.Offset;
+		pos += (long)readFileAt(File, pos, salt, saltSize);
 		char pwVerification[2];
 		char pwVerificationFile[2];
-		File->read(pwVerification, 2);
+		pos += (long)readFileAt(File, pos, pwVerification, 2);
 		fcrypt_ctx zctx; // the encryption context
 		int rc = fcrypt_init(
 			(e.header.Sig & 0x00ff0000) >>16,
@@ -561,14 +573,14 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 		u32 c = 0;
 		while ((c+32768)<=decryptedSize)
 		{
-			File->read(decryptedBuf+c, 32768);
+			pos += (long)readFileAt(File, pos, decryptedBuf+c, 32768);
 			fcrypt_decrypt(
 				decryptedBuf+c, // pointer to the data to decrypt
 				32768,   // how many bytes to decrypt
 				&zctx); // decryption context
 			c+=32768;
 		}
-		File->read(decryptedBuf+c, decryptedSize-c);
+		pos += (long)readFileAt(File, pos, decryptedBuf+c, decryptedSize-c);
 		fcrypt_decrypt(
 			decryptedBuf+c, // pointer to the data to decrypt
 			decryptedSize-c,   // how many bytes to decrypt
@@ -585,7 +597,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 			delete [] decryptedBuf;
 			return 0;
 		}
-		File->read(fileMAC, 10);
+		readFileAt(File, pos, fileMAC, 10);
 		if (strncmp(fileMAC, resMAC, 10))
 		{
 			os::Printer::log("Error on encryption check");
@@ -623,6 +635,11 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
   			#ifdef _IRR_COMPILE_WITH_ZLIB_
 
 			const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
+
+			// large files are inflated while they are read, encrypted ones are already in memory
+			if (!decrypted && uncompressedSize >= StreamMinSize)
+				return new CInflateReadFile(File, e.Offset, decryptedSize, uncompressedSize, StreamWindowSize, Files[index].FullName);
+
 			c8* pBuf = new c8[ uncompressedSize ];
 			if (!pBuf)
 			{
@@ -633,8 +650,15 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				return 0;
 			}
 
+			// an archive in memory is inflated without copying the compressed data
+			const u8* archiveMemory = getReadFileMemory(File);
+			if (archiveMemory && (long)e.Offset + (long)decryptedSize > File->getSize())
+				archiveMemory = 0;
+
 			u8 *pcData = decryptedBuf;
-			if (!pcData)
+			if (!pcData && archiveMemory)
+				pcData = const_cast<u8*>(archiveMemory) + e.Offset;
+			else if (!pcData)
 			{
 				pcData = new u8[decryptedSize];
 				if (!pcData)
@@ -646,8 +670,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				readFileAt(File, e.Offset, pcData, decryptedSize);
 			}
 
 			// Setup the inflate stream.
@@ -675,7 +698,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 
 			if (decrypted)
 				decrypted->drop();
-			else
+			else if (!archiveMemory)
 				delete[] pcData;
 
 			if (err != Z_OK)
@@ -720,8 +743,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				readFileAt(File, e.Offset, pcData, decryptedSize);
 			}
 
 			bz_stream bz_ctx;
@@ -793,8 +815,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				readFileAt(File, e.Offset, pcData, decryptedSize);
 			}
 
 			ELzmaStatus status;
@@ -198,6 +198,9 @@ namespace io
 		//! return the id of the file Archive
 		virtual const io::path& getArchiveName() const _IRR_OVERRIDE_ {return Path;}
 
+		//! Set when deflated files are inflated while they are read
+		virtual void setStreamingThresholds(u32 minStreamSize, u32 windowSize) _IRR_OVERRIDE_;
+
 	protected:
 
 		//! reads the next file header from a ZIP file, returns false if there are no more headers.
@@ -218,6 +221,11 @@ namespace io
 		core::array<SZipFileEntry> FileInfo;
 
 		bool IsGZip;
+
+		//! Deflated files of at least this size are inflated while they are read
+		u32 StreamMinSize;
+		//! Inflated bytes kept by a streamed file
+		u32 StreamWindowSize;
 	};
 
 
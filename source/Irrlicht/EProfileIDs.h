@@ -25,6 +25,7 @@ namespace irr
 		EPID_SM_RENDER_TRANSPARENT,
 		EPID_SM_RENDER_EFFECT,
 		EPID_SM_REGISTER,
+		EPID_SM_CULL,
 
 		//! octrees
 		EPID_OC_RENDER,
@@ -47,6 +47,11 @@ namespace core
 	irr::core::stringc LOCALE_DECIMAL_POINTS(".");
 }
 
+namespace scene
+{
+	std::atomic<u32> TransformationUpdateCounter(0);
+}
+
 namespace video
 {
 	SMaterial IdentityMaterial;
@@ -5,6 +5,8 @@
 #include "os.h"
 #include "irrString.h"
 #include "irrMath.h"
+#include "irrArray.h"
+#include "CWorkerPool.h"
 
 #include "SDL_endian.h"
 #define bswap_16(X) SDL_Swap16(X)
@@ -265,28 +267,87 @@ namespace os
 	// The platform independent implementation of the printer
 	ILogger* Printer::Logger = 0;
 
+	namespace
+	{
+		// messages of worker threads waiting for flushLog()
+		struct SQueuedLog
+		{
+			core::stringc Text;
+			ELOG_LEVEL Level;
+		};
+
+		std::mutex LogQueueMutex;
+		core::array<SQueuedLog> LogQueue;
+	}
+
+	// The logger passes messages to the user's event receiver, which
+	// expects to be called on the render thread. So messages of worker
+	// threads wait for flushLog().
+	void Printer::queueLog(const c8* message, ELOG_LEVEL ll)
+	{
+		SQueuedLog entry;
+		entry.Text = message;
+		entry.Level = ll;
+
+		std::lock_guard<std::mutex> lock(LogQueueMutex);
+		LogQueue.push_back(entry);
+	}
+
+	void Printer::flushLog()
+	{
+		core::array<SQueuedLog> queue;
+		{
+			std::lock_guard<std::mutex> lock(LogQueueMutex);
+			if (LogQueue.empty())
+				return;
+			queue.swap(LogQueue);
+		}
+
+		for (u32 i=0; i<queue.size(); ++i)
+			log(queue[i].Text.c_str(), queue[i].Level);
+	}
+
 	void Printer::log(const c8* message, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (!Logger)
+			return;
+
+		if (CWorkerPool::isWorkerThread())
+			queueLog(message, ll);
+		else
 			Logger->log(message, ll);
 	}
 
 	void Printer::log(const wchar_t* message, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (!Logger)
+			return;
+
+		if (CWorkerPool::isWorkerThread())
+			queueLog(core::stringc(message).c_str(), ll);
+		else
 			Logger->log(message, ll);
 	}
 
 	void Printer::log(const c8* message, const c8* hint, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (!Logger)
+			return;
+
+		if (CWorkerPool::isWorkerThread())
+		{
+			core::stringc text = message;
+			text += ": ";
+			text += hint;
+			queueLog(text.c_str(), ll);
+		}
+		else
 			Logger->log(message, hint, ll);
 	}
 
 	void Printer::log(const c8* message, const io::path& hint, ELOG_LEVEL ll)
 	{
-		if (Logger)
-			Logger->log(message, hint.c_str(), ll);
+		log(message, core::stringc(hint).c_str(), ll);
 	}
 
 	// our Randomizer is not really os specific, so we
@@ -40,7 +40,12 @@ namespace os
 		static void log(const wchar_t* message, ELOG_LEVEL ll = ELL_INFORMATION);
 		static void log(const c8* message, const c8* hint, ELOG_LEVEL ll = ELL_INFORMATION);
 		static void log(const c8* message, const io::path& hint, ELOG_LEVEL ll = ELL_INFORMATION);
+		// passes messages logged by worker threads to the Logger, call it on the render thread
+		static void flushLog();
 		static ILogger* Logger;
+	private:
+		// on worker threads log() queues the messages instead
+		static void queueLog(const c8* message, ELOG_LEVEL ll);
 	};
 
 